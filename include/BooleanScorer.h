@@ -12,15 +12,21 @@
 
 namespace Lucene {
 
-/// BooleanScorer uses a ~16k array to score windows of docs. So it scores docs 0-16k first, then docs 16-32k,
-/// etc. For each window it iterates through all query terms and accumulates a score in table[doc%16k]. It also
-/// stores in the table a bitmask representing which terms contributed to the score.  Non-zero scores are chained
-/// in a linked list. At the end of scoring each window it then iterates through the linked list and, if the
-/// bitmask matches the boolean constraints, collects a hit.  For boolean queries with lots of frequent terms this
-/// can be much faster, since it does not need to update a priority queue for each posting, instead performing
+/// BooleanScorer uses a 4k table to score windows of docs. So it scores docs 0-4k first, then docs 4-8k, etc.
+/// For each window it iterates through all query terms and accumulates a score in table[doc%4k]. It also stores
+/// in the table a bitmask representing which terms contributed to the score.  The slots holding a score are
+/// chained by index through the table's next array. At the end of scoring each window it then walks that chain
+/// and, if the bitmask matches the boolean constraints, collects a hit.  For boolean queries with lots of frequent terms this can be
+/// much faster, since it does not need to update a priority queue for each posting, instead performing
 /// constant-time operations per posting.  The only downside is that it results in hits being delivered out-of-order
 /// within the window, which means it cannot be nested within other scorers.  But it works well as a top-level scorer.
 ///
+/// The table is a {@link BucketTable} of flat parallel arrays, about 100KB in all, so that a window stays in the
+/// L2 cache.  A scorer hands its table on to the next BooleanScorer created on the same thread, so the table is
+/// not allocated again for each segment of each query.  Term clauses add their postings to it in batches of
+/// decoded documents and scores (see {@link TermScorer#nextScores}); other clauses go through a {@link
+/// Collector} for each document.
+///
 /// The new BooleanScorer2 implementation instead works by merging priority queues of postings, albeit with some
 /// clever tricks.  For example, a pure conjunction (all terms required) does not require a priority queue. Instead it
 /// sorts the posting streams at the start, then repeatedly skips the first to to the last.  If the first ever equals
@@ -45,13 +51,21 @@ protected:
     int32_t nextMask;
     int32_t minNrShouldMatch;
     int32_t end;
-    BucketPtr current;
+    int32_t current; // slot of the current document in the bucket table
     int32_t doc;
 
+    // documents and scores read in batches from term clauses
+    Collection<int32_t> docBuffer;
+    Collection<double> scoreBuffer;
+
 protected:
     // firstDocID is ignored since nextDoc() initializes 'current'
     virtual bool score(const CollectorPtr& collector, int32_t max, int32_t firstDocID);
 
+    /// Moves on to the next window and adds the matches of every clause in it to the bucket table.
+    /// @return true if more matching documents may remain.
+    bool fillWindow();
+
 public:
     virtual int32_t advance(int32_t target);
     virtual int32_t docID();
@@ -108,22 +122,8 @@ public:
     virtual double score();
 };
 
-class Bucket : public LuceneObject {
-public:
-    Bucket();
-    virtual ~Bucket();
-
-    LUCENE_CLASS(Bucket);
-
-public:
-    int32_t doc; // tells if bucket is valid
-    double score; // incremental score
-    int32_t bits; // used for bool constraints
-    int32_t coord; // count of terms in score
-    BucketWeakPtr _next; // next valid bucket
-};
-
-/// A simple hash table of document scores within a range.
+/// A simple hash table of document scores within a range, stored as parallel arrays.  The valid slots are
+/// chained through next, starting at first.
 class BucketTable : public LuceneObject {
 public:
     BucketTable();
@@ -135,23 +135,53 @@ public:
     static const int32_t SIZE;
     static const int32_t MASK;
 
-    Collection<BucketPtr> buckets;
-    BucketPtr first; // head of valid list
+    Collection<int32_t> docs; // tells if slot is valid
+    Collection<double> scores; // incremental score
+    Collection<int32_t> bits; // used for bool constraints
+    Collection<int32_t> coords; // count of terms in score
+    Collection<int32_t> next; // next valid slot
+    int32_t first; // head of valid list, -1 if empty
 
 public:
     CollectorPtr newCollector(int32_t mask);
     int32_t size();
+
+    /// Invalidates every slot, for reuse on another segment.
+    void clear();
+
+    /// Adds the score of a clause to a document.
+    inline void add(int32_t doc, double score, int32_t mask) {
+        int32_t i = doc & MASK;
+        if (docs[i] != doc) { // invalid slot
+            docs[i] = doc; // set doc
+            scores[i] = score; // initialize score
+            bits[i] = mask; // initialize mask
+            coords[i] = 1; // initialize coord
+
+            next[i] = first; // push onto valid list
+            first = i;
+        } else {
+            scores[i] += score; // increment score
+            bits[i] |= mask; // add bits in mask
+            ++coords[i]; // increment coord
+        }
+    }
+
+    /// Adds the scores of a clause to a batch of documents.
+    void add(Collection<int32_t> docBuffer, Collection<double> scoreBuffer, int32_t count, int32_t mask);
 };
 
 class SubScorer : public LuceneObject {
 public:
-    SubScorer(const ScorerPtr& scorer, bool required, bool prohibited, const CollectorPtr& collector, const SubScorerPtr& next);
+    SubScorer(const ScorerPtr& scorer, bool required, bool prohibited, int32_t mask, const CollectorPtr& collector, const SubScorerPtr& next);
     virtual ~SubScorer();
 
     LUCENE_CLASS(SubScorer);
 
 public:
     ScorerPtr scorer;
+    TermScorerPtr termScorer; // set if the clause can be read in batches
+    int32_t mask;
     bool required;
     bool prohibited;
     CollectorPtr collector;
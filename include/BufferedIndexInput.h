@@ -36,6 +36,14 @@ public:
     /// @see IndexOutput#writeByte(uint8_t)
     virtual uint8_t readByte();
 
+    /// Reads an int stored in variable-length format, decoding straight from the buffer when possible.
+    /// @see IndexOutput#writeVInt(int32_t)
+    virtual int32_t readVInt();
+
+    /// Reads count ints stored in variable-length format, decoding in bulk from the buffer.
+    /// @see #readVInt()
+    virtual void readVInts(int32_t* values, int32_t count);
+
     /// Change the buffer size used by this IndexInput.
     void setBufferSize(int32_t newSize);
 
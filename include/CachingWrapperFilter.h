@@ -53,7 +53,8 @@ protected:
     /// Provide the DocIdSet to be cached, using the DocIdSet provided by the wrapped Filter.
     ///
     /// This implementation returns the given {@link DocIdSet}, if {@link DocIdSet#isCacheable} returns
-    /// true, else it copies the {@link DocIdSetIterator} into an {@link OpenBitSetDISI}.
+    /// true, else it copies the {@link DocIdSetIterator} into a {@link RoaringDocIdSet}, whose size
+    /// follows the number and layout of the matching documents rather than maxDoc.
     DocIdSetPtr docIdSetToCache(const DocIdSetPtr& docIdSet, const IndexReaderPtr& reader);
 
 public:
@@ -11,7 +11,27 @@
 
 namespace Lucene {
 
+/// Per-thread slot table backing {@link CloseableThreadLocal}.  Each thread keeps its own table of weak
+/// references keyed by the id of the owning thread-local, so lookups from the current thread take no lock.
+class LPPAPI ThreadLocalSlots {
+public:
+    /// Returns a new slot id, never reused for the lifetime of the process.
+    static int64_t newId();
+
+    /// Returns the value stored by the current thread in the given slot, or null if there is none or it has
+    /// since been released.
+    static boost::shared_ptr<void> get(int64_t id);
+
+    /// Stores a weak reference to value in the given slot of the current thread.
+    static void set(int64_t id, const boost::shared_ptr<void>& value);
+};
+
 /// General purpose thread-local map.
+///
+/// Values are looked up through a per-thread slot table holding weak references, so {@link #get()} does not
+/// take a lock once the calling thread has a value.  The strong references are held by this object, keyed by
+/// thread, so values are released when the thread-local is closed or destroyed rather than living on in the
+/// threads that created them.
 template <typename TYPE>
 class CloseableThreadLocal : public LuceneObject {
 public:
@@ -19,19 +39,19 @@ public:
     typedef Map<int64_t, localDataPtr> MapLocalData;
 
     CloseableThreadLocal() {
+        id = ThreadLocalSlots::newId();
         localData = MapLocalData::newInstance();
     }
 
 public:
     localDataPtr get() {
-        SyncLock syncLock(this);
-        typename MapLocalData::iterator local = localData.find(LuceneThread::currentId());
-        if (local != localData.end()) {
-            return local->second;
+        localDataPtr local(boost::static_pointer_cast<TYPE>(ThreadLocalSlots::get(id)));
+        if (local) {
+            return local;
         }
         localDataPtr initial(initialValue());
         if (initial) {
-            localData.put(LuceneThread::currentId(), initial);
+            set(initial);
         }
         return initial;
     }
@@ -39,6 +59,7 @@ public:
     void set(const localDataPtr& data) {
         SyncLock syncLock(this);
         localData.put(LuceneThread::currentId(), data);
+        ThreadLocalSlots::set(id, data);
     }
 
     void close() {
@@ -47,7 +68,8 @@ public:
     }
 
 protected:
-    MapLocalData localData;
+    int64_t id;
+    MapLocalData localData; // strong references, keyed by thread
 
     virtual localDataPtr initialValue() {
         return localDataPtr(); // override
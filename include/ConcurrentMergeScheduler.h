@@ -12,10 +12,19 @@
 namespace Lucene {
 
 /// A {@link MergeScheduler} that runs each merge using a separate thread, up until a
-/// maximum number of threads ({@link #setMaxThreadCount}) at which when a merge is needed,
+/// maximum number of merges ({@link #setMaxMergeCount}) at which when a merge is needed,
 /// the thread(s) that are updating the index will pause until one or more merges completes.
 /// This is a simple way to use concurrency in the indexing process without having to create
 /// and manage application level threads.
+///
+/// At most {@link #getMaxThreadCount} merges run at once: the smallest ones, by number of
+/// documents.  The others are paused until enough of them complete, so that newly flushed
+/// segments are merged away while a large merge waits rather than piling up behind it.
+/// The combined write rate of the running merges can be limited with {@link
+/// #setMergeWriteMBPerSec}, to leave disk bandwidth to searches.
+///
+/// By default every merge gets its own thread.  Alternatively merges can be run on a shared
+/// {@link ThreadPool} (see {@link #setThreadPool}), for example the same pool used for searching.
 class LPPAPI ConcurrentMergeScheduler : public MergeScheduler {
 public:
     ConcurrentMergeScheduler();
@@ -31,6 +40,15 @@ protected:
     /// Max number of threads allowed to be merging at once
     int32_t maxThreadCount;
 
+    /// Max number of merges started at once, the ones beyond maxThreadCount are paused
+    int32_t maxMergeCount;
+
+    /// Max combined write rate of all merges, 0 if not limited
+    double mergeWriteMBPerSec;
+
+    /// Shared by all merges started while the write rate is limited, so that they split the rate
+    RateLimiterPtr rateLimiter;
+
     DirectoryPtr dir;
 
     bool closed;
@@ -41,17 +59,51 @@ protected:
     bool suppressExceptions;
     static bool anyExceptions;
 
+    /// Optional pool used to run merges instead of dedicated threads
+    ThreadPoolPtr threadPool;
+
 public:
     virtual void initialize();
 
-    /// Sets the max # simultaneous threads that may be running.  If a merge is necessary yet
-    /// we already have this many threads running, the incoming thread (that is calling
-    /// add/updateDocument) will block until a merge thread has completed.
+    /// Sets the max # simultaneous merge threads that may be running.  Merges started beyond
+    /// this are paused, largest first, until others complete.  The default is between 1 and 3,
+    /// half the number of processors.  It doesn't take the number of disks or their kind into
+    /// account, which can't be detected portably: use 1 for an index on a spinning disk, where
+    /// concurrent merges compete for the disk head.  Raises {@link #getMaxMergeCount} to count
+    /// if needed.
     virtual void setMaxThreadCount(int32_t count);
 
     /// Get the max # simultaneous threads that may be running. @see #setMaxThreadCount.
     virtual int32_t getMaxThreadCount();
 
+    /// Sets the max # merges that may be started at once, running or paused.  If a merge is
+    /// necessary yet we already have this many, the incoming thread (that is calling
+    /// add/updateDocument) will block until a merge has completed.  This must be at least
+    /// {@link #getMaxThreadCount}; the default is 2 more.
+    virtual void setMaxMergeCount(int32_t count);
+
+    /// Get the max # merges that may be started at once. @see #setMaxMergeCount.
+    virtual int32_t getMaxMergeCount();
+
+    /// Limits the rate at which merges write merged segments, in MB per second, or 0 to not limit
+    /// it (the default).  The rate is shared by all running merges rather than given to each of
+    /// them.  Merges already limited switch to a new rate, but keep the last one when the limit
+    /// is removed; merges started at full speed keep it.
+    /// @see RateLimiter
+    virtual void setMergeWriteMBPerSec(double mbPerSec);
+
+    /// Get the max rate at which merges write. @see #setMergeWriteMBPerSec.
+    virtual double getMergeWriteMBPerSec();
+
+    /// Run merges on the given thread pool rather than on dedicated merge threads.  At most
+    /// {@link #getMaxMergeCount} merges are still scheduled at once.  Pass null to go back
+    /// to dedicated threads.  Thread priorities are not applied to pooled merges.
+    virtual void setThreadPool(const ThreadPoolPtr& threadPool);
+
+    /// Get the thread pool merges are run on, or null if each merge gets a dedicated thread.
+    /// @see #setThreadPool
+    virtual ThreadPoolPtr getThreadPool();
+
     /// Return the priority that merge threads run at.  By default the priority is 1 plus the
     /// priority of (ie, slightly higher priority than) the first thread that calls merge.
     virtual int32_t getMergeThreadPriority();
@@ -82,6 +134,9 @@ protected:
     virtual void initMergeThreadPriority();
     virtual int32_t mergeThreadCount();
 
+    /// Runs the smallest merges, up to {@link #getMaxThreadCount}, and pauses the others.
+    virtual void updateMergeThreads();
+
     /// Does the actual merge, by calling {@link IndexWriter#merge}
     virtual void doMerge(const OneMergePtr& merge);
 
@@ -14,16 +14,20 @@ namespace Lucene {
 /// Implements the skip list reader for the default posting list format that stores positions and payloads.
 class DefaultSkipListReader : public MultiLevelSkipListReader {
 public:
-    DefaultSkipListReader(const IndexInputPtr& skipStream, int32_t maxSkipLevels, int32_t skipInterval);
+    /// @param hasMaxFreq Whether skip entries store the highest frequency of their block, see {@link
+    /// TermInfosWriter#FORMAT_BLOCK_MAX_FREQ}.
+    DefaultSkipListReader(const IndexInputPtr& skipStream, int32_t maxSkipLevels, int32_t skipInterval, bool hasMaxFreq = false);
     virtual ~DefaultSkipListReader();
 
     LUCENE_CLASS(DefaultSkipListReader);
 
 protected:
     bool currentFieldStoresPayloads;
+    bool hasMaxFreq;
     Collection<int64_t> freqPointer;
     Collection<int64_t> proxPointer;
     Collection<int32_t> payloadLength;
+    Collection<int32_t> maxFreq;
 
     int64_t lastFreqPointer;
     int64_t lastProxPointer;
@@ -44,6 +48,10 @@ public:
     /// MultiLevelSkipListReader#skipTo(int)} has skipped.
     int32_t getPayloadLength();
 
+    /// Returns the highest frequency of the term in the block of docs ending at the current skip entry on the
+    /// given level, or 0 if it is not stored.
+    int32_t getMaxFreq(int32_t level);
+
 protected:
     /// Seeks the skip entry on the given level
     virtual void seekChild(int32_t level);
@@ -25,6 +25,9 @@ protected:
     Collection<int64_t> lastSkipFreqPointer;
     Collection<int64_t> lastSkipProxPointer;
 
+    /// Highest frequency of the term since the last skip entry on each level.
+    Collection<int32_t> blockMaxFreq;
+
     IndexOutputPtr freqOutput;
     IndexOutputPtr proxOutput;
 
@@ -39,7 +42,8 @@ public:
     void setProxOutput(const IndexOutputPtr& proxOutput);
 
     /// Sets the values for the current skip data.
-    void setSkipData(int32_t doc, bool storePayloads, int32_t payloadLength);
+    /// @param maxFreq The highest frequency of the term in the documents since the previous skip point.
+    void setSkipData(int32_t doc, bool storePayloads, int32_t payloadLength, int32_t maxFreq);
 
 protected:
     virtual void resetSkip();
@@ -0,0 +1,78 @@
+/////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2009-2014 Alan Wright. All rights reserved.
+// Distributable under the terms of either the Apache License (Version 2.0)
+// or the GNU Lesser General Public License.
+/////////////////////////////////////////////////////////////////////////////
+
+#ifndef DOCVALUESFIELD_H
+#define DOCVALUESFIELD_H
+
+#include "Field.h"
+
+namespace Lucene {
+
+/// A field whose value is written to a per-segment column of values, one per document, rather than being
+/// indexed or stored.  Sorting and function queries read the column through {@link FieldCache} instead of
+/// un-inverting the field's terms, so loading the values of a fresh segment costs one sequential read of the
+/// column.  The values are available from {@link IndexReader#getNumericDocValues} and {@link
+/// IndexReader#getSortedDocValues}.
+///
+/// A numeric field holds an int64_t per document, read as 0 for documents without a value.  A sorted field
+/// holds a string per document, stored as an ordinal into the field's sorted unique values; documents without
+/// a value, or with the empty string, have ordinal 0.  A field name must always be used with the same type.
+///
+/// To also search on the value, add a separate {@link Field} or {@link NumericField} of the same name.  If a
+/// document has more than one value for a field, the last one added is kept.
+///
+/// <pre>
+/// doc->add(newLucene<DocValuesField>(L"price", (int64_t)1299));
+/// doc->add(newLucene<DocValuesField>(L"category", L"books"));
+/// </pre>
+class LPPAPI DocValuesField : public AbstractField {
+public:
+    /// Create a numeric doc values field.
+    DocValuesField(const String& name, int64_t value);
+
+    /// Create a sorted doc values field.
+    DocValuesField(const String& name, const String& value);
+
+    virtual ~DocValuesField();
+
+    LUCENE_CLASS(DocValuesField);
+
+public:
+    /// The type of values of a field.
+    enum DocValuesType {
+        DOC_VALUES_NUMERIC = 1,
+        DOC_VALUES_SORTED = 2
+    };
+
+protected:
+    DocValuesType type;
+
+public:
+    /// Returns the type of values of this field.
+    DocValuesType getDocValuesType();
+
+    /// Returns the value of a numeric field.
+    int64_t getNumericValue();
+
+    /// Returns the value of a sorted field, or the numeric value as a string.
+    virtual String stringValue();
+
+    /// Returns null, as doc values are not tokenized.
+    virtual ReaderPtr readerValue();
+
+    /// Returns null, as doc values are not tokenized.
+    virtual TokenStreamPtr tokenStreamValue();
+
+    /// Change the value of a numeric field, allowing the field to be reused across documents.
+    DocValuesFieldPtr setLongValue(int64_t value);
+
+    /// Change the value of a sorted field, allowing the field to be reused across documents.
+    DocValuesFieldPtr setStringValue(const String& value);
+};
+
+}
+
+#endif
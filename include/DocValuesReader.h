@@ -0,0 +1,45 @@
+/////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2009-2014 Alan Wright. All rights reserved.
+// Distributable under the terms of either the Apache License (Version 2.0)
+// or the GNU Lesser General Public License.
+/////////////////////////////////////////////////////////////////////////////
+
+#ifndef DOCVALUESREADER_H
+#define DOCVALUESREADER_H
+
+#include "LuceneObject.h"
+
+namespace Lucene {
+
+/// Reads the doc values file of a segment, as written by {@link DocValuesOutput}.  Only the directory of
+/// fields is read when opened; each column is loaded on first use and kept for the life of the segment.
+class DocValuesReader : public LuceneObject {
+public:
+    DocValuesReader(const DirectoryPtr& directory, const String& segment, int32_t readBufferSize);
+    virtual ~DocValuesReader();
+
+    LUCENE_CLASS(DocValuesReader);
+
+protected:
+    IndexInputPtr input;
+    HashMap<String, int32_t> types;
+    HashMap<String, int64_t> pointers;
+    HashMap<String, PackedValuesPtr> numericValues;
+    HashMap<String, PackedStringIndexPtr> sortedValues;
+
+public:
+    /// Returns the names of the fields of the given {@link DocValuesField} type.
+    HashSet<String> getFields(int32_t type);
+
+    /// Returns the values of a numeric field, or null if the field has none.
+    PackedValuesPtr getNumeric(const String& field);
+
+    /// Returns the values of a sorted field, or null if the field has none.
+    PackedStringIndexPtr getSorted(const String& field);
+
+    void close();
+};
+
+}
+
+#endif
@@ -0,0 +1,88 @@
+/////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2009-2014 Alan Wright. All rights reserved.
+// Distributable under the terms of either the Apache License (Version 2.0)
+// or the GNU Lesser General Public License.
+/////////////////////////////////////////////////////////////////////////////
+
+#ifndef DOCVALUESWRITER_H
+#define DOCVALUESWRITER_H
+
+#include "LuceneObject.h"
+
+namespace Lucene {
+
+/// Buffers the values of the {@link DocValuesField}s of the documents added since the last flush, and
+/// writes them to the segment's doc values file when it is flushed.
+class DocValuesWriter : public LuceneObject {
+public:
+    DocValuesWriter(const DocumentsWriterPtr& docWriter);
+    virtual ~DocValuesWriter();
+
+    LUCENE_CLASS(DocValuesWriter);
+
+protected:
+    DocumentsWriterWeakPtr _docWriter;
+    HashMap< String, Collection<int64_t> > numericFields; // values by docID
+    HashMap< String, Collection<String> > sortedFields;
+    int64_t bytesUsed; // charged to the RAM buffer of the DocumentsWriter until the next flush or abort
+
+public:
+    /// Buffer the value of a field for the given document.
+    void addField(int32_t docID, const DocValuesFieldPtr& field);
+
+    /// Produce _X.dv if any document had a doc values field.
+    void flush(const SegmentWriteStatePtr& state);
+
+    void abort();
+
+protected:
+    /// Give the bytes of the cleared buffers back to the DocumentsWriter.
+    void releaseBytes();
+};
+
+/// Writes a doc values file, one field at a time.  Used when flushing and merging segments.
+///
+/// The file holds a header, the columns of each field and a directory of the fields at the end:
+/// <pre>
+/// Header    --> Int (format)
+/// Numeric   --> Long (minimum value), PackedInts (value - minimum, per document)
+/// Sorted    --> VInt (length), Bytes (UTF-8 of the unique values, in order), PackedInts (start of each
+///               value in the bytes, plus the end of the last), PackedInts (ordinal per document)
+/// Directory --> VInt (field count), {String (name), Byte (type), Long (pointer to the column)}
+/// Footer    --> Long (pointer to the directory)
+/// </pre>
+/// Sorted ordinals start at 1; ordinal 0 is the empty value.  Columns only need sequential reads of one
+/// region of the file, which costs little more than a copy when the directory maps its files.
+class DocValuesOutput : public LuceneObject {
+public:
+    DocValuesOutput(const DirectoryPtr& directory, const String& fileName);
+    virtual ~DocValuesOutput();
+
+    LUCENE_CLASS(DocValuesOutput);
+
+public:
+    static const int32_t FORMAT_CURRENT;
+
+protected:
+    IndexOutputPtr output;
+    Collection<String> fields;
+    Collection<int32_t> types;
+    Collection<int64_t> pointers;
+
+public:
+    /// Write a numeric column of numDocs values.  Documents beyond the end of values read as 0.
+    void addNumeric(const String& field, Collection<int64_t> values, int32_t numDocs);
+
+    /// Write a sorted column of numDocs values.  Documents beyond the end of values read as empty.
+    void addSorted(const String& field, Collection<String> values, int32_t numDocs);
+
+    /// Write the directory of the fields and close the file.
+    void close();
+
+protected:
+    void addField(const String& field, int32_t type);
+};
+
+}
+
+#endif
@@ -66,10 +66,12 @@ protected:
     int32_t numDocsInRAM; // # docs buffered in RAM
 
     /// Max # ThreadState instances; if there are more threads than this they share ThreadStates
-    static const int32_t MAX_THREAD_STATE;
+    int32_t maxThreadStates;
     Collection<DocumentsWriterThreadStatePtr> threadStates;
     MapThreadDocumentsWriterThreadState threadBindings;
 
+    int32_t storedFieldsChunkSize; // Stored fields are compressed in chunks of about this many bytes, unless 0
+
     int32_t pauseThreads; // Non-zero when we need all threads to pause (eg to flush)
     bool aborting; // True if an abort is pending
 
@@ -212,6 +214,17 @@ public:
     void setMaxBufferedDocs(int32_t count);
     int32_t getMaxBufferedDocs();
 
+    /// Set the max number of thread states, which is the number of threads that can add documents at once.
+    void setMaxThreadStates(int32_t maxThreadStates);
+    int32_t getMaxThreadStates();
+
+    /// Returns the number of thread states created so far.
+    int32_t getNumThreadStates();
+
+    /// Set the size of the chunks that stored fields are compressed in, or 0 to not compress them.
+    void setStoredFieldsChunkSize(int32_t chunkSize);
+    int32_t getStoredFieldsChunkSize();
+
     /// Get current segment name we are writing.
     String getSegment();
 
@@ -11,10 +11,15 @@
 
 namespace Lucene {
 
-/// Base class for Directory implementations that store index files in the file system.  There are currently three
+/// Base class for Directory implementations that store index files in the file system.  There are currently four
 /// core subclasses:
 ///
-/// {@link SimpleFSDirectory} is a straightforward implementation using std::ofstream and std::ifstream.
+/// {@link SimpleFSDirectory} is a straightforward implementation using std::ofstream and std::ifstream.  However, it
+/// has poor concurrent performance (multiple threads will bottleneck) as it synchronizes when multiple threads read
+/// from the same file.
+///
+/// {@link NIOFSDirectory} uses positional reads (pread) on a raw file descriptor, which allows multiple threads to
+/// read from the same file without synchronizing.
 ///
 /// {@link MMapDirectory} uses memory-mapped IO when reading. This is a good choice if you have plenty of virtual
 /// memory relative to your index size, eg if you are running on a 64 bit operating system, oryour index sizes are
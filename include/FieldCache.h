@@ -9,6 +9,7 @@
 
 #include <boost/any.hpp>
 #include "LuceneObject.h"
+#include "PackedInts.h"
 
 namespace Lucene {
 
@@ -27,7 +28,10 @@ public:
         CACHE_LONG,
         CACHE_DOUBLE,
         CACHE_STRING,
-        CACHE_STRING_INDEX
+        CACHE_STRING_INDEX,
+        CACHE_PACKED_INT,
+        CACHE_PACKED_LONG,
+        CACHE_PACKED_STRING_INDEX
     };
 
     /// Indicator for StringIndex values in the cache.
@@ -81,7 +85,8 @@ public:
 
     /// Checks the internal cache for an appropriate entry, and if none are found, reads the terms in
     /// field as integers and returns an array of size reader.maxDoc() of the value each document has in
-    /// the given field.
+    /// the given field.  Numeric doc values of the field are used instead of its terms if it has any; an
+    /// IllegalStateException is thrown if one of them doesn't fit in an int.
     /// @param reader Used to get field values.
     /// @param field Which field contains the integers.
     /// @return The values in the given field for each document.
@@ -146,6 +151,48 @@ public:
     /// @return Array of terms and index into the array for each document.
     virtual StringIndexPtr getStringIndex(const IndexReaderPtr& reader, const String& field);
 
+    /// Checks the internal cache for an appropriate entry, and if none are found, reads the terms in
+    /// field as integers and returns them packed as deltas from the smallest value, using only as many
+    /// bits per document as the range of values needs.  Documents without a value read as 0, as with
+    /// {@link #getInts}, and numeric doc values are used and range checked as with {@link #getInts}.
+    /// @param reader Used to get field values.
+    /// @param field Which field contains the integers.
+    /// @return The packed values in the given field for each document.
+    virtual PackedValuesPtr getPackedInts(const IndexReaderPtr& reader, const String& field);
+
+    /// Checks the internal cache for an appropriate entry, and if none are found, reads the terms in
+    /// field as integers and returns them packed as deltas from the smallest value.
+    /// @param reader Used to get field values.
+    /// @param field Which field contains the integers.
+    /// @param parser Computes integer for string values.
+    /// @return The packed values in the given field for each document.
+    virtual PackedValuesPtr getPackedInts(const IndexReaderPtr& reader, const String& field, const IntParserPtr& parser);
+
+    /// Checks the internal cache for an appropriate entry, and if none are found, reads the terms in
+    /// field as longs and returns them packed as deltas from the smallest value, using only as many bits
+    /// per document as the range of values needs.  Documents without a value read as 0, as with {@link
+    /// #getLongs}.
+    /// @param reader Used to get field values.
+    /// @param field Which field contains the longs.
+    /// @return The packed values in the given field for each document.
+    virtual PackedValuesPtr getPackedLongs(const IndexReaderPtr& reader, const String& field);
+
+    /// Checks the internal cache for an appropriate entry, and if none are found, reads the terms in
+    /// field as longs and returns them packed as deltas from the smallest value.
+    /// @param reader Used to get field values.
+    /// @param field Which field contains the longs.
+    /// @param parser Computes long for string values.
+    /// @return The packed values in the given field for each document.
+    virtual PackedValuesPtr getPackedLongs(const IndexReaderPtr& reader, const String& field, const LongParserPtr& parser);
+
+    /// Compact version of {@link #getStringIndex}: the ordinal of each document is packed into as many
+    /// bits as the number of unique terms needs, and the terms are held as one block of UTF-8 bytes
+    /// rather than one String each.
+    /// @param reader Used to get field values.
+    /// @param field Which field contains the strings.
+    /// @return Terms and packed index into the terms for each document.
+    virtual PackedStringIndexPtr getPackedStringIndex(const IndexReaderPtr& reader, const String& field);
+
     /// Generates an array of CacheEntry objects representing all items currently in the FieldCache.
     virtual Collection<FieldCacheEntryPtr> getCacheEntries() = 0;
 
@@ -195,6 +242,84 @@ public:
     int32_t binarySearchLookup(const String& key);
 };
 
+/// Numeric values of a field, one per document, stored as deltas from the smallest value using the minimum
+/// number of bits.  A field of timestamps spanning a year needs 35 bits per document rather than 64, and a
+/// category id below 1000 needs 10 rather than 32.
+class LPPAPI PackedValues : public LuceneObject {
+public:
+    PackedValues(int64_t minValue, const PackedIntsPtr& deltas);
+    virtual ~PackedValues();
+
+    LUCENE_CLASS(PackedValues);
+
+protected:
+    int64_t minValue;
+    PackedIntsPtr deltas;
+
+public:
+    /// Returns the value of the given document.
+    inline int64_t get(int32_t doc) {
+        return (int64_t)((uint64_t)minValue + (uint64_t)deltas->get(doc));
+    }
+
+    /// Returns the number of documents.
+    int32_t size();
+
+    /// Returns the smallest value any document can have.
+    int64_t getMinValue();
+
+    /// Returns the number of bits used per document.
+    int32_t getBitsPerValue();
+
+    /// Returns the approximate number of bytes used by the values.
+    int64_t ramBytesUsed();
+};
+
+/// Stores term text values and document ordering data compactly.  Equivalent to {@link StringIndex}, with
+/// ordinals packed to the bits needed for the number of unique terms and the terms stored in one block of
+/// UTF-8 bytes.  Ordinal 0 is the empty value of documents with no term in the field.
+class LPPAPI PackedStringIndex : public LuceneObject {
+public:
+    PackedStringIndex(const PackedIntsPtr& order, ByteArray termBytes, const PackedIntsPtr& termOffsets);
+    virtual ~PackedStringIndex();
+
+    LUCENE_CLASS(PackedStringIndex);
+
+protected:
+    PackedIntsPtr order; // ordinal of each document
+    ByteArray termBytes; // UTF-8 of all terms, in ordinal order
+    PackedIntsPtr termOffsets; // start of each term in termBytes, plus the end of the last term
+
+public:
+    /// Returns the ordinal of the given document.
+    inline int32_t getOrd(int32_t doc) {
+        return (int32_t)order->get(doc);
+    }
+
+    /// Returns the number of ordinals, including ordinal 0.
+    int32_t numOrds();
+
+    /// Returns the term of the given ordinal.
+    String lookup(int32_t ord);
+
+    /// Returns the UTF-8 bytes of the term of the given ordinal, setting length to their number.
+    const uint8_t* lookupUTF8(int32_t ord, int32_t& length);
+
+    /// Returns the ordinal of the given term, or -(insertion point + 1) if not found.
+    /// @see StringIndex#binarySearchLookup
+    int32_t binarySearchLookup(const String& key);
+
+    /// Returns the ordinal of the given term within the ordinals [low, high], or -(insertion point + 1)
+    /// if not found.
+    int32_t binarySearchLookup(const String& key, int32_t low, int32_t high);
+
+    /// Returns the number of documents.
+    int32_t size();
+
+    /// Returns the approximate number of bytes used by the ordinals and terms.
+    int64_t ramBytesUsed();
+};
+
 /// Marker interface as super-interface to all parsers.  It is used to specify a custom parser to {@link
 /// SortField#SortField(String, Parser)}.
 class LPPAPI Parser : public LuceneObject {
@@ -44,6 +44,14 @@ public:
     virtual Collection<String> getStrings(const IndexReaderPtr& reader, const String& field);
     virtual StringIndexPtr getStringIndex(const IndexReaderPtr& reader, const String& field);
 
+    virtual PackedValuesPtr getPackedInts(const IndexReaderPtr& reader, const String& field);
+    virtual PackedValuesPtr getPackedInts(const IndexReaderPtr& reader, const String& field, const IntParserPtr& parser);
+
+    virtual PackedValuesPtr getPackedLongs(const IndexReaderPtr& reader, const String& field);
+    virtual PackedValuesPtr getPackedLongs(const IndexReaderPtr& reader, const String& field, const LongParserPtr& parser);
+
+    virtual PackedStringIndexPtr getPackedStringIndex(const IndexReaderPtr& reader, const String& field);
+
     virtual void setInfoStream(const InfoStreamPtr& stream);
     virtual InfoStreamPtr getInfoStream();
 };
@@ -157,6 +165,39 @@ protected:
     virtual boost::any createValue(const IndexReaderPtr& reader, const EntryPtr& key);
 };
 
+class PackedIntCache : public Cache {
+public:
+    PackedIntCache(const FieldCachePtr& wrapper = FieldCachePtr());
+    virtual ~PackedIntCache();
+
+    LUCENE_CLASS(PackedIntCache);
+
+protected:
+    virtual boost::any createValue(const IndexReaderPtr& reader, const EntryPtr& key);
+};
+
+class PackedLongCache : public Cache {
+public:
+    PackedLongCache(const FieldCachePtr& wrapper = FieldCachePtr());
+    virtual ~PackedLongCache();
+
+    LUCENE_CLASS(PackedLongCache);
+
+protected:
+    virtual boost::any createValue(const IndexReaderPtr& reader, const EntryPtr& key);
+};
+
+class PackedStringIndexCache : public Cache {
+public:
+    PackedStringIndexCache(const FieldCachePtr& wrapper = FieldCachePtr());
+    virtual ~PackedStringIndexCache();
+
+    LUCENE_CLASS(PackedStringIndexCache);
+
+protected:
+    virtual boost::any createValue(const IndexReaderPtr& reader, const EntryPtr& key);
+};
+
 class FieldCacheEntryImpl : public FieldCacheEntry {
 public:
     FieldCacheEntryImpl(const LuceneObjectPtr& readerKey, const String& fieldName, int32_t cacheType, const boost::any& custom, const boost::any& value);
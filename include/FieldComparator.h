@@ -213,6 +213,82 @@ public:
     virtual void setNextReader(const IndexReaderPtr& reader, int32_t docBase);
 };
 
+/// Sorts by ascending int value, like {@link IntComparator}, reading values from {@link
+/// FieldCache#getPackedInts}.
+class LPPAPI PackedIntComparator : public NumericComparator<int32_t> {
+public:
+    PackedIntComparator(int32_t numHits, const String& field, const ParserPtr& parser);
+    virtual ~PackedIntComparator();
+
+    LUCENE_CLASS(PackedIntComparator);
+
+protected:
+    IntParserPtr parser;
+    PackedValuesPtr currentReaderPacked;
+
+public:
+    virtual int32_t compare(int32_t slot1, int32_t slot2);
+    virtual int32_t compareBottom(int32_t doc);
+    virtual void copy(int32_t slot, int32_t doc);
+    virtual void setNextReader(const IndexReaderPtr& reader, int32_t docBase);
+};
+
+/// Sorts by ascending long value, like {@link LongComparator}, reading values from {@link
+/// FieldCache#getPackedLongs}.
+class LPPAPI PackedLongComparator : public NumericComparator<int64_t> {
+public:
+    PackedLongComparator(int32_t numHits, const String& field, const ParserPtr& parser);
+    virtual ~PackedLongComparator();
+
+    LUCENE_CLASS(PackedLongComparator);
+
+protected:
+    LongParserPtr parser;
+    PackedValuesPtr currentReaderPacked;
+
+public:
+    virtual int32_t compare(int32_t slot1, int32_t slot2);
+    virtual int32_t compareBottom(int32_t doc);
+    virtual void copy(int32_t slot, int32_t doc);
+    virtual void setNextReader(const IndexReaderPtr& reader, int32_t docBase);
+};
+
+/// Sorts by field's natural String sort order using ordinals, like {@link StringOrdValComparator}, reading
+/// the ordinals and terms from {@link FieldCache#getPackedStringIndex}.
+class LPPAPI PackedStringOrdValComparator : public FieldComparator {
+public:
+    PackedStringOrdValComparator(int32_t numHits, const String& field, int32_t sortPos, bool reversed);
+    virtual ~PackedStringOrdValComparator();
+
+    LUCENE_CLASS(PackedStringOrdValComparator);
+
+protected:
+    Collection<int32_t> ords;
+    Collection<String> values;
+    Collection<int32_t> readerGen;
+
+    int32_t currentReaderGen;
+    PackedStringIndexPtr index;
+    String field;
+
+    int32_t bottomSlot;
+    int32_t bottomOrd;
+    String bottomValue;
+    bool reversed;
+    int32_t sortPos;
+
+public:
+    virtual int32_t compare(int32_t slot1, int32_t slot2);
+    virtual int32_t compareBottom(int32_t doc);
+    virtual void copy(int32_t slot, int32_t doc);
+    virtual void setNextReader(const IndexReaderPtr& reader, int32_t docBase);
+    virtual void setBottom(int32_t slot);
+    virtual ComparableValue value(int32_t slot);
+
+protected:
+    void convert(int32_t slot);
+};
+
 /// Sorts by descending relevance.  NOTE: if you are sorting only by descending relevance and then secondarily
 /// by ascending docID, performance is faster using {@link TopScoreDocCollector} directly (which {@link
 /// IndexSearcher#search} uses when no {@link Sort} is specified).
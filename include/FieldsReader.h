@@ -49,6 +49,19 @@ protected:
     CloseableThreadLocal<IndexInput> fieldsStreamTL;
     bool isOriginal;
 
+    // When documents are compressed in chunks, chunksStream reads the compressed chunks and fieldsStream reads
+    // the documents of the last chunk, which is only decompressed again when another chunk is needed.
+    IndexInputPtr chunksStream;
+    FieldsChunkInputPtr chunkInput;
+    ByteArray compressedChunk;
+    int64_t chunkPointer; // start of the last chunk in the fields file, or -1
+    int64_t chunkDataPointer; // start of its compressed bytes
+    int32_t chunkDocBase; // its first document in the fields file
+    int32_t chunkNumDocs;
+    int32_t chunkCompressedLength;
+    IntArray chunkStarts; // start of each document in the decompressed chunk, followed by the chunk length
+    bool chunkDecompressed;
+
 public:
     /// Returns a cloned FieldsReader that shares open IndexInputs with the original one.  It is the caller's job not to
     /// close the original FieldsReader until all clones are called (eg, currently SegmentReader manages this logic).
@@ -62,6 +75,10 @@ public:
 
     bool canReadRawDocs();
 
+    /// Returns true if the documents are compressed in chunks, see {@link IndexWriter#setStoredFieldsChunkSize}.
+    /// Such documents are bulk-copied with {@link FieldsWriter#addDocuments} instead of {@link #rawDocs}.
+    bool isChunked();
+
     DocumentPtr doc(int32_t n, const FieldSelectorPtr& fieldSelector);
 
     /// Returns the length in bytes of each raw document in a contiguous range of length numDocs starting with startDocID.
@@ -75,6 +92,15 @@ protected:
 
     void seekIndex(int32_t docID);
 
+    void openChunks();
+
+    /// Reads the header of the chunk starting at pointer, unless it is the last chunk read, and positions
+    /// chunksStream on its compressed bytes.
+    void readChunkHeader(int64_t pointer);
+
+    /// Decompresses the chunk starting at pointer, unless it is the last chunk decompressed.
+    void loadChunk(int64_t pointer);
+
     /// Skip the field.  We still have to read some of the information about the field, but can skip past the actual content.
     /// This will have the most payoff on large fields.
     void skipField(bool binary, bool compressed);
@@ -92,6 +118,7 @@ protected:
     String uncompressString(ByteArray b);
 
     friend class LazyField;
+    friend class FieldsWriter;
 };
 
 class LazyField : public AbstractField {
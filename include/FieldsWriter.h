@@ -13,7 +13,7 @@ namespace Lucene {
 
 class FieldsWriter : public LuceneObject {
 public:
-    FieldsWriter(const DirectoryPtr& d, const String& segment, const FieldInfosPtr& fn);
+    FieldsWriter(const DirectoryPtr& d, const String& segment, const FieldInfosPtr& fn, int32_t chunkSize = 0);
     FieldsWriter(const IndexOutputPtr& fdx, const IndexOutputPtr& fdt, const FieldInfosPtr& fn);
     virtual ~FieldsWriter();
 
@@ -25,6 +25,15 @@ protected:
     IndexOutputPtr indexStream;
     bool doClose;
 
+    // Documents are compressed together in chunks of about chunkSize bytes, unless chunkSize is 0
+    int32_t chunkSize;
+    int32_t chunkDocBase; // documents in the fields file before the pending chunk
+    RAMFilePtr chunkFile;
+    RAMOutputStreamPtr chunkBuffer; // the documents of the pending chunk
+    Collection<int32_t> chunkDocEnds;
+    ByteArray chunkBytes;
+    ByteArray compressedBytes;
+
 public:
     static const uint8_t FIELD_IS_TOKENIZED;
     static const uint8_t FIELD_IS_BINARY;
@@ -33,6 +42,10 @@ public:
     static const int32_t FORMAT; // Original format
     static const int32_t FORMAT_VERSION_UTF8_LENGTH_IN_BYTES; // Changed strings to UTF8
     static const int32_t FORMAT_LUCENE_3_0_NO_COMPRESSED_FIELDS; // Lucene 3.0: Removal of compressed fields
+    static const int32_t FORMAT_CHUNKED_COMPRESSED; // Documents compressed together in chunks
+
+    /// Maximum number of documents in a chunk, so that small documents don't make chunks slow to read
+    static const int32_t MAX_CHUNK_DOCS;
 
     // NOTE: if you introduce a new format, make it 1 higher than the current one, and always change this
     // if you switch to a new format!
@@ -54,7 +67,20 @@ public:
     /// The stream IndexInput is the fieldsStream from which we should bulk-copy all bytes.
     void addRawDocuments(const IndexInputPtr& stream, Collection<int32_t> lengths, int32_t numDocs);
 
+    /// Bulk write a contiguous series of documents of a reader whose documents are compressed in chunks (see
+    /// {@link FieldsReader#isChunked}).  Chunks entirely within the series are copied without decompressing them.
+    void addDocuments(const FieldsReaderPtr& reader, int32_t startDocID, int32_t numDocs);
+
     void addDocument(const DocumentPtr& doc);
+
+protected:
+    void writeField(const IndexOutputPtr& out, const FieldInfoPtr& fi, const FieldablePtr& field);
+
+    /// Records the end of a document written to chunkBuffer, and compresses the chunk once it is full.
+    void finishChunkDocument();
+
+    /// Compresses the pending documents into a chunk of the fields stream.
+    void flushChunk();
 };
 
 }
@@ -45,6 +45,8 @@ public:
     virtual DocumentPtr document(int32_t n, const FieldSelectorPtr& fieldSelector);
     virtual bool isDeleted(int32_t n);
     virtual bool hasDeletions();
+    virtual PackedValuesPtr getNumericDocValues(const String& field);
+    virtual PackedStringIndexPtr getSortedDocValues(const String& field);
     virtual bool hasNorms(const String& field);
     virtual ByteArray norms(const String& field);
     virtual void norms(const String& field, ByteArray norms, int32_t offset);
@@ -95,6 +97,10 @@ public:
     virtual bool next();
     virtual int32_t read(Collection<int32_t> docs, Collection<int32_t> freqs);
     virtual bool skipTo(int32_t target);
+    virtual int32_t maxFreq();
+    virtual int32_t advanceShallow(int32_t target);
+    virtual int32_t blockEnd(int32_t level);
+    virtual int32_t blockMaxFreq(int32_t level);
     virtual void close();
 };
 
@@ -17,6 +17,9 @@ namespace Lucene {
 ///
 /// The cache is periodically cleaned up from a separate thread to ensure the cache doesn't exceed the
 /// maximum size.
+///
+/// The cache is bounded by a number of filters rather than by the memory their results use; see {@link
+/// LRUFilterCache} for a cache of filter results bounded by memory.
 class LPPAPI FilterManager : public LuceneObject {
 public:
     /// Sets up the FilterManager singleton.
@@ -35,6 +35,8 @@ public:
 
     int32_t lastDocID;
     int32_t df;
+    int32_t maxFreq;
+    int32_t blockMaxFreq; // highest frequency since the last skip point
 
     TermInfoPtr termInfo; // minimize consing
     UTF8ResultPtr utf8;
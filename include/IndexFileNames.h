@@ -30,6 +30,9 @@ public:
     /// Extension of norms file.
     static const String& NORMS_EXTENSION();
 
+    /// Extension of doc values file.
+    static const String& DOC_VALUES_EXTENSION();
+
     /// Extension of freq postings file.
     static const String& FREQ_EXTENSION();
 
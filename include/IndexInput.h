@@ -56,6 +56,13 @@ public:
     /// @see IndexOutput#writeVInt(int32_t)
     virtual int32_t readVInt();
 
+    /// Reads count ints stored in variable-length format into an array.  Subclasses with direct access to
+    /// their bytes override this to decode in bulk.
+    /// @param values the array to read values into.
+    /// @param count the number of values to read.
+    /// @see #readVInt()
+    virtual void readVInts(int32_t* values, int32_t count);
+
     /// Reads eight bytes and returns a int64.
     /// @see IndexOutput#writeLong(int64_t)
     virtual int64_t readLong();
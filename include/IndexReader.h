@@ -67,7 +67,11 @@ public:
         /// All fields with termvectors with offset values enabled
         FIELD_OPTION_TERMVECTOR_WITH_OFFSET,
         /// All fields with termvectors with offset values and position values enabled
-        FIELD_OPTION_TERMVECTOR_WITH_POSITION_OFFSET
+        FIELD_OPTION_TERMVECTOR_WITH_POSITION_OFFSET,
+        /// All fields with numeric doc values
+        FIELD_OPTION_NUMERIC_DOC_VALUES,
+        /// All fields with sorted doc values
+        FIELD_OPTION_SORTED_DOC_VALUES
     };
 
     static const int32_t DEFAULT_TERMS_INDEX_DIVISOR;
@@ -391,6 +395,16 @@ public:
     /// @see Similarity#decodeNorm(byte)
     virtual void setNorm(int32_t doc, const String& field, uint8_t value);
 
+    /// Returns the values of the named field of every document, as written with a numeric {@link
+    /// DocValuesField}, or null if this reader has none for the field.  Only segment readers hold doc
+    /// values; composite readers return null, and {@link FieldCache} joins the columns of their segments.
+    virtual PackedValuesPtr getNumericDocValues(const String& field);
+
+    /// Returns the values of the named field of every document, as written with a sorted {@link
+    /// DocValuesField}, or null if this reader has none for the field.
+    /// @see #getNumericDocValues(String)
+    virtual PackedStringIndexPtr getSortedDocValues(const String& field);
+
     /// Resets the normalization factor for the named field of the named document.
     ///
     /// @see #norms(String)
@@ -20,6 +20,11 @@ namespace Lucene {
 /// NOTE: {@link IndexSearcher} instances are completely thread safe, meaning multiple threads can call any
 /// of its methods, concurrently.  If your application requires external synchronization, you should not
 /// synchronize on the IndexSearcher instance; use your own (non-Lucene) objects instead.
+///
+/// If a {@link ThreadPool} is supplied, searches that return top hits ({@link #search(WeightPtr, FilterPtr,
+/// int32_t)} and the sorting variants) score each segment as a separate task on the pool and merge the per
+/// segment results.  Searches with a caller supplied {@link Collector} always run on the calling thread, since
+/// collectors are not thread safe.
 class LPPAPI IndexSearcher : public Searcher {
 public:
     /// Creates a searcher searching the index in the named directory.  You should pass readOnly = true,
@@ -32,6 +37,10 @@ public:
     /// Creates a searcher searching the provided index.
     IndexSearcher(const IndexReaderPtr& reader);
 
+    /// Creates a searcher searching the provided index, scoring its segments concurrently on the given
+    /// thread pool.
+    IndexSearcher(const IndexReaderPtr& reader, const ThreadPoolPtr& threadPool);
+
     /// Directly specify the reader, subReaders and their docID starts.
     IndexSearcher(const IndexReaderPtr& reader, Collection<IndexReaderPtr> subReaders, Collection<int32_t> docStarts);
 
@@ -50,11 +59,24 @@ protected:
 
     bool fieldSortDoTrackScores;
     bool fieldSortDoMaxScore;
+    bool trackTotalHits;
+
+    /// Optional pool used to search segments concurrently
+    ThreadPoolPtr threadPool;
+
+    /// One searcher per segment, used for concurrent searches
+    Collection<IndexSearcherPtr> subSearchers;
 
 public:
     /// Return the {@link IndexReader} this searches.
     IndexReaderPtr getIndexReader();
 
+    /// Returns the atomic subReaders used by this searcher.
+    Collection<IndexReaderPtr> getSubReaders();
+
+    /// Returns the docID of the first document of each subReader.
+    Collection<int32_t> getDocStarts();
+
     /// Note that the underlying IndexReader is not closed, if IndexSearcher was constructed with
     /// IndexSearcher(const IndexReaderPtr& reader).  If the IndexReader was supplied implicitly by specifying a
     /// directory, then the IndexReader gets closed.
@@ -90,11 +112,27 @@ public:
     /// @param doTrackScores If true, then scores are returned for every matching document in {@link TopFieldDocs}.
     /// @param doMaxScore If true, then the max score for all matching docs is computed.
     virtual void setDefaultFieldSortScoring(bool doTrackScores, bool doMaxScore);
+    virtual bool getFieldSortDoTrackScores();
+    virtual bool getFieldSortDoMaxScore();
+
+    /// By default, searches returning the top hits by score count every matching document in {@link
+    /// TopDocs#totalHits}.  If that count isn't needed, set this to false: the scorer can then skip the
+    /// documents that can't make it into the top hits, which makes disjunctions of terms much faster.  The
+    /// top hits are the same, but totalHits only counts the documents that were collected.  Searches sorted by
+    /// field also stop collecting a segment written in the order of the sort (see {@link SortingMergePolicy})
+    /// once its remaining documents can't compete.
+    virtual void setTrackTotalHits(bool trackTotalHits);
+    virtual bool getTrackTotalHits();
+
+    virtual void setProfiler(const QueryProfilerPtr& profiler);
 
 protected:
-    void ConstructSearcher(const IndexReaderPtr& reader, bool closeReader);
+    void ConstructSearcher(const IndexReaderPtr& reader, bool closeReader, const ThreadPoolPtr& threadPool = ThreadPoolPtr());
     void gatherSubReaders(Collection<IndexReaderPtr> allSubReaders, const IndexReaderPtr& reader);
     void searchWithFilter(const IndexReaderPtr& reader, const WeightPtr& weight, const FilterPtr& filter, const CollectorPtr& collector);
+
+    /// Returns true if searches returning top hits should run concurrently over the segments.
+    bool searchConcurrently();
 };
 
 }
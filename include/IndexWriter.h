@@ -144,6 +144,7 @@ protected:
     LockPtr writeLock;
 
     int32_t termIndexInterval;
+    int32_t storedFieldsChunkSize;
 
     bool closed;
     bool closing;
@@ -225,6 +226,9 @@ public:
     /// {@link #setMaxBufferedDeleteTerms(int32_t)}.
     static const int32_t DEFAULT_MAX_BUFFERED_DELETE_TERMS;
 
+    /// Default value is 8. Change using {@link #setMaxThreadStates(int32_t)}.
+    static const int32_t DEFAULT_MAX_THREAD_STATES;
+
     /// Default value is 10,000. Change using {@link #setMaxFieldLength(int32_t)}.
     static const int32_t DEFAULT_MAX_FIELD_LENGTH;
 
@@ -358,6 +362,20 @@ public:
     /// @see #setTermIndexInterval(int32_t)
     virtual int32_t getTermIndexInterval();
 
+    /// Sets the size in bytes of the chunks that the stored fields of documents are compressed in.  Documents
+    /// are buffered until they add up to this size, or to 128 documents, and are then compressed together with
+    /// LZ4 so that the field names and values that neighbouring documents share compress well.  Loading a
+    /// document decompresses its whole chunk, so larger chunks compress better but make loading a random
+    /// document slower; 16 KB is a reasonable trade-off.
+    ///
+    /// Set to 0 (the default) to store documents uncompressed, in the format older versions read.  This
+    /// applies to the stored fields written from the next doc store on, and by merges.
+    virtual void setStoredFieldsChunkSize(int32_t chunkSize);
+
+    /// Returns the size of the chunks that stored fields are compressed in, or 0 if they aren't compressed.
+    /// @see #setStoredFieldsChunkSize(int32_t)
+    virtual int32_t getStoredFieldsChunkSize();
+
     /// Set the merge policy used by this writer.
     virtual void setMergePolicy(const MergePolicyPtr& mp);
 
@@ -437,6 +455,23 @@ public:
     /// @see #setMaxBufferedDocs
     virtual int32_t getMaxBufferedDocs();
 
+    /// Determines the maximum number of threads that can add documents at the same time.  Each of them
+    /// inverts documents into its own thread state; further threads share the least loaded one and wait for
+    /// it to be idle.  All thread states are flushed into the same segment and share the RAM buffer, so
+    /// raising this doesn't change when flushes are triggered.  Flushing stays global: a flush pauses every
+    /// thread state until the segment is written.  Thread states don't have segments of their own that are
+    /// flushed independently.
+    ///
+    /// Set this to the number of indexing threads to let them all run concurrently.  Lowering it only
+    /// applies to threads that bind to a thread state after the next flush.
+    ///
+    /// The default value is {@link #DEFAULT_MAX_THREAD_STATES}.
+    virtual void setMaxThreadStates(int32_t maxThreadStates);
+
+    /// Returns the maximum number of threads that can add documents at the same time.
+    /// @see #setMaxThreadStates
+    virtual int32_t getMaxThreadStates();
+
     /// Determines the amount of RAM that may be used for buffering added documents and deletions
     /// before they are flushed to the Directory.  Generally for faster indexing performance it's
     /// best to flush by RAM usage instead of document count and use as large a RAM buffer as you can.
@@ -670,6 +705,10 @@ public:
 
     virtual String newSegmentName();
 
+    /// Expert: returns the segments that are being merged or are registered to be merged.  Merge policies
+    /// selecting segments that aren't adjacent use this to leave out segments that are already merging.
+    virtual SetSegmentInfo getMergingSegments();
+
     /// Requests an "optimize" operation on an index, priming the index for the fastest available
     /// search. Traditionally this has meant merging all segments into a single segment as is done in
     /// the default merge policy, but individual merge policies may implement optimize in different ways.
@@ -1045,14 +1084,16 @@ protected:
     virtual bool doFlush(bool flushDocStores, bool flushDeletes);
     virtual bool doFlushInternal(bool flushDocStores, bool flushDeletes);
 
-    virtual int32_t ensureContiguousMerge(const OneMergePtr& merge);
+    /// Checks that all the segments of the merge are still in the index, and returns the position of the
+    /// first of them, which the merged segment will take.
+    virtual int32_t ensureValidMerge(const OneMergePtr& merge);
 
     /// Carefully merges deletes for the segments we just merged.  This is tricky because, although merging
     /// will clear all deletes (compacts the documents), new deletes may have been flushed to the segments
     /// since the merge was started.  This method "carries over" such new deletes onto the newly merged
     /// segment, and saves the resulting deletes file (incrementing the delete generation for merge.info).
     /// If no deletes were flushed, no new deletes file is saved.
-    virtual void commitMergedDeletes(const OneMergePtr& merge, const SegmentReaderPtr& mergeReader);
+    virtual void commitMergedDeletes(const OneMergePtr& merge, const SegmentMergerPtr& merger, const SegmentReaderPtr& mergeReader);
     virtual bool commitMerge(const OneMergePtr& merge, const SegmentMergerPtr& merger, int32_t mergedDocCount, const SegmentReaderPtr& mergedReader);
 
     virtual LuceneException handleMergeException(const LuceneException& exc, const OneMergePtr& merge);
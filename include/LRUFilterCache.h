@@ -0,0 +1,129 @@
+/////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2009-2014 Alan Wright. All rights reserved.
+// Distributable under the terms of either the Apache License (Version 2.0)
+// or the GNU Lesser General Public License.
+/////////////////////////////////////////////////////////////////////////////
+
+#ifndef LRUFILTERCACHE_H
+#define LRUFILTERCACHE_H
+
+#include "LuceneObject.h"
+
+namespace Lucene {
+
+/// A cache of filter results that is shared by all filters and readers, bounded by both a number of
+/// entries and an amount of memory.
+///
+/// Results are cached per segment, keyed by the filter (using its equals() and hashCode()) and the
+/// segment's core, so an entry survives reopens of the segment, new deletions included, as with
+/// {@link CachingWrapperFilter#DELETES_IGNORE}.  Each entry is charged the memory of its {@link DocIdSet};
+/// sets that are not cacheable are stored as a compressed {@link RoaringDocIdSet}.  When either bound is
+/// exceeded the least recently used entries are evicted, and entries of segments that have been closed
+/// are dropped on the next insertion.  Segments with fewer than {@link #setMinSegmentSize} documents are
+/// not cached at all, as the filter is cheap to compute again there.
+///
+/// Filters are cached by wrapping them with {@link #doCache}:
+///
+/// <pre>
+/// FilterPtr filter = LRUFilterCache::getInstance()->doCache(newLucene<QueryWrapperFilter>(query));
+/// </pre>
+class LPPAPI LRUFilterCache : public LuceneObject {
+public:
+    /// Create a cache holding at most maxSize entries that use at most maxRamBytesUsed bytes.
+    LRUFilterCache(int32_t maxSize = DEFAULT_MAX_SIZE, int64_t maxRamBytesUsed = DEFAULT_MAX_RAM_BYTES_USED);
+    virtual ~LRUFilterCache();
+
+    LUCENE_CLASS(LRUFilterCache);
+
+public:
+    /// The default maximum number of cached entries.
+    static const int32_t DEFAULT_MAX_SIZE;
+
+    /// The default maximum memory used by cached entries (32MB).
+    static const int64_t DEFAULT_MAX_RAM_BYTES_USED;
+
+    /// The default minimum number of documents of a segment for its results to be cached.
+    static const int32_t DEFAULT_MIN_SEGMENT_SIZE;
+
+protected:
+    typedef HashMap< LRUFilterCacheKeyPtr, LRUFilterCacheEntryPtr, luceneHash<LRUFilterCacheKeyPtr>, luceneEquals<LRUFilterCacheKeyPtr> > MapKeyEntry;
+    typedef Map< int64_t, LRUFilterCacheKeyPtr > MapLongKey;
+
+    MapKeyEntry cache;
+
+    /// Cached keys ordered by their last use, least recently used first.
+    MapLongKey lru;
+
+    int32_t maxSize;
+    int64_t maxRamBytesUsed;
+    int32_t minSegmentSize;
+
+    int64_t useCount;
+    int64_t ramBytesUsed;
+
+    int64_t hitCount;
+    int64_t missCount;
+    int64_t cacheCount;
+    int64_t evictionCount;
+
+public:
+    /// Returns the cache shared by the whole process.
+    static LRUFilterCachePtr getInstance();
+
+    /// Returns a filter whose results are cached in this cache.
+    FilterPtr doCache(const FilterPtr& filter);
+
+    /// Returns the results of a filter for a segment, from the cache if present.
+    DocIdSetPtr getDocIdSet(const FilterPtr& filter, const IndexReaderPtr& reader);
+
+    /// Sets the maximum number of cached entries, evicting entries if needed.
+    void setMaxSize(int32_t maxSize);
+    int32_t getMaxSize();
+
+    /// Sets the maximum memory used by cached entries, evicting entries if needed.
+    void setMaxRamBytesUsed(int64_t maxRamBytesUsed);
+    int64_t getMaxRamBytesUsed();
+
+    /// Sets the minimum number of documents of a segment for its results to be cached.
+    void setMinSegmentSize(int32_t minSegmentSize);
+    int32_t getMinSegmentSize();
+
+    /// Remove all cached entries.  The statistics are kept.
+    void clear();
+
+    /// Returns the number of entries currently in the cache.
+    int32_t getCacheSize();
+
+    /// Returns the memory currently used by cached entries.
+    int64_t getRamBytesUsed();
+
+    /// Returns the number of lookups that found their result in the cache.
+    int64_t getHitCount();
+
+    /// Returns the number of lookups that had to compute their result, including uncached segments.
+    int64_t getMissCount();
+
+    /// Returns the total number of entries ever added to the cache.
+    int64_t getCacheCount();
+
+    /// Returns the number of entries removed to keep the cache within its bounds.
+    int64_t getEvictionCount();
+
+protected:
+    /// Returns the set to cache for the results of a filter.
+    DocIdSetPtr docIdSetToCache(const DocIdSetPtr& docIdSet);
+
+    /// Returns the memory used by a cached set, assuming a bitset of maxDoc bits for unknown types.
+    int64_t docIdSetBytesUsed(const DocIdSetPtr& docIdSet, int32_t maxDoc);
+
+    void putEntry(const LRUFilterCacheKeyPtr& key, const DocIdSetPtr& docIdSet, int64_t bytesUsed);
+    void removeEntry(const LRUFilterCacheKeyPtr& key);
+    void evictIfNecessary();
+
+    /// Remove the entries of segments that have been closed.
+    void purgeClosedSegments();
+};
+
+}
+
+#endif
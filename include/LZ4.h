@@ -0,0 +1,49 @@
+/////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2009-2014 Alan Wright. All rights reserved.
+// Distributable under the terms of either the Apache License (Version 2.0)
+// or the GNU Lesser General Public License.
+/////////////////////////////////////////////////////////////////////////////
+
+#ifndef LZ4_H
+#define LZ4_H
+
+#include "LuceneObject.h"
+
+namespace Lucene {
+
+/// A fast LZ77 compressor writing the LZ4 block format: sequences of literals followed by a back reference
+/// of at least 4 bytes within the previous 64 KB.  Compression is a single greedy pass over a hash table of
+/// 4 byte sequences, and decompression is little more than copying bytes, so that both are much faster than
+/// zlib at the cost of a lower compression ratio.  Used to compress chunks of stored fields.
+class LPPAPI LZ4 : public LuceneObject {
+public:
+    virtual ~LZ4();
+
+    LUCENE_CLASS(LZ4);
+
+public:
+    /// Returns the maximum compressed length of length bytes, for incompressible data.
+    static int32_t maxCompressedLength(int32_t length);
+
+    /// Compresses length bytes of src into dest, which must hold at least {@link #maxCompressedLength} bytes.
+    /// Returns the compressed length.
+    static int32_t compress(const uint8_t* src, int32_t length, uint8_t* dest);
+
+    /// Decompresses srcLength bytes of src, previously returned by {@link #compress}, into dest which holds
+    /// destLength bytes.  Returns the decompressed length, or throws {@link CompressionException} if the
+    /// compressed bytes are corrupt or don't fit in dest.
+    static int32_t decompress(const uint8_t* src, int32_t srcLength, uint8_t* dest, int32_t destLength);
+
+protected:
+    static const int32_t MIN_MATCH;
+    static const int32_t MAX_DISTANCE;
+    static const int32_t LAST_LITERALS;
+    static const int32_t MF_LIMIT;
+    static const int32_t HASH_LOG;
+
+    static int32_t writeLength(uint8_t* dest, int32_t out, int32_t length);
+};
+
+}
+
+#endif
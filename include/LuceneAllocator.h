@@ -8,6 +8,9 @@
 #define ALLOCATOR_H
 
 #include "Config.h"
+#include <new>
+#include <utility>
+#include <boost/config.hpp>
 
 namespace Lucene {
 
@@ -19,6 +22,213 @@ LPPAPI void* ReallocMemory(void* memory, size_t size);
 
 /// Release a given block of memory.
 LPPAPI void FreeMemory(void* memory);
+
+/// Source of the memory handed out by {@link AllocMemory}.  Every block remembers the allocator it came from,
+/// so it is always released back to that allocator, even if another allocator has since been installed.
+class LPPAPI MemoryAllocator {
+public:
+    virtual ~MemoryAllocator();
+
+public:
+    /// Allocate a block of at least size bytes, aligned to 16 bytes.  Returns null if out of memory.
+    virtual void* allocate(size_t size) = 0;
+
+    /// Release a block previously returned by {@link #allocate(size_t)} for the given size.
+    virtual void release(void* memory, size_t size) = 0;
+
+    /// Resize a block in place or by moving it.  Returns null if not supported, in which case the caller
+    /// allocates a new block and copies.
+    virtual void* reallocate(void* memory, size_t size, size_t newSize);
+};
+
+/// Install the process wide allocator used for all subsequent allocations, or null to restore the default
+/// malloc based allocator, and return the allocator it replaces.  Safe to call while other threads allocate;
+/// they pick up the new allocator on their next allocation, unless a {@link ScopedMemoryAllocator} is in scope
+/// on them.  The allocator must outlive every block allocated from it.
+LPPAPI MemoryAllocator* SetMemoryAllocator(MemoryAllocator* allocator);
+
+/// Returns the allocator the calling thread currently uses for new allocations.
+LPPAPI MemoryAllocator* GetMemoryAllocator();
+
+/// Installs an allocator for the calling thread for the lifetime of the guard, and restores the thread's
+/// previous one when it goes out of scope; null selects the default malloc based allocator.  Other threads
+/// keep their own allocator.  Guards on a thread must be destroyed in the reverse order of their creation.
+///
+/// <pre>
+/// static PoolMemoryAllocator* pool = new PoolMemoryAllocator(); // outlives every block allocated from it
+/// {
+///     ScopedMemoryAllocator scoped(pool);
+///     writer->addDocument(doc);
+/// }
+/// </pre>
+class LPPAPI ScopedMemoryAllocator {
+public:
+    ScopedMemoryAllocator(MemoryAllocator* allocator);
+    ~ScopedMemoryAllocator();
+
+protected:
+    MemoryAllocator* previous;
+
+private:
+    ScopedMemoryAllocator(const ScopedMemoryAllocator& other);
+    ScopedMemoryAllocator& operator= (const ScopedMemoryAllocator& other);
+};
+
+/// Allocator that keeps freed small blocks in per-thread lists, one per 16 byte size class, and hands them
+/// out again without going through the system heap.  Blocks larger than {@link #MAX_POOLED_SIZE} are passed
+/// straight to malloc.  Blocks freed by a thread other than the one that allocated them go to the freeing
+/// thread's lists.  A thread's lists are emptied when it exits, and the lists of all threads when the
+/// allocator is destroyed.
+class LPPAPI PoolMemoryAllocator : public MemoryAllocator {
+public:
+    PoolMemoryAllocator(int32_t maxBlocksPerClass = DEFAULT_MAX_BLOCKS_PER_CLASS);
+    virtual ~PoolMemoryAllocator();
+
+public:
+    /// Largest block size served from the pool.
+    static const int32_t MAX_POOLED_SIZE;
+
+    /// Default number of free blocks a thread keeps per size class.
+    static const int32_t DEFAULT_MAX_BLOCKS_PER_CLASS;
+
+protected:
+    void* threadCaches; // per-thread free lists and their registry, opaque to keep boost out of this header
+    int32_t maxBlocksPerClass;
+
+public:
+    virtual void* allocate(size_t size);
+    virtual void release(void* memory, size_t size);
+
+    /// Return the free blocks cached by the calling thread to the system heap.
+    void reset();
+};
+
+/// Bump allocator for the short-lived objects built while running a single query.  While a MemoryArena is in
+/// scope, allocations made by the thread that created it are carved from large chunks, and releasing them is
+/// just a counter decrement.  A chunk goes back to the system once every block in it has been freed and the
+/// arena has moved on, so objects that outlive the arena (cached or returned results) stay valid.
+///
+/// <pre>
+/// {
+///     MemoryArena arena;
+///     TopDocsPtr topDocs = searcher->search(query, 10);
+/// }
+/// </pre>
+///
+/// Allocations made on other threads (for example a {@link ThreadPool}) are not affected.
+class LPPAPI MemoryArena {
+public:
+    MemoryArena();
+    ~MemoryArena();
+
+public:
+    /// Size of the chunks blocks are carved from.  Chunks are aligned to their size.
+    static const int32_t CHUNK_SIZE;
+
+protected:
+    MemoryArena* previous; // arena this one replaced on the current thread
+    uint8_t* chunk; // current chunk
+    int32_t chunkPosition; // next free byte in current chunk
+
+public:
+    /// Allocate a block with room for a {@link AllocMemory} header, or null if the block is too large for
+    /// the arena.
+    void* allocate(size_t size);
+
+    /// Give up the current chunk, so it goes back to the system as soon as the blocks carved from it are
+    /// freed rather than when the arena goes out of scope.  Use between queries when one arena stays in scope
+    /// for a long running loop.
+    void reset();
+
+    /// Returns the arena in scope on the current thread, or null.
+    static MemoryArena* current();
+
+private:
+    MemoryArena(const MemoryArena& other);
+    MemoryArena& operator= (const MemoryArena& other);
+};
+
+/// STL compatible allocator that allocates through {@link AllocMemory}.
+template <typename TYPE>
+class LuceneAllocator {
+public:
+    typedef size_t size_type;
+    typedef ptrdiff_t difference_type;
+    typedef TYPE* pointer;
+    typedef const TYPE* const_pointer;
+    typedef TYPE& reference;
+    typedef const TYPE& const_reference;
+    typedef TYPE value_type;
+
+    template <typename OTHER>
+    struct rebind {
+        typedef LuceneAllocator<OTHER> other;
+    };
+
+    LuceneAllocator() {
+    }
+
+    template <typename OTHER>
+    LuceneAllocator(const LuceneAllocator<OTHER>&) {
+    }
+
+public:
+    pointer address(reference value) const {
+        return &value;
+    }
+
+    const_pointer address(const_reference value) const {
+        return &value;
+    }
+
+    pointer allocate(size_type n, const void* = 0) {
+        void* memory = AllocMemory(n * sizeof(TYPE));
+        if (memory == NULL) {
+            throw std::bad_alloc();
+        }
+        return static_cast<pointer>(memory);
+    }
+
+    void deallocate(pointer p, size_type) {
+        FreeMemory(p);
+    }
+
+#if defined(BOOST_NO_CXX11_VARIADIC_TEMPLATES) || defined(BOOST_NO_CXX11_RVALUE_REFERENCES)
+    void construct(pointer p, const TYPE& value) {
+        new (static_cast<void*>(p)) TYPE(value);
+    }
+
+    void destroy(pointer p) {
+        p->~TYPE();
+    }
+#else
+    // forward the arguments, so allocate_shared never copies (objects such as Future are not copyable)
+    template <typename OTHER, typename... ARGS>
+    void construct(OTHER* p, ARGS&&... args) {
+        new (static_cast<void*>(p)) OTHER(std::forward<ARGS>(args)...);
+    }
+
+    template <typename OTHER>
+    void destroy(OTHER* p) {
+        p->~OTHER();
+    }
+#endif
+
+    size_type max_size() const {
+        return (size_type)-1 / sizeof(TYPE);
+    }
+};
+
+template <typename TYPE, typename OTHER>
+inline bool operator== (const LuceneAllocator<TYPE>&, const LuceneAllocator<OTHER>&) {
+    return true;
+}
+
+template <typename TYPE, typename OTHER>
+inline bool operator!= (const LuceneAllocator<TYPE>&, const LuceneAllocator<OTHER>&) {
+    return false;
+}
+
 }
 
 #endif
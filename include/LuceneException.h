@@ -17,6 +17,7 @@ public:
     enum ExceptionType {
         Null,
         AlreadyClosed,
+        CollectionTerminated,
         Compression,
         CorruptIndex,
         FieldReader,
@@ -76,6 +77,7 @@ typedef ExceptionTemplate<RuntimeException, LuceneException::NullPointer> NullPo
 typedef ExceptionTemplate<RuntimeException, LuceneException::FieldReader> FieldReaderException;
 typedef ExceptionTemplate<RuntimeException, LuceneException::Merge> MergeException;
 typedef ExceptionTemplate<RuntimeException, LuceneException::StopFillCache> StopFillCacheException;
+typedef ExceptionTemplate<RuntimeException, LuceneException::CollectionTerminated> CollectionTerminatedException;
 typedef ExceptionTemplate<RuntimeException, LuceneException::TimeExceeded> TimeExceededException;
 typedef ExceptionTemplate<RuntimeException, LuceneException::TooManyClauses> TooManyClausesException;
 typedef ExceptionTemplate<RuntimeException, LuceneException::UnsupportedOperation> UnsupportedOperationException;
@@ -9,6 +9,7 @@
 
 #include <boost/make_shared.hpp>
 #include <boost/version.hpp>
+#include "LuceneAllocator.h"
 
 namespace Lucene {
 
@@ -17,7 +18,7 @@ boost::shared_ptr<T> newInstance() {
 #if BOOST_VERSION <= 103800
     return boost::shared_ptr<T>(new T);
 #else
-    return boost::make_shared<T>();
+    return boost::allocate_shared<T>(LuceneAllocator<T>());
 #endif
 }
 
@@ -26,7 +27,7 @@ boost::shared_ptr<T> newInstance(A1 const& a1) {
 #if BOOST_VERSION <= 103800
     return boost::shared_ptr<T>(new T(a1));
 #else
-    return boost::make_shared<T>(a1);
+    return boost::allocate_shared<T>(LuceneAllocator<T>(), a1);
 #endif
 }
 
@@ -35,7 +36,7 @@ boost::shared_ptr<T> newInstance(A1 const& a1, A2 const& a2) {
 #if BOOST_VERSION <= 103800
     return boost::shared_ptr<T>(new T(a1, a2));
 #else
-    return boost::make_shared<T>(a1, a2);
+    return boost::allocate_shared<T>(LuceneAllocator<T>(), a1, a2);
 #endif
 }
 
@@ -44,7 +45,7 @@ boost::shared_ptr<T> newInstance(A1 const& a1, A2 const& a2, A3 const& a3) {
 #if BOOST_VERSION <= 103800
     return boost::shared_ptr<T>(new T(a1, a2, a3));
 #else
-    return boost::make_shared<T>(a1, a2, a3);
+    return boost::allocate_shared<T>(LuceneAllocator<T>(), a1, a2, a3);
 #endif
 }
 
@@ -53,7 +54,7 @@ boost::shared_ptr<T> newInstance(A1 const& a1, A2 const& a2, A3 const& a3, A4 co
 #if BOOST_VERSION <= 103800
     return boost::shared_ptr<T>(new T(a1, a2, a3, a4));
 #else
-    return boost::make_shared<T>(a1, a2, a3, a4);
+    return boost::allocate_shared<T>(LuceneAllocator<T>(), a1, a2, a3, a4);
 #endif
 }
 
@@ -62,7 +63,7 @@ boost::shared_ptr<T> newInstance(A1 const& a1, A2 const& a2, A3 const& a3, A4 co
 #if BOOST_VERSION <= 103800
     return boost::shared_ptr<T>(new T(a1, a2, a3, a4, a5));
 #else
-    return boost::make_shared<T>(a1, a2, a3, a4, a5);
+    return boost::allocate_shared<T>(LuceneAllocator<T>(), a1, a2, a3, a4, a5);
 #endif
 }
 
@@ -71,7 +72,7 @@ boost::shared_ptr<T> newInstance(A1 const& a1, A2 const& a2, A3 const& a3, A4 co
 #if BOOST_VERSION <= 103800
     return boost::shared_ptr<T>(new T(a1, a2, a3, a4, a5, a6));
 #else
-    return boost::make_shared<T>(a1, a2, a3, a4, a5, a6);
+    return boost::allocate_shared<T>(LuceneAllocator<T>(), a1, a2, a3, a4, a5, a6);
 #endif
 }
 
@@ -80,7 +81,7 @@ boost::shared_ptr<T> newInstance(A1 const& a1, A2 const& a2, A3 const& a3, A4 co
 #if BOOST_VERSION <= 103800
     return boost::shared_ptr<T>(new T(a1, a2, a3, a4, a5, a6, a7));
 #else
-    return boost::make_shared<T>(a1, a2, a3, a4, a5, a6, a7);
+    return boost::allocate_shared<T>(LuceneAllocator<T>(), a1, a2, a3, a4, a5, a6, a7);
 #endif
 }
 
@@ -89,7 +90,7 @@ boost::shared_ptr<T> newInstance(A1 const& a1, A2 const& a2, A3 const& a3, A4 co
 #if BOOST_VERSION <= 103800
     return boost::shared_ptr<T>(new T(a1, a2, a3, a4, a5, a6, a7, a8));
 #else
-    return boost::make_shared<T>(a1, a2, a3, a4, a5, a6, a7, a8);
+    return boost::allocate_shared<T>(LuceneAllocator<T>(), a1, a2, a3, a4, a5, a6, a7, a8);
 #endif
 }
 
@@ -98,7 +99,7 @@ boost::shared_ptr<T> newInstance(A1 const& a1, A2 const& a2, A3 const& a3, A4 co
 #if BOOST_VERSION <= 103800
     return boost::shared_ptr<T>(new T(a1, a2, a3, a4, a5, a6, a7, a8, a9));
 #else
-    return boost::make_shared<T>(a1, a2, a3, a4, a5, a6, a7, a8, a9);
+    return boost::allocate_shared<T>(LuceneAllocator<T>(), a1, a2, a3, a4, a5, a6, a7, a8, a9);
 #endif
 }
 
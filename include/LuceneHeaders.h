@@ -30,6 +30,7 @@
 // Include most common files: document
 #include "DateField.h"
 #include "DateTools.h"
+#include "DocValuesField.h"
 #include "Document.h"
 #include "Field.h"
 #include "NumberTools.h"
@@ -73,6 +74,7 @@
 #include "PhraseQuery.h"
 #include "PrefixFilter.h"
 #include "PrefixQuery.h"
+#include "QueryProfiler.h"
 #include "ScoreDoc.h"
 #include "Scorer.h"
 #include "Searcher.h"
@@ -95,6 +97,7 @@
 // Include most common files: store
 #include "FSDirectory.h"
 #include "MMapDirectory.h"
+#include "NIOFSDirectory.h"
 #include "RAMDirectory.h"
 #include "RAMFile.h"
 #include "RAMInputStream.h"
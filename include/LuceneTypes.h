@@ -71,6 +71,7 @@ DECLARE_SHARED_PTR(AbstractField)
 DECLARE_SHARED_PTR(CompressionTools)
 DECLARE_SHARED_PTR(DateField)
 DECLARE_SHARED_PTR(DateTools)
+DECLARE_SHARED_PTR(DocValuesField)
 DECLARE_SHARED_PTR(Document)
 DECLARE_SHARED_PTR(Field)
 DECLARE_SHARED_PTR(Fieldable)
@@ -120,6 +121,9 @@ DECLARE_SHARED_PTR(DocInverter)
 DECLARE_SHARED_PTR(DocInverterPerField)
 DECLARE_SHARED_PTR(DocInverterPerThread)
 DECLARE_SHARED_PTR(DocState)
+DECLARE_SHARED_PTR(DocValuesOutput)
+DECLARE_SHARED_PTR(DocValuesReader)
+DECLARE_SHARED_PTR(DocValuesWriter)
 DECLARE_SHARED_PTR(DocumentsWriter)
 DECLARE_SHARED_PTR(DocumentsWriterThreadState)
 DECLARE_SHARED_PTR(DocWriter)
@@ -128,6 +132,7 @@ DECLARE_SHARED_PTR(FieldInfos)
 DECLARE_SHARED_PTR(FieldInvertState)
 DECLARE_SHARED_PTR(FieldNormStatus)
 DECLARE_SHARED_PTR(FieldSortedTermVectorMapper)
+DECLARE_SHARED_PTR(FieldsChunkInput)
 DECLARE_SHARED_PTR(FieldsReader)
 DECLARE_SHARED_PTR(FieldsReaderLocal)
 DECLARE_SHARED_PTR(FieldsWriter)
@@ -226,6 +231,7 @@ DECLARE_SHARED_PTR(SkipBuffer)
 DECLARE_SHARED_PTR(SkipDocWriter)
 DECLARE_SHARED_PTR(SnapshotDeletionPolicy)
 DECLARE_SHARED_PTR(SortedTermVectorMapper)
+DECLARE_SHARED_PTR(SortingMergePolicy)
 DECLARE_SHARED_PTR(StoredFieldStatus)
 DECLARE_SHARED_PTR(StoredFieldsWriter)
 DECLARE_SHARED_PTR(StoredFieldsWriterPerDoc)
@@ -238,6 +244,7 @@ DECLARE_SHARED_PTR(TermFreqVector)
 DECLARE_SHARED_PTR(TermIndexStatus)
 DECLARE_SHARED_PTR(TermInfo)
 DECLARE_SHARED_PTR(TermInfosReader)
+DECLARE_SHARED_PTR(TermInfosReaderIndex)
 DECLARE_SHARED_PTR(TermInfosReaderThreadResources)
 DECLARE_SHARED_PTR(TermInfosWriter)
 DECLARE_SHARED_PTR(TermPositions)
@@ -262,6 +269,7 @@ DECLARE_SHARED_PTR(TermVectorsTermsWriterPerThread)
 DECLARE_SHARED_PTR(TermVectorsTermsWriterPostingList)
 DECLARE_SHARED_PTR(TermVectorsWriter)
 DECLARE_SHARED_PTR(TermVectorsPositionInfo)
+DECLARE_SHARED_PTR(TieredMergePolicy)
 DECLARE_SHARED_PTR(WaitQueue)
 
 // query parser
@@ -281,7 +289,6 @@ DECLARE_SHARED_PTR(BooleanScorer)
 DECLARE_SHARED_PTR(BooleanScorerCollector)
 DECLARE_SHARED_PTR(BooleanScorer2)
 DECLARE_SHARED_PTR(BooleanWeight)
-DECLARE_SHARED_PTR(Bucket)
 DECLARE_SHARED_PTR(BucketScorer)
 DECLARE_SHARED_PTR(BucketTable)
 DECLARE_SHARED_PTR(ByteCache)
@@ -376,10 +383,15 @@ DECLARE_SHARED_PTR(IntFieldSource)
 DECLARE_SHARED_PTR(IntParser)
 DECLARE_SHARED_PTR(LongCache)
 DECLARE_SHARED_PTR(LongParser)
+DECLARE_SHARED_PTR(LRUCachedFilter)
+DECLARE_SHARED_PTR(LRUFilterCache)
+DECLARE_SHARED_PTR(LRUFilterCacheEntry)
+DECLARE_SHARED_PTR(LRUFilterCacheKey)
 DECLARE_SHARED_PTR(MatchAllDocsQuery)
 DECLARE_SHARED_PTR(MatchAllDocsWeight)
 DECLARE_SHARED_PTR(MatchAllScorer)
 DECLARE_SHARED_PTR(MaxPayloadFunction)
+DECLARE_SHARED_PTR(MaxScoreScorer)
 DECLARE_SHARED_PTR(MinPayloadFunction)
 DECLARE_SHARED_PTR(MultiComparatorsFieldValueHitQueue)
 DECLARE_SHARED_PTR(MultiPhraseQuery)
@@ -397,6 +409,12 @@ DECLARE_SHARED_PTR(NumericUtilsIntParser)
 DECLARE_SHARED_PTR(NumericUtilsLongParser)
 DECLARE_SHARED_PTR(OneComparatorFieldValueHitQueue)
 DECLARE_SHARED_PTR(OrdFieldSource)
+DECLARE_SHARED_PTR(PackedComparatorSource)
+DECLARE_SHARED_PTR(PackedIntCache)
+DECLARE_SHARED_PTR(PackedLongCache)
+DECLARE_SHARED_PTR(PackedStringIndex)
+DECLARE_SHARED_PTR(PackedStringIndexCache)
+DECLARE_SHARED_PTR(PackedValues)
 DECLARE_SHARED_PTR(ParallelMultiSearcher)
 DECLARE_SHARED_PTR(Parser)
 DECLARE_SHARED_PTR(PayloadFunction)
@@ -417,7 +435,16 @@ DECLARE_SHARED_PTR(PrefixFilter)
 DECLARE_SHARED_PTR(PrefixQuery)
 DECLARE_SHARED_PTR(PrefixTermEnum)
 DECLARE_SHARED_PTR(PriorityQueueScoreDocs)
+DECLARE_SHARED_PTR(ProfilingCollector)
+DECLARE_SHARED_PTR(ProfilingScorer)
+DECLARE_SHARED_PTR(ProfilingWeight)
 DECLARE_SHARED_PTR(Query)
+DECLARE_SHARED_PTR(QueryProfileNode)
+DECLARE_SHARED_PTR(QueryProfileSegment)
+DECLARE_SHARED_PTR(QueryProfiler)
+DECLARE_SHARED_PTR(QueryResultCache)
+DECLARE_SHARED_PTR(QueryResultCacheEntry)
+DECLARE_SHARED_PTR(QueryResultCacheKey)
 DECLARE_SHARED_PTR(QueryTermVector)
 DECLARE_SHARED_PTR(QueryWrapperFilter)
 DECLARE_SHARED_PTR(ReqExclScorer)
@@ -432,6 +459,8 @@ DECLARE_SHARED_PTR(ScoreTermQueue)
 DECLARE_SHARED_PTR(ScoringBooleanQueryRewrite)
 DECLARE_SHARED_PTR(Searchable)
 DECLARE_SHARED_PTR(Searcher)
+DECLARE_SHARED_PTR(SearcherManager)
+DECLARE_SHARED_PTR(SearcherRefreshThread)
 DECLARE_SHARED_PTR(Similarity)
 DECLARE_SHARED_PTR(SimilarityDisableCoord)
 DECLARE_SHARED_PTR(SimilarityDelegator)
@@ -499,13 +528,19 @@ DECLARE_SHARED_PTR(MMapDirectory)
 DECLARE_SHARED_PTR(MMapIndexInput)
 DECLARE_SHARED_PTR(NativeFSLock)
 DECLARE_SHARED_PTR(NativeFSLockFactory)
+DECLARE_SHARED_PTR(NIOFSDirectory)
+DECLARE_SHARED_PTR(NIOFSIndexInput)
 DECLARE_SHARED_PTR(NoLock)
 DECLARE_SHARED_PTR(NoLockFactory)
 DECLARE_SHARED_PTR(OutputFile)
+DECLARE_SHARED_PTR(PositionalInputFile)
 DECLARE_SHARED_PTR(RAMDirectory)
 DECLARE_SHARED_PTR(RAMFile)
 DECLARE_SHARED_PTR(RAMInputStream)
 DECLARE_SHARED_PTR(RAMOutputStream)
+DECLARE_SHARED_PTR(RateLimitedDirectory)
+DECLARE_SHARED_PTR(RateLimitedIndexOutput)
+DECLARE_SHARED_PTR(RateLimiter)
 DECLARE_SHARED_PTR(SimpleFSDirectory)
 DECLARE_SHARED_PTR(SimpleFSIndexInput)
 DECLARE_SHARED_PTR(SimpleFSIndexOutput)
@@ -539,13 +574,21 @@ DECLARE_SHARED_PTR(LongRangeBuilder)
 DECLARE_SHARED_PTR(LuceneObject)
 DECLARE_SHARED_PTR(LuceneSignal)
 DECLARE_SHARED_PTR(LuceneThread)
+DECLARE_SHARED_PTR(LZ4)
 DECLARE_SHARED_PTR(NumericUtils)
 DECLARE_SHARED_PTR(OpenBitSet)
 DECLARE_SHARED_PTR(OpenBitSetDISI)
 DECLARE_SHARED_PTR(OpenBitSetIterator)
+DECLARE_SHARED_PTR(PackedInts)
 DECLARE_SHARED_PTR(Random)
 DECLARE_SHARED_PTR(Reader)
 DECLARE_SHARED_PTR(ReaderField)
+DECLARE_SHARED_PTR(RoaringArrayContainer)
+DECLARE_SHARED_PTR(RoaringBitmapContainer)
+DECLARE_SHARED_PTR(RoaringContainer)
+DECLARE_SHARED_PTR(RoaringDocIdSet)
+DECLARE_SHARED_PTR(RoaringDocIdSetIterator)
+DECLARE_SHARED_PTR(RoaringRunContainer)
 DECLARE_SHARED_PTR(ScorerDocQueue)
 DECLARE_SHARED_PTR(SortedVIntList)
 DECLARE_SHARED_PTR(StringReader)
@@ -19,6 +19,11 @@ namespace Lucene {
 /// NOTE: Accessing this class either directly or indirectly from a thread while it's interrupted can close the
 /// underlying channel immediately if at the same time the thread is blocked on IO.  The channel will remain closed and
 /// subsequent access to {@link MMapDirectory} will throw an exception.
+///
+/// Files are mapped in chunks of at most {@link #getMaxChunkSize} bytes so that files larger than 2GB (or larger
+/// than the available contiguous address space on 32 bit platforms) can be mapped.  An optional access pattern
+/// hint can be registered per file extension using {@link #setAdvice}; it is passed to the operating system via
+/// madvise where supported.
 class LPPAPI MMapDirectory : public FSDirectory {
 public:
     /// Create a new MMapDirectory for the named location.
@@ -30,9 +35,53 @@ public:
 
     LUCENE_CLASS(MMapDirectory);
 
+public:
+    /// Access pattern hints passed to the operating system for mapped files.
+    enum MMapAdvice {
+        /// No special treatment.
+        ADVICE_NORMAL,
+
+        /// Expect page references in random order (eg. term dictionary and postings lookups).
+        ADVICE_RANDOM,
+
+        /// Expect page references in sequential order (eg. merging).
+        ADVICE_SEQUENTIAL,
+
+        /// Expect access in the near future, so read ahead the whole mapping.
+        ADVICE_WILLNEED
+    };
+
+    /// Default maximum chunk size.  This is a conditional default based on operating system.
+    /// @see #setMaxChunkSize
+    static const int32_t DEFAULT_MAX_CHUNK_SIZE;
+
+protected:
+    /// Power of two of the maximum chunk size.
+    int32_t chunkSizePower;
+
+    /// Access pattern hints keyed by file extension.
+    MapStringInt advices;
+
 public:
     using FSDirectory::openInput;
 
+    /// Sets the maximum chunk size (default is {@link #DEFAULT_MAX_CHUNK_SIZE}) used for memory mapping.  The value
+    /// is rounded down to a power of two and up to the platform mapping alignment.  Changes to this value will not
+    /// impact any already-opened {@link IndexInput}s.
+    void setMaxChunkSize(int32_t maxChunkSize);
+
+    /// Returns the current maximum chunk size.
+    /// @see #setMaxChunkSize
+    int32_t getMaxChunkSize();
+
+    /// Sets the access pattern hint for files with the given extension (eg. "frq").  Changes to this value will
+    /// not impact any already-opened {@link IndexInput}s.
+    void setAdvice(const String& extension, MMapAdvice advice);
+
+    /// Returns the access pattern hint for files with the given extension.
+    /// @see #setAdvice
+    MMapAdvice getAdvice(const String& extension);
+
     /// Creates an IndexInput for the file with the given name.
     virtual IndexInputPtr openInput(const String& name, int32_t bufferSize);
 
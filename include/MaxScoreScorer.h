@@ -0,0 +1,93 @@
+/////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2009-2014 Alan Wright. All rights reserved.
+// Distributable under the terms of either the Apache License (Version 2.0)
+// or the GNU Lesser General Public License.
+/////////////////////////////////////////////////////////////////////////////
+
+#ifndef MAXSCORESCORER_H
+#define MAXSCORESCORER_H
+
+#include "Scorer.h"
+
+namespace Lucene {
+
+/// A Scorer for OR like queries whose clauses have known upper bounds on their scores, which skips the
+/// documents that cannot score above the minimum competitive score set by the collector (the MaxScore
+/// algorithm).
+///
+/// Clauses are ordered by increasing bound.  Once the bounds of the lowest clauses add up to no more than the
+/// minimum competitive score, a document matching only these clauses cannot compete, so they become
+/// non-essential: candidates are only drawn from the remaining essential clauses, and the non-essential
+/// clauses are advanced to a candidate with {@link #advance} only while it may still compete.  Until a
+/// minimum competitive score is set, this scores like {@link DisjunctionSumScorer}.
+///
+/// The bounds of {@link TermScorer} clauses are tightened for each candidate with the highest frequency of
+/// the term in the block of documents containing it, so that clauses need not be advanced to candidates in
+/// blocks where they can't score much.
+class LPPAPI MaxScoreScorer : public Scorer {
+public:
+    /// @param similarity The similarity of the query.
+    /// @param subScorers The scorers of the clauses, in query order.
+    /// @param maxScores Upper bounds of the scores of each clause, infinite if unknown.
+    /// @param coordFactors The coordination factor for each number of matching clauses.
+    MaxScoreScorer(const SimilarityPtr& similarity, Collection<ScorerPtr> subScorers, Collection<double> maxScores, Collection<double> coordFactors);
+    virtual ~MaxScoreScorer();
+
+    LUCENE_CLASS(MaxScoreScorer);
+
+public:
+    /// The largest number of clauses scored with this scorer.  Every candidate visits each clause, which costs
+    /// more than the queue of {@link DisjunctionSumScorer} for large disjunctions, or when the collector never
+    /// raises the minimum competitive score.
+    static const int32_t MAX_CLAUSES;
+
+protected:
+    Collection<ScorerPtr> subScorers;
+    Collection<double> coordFactors;
+
+    /// The clauses that are {@link TermScorer}s, null for others.
+    Collection<TermScorerPtr> termScorers;
+
+    /// The largest coordination factor.
+    double maxCoord;
+
+    /// Bounds of the clauses for the current candidate.
+    Collection<double> candidateMaxScores;
+
+    /// Upper bounds of the contribution of each clause to a score, including the largest coordination factor.
+    Collection<double> maxScores;
+
+    /// Clauses by increasing bound.
+    Collection<int32_t> order;
+
+    /// Sum of the bounds of the clauses up to each position of order.
+    Collection<double> sumMaxScores;
+
+    /// Allowance for rounding when comparing bounds computed by summing in another order than the scores.
+    double slack;
+
+    /// Position in order of the first essential clause.
+    int32_t firstEssential;
+
+    double minCompetitiveScore;
+    int32_t doc;
+    double currentScore;
+
+public:
+    virtual int32_t docID();
+    virtual int32_t nextDoc();
+    virtual int32_t advance(int32_t target);
+    virtual double score();
+    virtual void setMinCompetitiveScore(double minScore);
+
+protected:
+    /// Scores a document matched by an essential clause, returning false if it cannot compete.
+    bool scoreCandidate(int32_t candidate);
+
+    /// Returns an upper bound of the contribution of a clause to the score of a candidate.
+    double candidateMaxScore(int32_t clause, int32_t candidate);
+};
+
+}
+
+#endif
@@ -11,9 +11,9 @@
 
 namespace Lucene {
 
-/// Remaps docIDs after a merge has completed, where the merged segments had at least one deletion.
-/// This is used to renumber the buffered deletes in IndexWriter when a merge of segments with deletions
-/// commits.
+/// Remaps docIDs after a merge has completed, where the merged segments had at least one deletion
+/// or weren't adjacent in the index.  This is used to renumber the buffered deletes in IndexWriter
+/// when such a merge commits.
 class MergeDocIDRemapper : public LuceneObject {
 public:
     MergeDocIDRemapper(const SegmentInfosPtr& infos, Collection< Collection<int32_t> > docMaps, Collection<int32_t> delCounts, const OneMergePtr& merge, int32_t mergedDocCount);
@@ -23,13 +23,18 @@ public:
 
 public:
     Collection<int32_t> starts; // used for binary search of mapped docID
-    Collection<int32_t> newStarts; // starts, minus the deletes
+    Collection<int32_t> newStarts; // starts, minus the deletes and moved after the merged segment
+    Collection<int32_t> mergeOrds; // position of each segment in the merge, or -1 if not merged
     Collection< Collection<int32_t> > docMaps; // maps docIDs in the merged set
     int32_t minDocID; // minimum docID that needs renumbering
     int32_t maxDocID; // 1+ the max docID that needs renumbering
     int32_t docShift; // total # deleted docs that were compacted by this merge
+    bool reordered; // true if segments were merged out of order or around other segments
 
 public:
+    /// Returns true if any docID needs renumbering.
+    bool changesDocIDs();
+
     int32_t remap(int32_t oldDocID);
 };
 
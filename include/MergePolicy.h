@@ -94,6 +94,16 @@ public:
     SegmentInfosPtr segments;
     bool useCompoundFile;
     bool aborted;
+    bool paused;
+
+    /// Limits the rate at which the merged segment is written, or null to write it at full speed.  The
+    /// limiter may be shared with other merges.
+    /// @see ConcurrentMergeScheduler#setMergeWriteMBPerSec
+    RateLimiterPtr rateLimiter;
+
+    /// The order of the documents in the merged segment, or null to keep the order of the segments.
+    /// @see SortingMergePolicy
+    SortPtr sort;
     LuceneException error;
 
 public:
@@ -109,8 +119,19 @@ public:
     /// Returns true if this merge was aborted.
     bool isAborted();
 
+    /// Pauses or resumes this merge.  A paused merge waits in {@link #checkAborted}, which it calls regularly
+    /// while merging, until it is resumed or aborted.
+    void setPause(bool paused);
+
+    /// Returns true if this merge is paused.
+    bool getPause();
+
+    /// Throws {@link MergeAbortedException} if this merge was aborted, after waiting while it is paused.
     void checkAborted(const DirectoryPtr& dir);
 
+    /// Returns the number of documents in the segments merged, including deleted ones.
+    int32_t totalDocCount();
+
     String segString(const DirectoryPtr& dir);
 };
 
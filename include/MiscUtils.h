@@ -29,6 +29,10 @@ public:
     /// Returns the current time in milliseconds.
     static uint64_t currentTimeMillis();
 
+    /// Returns the current value of a monotonic high-resolution timer, in nanoseconds.  Only meaningful
+    /// for measuring elapsed time.
+    static int64_t nanoTime();
+
     /// This over-allocates proportional to the list size, making room for additional growth.
     /// The over-allocation is mild, but is enough to give linear-time amortized behavior over a long
     /// sequence of appends().
@@ -130,6 +134,18 @@ public:
 
     /// Perform unsigned right-shift (left bits are zero filled)
     static int32_t unsignedShift(int32_t num, int32_t shift);
+
+    /// Decode a run of variable-length ints (as written by {@link IndexOutput#writeVInt(int32_t)}) from a
+    /// byte buffer.  Decoding stops after count values, or earlier once fewer than five bytes remain, so a
+    /// value is never split across the end of the buffer.  Runs of single byte values are widened 16 at a
+    /// time where SSE2 is available.
+    /// @param bytes the buffer to decode from.
+    /// @param length the number of bytes available in the buffer.
+    /// @param values the array to decode values into.
+    /// @param count the maximum number of values to decode.
+    /// @param bytesRead set to the number of bytes consumed.
+    /// @return the number of values decoded.
+    static int32_t decodeVInts(const uint8_t* bytes, int32_t length, int32_t* values, int32_t count, int32_t& bytesRead);
 };
 
 }
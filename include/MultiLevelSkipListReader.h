@@ -60,6 +60,14 @@ public:
     /// target. Returns the current doc count.
     virtual int32_t skipTo(int32_t target);
 
+    /// Returns the number of levels that still have a skip entry at or after the target of the last call of
+    /// {@link #skipTo(int)}.
+    int32_t getNumberOfSkipLevels();
+
+    /// Returns the id of the doc of the current skip entry on the given level, the last doc of the block of
+    /// docs containing the target of the last call of {@link #skipTo(int)}.
+    int32_t getSkipDoc(int32_t level);
+
     virtual void close();
 
     /// Initializes the reader.
@@ -0,0 +1,43 @@
+/////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2009-2014 Alan Wright. All rights reserved.
+// Distributable under the terms of either the Apache License (Version 2.0)
+// or the GNU Lesser General Public License.
+/////////////////////////////////////////////////////////////////////////////
+
+#ifndef NIOFSDIRECTORY_H
+#define NIOFSDIRECTORY_H
+
+#include "FSDirectory.h"
+
+namespace Lucene {
+
+/// An {@link FSDirectory} implementation that uses positional reads (pread on POSIX, overlapped ReadFile on Windows)
+/// on a raw file descriptor, which allows multiple threads to read from the same file without synchronizing.
+///
+/// This class only uses positional reads when reading; writing is achieved with {@link SimpleFSIndexOutput}.
+///
+/// NOTE: This is the preferred choice for highly concurrent searching, since unlike {@link SimpleFSDirectory} the
+/// clones of an {@link IndexInput} opened by this directory do not contend on a per-file lock.
+class LPPAPI NIOFSDirectory : public FSDirectory {
+public:
+    /// Create a new NIOFSDirectory for the named location.
+    /// @param path the path of the directory.
+    /// @param lockFactory the lock factory to use, or null for the default ({@link NativeFSLockFactory})
+    NIOFSDirectory(const String& path, const LockFactoryPtr& lockFactory = LockFactoryPtr());
+    virtual ~NIOFSDirectory();
+
+    LUCENE_CLASS(NIOFSDirectory);
+
+public:
+    using FSDirectory::openInput;
+
+    /// Creates an IndexInput for the file with the given name.
+    virtual IndexInputPtr openInput(const String& name, int32_t bufferSize);
+
+    /// Creates an IndexOutput for the file with the given name.
+    virtual IndexOutputPtr createOutput(const String& name);
+};
+
+}
+
+#endif
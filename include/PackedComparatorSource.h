@@ -0,0 +1,47 @@
+/////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2009-2014 Alan Wright. All rights reserved.
+// Distributable under the terms of either the Apache License (Version 2.0)
+// or the GNU Lesser General Public License.
+/////////////////////////////////////////////////////////////////////////////
+
+#ifndef PACKEDCOMPARATORSOURCE_H
+#define PACKEDCOMPARATORSOURCE_H
+
+#include "FieldComparatorSource.h"
+
+namespace Lucene {
+
+/// Sorts int, long and string fields using the packed {@link FieldCache} arrays ({@link
+/// FieldCache#getPackedInts}, {@link FieldCache#getPackedLongs} and {@link FieldCache#getPackedStringIndex})
+/// rather than the full width ones.  The order is the same as a {@link SortField} of the given type; the
+/// cached values take a fraction of the memory when their range or number of unique terms is small, at a
+/// small cost in comparison speed.
+///
+/// <pre>
+/// SortPtr sort = newLucene<Sort>(newLucene<SortField>(L"timestamp", newLucene<PackedComparatorSource>(SortField::LONG)));
+/// </pre>
+class LPPAPI PackedComparatorSource : public FieldComparatorSource {
+public:
+    /// @param type One of {@link SortField#INT}, {@link SortField#SHORT}, {@link SortField#LONG} or {@link
+    /// SortField#STRING}.
+    /// @param parser Parser of int or long values, or null for the default.
+    PackedComparatorSource(int32_t type, const ParserPtr& parser = ParserPtr());
+    virtual ~PackedComparatorSource();
+
+    LUCENE_CLASS(PackedComparatorSource);
+
+protected:
+    int32_t type;
+    ParserPtr parser;
+
+public:
+    virtual FieldComparatorPtr newComparator(const String& fieldname, int32_t numHits, int32_t sortPos, bool reversed);
+
+    virtual bool equals(const LuceneObjectPtr& other);
+    virtual int32_t hashCode();
+    virtual String toString();
+};
+
+}
+
+#endif
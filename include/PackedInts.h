@@ -0,0 +1,72 @@
+/////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2009-2014 Alan Wright. All rights reserved.
+// Distributable under the terms of either the Apache License (Version 2.0)
+// or the GNU Lesser General Public License.
+/////////////////////////////////////////////////////////////////////////////
+
+#ifndef PACKEDINTS_H
+#define PACKEDINTS_H
+
+#include "LuceneObject.h"
+
+namespace Lucene {
+
+/// A fixed size array of non-negative integers, each stored using the same number of bits.  Values are packed
+/// contiguously into 64 bit blocks and may span two blocks, so no space is wasted between values.
+///
+/// Use {@link #bitsRequired} to find the minimum number of bits needed for a given maximum value.
+class LPPAPI PackedInts : public LuceneObject {
+public:
+    /// Constructs an array of valueCount values, each using bitsPerValue bits (between 1 and 64).
+    /// All values are initially 0.
+    PackedInts(int32_t valueCount, int32_t bitsPerValue);
+
+    virtual ~PackedInts();
+
+    LUCENE_CLASS(PackedInts);
+
+protected:
+    LongArray blocks;
+    int32_t valueCount;
+    int32_t bitsPerValue;
+    int64_t maskRight;
+
+public:
+    /// Returns the number of bits required to store the given non-negative maximum value.
+    static int32_t bitsRequired(int64_t maxValue);
+
+    /// Returns the value at the given index.
+    inline int64_t get(int32_t index) {
+        int64_t bitPosition = (int64_t)index * bitsPerValue;
+        int32_t block = (int32_t)(bitPosition >> 6);
+        int32_t shift = (int32_t)(bitPosition & 63);
+        uint64_t value = (uint64_t)blocks[block] >> shift;
+        int32_t end = shift + bitsPerValue;
+        if (end > 64) {
+            value |= (uint64_t)blocks[block + 1] << (64 - shift);
+        }
+        return (int64_t)(value & (uint64_t)maskRight);
+    }
+
+    /// Sets the value at the given index.  The value must be non-negative and fit in {@link #getBitsPerValue}.
+    void set(int32_t index, int64_t value);
+
+    /// Returns the number of values in this array.
+    int32_t size();
+
+    /// Returns the number of bits used to store each value.
+    int32_t getBitsPerValue();
+
+    /// Returns the approximate number of bytes used by this array.
+    int64_t ramBytesUsed();
+
+    /// Writes the array to the given output, to be read back with {@link #read}.
+    void write(const IndexOutputPtr& output);
+
+    /// Reads an array written with {@link #write}.
+    static PackedIntsPtr read(const IndexInputPtr& input);
+};
+
+}
+
+#endif
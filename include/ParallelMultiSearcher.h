@@ -17,12 +17,19 @@ namespace Lucene {
 /// {@link #search(QueryPtr, FilterPtr, int32_t)} methods.
 class LPPAPI ParallelMultiSearcher : public MultiSearcher {
 public:
-    /// Creates a {@link Searchable} which searches searchables.
+    /// Creates a {@link Searchable} which searches searchables using the shared {@link ThreadPool} instance.
     ParallelMultiSearcher(Collection<SearchablePtr> searchables);
+
+    /// Creates a {@link Searchable} which searches searchables using the given thread pool.
+    ParallelMultiSearcher(Collection<SearchablePtr> searchables, const ThreadPoolPtr& threadPool);
+
     virtual ~ParallelMultiSearcher();
 
     LUCENE_CLASS(ParallelMultiSearcher);
 
+protected:
+    ThreadPoolPtr threadPool;
+
 public:
     /// Executes each {@link Searchable}'s docFreq() in its own thread and waits for each search to
     /// complete and merge the results back together.
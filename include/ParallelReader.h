@@ -98,6 +98,9 @@ public:
     /// Map all the term vectors for all fields in a Document
     virtual void getTermFreqVector(int32_t docNumber, const TermVectorMapperPtr& mapper);
 
+    virtual PackedValuesPtr getNumericDocValues(const String& field);
+    virtual PackedStringIndexPtr getSortedDocValues(const String& field);
+
     /// Returns true if there are norms stored for this field.
     virtual bool hasNorms(const String& field);
 
@@ -0,0 +1,153 @@
+/////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2009-2014 Alan Wright. All rights reserved.
+// Distributable under the terms of either the Apache License (Version 2.0)
+// or the GNU Lesser General Public License.
+/////////////////////////////////////////////////////////////////////////////
+
+#ifndef QUERYPROFILER_H
+#define QUERYPROFILER_H
+
+#include "LuceneObject.h"
+#include "CloseableThreadLocal.h"
+
+namespace Lucene {
+
+/// Timings of one node of a query tree against one segment (one call to {@link Weight#scorer}).
+/// All times are in nanoseconds.
+class LPPAPI QueryProfileSegment : public LuceneObject {
+public:
+    QueryProfileSegment(const String& segment);
+    virtual ~QueryProfileSegment();
+
+    LUCENE_CLASS(QueryProfileSegment);
+
+public:
+    /// Name of the segment, or a description of the reader if it is not a segment.
+    String segment;
+
+    /// Time spent building the scorer.
+    int64_t scorerNanos;
+
+    /// Calls to and time spent in {@link DocIdSetIterator#nextDoc()}.
+    int64_t nextDocCount;
+    int64_t nextDocNanos;
+
+    /// Calls to and time spent in {@link DocIdSetIterator#advance(int32_t)}.
+    int64_t advanceCount;
+    int64_t advanceNanos;
+
+    /// Calls to and time spent in {@link Scorer#score()}.
+    int64_t scoreCount;
+    int64_t scoreNanos;
+
+    /// Time spent in {@link Scorer#score(CollectorPtr)}, where the scorer drives collection itself (this
+    /// includes the time spent collecting).
+    int64_t bulkScoreNanos;
+
+public:
+    virtual String toString();
+};
+
+/// Timings of one node of a query tree: the time taken to create its {@link Weight}, the timings of each
+/// segment it was scored against and the nodes of its sub-queries.
+class LPPAPI QueryProfileNode : public LuceneObject {
+public:
+    QueryProfileNode(const QueryPtr& query);
+    virtual ~QueryProfileNode();
+
+    LUCENE_CLASS(QueryProfileNode);
+
+public:
+    /// Class name of the query.
+    String type;
+
+    /// The query, as given by {@link Query#toString()}.
+    String description;
+
+    /// Time spent creating the weight, including the weights of sub-queries.
+    int64_t weightNanos;
+
+    /// Timings per segment, in the order the segments were searched.
+    Collection<QueryProfileSegmentPtr> segments;
+
+    /// Nodes of the sub-queries.
+    Collection<QueryProfileNodePtr> children;
+
+public:
+    /// Add a segment, called from the threads searching segments.
+    QueryProfileSegmentPtr addSegment(const String& segment);
+
+    virtual String toString();
+
+    /// Render this node and its children, indented to the given depth.
+    String toString(int32_t depth);
+};
+
+/// Opt-in profiler recording where time goes while running a query: rewriting, weight creation, scorer
+/// construction per segment, iteration and scoring per node of the query tree, and collection.
+///
+/// Set a profiler on a searcher with {@link Searcher#setProfiler}, run the search and read the tree with
+/// {@link #getProfile()}.  Weights, scorers and the collector are only wrapped while a profiler is set, so
+/// searches without one are unaffected.  Timing every iteration call has a cost of its own, so absolute
+/// numbers are inflated for cheap scorers; compare nodes with each other rather than with unprofiled runs.
+/// A profiler may be shared by searchers running on several threads; each thread builds its own trees.
+///
+/// <pre>
+/// QueryProfilerPtr profiler = newLucene<QueryProfiler>();
+/// searcher->setProfiler(profiler);
+/// TopDocsPtr topDocs = searcher->search(query, 10);
+/// searcher->setProfiler(QueryProfilerPtr());
+/// std::wcout << profiler->toString();
+/// </pre>
+class LPPAPI QueryProfiler : public LuceneObject {
+public:
+    QueryProfiler();
+    virtual ~QueryProfiler();
+
+    LUCENE_CLASS(QueryProfiler);
+
+protected:
+    Collection<QueryProfileNodePtr> profiles; // one root per query weighted
+    CloseableThreadLocal< Collection<QueryProfileNodePtr> > stacks; // per thread, nodes whose weights are being created
+    int64_t rewriteNanos;
+    int64_t collectCount;
+    int64_t collectNanos;
+
+public:
+    /// Returns the tree of the last query profiled, or null if none.
+    QueryProfileNodePtr getProfile();
+
+    /// Returns the trees of all queries profiled since the last {@link #reset()}.
+    Collection<QueryProfileNodePtr> getProfiles();
+
+    /// Time spent rewriting queries, in nanoseconds.
+    int64_t getRewriteNanos();
+
+    /// Number of hits passed to the collector.
+    int64_t getCollectCount();
+
+    /// Time spent in the collector, in nanoseconds.
+    int64_t getCollectNanos();
+
+    /// Clear all recorded profiles.
+    void reset();
+
+    virtual String toString();
+
+    /// Create the weight of a query, recording a node for it under the node whose weight is being created.
+    WeightPtr createWeight(const QueryPtr& query, const SearcherPtr& searcher);
+
+    /// Wrap a collector to record collection counts and times.
+    CollectorPtr wrapCollector(const CollectorPtr& collector);
+
+    /// Record the counts and times of a collector returned by {@link #wrapCollector} once the search using it
+    /// has finished collecting.
+    void endCollection(const CollectorPtr& collector);
+
+    void addRewriteTime(int64_t nanos);
+    void addCollectTime(int64_t count, int64_t nanos);
+};
+
+}
+
+#endif
@@ -0,0 +1,106 @@
+/////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2009-2014 Alan Wright. All rights reserved.
+// Distributable under the terms of either the Apache License (Version 2.0)
+// or the GNU Lesser General Public License.
+/////////////////////////////////////////////////////////////////////////////
+
+#ifndef QUERYRESULTCACHE_H
+#define QUERYRESULTCACHE_H
+
+#include "LuceneObject.h"
+
+namespace Lucene {
+
+/// A cache of the top hits of searches, keyed by the query, filter and sort (using their equals() and
+/// hashCode()), the number of hits, the searcher's {@link Similarity} and settings, and the segments searched.
+///
+/// Searches sorted by fields, without scores, are cached per segment: the top hits of each segment don't
+/// depend on the rest of the index, so when a reader is reopened only the new or changed segments are
+/// searched again and the cached hits of the others are merged in.  A segment changes when it gets new
+/// deletions.  Searches that rank by score depend on statistics of the whole index and are cached for the
+/// exact set of segments searched, so any change to the index invalidates them.
+///
+/// The cached hits are shared by all callers and must not be modified.  Deletions made through a reader
+/// that isn't read only are not seen by hits already cached for it.  When the cache is full the least
+/// recently used entries are evicted, and entries of segments that have been closed are dropped on the
+/// next insertion.
+///
+/// <pre>
+/// QueryResultCachePtr cache = newLucene<QueryResultCache>();
+/// TopDocsPtr topDocs = cache->search(searcher, query, FilterPtr(), 10);
+/// </pre>
+class LPPAPI QueryResultCache : public LuceneObject {
+public:
+    /// Create a cache holding the hits of at most maxSize searches or segments.
+    QueryResultCache(int32_t maxSize = DEFAULT_MAX_SIZE);
+    virtual ~QueryResultCache();
+
+    LUCENE_CLASS(QueryResultCache);
+
+public:
+    /// The default maximum number of cached entries.
+    static const int32_t DEFAULT_MAX_SIZE;
+
+protected:
+    typedef HashMap< QueryResultCacheKeyPtr, QueryResultCacheEntryPtr, luceneHash<QueryResultCacheKeyPtr>, luceneEquals<QueryResultCacheKeyPtr> > MapKeyEntry;
+    typedef Map< int64_t, QueryResultCacheKeyPtr > MapLongKey;
+
+    MapKeyEntry cache;
+
+    /// Cached keys ordered by their last use, least recently used first.
+    MapLongKey lru;
+
+    int32_t maxSize;
+    int64_t useCount;
+
+    int64_t hitCount;
+    int64_t missCount;
+    int64_t evictionCount;
+
+public:
+    /// Finds the top n hits for query, from the cache if present.
+    /// @see Searcher#search(QueryPtr, FilterPtr, int32_t)
+    TopDocsPtr search(const IndexSearcherPtr& searcher, const QueryPtr& query, const FilterPtr& filter, int32_t n);
+
+    /// Finds the top n hits for query sorted by sort, from the cache if present.
+    /// @see Searcher#search(QueryPtr, FilterPtr, int32_t, SortPtr)
+    TopFieldDocsPtr search(const IndexSearcherPtr& searcher, const QueryPtr& query, const FilterPtr& filter, int32_t n, const SortPtr& sort);
+
+    /// Sets the maximum number of cached entries, evicting entries if needed.
+    void setMaxSize(int32_t maxSize);
+    int32_t getMaxSize();
+
+    /// Remove all cached entries.  The statistics are kept.
+    void clear();
+
+    /// Returns the number of entries currently in the cache.
+    int32_t getCacheSize();
+
+    /// Returns the number of searches or segments whose hits were found in the cache.
+    int64_t getHitCount();
+
+    /// Returns the number of searches or segments whose hits had to be computed.
+    int64_t getMissCount();
+
+    /// Returns the number of entries removed to keep the cache within its bound.
+    int64_t getEvictionCount();
+
+protected:
+    /// Returns true if the top hits of the search can be computed per segment and merged.
+    bool searchPerSegment(const IndexSearcherPtr& searcher, const SortPtr& sort);
+
+    /// Searches each segment, reusing the cached hits of the segments that haven't changed.
+    TopFieldDocsPtr searchSegments(const IndexSearcherPtr& searcher, const QueryPtr& query, const FilterPtr& filter, int32_t n, const SortPtr& sort);
+
+    TopDocsPtr getEntry(const QueryResultCacheKeyPtr& key);
+    void putEntry(const QueryResultCacheKeyPtr& key, const TopDocsPtr& topDocs);
+    void removeEntry(const QueryResultCacheKeyPtr& key);
+    void evictIfNecessary();
+
+    /// Remove the entries of segments that have been closed.
+    void purgeClosedSegments();
+};
+
+}
+
+#endif
@@ -0,0 +1,80 @@
+/////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2009-2014 Alan Wright. All rights reserved.
+// Distributable under the terms of either the Apache License (Version 2.0)
+// or the GNU Lesser General Public License.
+/////////////////////////////////////////////////////////////////////////////
+
+#ifndef RATELIMITEDDIRECTORY_H
+#define RATELIMITEDDIRECTORY_H
+
+#include "Directory.h"
+
+namespace Lucene {
+
+/// A Directory that passes everything through to another Directory, but limits the rate at which the
+/// files it creates are written with a {@link RateLimiter}.  Reads are not limited.
+///
+/// {@link ConcurrentMergeScheduler} uses it to throttle the writes of merges.
+class LPPAPI RateLimitedDirectory : public Directory {
+public:
+    RateLimitedDirectory(const DirectoryPtr& dir, const RateLimiterPtr& rateLimiter);
+    virtual ~RateLimitedDirectory();
+
+    LUCENE_CLASS(RateLimitedDirectory);
+
+protected:
+    DirectoryPtr dir;
+    RateLimiterPtr rateLimiter;
+
+public:
+    /// Return the wrapped directory.
+    DirectoryPtr getDirectory();
+
+    /// Return the rate limiter of the files created.
+    RateLimiterPtr getRateLimiter();
+
+    /// Closes the wrapped directory.
+    virtual void close();
+
+    /// Returns an array of strings, one for each file in the directory.
+    virtual HashSet<String> listAll();
+
+    /// Returns true if a file with the given name exists.
+    virtual bool fileExists(const String& name);
+
+    /// Returns the time the named file was last modified.
+    virtual uint64_t fileModified(const String& name);
+
+    /// Set the modified time of an existing file to now.
+    virtual void touchFile(const String& name);
+
+    /// Removes an existing file in the directory.
+    virtual void deleteFile(const String& name);
+
+    /// Returns the length of a file in the directory.
+    virtual int64_t fileLength(const String& name);
+
+    /// Creates a new, empty file in the directory with the given name.  Returns a stream writing this file
+    /// no faster than the rate limit.
+    virtual IndexOutputPtr createOutput(const String& name);
+
+    /// Ensure that any writes to this file are moved to stable storage.
+    virtual void sync(const String& name);
+
+    /// Returns a stream reading an existing file.
+    virtual IndexInputPtr openInput(const String& name);
+
+    /// Returns a stream reading an existing file, with the specified read buffer size.
+    virtual IndexInputPtr openInput(const String& name, int32_t bufferSize);
+
+    /// Construct a {@link Lock} of the wrapped directory.
+    virtual LockPtr makeLock(const String& name);
+
+    virtual String getLockID();
+
+    virtual String toString();
+};
+
+}
+
+#endif
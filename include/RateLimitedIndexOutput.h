@@ -0,0 +1,66 @@
+/////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2009-2014 Alan Wright. All rights reserved.
+// Distributable under the terms of either the Apache License (Version 2.0)
+// or the GNU Lesser General Public License.
+/////////////////////////////////////////////////////////////////////////////
+
+#ifndef RATELIMITEDINDEXOUTPUT_H
+#define RATELIMITEDINDEXOUTPUT_H
+
+#include "IndexOutput.h"
+
+namespace Lucene {
+
+/// Writes bytes through to a primary IndexOutput, pausing on a {@link RateLimiter} to keep the write rate
+/// under its limit.
+class LPPAPI RateLimitedIndexOutput : public IndexOutput {
+public:
+    RateLimitedIndexOutput(const IndexOutputPtr& main, const RateLimiterPtr& rateLimiter);
+    virtual ~RateLimitedIndexOutput();
+
+    LUCENE_CLASS(RateLimitedIndexOutput);
+
+public:
+    /// Number of bytes written between pauses.
+    static const int32_t PAUSE_BYTES;
+
+protected:
+    IndexOutputPtr main;
+    RateLimiterPtr rateLimiter;
+    int32_t pendingBytes; // bytes written since the last pause
+
+public:
+    /// Writes a single byte.
+    /// @see IndexInput#readByte()
+    virtual void writeByte(uint8_t b);
+
+    /// Writes an array of bytes.
+    /// @param b the bytes to write.
+    /// @param length the number of bytes to write.
+    /// @see IndexInput#readBytes(uint8_t*, int32_t, int32_t)
+    virtual void writeBytes(const uint8_t* b, int32_t offset, int32_t length);
+
+    /// Forces any buffered output to be written.
+    virtual void flush();
+
+    /// Closes the stream to further operations.
+    virtual void close();
+
+    /// Returns the current position in this file, where the next write will occur.
+    /// @see #seek(int64_t)
+    virtual int64_t getFilePointer();
+
+    /// Sets current position in this file, where the next write will occur.
+    /// @see #getFilePointer()
+    virtual void seek(int64_t pos);
+
+    /// The number of bytes in the file.
+    virtual int64_t length();
+
+protected:
+    void pause();
+};
+
+}
+
+#endif
@@ -0,0 +1,47 @@
+/////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2009-2014 Alan Wright. All rights reserved.
+// Distributable under the terms of either the Apache License (Version 2.0)
+// or the GNU Lesser General Public License.
+/////////////////////////////////////////////////////////////////////////////
+
+#ifndef RATELIMITER_H
+#define RATELIMITER_H
+
+#include "LuceneObject.h"
+
+namespace Lucene {
+
+/// Limits the rate at which bytes are written by pausing the writing thread.
+///
+/// The time each write should take at the configured rate is added to a running target, and {@link #pause}
+/// sleeps until the clock catches up with it.  Time spent idle between writes isn't credited, so a burst
+/// after a pause is still limited.
+/// @see RateLimitedIndexOutput
+class LPPAPI RateLimiter : public LuceneObject {
+public:
+    /// @param mbPerSec The maximum write rate in MB per second.
+    RateLimiter(double mbPerSec);
+    virtual ~RateLimiter();
+
+    LUCENE_CLASS(RateLimiter);
+
+protected:
+    double mbPerSec;
+    double nsPerByte;
+    int64_t lastNS;
+
+public:
+    /// Sets the maximum write rate in MB per second, applied from the next call to {@link #pause}.
+    void setMbPerSec(double mbPerSec);
+
+    /// Returns the maximum write rate in MB per second.
+    double getMbPerSec();
+
+    /// Pauses, if necessary, so that writing bytes (in addition to the bytes already written) stays under the
+    /// maximum rate.
+    void pause(int64_t bytes);
+};
+
+}
+
+#endif
@@ -0,0 +1,62 @@
+/////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2009-2014 Alan Wright. All rights reserved.
+// Distributable under the terms of either the Apache License (Version 2.0)
+// or the GNU Lesser General Public License.
+/////////////////////////////////////////////////////////////////////////////
+
+#ifndef ROARINGDOCIDSET_H
+#define ROARINGDOCIDSET_H
+
+#include "DocIdSet.h"
+
+namespace Lucene {
+
+/// A compressed, immutable set of document ids in the manner of Roaring bitmaps.  Ids are split into
+/// blocks of 65536 by their high 16 bits, and each non-empty block is held in whichever container is
+/// smallest for its contents: a sorted array of the low 16 bits for sparse blocks, a 8KB bitmap for dense
+/// blocks, or a list of [start, end] runs for blocks of consecutive ids.
+///
+/// A set with few matches costs 2 bytes per document rather than the maxDoc / 8 bytes of an {@link
+/// OpenBitSet}, and a set matching nearly everything costs a few bytes per run, so far more filters can be
+/// cached in the same memory.  Iteration and {@link DocIdSetIterator#advance} skip empty blocks outright.
+class LPPAPI RoaringDocIdSet : public DocIdSet {
+public:
+    /// Create a set from all documents of an iterator, which must return them in increasing order.
+    RoaringDocIdSet(const DocIdSetIteratorPtr& docIdSetIterator);
+
+    /// Create a set from the given containers and the high 16 bits of their documents.
+    RoaringDocIdSet(Collection<int32_t> keys, Collection<RoaringContainerPtr> containers);
+
+    virtual ~RoaringDocIdSet();
+
+    LUCENE_CLASS(RoaringDocIdSet);
+
+protected:
+    Collection<int32_t> keys; // high 16 bits of the documents of each container, in increasing order
+    Collection<RoaringContainerPtr> containers;
+    int32_t cardinality;
+
+public:
+    /// Returns the number of documents in the set.
+    int32_t size();
+
+    /// Returns true if the set contains the given document.
+    bool contains(int32_t doc);
+
+    /// Returns the documents in both this set and another, intersecting one container at a time.
+    RoaringDocIdSetPtr intersect(const RoaringDocIdSetPtr& other);
+
+    /// Returns the approximate number of bytes used by the set.
+    int64_t ramBytesUsed();
+
+    /// This DocIdSet implementation is cacheable.
+    virtual bool isCacheable();
+
+    virtual DocIdSetIteratorPtr iterator();
+
+    friend class RoaringDocIdSetIterator;
+};
+
+}
+
+#endif
@@ -66,6 +66,11 @@ public:
         boost::throw_exception(RuntimeException(L"Freq not implemented"));
     }
 
+    /// Called by collectors once only documents scoring above minScore can still make it into the results.
+    /// Scorers that can bound their scores may skip the other documents; the default implementation
+    /// ignores it.  minScore never decreases between calls.
+    virtual void setMinCompetitiveScore(double minScore);
+
 protected:
     /// Collects matching documents in a range.  Hook for optimization.
     /// Note, firstDocID is added to ensure that {@link #nextDoc()} was called before this method.
@@ -77,6 +82,7 @@ protected:
     virtual bool score(const CollectorPtr& collector, int32_t max, int32_t firstDocID);
 
     friend class BooleanScorer;
+    friend class ProfilingScorer;
     friend class ScoreCachingWrappingScorer;
 };
     
@@ -26,6 +26,9 @@ protected:
     /// The Similarity implementation used by this searcher.
     SimilarityPtr similarity;
 
+    /// Profiler recording the timings of searches, if any.
+    QueryProfilerPtr profiler;
+
 public:
     /// Search implementation with arbitrary sorting.  Finds the top n hits for query, applying filter if
     /// non-null, and sorting the hits by the criteria in sort.
@@ -83,6 +86,17 @@ public:
 
     virtual Collection<int32_t> docFreqs(Collection<TermPtr> terms);
 
+    /// Set the profiler that records the timings of subsequent searches, or null to stop profiling.
+    /// @see QueryProfiler
+    virtual void setProfiler(const QueryProfilerPtr& profiler);
+
+    /// Returns the profiler set with {@link #setProfiler}, or null.
+    virtual QueryProfilerPtr getProfiler();
+
+    /// Create the weight of a query or sub-query, through the profiler if one is set.  Compound queries
+    /// should create the weights of their clauses with this rather than {@link Query#createWeight}.
+    WeightPtr createNodeWeight(const QueryPtr& query);
+
     virtual void search(const WeightPtr& weight, const FilterPtr& filter, const CollectorPtr& results) = 0;
     virtual void close() = 0;
     virtual int32_t docFreq(const TermPtr& term) = 0;
@@ -0,0 +1,101 @@
+/////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2009-2014 Alan Wright. All rights reserved.
+// Distributable under the terms of either the Apache License (Version 2.0)
+// or the GNU Lesser General Public License.
+/////////////////////////////////////////////////////////////////////////////
+
+#ifndef SEARCHERMANAGER_H
+#define SEARCHERMANAGER_H
+
+#include "LuceneObject.h"
+
+namespace Lucene {
+
+/// Shares an {@link IndexSearcher} between threads and replaces it as the index changes.
+///
+/// Each search acquires the current searcher and releases it when done:
+///
+/// <pre>
+/// IndexSearcherPtr searcher = manager->acquire();
+/// LuceneException finally;
+/// try {
+///     // search...
+/// } catch (LuceneException& e) {
+///     finally = e;
+/// }
+/// manager->release(searcher);
+/// finally.throwException();
+/// </pre>
+///
+/// {@link #maybeRefresh} reopens the reader of the current searcher, either from the {@link IndexWriter}
+/// (near real-time) or from the latest commit of the directory.  Before the new searcher is made current, the
+/// {@link IndexReaderWarmer} is run on the segments the previous reader didn't have, so that the first
+/// searches on them don't pay for loading the FieldCache or cached filters.  Searches that acquired the
+/// previous searcher keep using it, and its reader is closed once they have all released it.
+///
+/// {@link #startRefreshing} refreshes in a background thread instead, bounding how stale the searcher gets.
+class LPPAPI SearcherManager : public LuceneObject {
+public:
+    /// Creates a manager of near real-time searchers of the documents added with writer.
+    /// @param writer The writer to open the readers from, see {@link IndexWriter#getReader}.
+    /// @param warmer Called with each new segment before it is searched, can be null.
+    SearcherManager(const IndexWriterPtr& writer, const IndexReaderWarmerPtr& warmer = IndexReaderWarmerPtr());
+
+    /// Creates a manager of searchers of the latest commit in directory.
+    /// @param directory The directory of the index.
+    /// @param warmer Called with each new segment before it is searched, can be null.
+    SearcherManager(const DirectoryPtr& directory, const IndexReaderWarmerPtr& warmer = IndexReaderWarmerPtr());
+
+    virtual ~SearcherManager();
+
+    LUCENE_CLASS(SearcherManager);
+
+protected:
+    IndexReaderWarmerPtr warmer;
+    IndexSearcherPtr current;
+    bool refreshing;
+    bool closed;
+
+    int32_t refreshMillis;
+    SearcherRefreshThreadPtr refreshThread;
+
+public:
+    /// Returns the current searcher, which must be released with {@link #release} when done.
+    IndexSearcherPtr acquire();
+
+    /// Releases a searcher returned by {@link #acquire}.
+    void release(const IndexSearcherPtr& searcher);
+
+    /// Reopens the reader of the current searcher and, if the index has changed, warms the new segments and
+    /// makes a searcher of the new reader current.  Returns false without waiting if another thread is
+    /// refreshing.  An exception thrown while reopening or warming is rethrown, and the current searcher is
+    /// kept.
+    /// @return true if a new searcher was made current.
+    bool maybeRefresh();
+
+    /// Starts refreshing in a background thread, refreshMillis after the end of the previous refresh.  A refresh
+    /// that fails leaves the current searcher in place and is tried again at the next interval.
+    void startRefreshing(int32_t refreshMillis);
+
+    /// Stops the background thread, if started, and releases the current searcher.  Searchers still acquired
+    /// keep their readers open until they are released.
+    void close();
+
+protected:
+    void ConstructManager(const IndexReaderPtr& reader);
+
+    /// Runs the warmer on the segments of reader that previousReader didn't have.
+    void warmNewSegments(const IndexReaderPtr& reader, const IndexReaderPtr& previousReader);
+
+    /// Returns the atomic readers of reader.
+    static Collection<IndexReaderPtr> getSegments(const IndexReaderPtr& reader);
+
+    /// Waits until the next background refresh is due; returns false once the manager is closed.
+    bool waitForRefresh();
+
+    friend class SearcherRefreshThread;
+};
+
+}
+
+#endif
@@ -87,6 +87,9 @@ protected:
 
     MapStringString diagnostics;
 
+    // The order of the documents if this segment was written sorted, null otherwise
+    SortPtr indexSort;
+
 public:
     String name; // unique name in dir
     int32_t docCount; // number of docs in seg
@@ -149,6 +152,12 @@ public:
     void setHasProx(bool hasProx);
     bool getHasProx();
 
+    /// Record that the documents of this segment are in the order of the given sort.
+    void setIndexSort(const SortPtr& indexSort);
+
+    /// Returns the sort the documents of this segment are in, or null if they are in the order they were added.
+    SortPtr getIndexSort();
+
     /// Return all files referenced by this SegmentInfo.  The returns List is a locally cached List so
     /// you should not modify it.
     HashSet<String> files();
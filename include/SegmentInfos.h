@@ -51,6 +51,9 @@ public:
     /// This format adds optional per-segment string diagnostics storage, and switches userData to Map
     static const int32_t FORMAT_DIAGNOSTICS;
 
+    /// This format adds the sort of the documents of each segment written sorted by a {@link SortingMergePolicy}.
+    static const int32_t FORMAT_INDEX_SORT;
+
     /// This must always point to the most recent file format.
     static const int32_t CURRENT_FORMAT;
 
@@ -15,6 +15,9 @@ namespace Lucene {
 /// Segment.  After adding the appropriate readers, call the merge method to combine the segments.
 ///
 /// If the compoundFile flag is set, then the segments will be merged into a compound file.
+///
+/// If the merge has a sort, the documents of the merged segment are written in the order of the sort instead
+/// of one segment after another.
 /// @see #merge
 /// @see #add
 class SegmentMerger : public LuceneObject {
@@ -29,6 +32,7 @@ protected:
     DirectoryPtr directory;
     String segment;
     int32_t termIndexInterval;
+    int32_t storedFieldsChunkSize;
 
     Collection<IndexReaderPtr> readers;
     FieldInfosPtr fieldInfos;
@@ -49,11 +53,28 @@ protected:
 
     SegmentMergeQueuePtr queue;
     bool omitTermFreqAndPositions;
+    bool hasDocValues;
 
     ByteArray payloadBuffer;
     Collection< Collection<int32_t> > docMaps;
     Collection<int32_t> delCounts;
 
+    /// The order of the merged documents, null to append the segments.
+    SortPtr sort;
+
+    /// For a sorted merge, the reader and the document in it of each merged document.
+    Collection<int32_t> sortedReaders;
+    Collection<int32_t> sortedDocs;
+
+    /// Postings of the current term, buffered to be written in the sorted order of the documents.
+    Collection<int32_t> postingDocs;
+    Collection<int32_t> postingFreqs;
+    Collection<int32_t> postingStarts;
+    Collection<int32_t> postingPositions;
+    Collection<int32_t> postingPayloadStarts;
+    Collection<int32_t> postingPayloadLengths;
+    ByteArray postingPayloads;
+
 public:
     /// norms header placeholder
     static const uint8_t NORMS_HEADER[];
@@ -96,15 +117,28 @@ protected:
                     bool omitTFAndPositions);
 
     void setMatchingSegmentReaders();
+
+    /// Orders the live documents of the readers by the sort, filling docMaps with the position of each document
+    /// in the merged segment relative to the first document of its reader.
+    void sortDocs();
+
+    /// Copies the stored fields of the documents in the sorted order.
+    int32_t copySortedFields(const FieldsWriterPtr& fieldsWriter);
     int32_t copyFieldsWithDeletions(const FieldsWriterPtr& fieldsWriter, const IndexReaderPtr& reader, const FieldsReaderPtr& matchingFieldsReader);
     int32_t copyFieldsNoDeletions(const FieldsWriterPtr& fieldsWriter, const IndexReaderPtr& reader, const FieldsReaderPtr& matchingFieldsReader);
 
+    /// Bulk-copies a contiguous series of documents, in compressed chunks when the reader has them.
+    void copyRawDocuments(const FieldsWriterPtr& fieldsWriter, const FieldsReaderPtr& matchingFieldsReader, int32_t startDocID, int32_t numDocs);
+
     /// Merge the TermVectors from each of the segments into the new one.
     void mergeVectors();
 
     void copyVectorsWithDeletions(const TermVectorsWriterPtr& termVectorsWriter, const TermVectorsReaderPtr& matchingVectorsReader, const IndexReaderPtr& reader);
     void copyVectorsNoDeletions(const TermVectorsWriterPtr& termVectorsWriter, const TermVectorsReaderPtr& matchingVectorsReader, const IndexReaderPtr& reader);
 
+    /// Copies the term vectors of the documents in the sorted order.
+    void copySortedVectors(const TermVectorsWriterPtr& termVectorsWriter);
+
     void mergeTerms();
 
     void mergeTermInfos(const FormatPostingsFieldsConsumerPtr& consumer);
@@ -116,7 +150,13 @@ protected:
     /// @return number of documents across all segments where this term was found
     int32_t appendPostings(const FormatPostingsTermsConsumerPtr& termsConsumer, Collection<SegmentMergeInfoPtr> smis, int32_t n);
 
+    /// Like {@link #appendPostings} for a sorted merge, where the documents of the segments are interleaved.
+    int32_t appendSortedPostings(const FormatPostingsTermsConsumerPtr& termsConsumer, Collection<SegmentMergeInfoPtr> smis, int32_t n);
+
     void mergeNorms();
+
+    /// Merge the doc values columns of each of the segments into the new one.
+    void mergeDocValues();
 };
 
 class CheckAbort : public LuceneObject {
@@ -113,6 +113,9 @@ public:
     /// Get a list of unique field names that exist in this index and have the specified field option information.
     virtual HashSet<String> getFieldNames(FieldOption fieldOption);
 
+    virtual PackedValuesPtr getNumericDocValues(const String& field);
+    virtual PackedStringIndexPtr getSortedDocValues(const String& field);
+
     /// Returns true if there are norms stored for this field.
     virtual bool hasNorms(const String& field);
 
@@ -122,6 +125,10 @@ public:
     /// Read norms into a pre-allocated array.
     virtual void norms(const String& field, ByteArray norms, int32_t offset);
 
+    /// Returns the highest byte-encoded normalization factor of the named field, or 0 if the field has no norms.
+    /// The value is computed once and kept with the field's norms until they are changed.
+    uint8_t maxNorm(const String& field);
+
     bool termsIndexLoaded();
 
     /// NOTE: only called from IndexWriter when a near real-time reader is opened, or applyDeletes is run, sharing a
@@ -26,9 +26,11 @@ protected:
     BitVectorPtr deletedDocs;
     int32_t _doc;
     int32_t _freq;
+    int32_t _maxFreq;
 
     int32_t skipInterval;
     int32_t maxSkipLevels;
+    bool hasBlockMaxFreq;
     DefaultSkipListReaderPtr skipListReader;
 
     int64_t freqBasePointer;
@@ -40,6 +42,8 @@ protected:
     bool currentFieldStoresPayloads;
     bool currentFieldOmitTermFreqAndPositions;
 
+    IntArray docCodes; // scratch buffer for bulk decoding
+
 public:
     /// Sets this to the data for a term.
     virtual void seek(const TermPtr& term);
@@ -66,14 +70,29 @@ public:
     /// Optimized implementation.
     virtual bool skipTo(int32_t target);
 
+    /// Returns the highest frequency of the term, as recorded in the term dictionary.
+    virtual int32_t maxFreq();
+
+    /// Uses the highest frequencies recorded in the skip entries, which cover all but the documents after the
+    /// last skip entry.
+    virtual int32_t advanceShallow(int32_t target);
+    virtual int32_t blockEnd(int32_t level);
+    virtual int32_t blockMaxFreq(int32_t level);
+
     /// Used for testing
     virtual IndexInputPtr freqStream();
     virtual void freqStream(const IndexInputPtr& freqStream);
 
 protected:
     virtual void skippingDoc();
+
+    /// Lazily creates and positions the skip list reader at the start of the skip data of the current term.
+    void initSkipListReader();
     virtual int32_t readNoTf(Collection<int32_t> docs, Collection<int32_t> freqs, int32_t length);
 
+    /// Bulk decodes count vints from the freq stream into the scratch buffer.
+    int32_t* readDocCodes(int32_t count);
+
     /// Overridden by SegmentTermPositions to skip in prox stream.
     virtual void skipProx(int64_t proxPointer, int32_t payloadLength);
 };
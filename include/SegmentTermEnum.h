@@ -59,6 +59,9 @@ public:
     /// Returns the previous Term enumerated. Initially null.
     TermPtr prev();
 
+    /// Returns the format version of the file.
+    int32_t getFormat();
+
     /// Returns the current TermInfo in the enumeration.
     /// Initially invalid, valid after next() called for the first time.
     TermInfoPtr termInfo();
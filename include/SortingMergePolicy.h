@@ -0,0 +1,63 @@
+/////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2009-2014 Alan Wright. All rights reserved.
+// Distributable under the terms of either the Apache License (Version 2.0)
+// or the GNU Lesser General Public License.
+/////////////////////////////////////////////////////////////////////////////
+
+#ifndef SORTINGMERGEPOLICY_H
+#define SORTINGMERGEPOLICY_H
+
+#include "MergePolicy.h"
+
+namespace Lucene {
+
+/// A {@link MergePolicy} that writes the segments it merges with their documents in the order of a {@link Sort}.
+/// Which segments to merge is left to another merge policy.
+///
+/// The sort of a merged segment is recorded in its {@link SegmentInfo}.  A {@link TopFieldCollector} that sorts
+/// by the same fields can then stop collecting a sorted segment as soon as a document can't compete, so that
+/// searching for the top N documents by the sort visits about N documents per segment rather than every match
+/// (see {@link IndexSearcher#setTrackTotalHits}).
+///
+/// Newly flushed segments keep the documents in the order they were added, so only merged segments are sorted;
+/// optimizing the index also sorts the segments the wrapped policy would leave alone.  Only fields of type
+/// STRING, STRING_VAL, BYTE, SHORT, INT, LONG, FLOAT and DOUBLE using the default parsers can be sorted by.
+class LPPAPI SortingMergePolicy : public MergePolicy {
+public:
+    /// @param writer The writer this policy is used by.
+    /// @param mergePolicy The policy choosing the segments to merge.
+    /// @param sort The order of the documents in the merged segments.
+    SortingMergePolicy(const IndexWriterPtr& writer, const MergePolicyPtr& mergePolicy, const SortPtr& sort);
+    virtual ~SortingMergePolicy();
+
+    LUCENE_CLASS(SortingMergePolicy);
+
+protected:
+    MergePolicyPtr mergePolicy;
+    SortPtr sort;
+
+public:
+    virtual MergeSpecificationPtr findMerges(const SegmentInfosPtr& segmentInfos);
+    virtual MergeSpecificationPtr findMergesForOptimize(const SegmentInfosPtr& segmentInfos, int32_t maxSegmentCount, SetSegmentInfo segmentsToOptimize);
+    virtual MergeSpecificationPtr findMergesToExpungeDeletes(const SegmentInfosPtr& segmentInfos);
+    virtual void close();
+    virtual bool useCompoundFile(const SegmentInfosPtr& segments, const SegmentInfoPtr& newSegment);
+    virtual bool useCompoundDocStore(const SegmentInfosPtr& segments);
+
+    /// Returns the policy choosing the segments to merge.
+    MergePolicyPtr getMergePolicy();
+
+    /// Returns the order of the documents in the merged segments.
+    SortPtr getSort();
+
+    /// Returns true if the documents of the segment are in the order of the sort.
+    bool isSorted(const SegmentInfoPtr& info);
+
+protected:
+    /// Records the sort on the merges chosen by the wrapped policy.
+    MergeSpecificationPtr sortMerges(const MergeSpecificationPtr& spec);
+};
+
+}
+
+#endif
@@ -50,6 +50,23 @@ public:
     /// Returns true if there is such an entry.
     virtual bool skipTo(int32_t target) = 0;
 
+    /// Returns the highest frequency of the term in any document, or 0 if it is not known.  This bounds the
+    /// frequencies returned by {@link #freq()}.
+    virtual int32_t maxFreq();
+
+    /// Moves the skip data, but not the enumeration, to the blocks of documents containing target and returns
+    /// the number of levels of blocks whose highest frequency is known, or 0 if there are none.  The blocks get
+    /// larger with their level, each containing the block below it.  Targets must not decrease between calls.
+    virtual int32_t advanceShallow(int32_t target);
+
+    /// Returns the last document of the block on the given level containing the target of the last call of
+    /// {@link #advanceShallow(int32_t)}.
+    virtual int32_t blockEnd(int32_t level);
+
+    /// Returns the highest frequency of the term in the block on the given level containing the target of the
+    /// last call of {@link #advanceShallow(int32_t)}.
+    virtual int32_t blockMaxFreq(int32_t level);
+
     /// Frees associated resources.
     virtual void close() = 0;
 };
@@ -27,8 +27,12 @@ public:
     int64_t proxPointer;
     int32_t skipOffset;
 
+    /// The highest frequency of the term in a document, or 0 if unknown (segments written before it was
+    /// recorded).
+    int32_t maxFreq;
+
 public:
-    void set(int32_t docFreq, int64_t freqPointer, int64_t proxPointer, int32_t skipOffset);
+    void set(int32_t docFreq, int64_t freqPointer, int64_t proxPointer, int32_t skipOffset, int32_t maxFreq);
     void set(const TermInfoPtr& ti);
 };
 
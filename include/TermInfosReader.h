@@ -29,9 +29,7 @@ protected:
     SegmentTermEnumPtr origEnum;
     int64_t _size;
 
-    Collection<TermPtr> indexTerms;
-    Collection<TermInfoPtr> indexInfos;
-    Collection<int64_t> indexPointers;
+    TermInfosReaderIndexPtr index;
 
     int32_t totalIndexInterval;
 
@@ -40,6 +38,9 @@ protected:
 public:
     int32_t getSkipInterval();
     int32_t getMaxSkipLevels();
+
+    /// Returns the format version of the term dictionary, see {@link TermInfosWriter#FORMAT_CURRENT}.
+    int32_t getFormat();
     void close();
 
     /// Returns the number of term/value pairs in the set.
@@ -60,11 +61,6 @@ public:
 protected:
     TermInfosReaderThreadResourcesPtr getThreadResources();
 
-    /// Returns the offset of the greatest index entry which is less than or equal to term.
-    int32_t getIndexOffset(const TermPtr& term);
-
-    void seekEnum(const SegmentTermEnumPtr& enumerator, int32_t indexOffset);
-
     /// Returns the TermInfo for a Term in the set, or null.
     TermInfoPtr get(const TermPtr& term, bool useCache);
 
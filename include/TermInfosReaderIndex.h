@@ -0,0 +1,77 @@
+/////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2009-2014 Alan Wright. All rights reserved.
+// Distributable under the terms of either the Apache License (Version 2.0)
+// or the GNU Lesser General Public License.
+/////////////////////////////////////////////////////////////////////////////
+
+#ifndef TERMINFOSREADERINDEX_H
+#define TERMINFOSREADERINDEX_H
+
+#include "LuceneObject.h"
+
+namespace Lucene {
+
+/// This stores the terms index of a {@link TermInfosReader} in a compact form.  Every index entry (field number,
+/// UTF-8 term bytes, {@link TermInfo} and pointer into the term dictionary) is appended to one contiguous byte
+/// block and located through a monotonic packed offsets array, so the index needs no per-term objects and a
+/// binary search compares raw term bytes.
+class TermInfosReaderIndex : public LuceneObject {
+public:
+    /// Loads the terms index.
+    /// @param indexEnum the terms index enumerator positioned before the first entry.
+    /// @param indexDivisor only every indexDivisor-th entry is loaded.
+    /// @param totalIndexInterval the number of terms between two loaded entries.
+    /// @param fieldInfos the field infos of the segment.
+    TermInfosReaderIndex(const SegmentTermEnumPtr& indexEnum, int32_t indexDivisor, int32_t totalIndexInterval, const FieldInfosPtr& fieldInfos);
+
+    virtual ~TermInfosReaderIndex();
+
+    LUCENE_CLASS(TermInfosReaderIndex);
+
+protected:
+    int32_t totalIndexInterval;
+    int32_t skipInterval;
+    int32_t indexSize;
+
+    Collection<String> fieldNames;
+
+    ByteArray data;
+    int32_t dataLength;
+
+    // entry offsets are stored as packed deviations from a linear estimate
+    PackedIntsPtr offsets;
+    double offsetsAverage;
+    int64_t offsetsMinimum;
+
+public:
+    /// Returns the number of entries in the index.
+    int32_t length();
+
+    /// Returns the approximate number of bytes used by the index.
+    int64_t ramBytesUsed();
+
+    /// Seeks the enumerator to the given index entry.
+    void seekEnum(const SegmentTermEnumPtr& enumerator, int32_t indexOffset);
+
+    /// Returns the offset of the greatest index entry which is less than or equal to term.
+    int32_t getIndexOffset(const TermPtr& term);
+
+    /// Compares the term with the term at the given index entry.
+    /// @return less than zero if term is less than the entry, zero if equal, greater than zero if greater.
+    int32_t compareTo(const TermPtr& term, int32_t indexOffset);
+
+    /// Returns the term at the given index entry, null for the empty term that starts the index.
+    TermPtr getTerm(int32_t indexOffset);
+
+protected:
+    int32_t getOffset(int32_t indexOffset);
+    int32_t compareTo(const String& field, const SingleString& termBytes, int32_t indexOffset);
+    void ensureCapacity(int32_t length);
+    void writeVInt(int32_t i);
+    void writeVLong(int64_t i);
+    void writeBytes(const uint8_t* b, int32_t length);
+};
+
+}
+
+#endif
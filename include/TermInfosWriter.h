@@ -28,6 +28,12 @@ public:
     /// Changed strings to true utf8 with length-in-bytes not length-in-chars.
     static const int32_t FORMAT_VERSION_UTF8_LENGTH_IN_BYTES;
 
+    /// Added the highest frequency of each term in a document, used to bound its scores.
+    static const int32_t FORMAT_MAX_FREQ;
+
+    /// Added the highest frequency of the term in the block of documents before each skip entry.
+    static const int32_t FORMAT_BLOCK_MAX_FREQ;
+
     /// NOTE: always change this if you switch to a new format.
     static const int32_t FORMAT_CURRENT;
 
@@ -19,7 +19,8 @@ public:
     /// @param td An iterator over the documents matching the Term.
     /// @param similarity The Similarity implementation to be used for score computations.
     /// @param norms The field norms of the document fields for the Term.
-    TermScorer(const WeightPtr& weight, const TermDocsPtr& td, const SimilarityPtr& similarity, ByteArray norms);
+    /// @param maxNorm The decoded highest of the field norms, or negative to find it in norms when first needed.
+    TermScorer(const WeightPtr& weight, const TermDocsPtr& td, const SimilarityPtr& similarity, ByteArray norms, double maxNorm = -1.0);
 
     virtual ~TermScorer();
 
@@ -40,9 +41,12 @@ protected:
     int32_t pointerMax;
 
     static const int32_t SCORE_CACHE_SIZE;
+    static const int32_t DOCS_BUFFER_SIZE;
     Collection<double> scoreCache;
-    
-    
+
+    double maxNorm; // decoded highest norm of the field, negative until known
+    double minCompetitiveScore;
+
 
 public:
     virtual void score(const CollectorPtr& collector);
@@ -64,15 +68,44 @@ public:
 
     /// Returns a string representation of this TermScorer.
     virtual String toString();
+
+    /// Reads the documents before max, starting with the current one, and their scores into the buffers, and
+    /// moves past them.  This lets {@link BooleanScorer} score a window in bulk rather than with calls for each
+    /// document.  It does not skip non-competitive blocks.
+    /// @return the number of documents read, 0 once the current document is at or after max.
+    int32_t nextScores(int32_t max, Collection<int32_t> docBuffer, Collection<double> scoreBuffer);
     
     virtual float termFreq(){
         return freq;
     }
 
+    /// Returns an upper bound of the scores of this scorer, computed from the highest frequency of the term
+    /// and the highest norm of the field, or infinity if it is not known.  This assumes that {@link
+    /// Similarity#tf} does not decrease as the frequency grows.
+    double maxScore();
+
+    /// Returns an upper bound of the score of the target document, computed from the highest frequency of
+    /// the term in the smallest block of documents containing it and the highest norm of the field, which
+    /// segments keep with their norms.  Targets must not decrease between calls.
+    double maxScore(int32_t target);
+
+    /// Documents in blocks whose highest frequency can't produce a score above the minimum competitive score
+    /// are skipped without being decoded.
+    virtual void setMinCompetitiveScore(double minScore);
+
 protected:
     static const Collection<double> SIM_NORM_DECODER();
 
     virtual bool score(const CollectorPtr& collector, int32_t max, int32_t firstDocID);
+
+    /// Returns an upper bound of the scores of documents where the term occurs at most maxFreq times.
+    double maxScoreForFreq(int32_t maxFreq);
+
+    /// Returns the first document at or after target that isn't in a block of non-competitive documents.
+    int32_t competitiveTarget(int32_t target);
+
+    /// Advances to the first document at or after target, without pruning.
+    void advanceDoc(int32_t target);
 };
 
 }
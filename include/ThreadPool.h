@@ -7,74 +7,152 @@
 #ifndef THREADPOOL_H
 #define THREADPOOL_H
 
-#include <boost/asio.hpp>
+#include <deque>
 #include <boost/any.hpp>
+#include <boost/bind.hpp>
+#include <boost/bind/protect.hpp>
+#include <boost/function.hpp>
 #include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
 #include "LuceneObject.h"
+#include "StringUtils.h"
 
 namespace Lucene {
 
-typedef boost::shared_ptr<boost::asio::io_service::work> workPtr;
-
 /// A Future represents the result of an asynchronous computation. Methods are provided to check if the computation
 /// is complete, to wait for its completion, and to retrieve the result of the computation. The result can only be
 /// retrieved using method get when the computation has completed, blocking if necessary until it is ready.
-class Future : public LuceneObject {
+class LPPAPI Future : public LuceneObject {
 public:
+    Future(const ThreadPoolPtr& pool = ThreadPoolPtr());
     virtual ~Future();
 
 protected:
+    ThreadPoolWeakPtr _pool;
     boost::any value;
+    LuceneException error;
+    bool done;
+    boost::mutex futureMutex;
+    boost::condition_variable futureCondition;
 
 public:
-    void set(const boost::any& value) {
-        SyncLock syncLock(this);
-        this->value = value;
-    }
+    /// Set the result of the computation and wake up any waiting threads.
+    void set(const boost::any& value);
+
+    /// Set the exception thrown by the computation and wake up any waiting threads.
+    void setException(const LuceneException& error);
 
+    /// Returns true if the computation has completed.
+    bool isDone();
+
+    /// Waits if necessary for the computation to complete, and then retrieves its result.  If the computation
+    /// threw an exception, it is re-thrown here.
     template <typename TYPE>
     TYPE get() {
-        SyncLock syncLock(this);
-        while (value.empty()) {
-            wait(10);
-        }
+        waitForCompletion();
+        error.throwException();
         return value.empty() ? TYPE() : boost::any_cast<TYPE>(value);
     }
+
+protected:
+    /// Wait for the computation to complete.  When called from a pool thread, pending tasks are executed while
+    /// waiting, so that tasks waiting on other tasks cannot exhaust the pool.
+    void waitForCompletion();
 };
 
 /// Utility class to handle a pool of threads.
-class ThreadPool : public LuceneObject {
+///
+/// Each worker thread owns a double-ended task queue.  Tasks scheduled from a worker thread are pushed on that
+/// worker's own queue and popped in LIFO order, while tasks scheduled from other threads are distributed round
+/// robin across the workers.  Idle workers steal the oldest tasks from the other queues.
+class LPPAPI ThreadPool : public LuceneObject {
 public:
-    ThreadPool();
+    /// Create a thread pool with the given number of threads.
+    /// @param numThreads the number of worker threads, or 0 to use the number of available processors.
+    ThreadPool(int32_t numThreads = 0);
     virtual ~ThreadPool();
 
     LUCENE_CLASS(ThreadPool);
 
+public:
+    typedef boost::function<void()> Task;
+
 protected:
-    boost::asio::io_service io_service;
-    workPtr work;
-    boost::thread_group threadGroup;
+    class WorkQueue {
+    public:
+        boost::mutex queueMutex;
+        std::deque<Task> tasks;
+    };
+
+    typedef boost::shared_ptr<WorkQueue> WorkQueuePtr;
+    typedef boost::shared_ptr<boost::thread> ThreadPtr;
+
+    std::vector<WorkQueuePtr> queues;
+    std::vector<ThreadPtr> threads;
 
-    static const int32_t THREADPOOL_SIZE;
+    boost::mutex poolMutex;
+    boost::condition_variable poolCondition;
+    int32_t pendingTasks;
+    int32_t idleThreads;
+    int32_t nextQueue;
+    bool shutdown;
 
 public:
-    /// Get singleton thread pool instance.
+    /// Returns the number of available processors, or 1 if this cannot be determined.
+    static int32_t availableProcessors();
+
+    /// Get singleton thread pool instance.  The pool is sized to the number of available processors.
     static ThreadPoolPtr getInstance();
 
+    /// Returns the number of worker threads.
+    int32_t getNumThreads();
+
+    /// Schedule a function returning a value and return a {@link Future} for its result.
     template <typename FUNC>
     FuturePtr scheduleTask(FUNC func) {
-        FuturePtr future(newInstance<Future>());
-        io_service.post(boost::bind(&ThreadPool::execute<FUNC>, this, func, future));
+        FuturePtr future(newInstance<Future>(shared_from_this()));
+        execute(boost::bind(&ThreadPool::executeTask<FUNC>, func, future));
         return future;
     }
 
+    /// Schedule a task that does not produce a result.  Any exception thrown by the task is discarded.
+    void execute(const Task& task);
+
+    /// Run one pending task on the calling thread, if there is one.
+    /// @return true if a task was run.
+    bool runPendingTask();
+
+    /// Returns true if the calling thread is one of this pool's workers.
+    bool isWorkerThread();
+
+    /// Stop accepting new tasks, finish all queued tasks and wait for the worker threads to exit.  When called
+    /// from one of the pool's own workers (for example when a task drops the last reference to the pool), that
+    /// worker is detached rather than joined and exits once its current task returns.
+    void close();
+
 protected:
-    // this will be executed when one of the threads is available
     template <typename FUNC>
-    void execute(FUNC func, const FuturePtr& future) {
-        future->set(func());
-        future->notifyAll();
+    static void executeTask(FUNC func, const FuturePtr& future) {
+        try {
+            future->set(func());
+        } catch (LuceneException& e) {
+            future->setException(e);
+        } catch (std::exception& e) {
+            future->setException(RuntimeException(StringUtils::toUnicode(e.what())));
+        } catch (...) {
+            future->setException(RuntimeException(L"Unknown exception thrown by task"));
+        }
     }
+
+    /// Remove a task from the given worker's own queue or, failing that, steal one from another queue.
+    bool popTask(int32_t index, Task& task);
+
+    /// Main loop of a worker thread.
+    void workerRun(int32_t index);
+
+    /// Returns the index of the calling worker thread, or -1 if it is not one of this pool's workers.
+    int32_t workerIndex();
 };
 
 }
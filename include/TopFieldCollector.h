@@ -33,6 +33,12 @@ protected:
     bool queueFull;
     int32_t docBase;
 
+    /// Whether collection of a segment sorted by the sort stops at its first non competitive document.
+    bool earlyTerminate;
+
+    /// Whether the current segment is sorted by the sort and can be terminated early.
+    bool segmentSorted;
+
 public:
     /// Creates a new {@link TopFieldCollector} from the given arguments.
     ///
@@ -54,6 +60,14 @@ public:
     /// @return a {@link TopFieldCollector} instance which will sort the results by the sort criteria.
     static TopFieldCollectorPtr create(const SortPtr& sort, int32_t numHits, bool fillFields, bool trackDocScores, bool trackMaxScore, bool docsScoredInOrder);
 
+    /// Creates a new {@link TopFieldCollector} like {@link #create(SortPtr, int32_t, bool, bool, bool, bool)}.
+    ///
+    /// If trackTotalHits is false and trackMaxScore is false, documents are collected in order and the
+    /// collection of a segment whose documents are sorted by the sort (see {@link SortingMergePolicy}) stops
+    /// at the first document that isn't competitive, since no later document of the segment can be.  The top
+    /// hits are unchanged but {@link TopDocs#totalHits} only counts the documents that were collected.
+    static TopFieldCollectorPtr create(const SortPtr& sort, int32_t numHits, bool fillFields, bool trackDocScores, bool trackMaxScore, bool docsScoredInOrder, bool trackTotalHits);
+
     virtual void add(int32_t slot, int32_t doc, double score);
 
     virtual bool acceptsDocsOutOfOrder();
@@ -61,6 +75,13 @@ public:
 protected:
     static const Collection<ScoreDocPtr> EMPTY_SCOREDOCS();
 
+    /// Returns true if the documents of the segment are sorted by the sort, or by sort fields it starts with.
+    bool isSortedSegment(const IndexReaderPtr& reader);
+
+    /// Called by the collectors visiting documents in order when a document isn't competitive.  If the
+    /// segment is sorted by the sort, this throws a {@link CollectionTerminatedException} to stop collecting it.
+    void notCompetitive();
+
     /// Only the following callback methods need to be overridden since topDocs(int32_t, int32_t) calls them to
     /// return the results.
     virtual void populateResults(Collection<ScoreDocPtr> results, int32_t howMany);
@@ -34,8 +34,13 @@ public:
     /// Creates a new {@link TopScoreDocCollector} given the number of hits to collect and whether documents
     /// are scored in order by the input {@link Scorer} to {@link #setScorer(ScorerPtr)}.
     ///
+    /// If trackTotalHits is false, the collector tells the scorer the minimum score a document needs to enter
+    /// the top hits, which lets scorers such as {@link MaxScoreScorer} skip the documents that can't.  The
+    /// top hits are unchanged but {@link TopDocs#totalHits} only counts the documents that were collected,
+    /// and documents are always collected in order.
+    ///
     /// NOTE: The instances returned by this method pre-allocate a full array of length numHits.
-    static TopScoreDocCollectorPtr create(int32_t numHits, bool docsScoredInOrder);
+    static TopScoreDocCollectorPtr create(int32_t numHits, bool docsScoredInOrder, bool trackTotalHits = true);
 
     virtual void setNextReader(const IndexReaderPtr& reader, int32_t docBase);
     virtual void setScorer(const ScorerPtr& scorer);
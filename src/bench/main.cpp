@@ -0,0 +1,377 @@
+/////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2009-2014 Alan Wright. All rights reserved.
+// Distributable under the terms of either the Apache License (Version 2.0)
+// or the GNU Lesser General Public License.
+/////////////////////////////////////////////////////////////////////////////
+
+#define NOMINMAX
+
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <vector>
+#include <boost/date_time/posix_time/posix_time.hpp>
+#include "LuceneHeaders.h"
+#include "LuceneThread.h"
+#include "NumericField.h"
+#include "NumericRangeQuery.h"
+#include "FuzzyQuery.h"
+#include "SortField.h"
+#include "TopFieldDocs.h"
+#include "Random.h"
+#include "MiscUtils.h"
+
+using namespace Lucene;
+
+/// Synthetic corpus and query generator.  Everything is derived from a fixed seed so runs are comparable.
+class Corpus {
+public:
+    Corpus(int32_t vocabularySize, int32_t wordsPerDoc) : vocabularySize(vocabularySize), wordsPerDoc(wordsPerDoc) {
+    }
+
+    int32_t vocabularySize;
+    int32_t wordsPerDoc;
+
+    /// Word for a given rank: base 26 spelling, at least three letters.
+    String word(int32_t rank) const {
+        String w;
+        int32_t value = rank + 26 * 26;
+        while (value > 0) {
+            w += (wchar_t)(L'a' + value % 26);
+            value /= 26;
+        }
+        return w;
+    }
+
+    /// Pick a word rank with a roughly Zipfian distribution, so a few terms have very high doc freq.
+    int32_t randomRank(const RandomPtr& random) const {
+        double u = random->nextDouble();
+        int32_t rank = (int32_t)std::pow((double)vocabularySize, u) - 1;
+        return std::max(0, std::min(vocabularySize - 1, rank));
+    }
+
+    DocumentPtr document(int32_t id) const {
+        RandomPtr random(newLucene<Random>(id));
+        StringStream body;
+        for (int32_t i = 0; i < wordsPerDoc; ++i) {
+            if (i > 0) {
+                body << L" ";
+            }
+            body << word(randomRank(random));
+        }
+        DocumentPtr doc(newLucene<Document>());
+        doc->add(newLucene<Field>(L"id", StringUtils::toString(id), Field::STORE_YES, Field::INDEX_NOT_ANALYZED_NO_NORMS));
+        doc->add(newLucene<Field>(L"body", body.str(), Field::STORE_NO, Field::INDEX_ANALYZED));
+        doc->add(newLucene<Field>(L"sort", word(random->nextInt(vocabularySize)), Field::STORE_NO, Field::INDEX_NOT_ANALYZED_NO_NORMS));
+        doc->add(newLucene<NumericField>(L"num")->setIntValue(random->nextInt(1000000)));
+        return doc;
+    }
+};
+
+/// Adds a slice of the corpus to a shared writer.
+class IndexingThread : public LuceneThread {
+public:
+    IndexingThread(const IndexWriterPtr& writer, const Corpus& corpus, int32_t start, int32_t end) : writer(writer), corpus(corpus), start(start), end(end) {
+    }
+
+    virtual ~IndexingThread() {
+    }
+
+    LUCENE_CLASS(IndexingThread);
+
+protected:
+    IndexWriterPtr writer;
+    const Corpus& corpus;
+    int32_t start;
+    int32_t end;
+
+public:
+    virtual void run() {
+        for (int32_t id = start; id < end; ++id) {
+            writer->addDocument(corpus.document(id));
+        }
+    }
+};
+
+/// Minimal JSON object writer.
+class JsonWriter {
+public:
+    JsonWriter() : first(true) {
+        out << "{";
+    }
+
+protected:
+    SingleStringStream out;
+    bool first;
+
+    void key(const std::string& name) {
+        out << (first ? "" : ",") << "\n  \"" << name << "\": ";
+        first = false;
+    }
+
+public:
+    void add(const std::string& name, int32_t value) {
+        key(name);
+        out << value;
+    }
+
+    void add(const std::string& name, double value) {
+        key(name);
+        out << std::fixed << std::setprecision(3) << value;
+    }
+
+    void add(const std::string& name, const std::string& value) {
+        key(name);
+        out << "\"" << value << "\"";
+    }
+
+    void addRaw(const std::string& name, const std::string& json) {
+        key(name);
+        out << json;
+    }
+
+    std::string str() {
+        return out.str() + "\n}";
+    }
+};
+
+static double elapsedMillis(const boost::posix_time::ptime& start) {
+    return (double)(boost::posix_time::microsec_clock::universal_time() - start).total_microseconds() / 1000.0;
+}
+
+static double percentile(std::vector<double> sorted, double p) {
+    if (sorted.empty()) {
+        return 0.0;
+    }
+    int32_t index = (int32_t)std::ceil(p * (double)sorted.size()) - 1;
+    return sorted[std::max(0, std::min((int32_t)sorted.size() - 1, index))];
+}
+
+static IndexWriterPtr newWriter(const DirectoryPtr& dir, double ramBufferMB) {
+    IndexWriterPtr writer(newLucene<IndexWriter>(dir, newLucene<WhitespaceAnalyzer>(), true, IndexWriter::MaxFieldLengthUNLIMITED));
+    writer->setRAMBufferSizeMB(ramBufferMB);
+    return writer;
+}
+
+static std::string benchIndexing(const Corpus& corpus, int32_t numDocs, double ramBufferMB, int32_t numThreads) {
+    DirectoryPtr dir(newLucene<RAMDirectory>());
+    IndexWriterPtr writer(newWriter(dir, ramBufferMB));
+    boost::posix_time::ptime start(boost::posix_time::microsec_clock::universal_time());
+    Collection<LuceneThreadPtr> threads(Collection<LuceneThreadPtr>::newInstance(numThreads));
+    for (int32_t i = 0; i < numThreads; ++i) {
+        threads[i] = newLucene<IndexingThread>(writer, corpus, (int32_t)((int64_t)numDocs * i / numThreads), (int32_t)((int64_t)numDocs * (i + 1) / numThreads));
+        threads[i]->start();
+    }
+    for (int32_t i = 0; i < numThreads; ++i) {
+        threads[i]->join();
+    }
+    writer->commit();
+    double millis = elapsedMillis(start);
+    writer->close();
+    dir->close();
+
+    JsonWriter json;
+    json.add("ram_buffer_mb", ramBufferMB);
+    json.add("threads", numThreads);
+    json.add("docs", numDocs);
+    json.add("millis", millis);
+    json.add("docs_per_sec", millis > 0 ? numDocs * 1000.0 / millis : 0.0);
+    return json.str();
+}
+
+/// A named family of queries built from the corpus vocabulary.
+class QueryFactory {
+public:
+    QueryFactory(const Corpus& corpus) : corpus(corpus) {
+    }
+
+protected:
+    const Corpus& corpus;
+
+    TermPtr term(const RandomPtr& random) const {
+        return newLucene<Term>(L"body", corpus.word(corpus.randomRank(random)));
+    }
+
+public:
+    QueryPtr create(const std::string& type, const RandomPtr& random) const {
+        if (type == "term" || type == "sorted") {
+            return newLucene<TermQuery>(term(random));
+        } else if (type == "boolean") {
+            BooleanQueryPtr query(newLucene<BooleanQuery>());
+            query->add(newLucene<TermQuery>(term(random)), BooleanClause::MUST);
+            query->add(newLucene<TermQuery>(term(random)), BooleanClause::SHOULD);
+            query->add(newLucene<TermQuery>(term(random)), BooleanClause::SHOULD);
+            return query;
+        } else if (type == "phrase") {
+            // pick two frequent words so phrases have a chance to match
+            PhraseQueryPtr query(newLucene<PhraseQuery>());
+            query->add(newLucene<Term>(L"body", corpus.word(random->nextInt(10))));
+            query->add(newLucene<Term>(L"body", corpus.word(random->nextInt(10))));
+            return query;
+        } else if (type == "wildcard") {
+            String text(corpus.word(corpus.randomRank(random)));
+            return newLucene<WildcardQuery>(newLucene<Term>(L"body", text.substr(0, 2) + L"*"));
+        } else if (type == "fuzzy") {
+            String text(corpus.word(corpus.randomRank(random)));
+            text[random->nextInt((int32_t)text.length())] = (wchar_t)(L'a' + random->nextInt(26));
+            return newLucene<FuzzyQuery>(newLucene<Term>(L"body", text));
+        } else if (type == "numeric_range") {
+            int32_t min = random->nextInt(1000000);
+            return NumericRangeQuery::newIntRange(L"num", min, min + 10000, true, true);
+        }
+        boost::throw_exception(IllegalArgumentException(L"unknown query type"));
+        return QueryPtr();
+    }
+};
+
+static std::string benchQueries(const IndexSearcherPtr& searcher, const QueryFactory& factory, const std::string& type, int32_t numQueries) {
+    RandomPtr random(newLucene<Random>(42));
+    SortPtr sort(newLucene<Sort>(newLucene<SortField>(L"sort", SortField::STRING)));
+    std::vector<double> latencies;
+    int64_t totalHits = 0;
+
+    // warm up caches (field cache for sorting, norms) before measuring
+    searcher->search(factory.create(type, newLucene<Random>(1)), FilterPtr(), 10, sort);
+
+    boost::posix_time::ptime start(boost::posix_time::microsec_clock::universal_time());
+    for (int32_t i = 0; i < numQueries; ++i) {
+        QueryPtr query(factory.create(type, random));
+        boost::posix_time::ptime queryStart(boost::posix_time::microsec_clock::universal_time());
+        TopDocsPtr topDocs;
+        if (type == "sorted") {
+            topDocs = searcher->search(query, FilterPtr(), 10, sort);
+        } else {
+            topDocs = searcher->search(query, 10);
+        }
+        latencies.push_back(elapsedMillis(queryStart));
+        totalHits += topDocs->totalHits;
+    }
+    double millis = elapsedMillis(start);
+    std::sort(latencies.begin(), latencies.end());
+
+    JsonWriter json;
+    json.add("type", type);
+    json.add("queries", numQueries);
+    json.add("qps", millis > 0 ? numQueries * 1000.0 / millis : 0.0);
+    json.add("p50_ms", percentile(latencies, 0.50));
+    json.add("p99_ms", percentile(latencies, 0.99));
+    json.add("avg_hits", numQueries > 0 ? (double)totalHits / numQueries : 0.0);
+    return json.str();
+}
+
+static std::string benchReaders(const Corpus& corpus, int32_t numDocs) {
+    DirectoryPtr dir(newLucene<RAMDirectory>());
+    IndexWriterPtr writer(newWriter(dir, 16.0));
+    for (int32_t id = 0; id < numDocs; ++id) {
+        writer->addDocument(corpus.document(id));
+    }
+    writer->commit();
+
+    boost::posix_time::ptime start(boost::posix_time::microsec_clock::universal_time());
+    IndexReaderPtr reader(IndexReader::open(dir, true));
+    double openMillis = elapsedMillis(start);
+
+    for (int32_t id = numDocs; id < numDocs + 100; ++id) {
+        writer->addDocument(corpus.document(id));
+    }
+    writer->commit();
+
+    start = boost::posix_time::microsec_clock::universal_time();
+    IndexReaderPtr newReader(reader->reopen());
+    double reopenMillis = elapsedMillis(start);
+
+    newReader->close();
+    if (newReader != reader) {
+        reader->close();
+    }
+    writer->close();
+    dir->close();
+
+    JsonWriter json;
+    json.add("docs", numDocs);
+    json.add("open_ms", openMillis);
+    json.add("reopen_ms", reopenMillis);
+    return json.str();
+}
+
+static std::string jsonArray(const std::vector<std::string>& items) {
+    std::string array("[");
+    for (size_t i = 0; i < items.size(); ++i) {
+        array += (i > 0 ? ", " : "") + items[i];
+    }
+    return array + "]";
+}
+
+/// Deterministic indexing and search throughput benchmark, results written as JSON.
+int main(int argc, char* argv[]) {
+    int32_t numDocs = 20000;
+    int32_t numQueries = 200;
+    std::string output;
+
+    for (int32_t i = 1; i < argc; ++i) {
+        std::string arg(argv[i]);
+        if (arg == "--docs" && i + 1 < argc) {
+            numDocs = atoi(argv[++i]);
+        } else if (arg == "--queries" && i + 1 < argc) {
+            numQueries = atoi(argv[++i]);
+        } else if (arg == "--output" && i + 1 < argc) {
+            output = argv[++i];
+        } else {
+            std::wcout << L"Usage: lucene++-bench [--docs <count>] [--queries <count>] [--output <file>]\n";
+            return 1;
+        }
+    }
+    if (numDocs <= 0 || numQueries <= 0) {
+        std::wcout << L"Document and query counts must be greater than 0\n";
+        return 1;
+    }
+
+    try {
+        Corpus corpus(50000, 100);
+        JsonWriter results;
+        results.add("version", StringUtils::toUTF8(Constants::LUCENE_VERSION));
+        results.add("docs", numDocs);
+
+        std::vector<std::string> indexing;
+        const double ramBuffers[] = {16.0, 64.0};
+        const int32_t threadCounts[] = {1, 2, 4};
+        for (int32_t r = 0; r < 2; ++r) {
+            for (int32_t t = 0; t < 3; ++t) {
+                indexing.push_back(benchIndexing(corpus, numDocs, ramBuffers[r], threadCounts[t]));
+            }
+        }
+        results.addRaw("indexing", jsonArray(indexing));
+
+        DirectoryPtr dir(newLucene<RAMDirectory>());
+        IndexWriterPtr writer(newWriter(dir, 64.0));
+        for (int32_t id = 0; id < numDocs; ++id) {
+            writer->addDocument(corpus.document(id));
+        }
+        writer->close();
+
+        IndexSearcherPtr searcher(newLucene<IndexSearcher>(dir, true));
+        QueryFactory factory(corpus);
+        std::vector<std::string> search;
+        const char* queryTypes[] = {"term", "boolean", "phrase", "wildcard", "fuzzy", "numeric_range", "sorted"};
+        for (int32_t q = 0; q < 7; ++q) {
+            search.push_back(benchQueries(searcher, factory, queryTypes[q], numQueries));
+        }
+        results.addRaw("search", jsonArray(search));
+        searcher->close();
+        dir->close();
+
+        results.addRaw("readers", benchReaders(corpus, numDocs));
+
+        if (output.empty()) {
+            std::cout << results.str() << "\n";
+        } else {
+            std::ofstream file(output.c_str());
+            file << results.str() << "\n";
+        }
+    } catch (LuceneException& e) {
+        std::wcout << L"Exception: " << e.getError() << L"\n";
+        return 1;
+    }
+
+    return 0;
+}
@@ -422,6 +422,9 @@ HashSet<String> MemoryIndexReader::getFieldNames(FieldOption fieldOption) {
     if (fieldOption == FIELD_OPTION_UNINDEXED) {
         return emptySet;
     }
+    if (fieldOption == FIELD_OPTION_NUMERIC_DOC_VALUES || fieldOption == FIELD_OPTION_SORTED_DOC_VALUES) {
+        return emptySet;
+    }
     if (fieldOption == FIELD_OPTION_INDEXED_NO_TERMVECTOR) {
         return emptySet;
     }
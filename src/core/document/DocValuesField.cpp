@@ -0,0 +1,68 @@
+/////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2009-2014 Alan Wright. All rights reserved.
+// Distributable under the terms of either the Apache License (Version 2.0)
+// or the GNU Lesser General Public License.
+/////////////////////////////////////////////////////////////////////////////
+
+#include "LuceneInc.h"
+#include "DocValuesField.h"
+#include "StringUtils.h"
+#include "VariantUtils.h"
+
+namespace Lucene {
+
+DocValuesField::DocValuesField(const String& name, int64_t value)
+    : AbstractField(name, Field::STORE_NO, Field::INDEX_NO, Field::TERM_VECTOR_NO) {
+    type = DOC_VALUES_NUMERIC;
+    fieldsData = value;
+}
+
+DocValuesField::DocValuesField(const String& name, const String& value)
+    : AbstractField(name, Field::STORE_NO, Field::INDEX_NO, Field::TERM_VECTOR_NO) {
+    type = DOC_VALUES_SORTED;
+    fieldsData = value;
+}
+
+DocValuesField::~DocValuesField() {
+}
+
+DocValuesField::DocValuesType DocValuesField::getDocValuesType() {
+    return type;
+}
+
+int64_t DocValuesField::getNumericValue() {
+    return VariantUtils::typeOf<int64_t>(fieldsData) ? VariantUtils::get<int64_t>(fieldsData) : 0;
+}
+
+String DocValuesField::stringValue() {
+    if (VariantUtils::typeOf<String>(fieldsData)) {
+        return VariantUtils::get<String>(fieldsData);
+    }
+    return StringUtils::toString(getNumericValue());
+}
+
+ReaderPtr DocValuesField::readerValue() {
+    return ReaderPtr();
+}
+
+TokenStreamPtr DocValuesField::tokenStreamValue() {
+    return TokenStreamPtr();
+}
+
+DocValuesFieldPtr DocValuesField::setLongValue(int64_t value) {
+    if (type != DOC_VALUES_NUMERIC) {
+        boost::throw_exception(IllegalArgumentException(L"field " + _name + L" is not a numeric doc values field"));
+    }
+    fieldsData = value;
+    return shared_from_this();
+}
+
+DocValuesFieldPtr DocValuesField::setStringValue(const String& value) {
+    if (type != DOC_VALUES_SORTED) {
+        boost::throw_exception(IllegalArgumentException(L"field " + _name + L" is not a sorted doc values field"));
+    }
+    fieldsData = value;
+    return shared_from_this();
+}
+
+}
@@ -23,10 +23,22 @@ protected:
     IndexWriterWeakPtr _writer;
     OneMergePtr startMerge;
     OneMergePtr runningMerge;
+    bool pooled;
 
 public:
+    using LuceneThread::start;
+
+    /// Run this merge thread as a task on the given thread pool instead of starting a new thread.
+    void start(const ThreadPoolPtr& threadPool);
+
+    virtual bool isAlive();
+
     void setRunningMerge(const OneMergePtr& merge);
     OneMergePtr getRunningMerge();
+
+    /// Returns the running merge, or the merge this thread was started with if it hasn't started yet.
+    OneMergePtr getCurrentMerge();
+
     void setThreadPriority(int32_t pri);
     virtual void run();
 };
@@ -0,0 +1,42 @@
+/////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2009-2014 Alan Wright. All rights reserved.
+// Distributable under the terms of either the Apache License (Version 2.0)
+// or the GNU Lesser General Public License.
+/////////////////////////////////////////////////////////////////////////////
+
+#ifndef _FIELDSREADER_H
+#define _FIELDSREADER_H
+
+#include "IndexInput.h"
+
+namespace Lucene {
+
+/// Reads the documents of a decompressed chunk of stored fields.
+class FieldsChunkInput : public IndexInput {
+public:
+    FieldsChunkInput();
+    virtual ~FieldsChunkInput();
+
+    LUCENE_CLASS(FieldsChunkInput);
+
+public:
+    ByteArray bytes;
+    int32_t bytesLength;
+    int32_t position;
+
+public:
+    /// Returns a buffer of at least length bytes to decompress the next chunk into, and rewinds to its start.
+    uint8_t* reset(int32_t length);
+
+    virtual uint8_t readByte();
+    virtual void readBytes(uint8_t* b, int32_t offset, int32_t length);
+    virtual void close();
+    virtual int64_t getFilePointer();
+    virtual void seek(int64_t pos);
+    virtual int64_t length();
+    virtual LuceneObjectPtr clone(const LuceneObjectPtr& other = LuceneObjectPtr());
+};
+
+}
+
+#endif
@@ -0,0 +1,72 @@
+/////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2009-2014 Alan Wright. All rights reserved.
+// Distributable under the terms of either the Apache License (Version 2.0)
+// or the GNU Lesser General Public License.
+/////////////////////////////////////////////////////////////////////////////
+
+#ifndef _LRUFILTERCACHE_H
+#define _LRUFILTERCACHE_H
+
+#include "Filter.h"
+
+namespace Lucene {
+
+/// A filter and the core of the segment it was applied to.  The core is held weakly so that the cache
+/// does not keep closed segments alive; its hash is kept so that the key can still be removed after
+/// the core has gone.
+class LRUFilterCacheKey : public LuceneObject {
+public:
+    LRUFilterCacheKey(const FilterPtr& filter, const LuceneObjectPtr& coreKey);
+    virtual ~LRUFilterCacheKey();
+
+    LUCENE_CLASS(LRUFilterCacheKey);
+
+public:
+    FilterPtr filter;
+    LuceneObjectWeakPtr _coreKey;
+    int32_t hash;
+
+public:
+    /// Returns true if the segment of this key has been closed.
+    bool isClosed();
+
+    virtual bool equals(const LuceneObjectPtr& other);
+    virtual int32_t hashCode();
+};
+
+class LRUFilterCacheEntry : public LuceneObject {
+public:
+    LRUFilterCacheEntry(const DocIdSetPtr& docIdSet, int64_t bytesUsed, int64_t lastUse);
+    virtual ~LRUFilterCacheEntry();
+
+    LUCENE_CLASS(LRUFilterCacheEntry);
+
+public:
+    DocIdSetPtr docIdSet;
+    int64_t bytesUsed;
+    int64_t lastUse;
+};
+
+/// Filter returned by {@link LRUFilterCache#doCache}.
+class LRUCachedFilter : public Filter {
+public:
+    LRUCachedFilter(const LRUFilterCachePtr& cache, const FilterPtr& filter);
+    virtual ~LRUCachedFilter();
+
+    LUCENE_CLASS(LRUCachedFilter);
+
+protected:
+    LRUFilterCachePtr cache;
+    FilterPtr filter;
+
+public:
+    virtual DocIdSetPtr getDocIdSet(const IndexReaderPtr& reader);
+
+    virtual String toString();
+    virtual bool equals(const LuceneObjectPtr& other);
+    virtual int32_t hashCode();
+};
+
+}
+
+#endif
@@ -9,21 +9,32 @@
 
 #include <boost/iostreams/device/mapped_file.hpp>
 #include "IndexInput.h"
+#include "MMapDirectory.h"
 
 namespace Lucene {
 
+/// IndexInput that maps a file as a sequence of fixed size chunks, so that positions are not limited to 32 bits.
 class MMapIndexInput : public IndexInput {
 public:
-    MMapIndexInput(const String& path = L"");
+    MMapIndexInput(const String& path = L"", int32_t chunkSizePower = 30, int32_t advice = MMapDirectory::ADVICE_NORMAL);
     virtual ~MMapIndexInput();
 
     LUCENE_CLASS(MMapIndexInput);
 
 protected:
-    int32_t _length;
+    typedef std::vector<boost::iostreams::mapped_file_source> chunk_vector;
+
+    int64_t _length;
     bool isClone;
-    boost::iostreams::mapped_file_source file;
-    int32_t bufferPosition; // next byte to read
+    bool closed;
+    chunk_vector chunks;
+    int32_t chunkSizePower;
+    int64_t chunkMask;
+
+    const uint8_t* curChunk; // current chunk data
+    int32_t curChunkIndex; // index of current chunk
+    int32_t curChunkPosition; // next byte to read in current chunk
+    int32_t curChunkLength; // number of bytes in current chunk
 
 public:
     /// Reads and returns a single byte.
@@ -37,6 +48,9 @@ public:
     /// @see IndexOutput#writeBytes(const uint8_t*,int)
     virtual void readBytes(uint8_t* b, int32_t offset, int32_t length);
 
+    /// Reads count ints stored in variable-length format, decoding in bulk from the mapped chunk.
+    virtual void readVInts(int32_t* values, int32_t count);
+
     /// Returns the current position in this file, where the next read will occur.
     /// @see #seek(int64_t)
     virtual int64_t getFilePointer();
@@ -53,6 +67,16 @@ public:
 
     /// Returns a clone of this stream.
     virtual LuceneObjectPtr clone(const LuceneObjectPtr& other = LuceneObjectPtr());
+
+protected:
+    /// Throws AlreadyClosedException if this stream has been closed.
+    void ensureOpen();
+
+    /// Make the given chunk current and position at the given offset within it.
+    void setChunk(int32_t index, int32_t position);
+
+    /// Pass the access pattern hint for a mapped chunk to the operating system.
+    static void adviseChunk(const boost::iostreams::mapped_file_source& chunk, int32_t advice);
 };
 
 }
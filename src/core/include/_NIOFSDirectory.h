@@ -0,0 +1,76 @@
+/////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2009-2014 Alan Wright. All rights reserved.
+// Distributable under the terms of either the Apache License (Version 2.0)
+// or the GNU Lesser General Public License.
+/////////////////////////////////////////////////////////////////////////////
+
+#ifndef _NIOFSDIRECTORY_H
+#define _NIOFSDIRECTORY_H
+
+#include "BufferedIndexInput.h"
+
+namespace Lucene {
+
+/// Read-only file handle that supports reading at an absolute position without moving a shared file pointer,
+/// so it can be used concurrently from several threads without locking.
+class PositionalInputFile : public LuceneObject {
+public:
+    PositionalInputFile(const String& path);
+    virtual ~PositionalInputFile();
+
+    LUCENE_CLASS(PositionalInputFile);
+
+public:
+    static const int32_t FILE_EOF;
+    static const int32_t FILE_ERROR;
+
+protected:
+#if defined(_WIN32)
+    void* handle;
+#else
+    int32_t fd;
+#endif
+    int64_t length;
+
+public:
+    int64_t getLength();
+
+    /// Read up to length bytes starting at the given file position.  Returns the number of bytes read, or
+    /// {@link #FILE_EOF} or {@link #FILE_ERROR}.
+    int32_t read(uint8_t* b, int32_t offset, int32_t length, int64_t position);
+
+    void close();
+    bool isValid();
+};
+
+class NIOFSIndexInput : public BufferedIndexInput {
+public:
+    NIOFSIndexInput();
+    NIOFSIndexInput(const String& path, int32_t bufferSize, int32_t chunkSize);
+    virtual ~NIOFSIndexInput();
+
+    LUCENE_CLASS(NIOFSIndexInput);
+
+protected:
+    PositionalInputFilePtr file;
+    bool isClone;
+    int32_t chunkSize;
+
+protected:
+    virtual void readInternal(uint8_t* b, int32_t offset, int32_t length);
+    virtual void seekInternal(int64_t pos);
+
+public:
+    virtual int64_t length();
+    virtual void close();
+
+    /// Method used for testing.
+    bool isValid();
+
+    /// Returns a clone of this stream.
+    virtual LuceneObjectPtr clone(const LuceneObjectPtr& other = LuceneObjectPtr());
+};
+
+}
+
+#endif
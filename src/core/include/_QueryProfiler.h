@@ -0,0 +1,119 @@
+/////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2009-2014 Alan Wright. All rights reserved.
+// Distributable under the terms of either the Apache License (Version 2.0)
+// or the GNU Lesser General Public License.
+/////////////////////////////////////////////////////////////////////////////
+
+#ifndef _QUERYPROFILER_H
+#define _QUERYPROFILER_H
+
+#include "Weight.h"
+#include "Scorer.h"
+#include "Collector.h"
+
+namespace Lucene {
+
+/// Adds the time spent in a scope to a counter when the scope is left, also when it is left by an exception.
+class ProfileTimer {
+public:
+    ProfileTimer(int64_t& nanos);
+    ~ProfileTimer();
+
+protected:
+    int64_t& nanos;
+    int64_t start;
+
+private:
+    ProfileTimer(const ProfileTimer& other);
+    ProfileTimer& operator= (const ProfileTimer& other);
+};
+
+/// Pushes a node on the calling thread's stack of nodes whose weights are being created, and pops it again
+/// when the scope is left.
+class ProfileScope {
+public:
+    ProfileScope(Collection<QueryProfileNodePtr> stack, const QueryProfileNodePtr& node);
+    ~ProfileScope();
+
+protected:
+    Collection<QueryProfileNodePtr> stack;
+
+private:
+    ProfileScope(const ProfileScope& other);
+    ProfileScope& operator= (const ProfileScope& other);
+};
+
+/// Weight that times the creation of its scorers and wraps them in a {@link ProfilingScorer}.
+class ProfilingWeight : public Weight {
+public:
+    ProfilingWeight(const WeightPtr& weight, const QueryProfileNodePtr& node);
+    virtual ~ProfilingWeight();
+
+    LUCENE_CLASS(ProfilingWeight);
+
+protected:
+    WeightPtr weight;
+    QueryProfileNodePtr node;
+
+public:
+    virtual ExplanationPtr explain(const IndexReaderPtr& reader, int32_t doc);
+    virtual QueryPtr getQuery();
+    virtual double getValue();
+    virtual void normalize(double norm);
+    virtual ScorerPtr scorer(const IndexReaderPtr& reader, bool scoreDocsInOrder, bool topScorer);
+    virtual double sumOfSquaredWeights();
+    virtual bool scoresDocsOutOfOrder();
+};
+
+/// Scorer that counts and times the calls made to another scorer against a single segment.
+class ProfilingScorer : public Scorer {
+public:
+    ProfilingScorer(const ScorerPtr& scorer, const QueryProfileSegmentPtr& segment);
+    virtual ~ProfilingScorer();
+
+    LUCENE_CLASS(ProfilingScorer);
+
+protected:
+    ScorerPtr scorer;
+    QueryProfileSegmentPtr segment;
+
+public:
+    virtual int32_t docID();
+    virtual int32_t nextDoc();
+    virtual int32_t advance(int32_t target);
+    virtual double score();
+    virtual void score(const CollectorPtr& collector);
+    virtual float termFreq();
+    virtual void setMinCompetitiveScore(double minScore);
+
+protected:
+    virtual bool score(const CollectorPtr& collector, int32_t max, int32_t firstDocID);
+};
+
+/// Collector that counts and times the hits passed to another collector.
+class ProfilingCollector : public Collector {
+public:
+    ProfilingCollector(const CollectorPtr& collector, const QueryProfilerPtr& profiler);
+    virtual ~ProfilingCollector();
+
+    LUCENE_CLASS(ProfilingCollector);
+
+protected:
+    CollectorPtr collector;
+    QueryProfilerPtr profiler;
+    int64_t collectCount; // added to the profiler once the search is done
+    int64_t collectNanos;
+
+public:
+    /// Add the counts and times recorded so far to the profiler.
+    void finish();
+
+    virtual void setScorer(const ScorerPtr& scorer);
+    virtual void collect(int32_t doc);
+    virtual void setNextReader(const IndexReaderPtr& reader, int32_t docBase);
+    virtual bool acceptsDocsOutOfOrder();
+};
+
+}
+
+#endif
@@ -0,0 +1,63 @@
+/////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2009-2014 Alan Wright. All rights reserved.
+// Distributable under the terms of either the Apache License (Version 2.0)
+// or the GNU Lesser General Public License.
+/////////////////////////////////////////////////////////////////////////////
+
+#ifndef _QUERYRESULTCACHE_H
+#define _QUERYRESULTCACHE_H
+
+#include "LuceneObject.h"
+
+namespace Lucene {
+
+/// A search and the segments it was run against.  Each segment is identified by its core and its deletions,
+/// both held weakly so that the cache does not keep closed segments alive; the hash is kept so that the key
+/// can still be removed after they have gone.
+class QueryResultCacheKey : public LuceneObject {
+public:
+    QueryResultCacheKey(const QueryPtr& query, const FilterPtr& filter, const SortPtr& sort, int32_t n, const SimilarityPtr& similarity, int32_t options, Collection<IndexReaderPtr> readers);
+    virtual ~QueryResultCacheKey();
+
+    LUCENE_CLASS(QueryResultCacheKey);
+
+public:
+    QueryPtr query;
+    FilterPtr filter;
+    SortPtr sort;
+    int32_t n;
+
+    /// The similarity of the searcher, which scores the hits.
+    SimilarityPtr similarity;
+
+    /// The searcher settings that change the hits, see {@link QueryResultCache}.
+    int32_t options;
+
+    /// The core and deletions of each segment, in turn.
+    Collection<LuceneObjectWeakPtr> readerKeys;
+
+    int32_t hash;
+
+public:
+    /// Returns true if a segment of this key has been closed or has new deletions.
+    bool isClosed();
+
+    virtual bool equals(const LuceneObjectPtr& other);
+    virtual int32_t hashCode();
+};
+
+class QueryResultCacheEntry : public LuceneObject {
+public:
+    QueryResultCacheEntry(const TopDocsPtr& topDocs, int64_t lastUse);
+    virtual ~QueryResultCacheEntry();
+
+    LUCENE_CLASS(QueryResultCacheEntry);
+
+public:
+    TopDocsPtr topDocs;
+    int64_t lastUse;
+};
+
+}
+
+#endif
@@ -0,0 +1,140 @@
+/////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2009-2014 Alan Wright. All rights reserved.
+// Distributable under the terms of either the Apache License (Version 2.0)
+// or the GNU Lesser General Public License.
+/////////////////////////////////////////////////////////////////////////////
+
+#ifndef _ROARINGDOCIDSET_H
+#define _ROARINGDOCIDSET_H
+
+#include "DocIdSetIterator.h"
+
+namespace Lucene {
+
+/// The low 16 bits of the documents of one block of a {@link RoaringDocIdSet}.
+class RoaringContainer : public LuceneObject {
+public:
+    virtual ~RoaringContainer();
+
+    LUCENE_CLASS(RoaringContainer);
+
+public:
+    /// Number of values in a block.
+    static const int32_t BLOCK_SIZE;
+
+    /// Arrays hold at most this many values; above it a bitmap is never larger.
+    static const int32_t MAX_ARRAY_SIZE;
+
+    /// Create the smallest container holding the given values, which must be sorted and unique.
+    static RoaringContainerPtr create(const uint16_t* values, int32_t count);
+
+public:
+    virtual int32_t cardinality() = 0;
+    virtual bool contains(int32_t value) = 0;
+
+    /// Returns the first value >= target, or -1 if there is none.  index is a position within the
+    /// container, starting at 0, that is kept between calls with increasing targets.
+    virtual int32_t advance(int32_t& index, int32_t target) = 0;
+
+    /// Copy the values into an array of at least {@link #cardinality} values, returning their number.
+    virtual int32_t getValues(uint16_t* values) = 0;
+
+    virtual int64_t ramBytesUsed() = 0;
+
+    /// Copy the values in both this container and another into an array of at least {@link #BLOCK_SIZE}
+    /// values, returning their number.  This implementation checks each value of the smaller container
+    /// against the larger.
+    virtual int32_t intersect(const RoaringContainerPtr& other, uint16_t* values);
+};
+
+/// Sorted array of values, for blocks of up to {@link #MAX_ARRAY_SIZE} documents.
+class RoaringArrayContainer : public RoaringContainer {
+public:
+    RoaringArrayContainer(const uint16_t* values, int32_t count);
+    virtual ~RoaringArrayContainer();
+
+    LUCENE_CLASS(RoaringArrayContainer);
+
+protected:
+    Array<uint16_t> values;
+
+public:
+    virtual int32_t cardinality();
+    virtual bool contains(int32_t value);
+    virtual int32_t advance(int32_t& index, int32_t target);
+    virtual int32_t getValues(uint16_t* values);
+    virtual int64_t ramBytesUsed();
+};
+
+/// One bit per value, for dense blocks.
+class RoaringBitmapContainer : public RoaringContainer {
+public:
+    RoaringBitmapContainer(const uint16_t* values, int32_t count);
+    RoaringBitmapContainer(LongArray words, int32_t count);
+    virtual ~RoaringBitmapContainer();
+
+    LUCENE_CLASS(RoaringBitmapContainer);
+
+public:
+    static const int32_t NUM_WORDS;
+
+protected:
+    LongArray words;
+    int32_t count;
+
+public:
+    virtual int32_t cardinality();
+    virtual bool contains(int32_t value);
+    virtual int32_t advance(int32_t& index, int32_t target);
+    virtual int32_t getValues(uint16_t* values);
+    virtual int64_t ramBytesUsed();
+    virtual int32_t intersect(const RoaringContainerPtr& other, uint16_t* values);
+};
+
+/// Runs of consecutive values, each held as its first and last value.
+class RoaringRunContainer : public RoaringContainer {
+public:
+    RoaringRunContainer(const uint16_t* values, int32_t count, int32_t numRuns);
+    virtual ~RoaringRunContainer();
+
+    LUCENE_CLASS(RoaringRunContainer);
+
+protected:
+    Array<uint16_t> runs; // first and last value of each run
+    int32_t numRuns;
+    int32_t count;
+
+public:
+    virtual int32_t cardinality();
+    virtual bool contains(int32_t value);
+    virtual int32_t advance(int32_t& index, int32_t target);
+    virtual int32_t getValues(uint16_t* values);
+    virtual int64_t ramBytesUsed();
+
+protected:
+    /// Returns the index of the first run ending at or after value, starting from the given run.
+    int32_t findRun(int32_t from, int32_t value);
+};
+
+class RoaringDocIdSetIterator : public DocIdSetIterator {
+public:
+    RoaringDocIdSetIterator(const RoaringDocIdSetPtr& set);
+    virtual ~RoaringDocIdSetIterator();
+
+    LUCENE_CLASS(RoaringDocIdSetIterator);
+
+protected:
+    RoaringDocIdSetPtr set;
+    int32_t container;
+    int32_t index;
+    int32_t doc;
+
+public:
+    virtual int32_t docID();
+    virtual int32_t nextDoc();
+    virtual int32_t advance(int32_t target);
+};
+
+}
+
+#endif
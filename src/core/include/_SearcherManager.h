@@ -0,0 +1,31 @@
+/////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2009-2014 Alan Wright. All rights reserved.
+// Distributable under the terms of either the Apache License (Version 2.0)
+// or the GNU Lesser General Public License.
+/////////////////////////////////////////////////////////////////////////////
+
+#ifndef _SEARCHERMANAGER_H
+#define _SEARCHERMANAGER_H
+
+#include "LuceneThread.h"
+
+namespace Lucene {
+
+/// Refreshes the searcher of a {@link SearcherManager} at regular intervals.
+class SearcherRefreshThread : public LuceneThread {
+public:
+    SearcherRefreshThread(const SearcherManagerPtr& manager);
+    virtual ~SearcherRefreshThread();
+
+    LUCENE_CLASS(SearcherRefreshThread);
+
+protected:
+    SearcherManagerWeakPtr _manager;
+
+public:
+    virtual void run();
+};
+
+}
+
+#endif
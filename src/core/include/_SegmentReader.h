@@ -44,6 +44,7 @@ public:
     TermVectorsReaderPtr termVectorsReaderOrig;
     CompoundFileReaderPtr cfsReader;
     CompoundFileReaderPtr storeCFSReader;
+    DocValuesReaderPtr docValues;
 
 public:
     TermVectorsReaderPtr getTermVectorsReaderOrig();
@@ -124,6 +125,7 @@ protected:
     bool dirty;
     int32_t number;
     bool rollbackDirty;
+    int32_t maxByte; // highest byte of _bytes, -1 until computed
 
 public:
     void incRef();
@@ -135,6 +137,9 @@ public:
     /// Load & cache full bytes array.  Returns bytes.
     ByteArray bytes();
 
+    /// Returns the highest norm byte, computed from the cached bytes on first use.
+    uint8_t maxBytesValue();
+
     /// Only for testing
     SegmentReaderRefPtr bytesRef();
 
@@ -24,6 +24,20 @@ public:
     virtual bool acceptsDocsOutOfOrder();
 };
 
+/// Assumes docs are scored in order, and tells the scorer the score to beat once the queue is full so that
+/// it can skip documents that can't compete.  totalHits then only counts the documents that were collected.
+class PruningTopScoreDocCollector : public InOrderTopScoreDocCollector {
+public:
+    PruningTopScoreDocCollector(int32_t numHits);
+    virtual ~PruningTopScoreDocCollector();
+
+    LUCENE_CLASS(PruningTopScoreDocCollector);
+
+public:
+    virtual void setScorer(const ScorerPtr& scorer);
+    virtual void collect(int32_t doc);
+};
+
 /// Assumes docs are scored out of order.
 class OutOfOrderTopScoreDocCollector : public TopScoreDocCollector {
 public:
@@ -9,6 +9,8 @@
 #include "_ConcurrentMergeScheduler.h"
 #include "IndexWriter.h"
 #include "TestPoint.h"
+#include "ThreadPool.h"
+#include "RateLimiter.h"
 #include "StringUtils.h"
 
 namespace Lucene {
@@ -19,7 +21,9 @@ bool ConcurrentMergeScheduler::anyExceptions = false;
 ConcurrentMergeScheduler::ConcurrentMergeScheduler() {
     mergeThreadPriority = -1;
     mergeThreads = SetMergeThread::newInstance();
-    maxThreadCount = 1;
+    maxThreadCount = std::max(1, std::min(3, ThreadPool::availableProcessors() / 2));
+    maxMergeCount = maxThreadCount + 2;
+    mergeWriteMBPerSec = 0.0;
     suppressExceptions = false;
     closed = false;
 }
@@ -35,16 +39,63 @@ void ConcurrentMergeScheduler::initialize() {
 }
 
 void ConcurrentMergeScheduler::setMaxThreadCount(int32_t count) {
+    SyncLock syncLock(this);
     if (count < 1) {
         boost::throw_exception(IllegalArgumentException(L"count should be at least 1"));
     }
     maxThreadCount = count;
+    maxMergeCount = std::max(maxMergeCount, count);
+    updateMergeThreads();
 }
 
 int32_t ConcurrentMergeScheduler::getMaxThreadCount() {
+    SyncLock syncLock(this);
     return maxThreadCount;
 }
 
+void ConcurrentMergeScheduler::setMaxMergeCount(int32_t count) {
+    SyncLock syncLock(this);
+    if (count < maxThreadCount) {
+        boost::throw_exception(IllegalArgumentException(L"count should be at least maxThreadCount (= " + StringUtils::toString(maxThreadCount) + L")"));
+    }
+    maxMergeCount = count;
+}
+
+int32_t ConcurrentMergeScheduler::getMaxMergeCount() {
+    SyncLock syncLock(this);
+    return maxMergeCount;
+}
+
+void ConcurrentMergeScheduler::setMergeWriteMBPerSec(double mbPerSec) {
+    SyncLock syncLock(this);
+    if (mbPerSec < 0.0) {
+        boost::throw_exception(IllegalArgumentException(L"mbPerSec should be 0 or positive"));
+    }
+    mergeWriteMBPerSec = mbPerSec;
+    if (mbPerSec == 0.0) {
+        rateLimiter.reset();
+    } else if (rateLimiter) {
+        rateLimiter->setMbPerSec(mbPerSec);
+    } else {
+        rateLimiter = newLucene<RateLimiter>(mbPerSec);
+    }
+}
+
+double ConcurrentMergeScheduler::getMergeWriteMBPerSec() {
+    SyncLock syncLock(this);
+    return mergeWriteMBPerSec;
+}
+
+void ConcurrentMergeScheduler::setThreadPool(const ThreadPoolPtr& threadPool) {
+    SyncLock syncLock(this);
+    this->threadPool = threadPool;
+}
+
+ThreadPoolPtr ConcurrentMergeScheduler::getThreadPool() {
+    SyncLock syncLock(this);
+    return threadPool;
+}
+
 int32_t ConcurrentMergeScheduler::getMergeThreadPriority() {
     SyncLock syncLock(this);
     initMergeThreadPriority();
@@ -107,6 +158,35 @@ int32_t ConcurrentMergeScheduler::mergeThreadCount() {
     return count;
 }
 
+/// Orders merges by the number of documents they merge, smallest first.
+struct lessMergeDocCount {
+    inline bool operator()(const std::pair<int32_t, OneMergePtr>& first, const std::pair<int32_t, OneMergePtr>& second) const {
+        return first.first < second.first;
+    }
+};
+
+void ConcurrentMergeScheduler::updateMergeThreads() {
+    SyncLock syncLock(this);
+    Collection< std::pair<int32_t, OneMergePtr> > merges(Collection< std::pair<int32_t, OneMergePtr> >::newInstance());
+    for (SetMergeThread::iterator merger = mergeThreads.begin(); merger != mergeThreads.end(); ++merger) {
+        OneMergePtr merge((*merger)->getCurrentMerge());
+        if (merge) {
+            merges.add(std::make_pair(merge->totalDocCount(), merge));
+        }
+    }
+    std::stable_sort(merges.begin(), merges.end(), lessMergeDocCount());
+
+    int32_t numMerges = merges.size();
+    for (int32_t i = 0; i < numMerges; ++i) {
+        OneMergePtr merge(merges[i].second);
+        bool pause = (i >= maxThreadCount);
+        if (pause != merge->getPause()) {
+            message(String(pause ? L"pause" : L"resume") + L" merge " + merge->segString(dir));
+            merge->setPause(pause);
+        }
+    }
+}
+
 void ConcurrentMergeScheduler::merge(const IndexWriterPtr& writer) {
     BOOST_ASSERT(!writer->holdsLock());
 
@@ -138,21 +218,26 @@ void ConcurrentMergeScheduler::merge(const IndexWriterPtr& writer) {
         try {
             SyncLock syncLock(this);
             MergeThreadPtr merger;
-            while (mergeThreadCount() >= maxThreadCount) {
-                message(L"    too many merge threads running; stalling...");
+            while (mergeThreadCount() >= maxMergeCount) {
+                message(L"    too many merges running; stalling...");
                 wait(1000);
             }
 
             message(L"  consider merge " + merge->segString(dir));
 
-            BOOST_ASSERT(mergeThreadCount() < maxThreadCount);
+            BOOST_ASSERT(mergeThreadCount() < maxMergeCount);
 
             // OK to spawn a new merge thread to handle this merge
             merger = getMergeThread(writer, merge);
             mergeThreads.add(merger);
-            message(L"    launch new thread");
-
-            merger->start();
+            if (threadPool) {
+                message(L"    launch new pooled merge");
+                merger->start(threadPool);
+            } else {
+                message(L"    launch new thread");
+                merger->start();
+            }
+            updateMergeThreads();
             success = true;
         } catch (LuceneException& e) {
             finally = e;
@@ -166,6 +251,10 @@ void ConcurrentMergeScheduler::merge(const IndexWriterPtr& writer) {
 
 void ConcurrentMergeScheduler::doMerge(const OneMergePtr& merge) {
     TestScope testScope(L"ConcurrentMergeScheduler", L"doMerge");
+    {
+        SyncLock syncLock(this);
+        merge->rateLimiter = rateLimiter;
+    }
     IndexWriterPtr(_writer)->merge(merge);
 }
 
@@ -234,6 +323,7 @@ MergeThread::MergeThread(const ConcurrentMergeSchedulerPtr& merger, const IndexW
     this->_merger = merger;
     this->_writer = writer;
     this->startMerge = startMerge;
+    this->pooled = false;
 }
 
 MergeThread::~MergeThread() {
@@ -243,6 +333,7 @@ void MergeThread::setRunningMerge(const OneMergePtr& merge) {
     ConcurrentMergeSchedulerPtr merger(_merger);
     SyncLock syncLock(merger);
     runningMerge = merge;
+    merger->updateMergeThreads();
 }
 
 OneMergePtr MergeThread::getRunningMerge() {
@@ -251,6 +342,27 @@ OneMergePtr MergeThread::getRunningMerge() {
     return runningMerge;
 }
 
+OneMergePtr MergeThread::getCurrentMerge() {
+    ConcurrentMergeSchedulerPtr merger(_merger);
+    SyncLock syncLock(merger);
+    return runningMerge ? runningMerge : startMerge;
+}
+
+void MergeThread::start(const ThreadPoolPtr& threadPool) {
+    pooled = true;
+    setRunning(true);
+    try {
+        threadPool->execute(boost::bind(&LuceneThread::runThread, this));
+    } catch (...) {
+        setRunning(false);
+        throw;
+    }
+}
+
+bool MergeThread::isAlive() {
+    return pooled ? isRunning() : LuceneThread::isAlive();
+}
+
 void MergeThread::setThreadPriority(int32_t pri) {
     try {
         setPriority(pri);
@@ -301,6 +413,7 @@ void MergeThread::run() {
 
         bool removed = merger->mergeThreads.remove(shared_from_this());
         BOOST_ASSERT(removed);
+        merger->updateMergeThreads();
     }
     finally.throwException();
 }
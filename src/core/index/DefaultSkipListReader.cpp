@@ -10,9 +10,10 @@
 
 namespace Lucene {
 
-DefaultSkipListReader::DefaultSkipListReader(const IndexInputPtr& skipStream, int32_t maxSkipLevels, int32_t skipInterval)
+DefaultSkipListReader::DefaultSkipListReader(const IndexInputPtr& skipStream, int32_t maxSkipLevels, int32_t skipInterval, bool hasMaxFreq)
     : MultiLevelSkipListReader(skipStream, maxSkipLevels, skipInterval) {
     currentFieldStoresPayloads = false;
+    this->hasMaxFreq = hasMaxFreq;
     lastFreqPointer = 0;
     lastProxPointer = 0;
     lastPayloadLength = 0;
@@ -20,10 +21,12 @@ DefaultSkipListReader::DefaultSkipListReader(const IndexInputPtr& skipStream, in
     freqPointer = Collection<int64_t>::newInstance(maxSkipLevels);
     proxPointer = Collection<int64_t>::newInstance(maxSkipLevels);
     payloadLength = Collection<int32_t>::newInstance(maxSkipLevels);
+    maxFreq = Collection<int32_t>::newInstance(maxSkipLevels);
 
     MiscUtils::arrayFill(freqPointer.begin(), 0, freqPointer.size(), 0);
     MiscUtils::arrayFill(proxPointer.begin(), 0, proxPointer.size(), 0);
     MiscUtils::arrayFill(payloadLength.begin(), 0, payloadLength.size(), 0);
+    MiscUtils::arrayFill(maxFreq.begin(), 0, maxFreq.size(), 0);
 }
 
 DefaultSkipListReader::~DefaultSkipListReader() {
@@ -38,6 +41,7 @@ void DefaultSkipListReader::init(int64_t skipPointer, int64_t freqBasePointer, i
     MiscUtils::arrayFill(freqPointer.begin(), 0, freqPointer.size(), freqBasePointer);
     MiscUtils::arrayFill(proxPointer.begin(), 0, proxPointer.size(), proxBasePointer);
     MiscUtils::arrayFill(payloadLength.begin(), 0, payloadLength.size(), 0);
+    MiscUtils::arrayFill(maxFreq.begin(), 0, maxFreq.size(), 0);
 }
 
 int64_t DefaultSkipListReader::getFreqPointer() {
@@ -52,6 +56,10 @@ int32_t DefaultSkipListReader::getPayloadLength() {
     return lastPayloadLength;
 }
 
+int32_t DefaultSkipListReader::getMaxFreq(int32_t level) {
+    return maxFreq[level];
+}
+
 void DefaultSkipListReader::seekChild(int32_t level) {
     MultiLevelSkipListReader::seekChild(level);
     freqPointer[level] = lastFreqPointer;
@@ -82,6 +90,9 @@ int32_t DefaultSkipListReader::readSkipData(int32_t level, const IndexInputPtr&
 
     freqPointer[level] += skipStream->readVInt();
     proxPointer[level] += skipStream->readVInt();
+    if (hasMaxFreq) {
+        maxFreq[level] = skipStream->readVInt();
+    }
 
     return delta;
 }
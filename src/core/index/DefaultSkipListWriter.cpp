@@ -25,6 +25,7 @@ DefaultSkipListWriter::DefaultSkipListWriter(int32_t skipInterval, int32_t numbe
     lastSkipPayloadLength = Collection<int32_t>::newInstance(numberOfSkipLevels);
     lastSkipFreqPointer = Collection<int64_t>::newInstance(numberOfSkipLevels);
     lastSkipProxPointer = Collection<int64_t>::newInstance(numberOfSkipLevels);
+    blockMaxFreq = Collection<int32_t>::newInstance(numberOfSkipLevels);
 }
 
 DefaultSkipListWriter::~DefaultSkipListWriter() {
@@ -38,7 +39,11 @@ void DefaultSkipListWriter::setProxOutput(const IndexOutputPtr& proxOutput) {
     this->proxOutput = proxOutput;
 }
 
-void DefaultSkipListWriter::setSkipData(int32_t doc, bool storePayloads, int32_t payloadLength) {
+void DefaultSkipListWriter::setSkipData(int32_t doc, bool storePayloads, int32_t payloadLength, int32_t maxFreq) {
+    // the blocks of the upper levels span the blocks below them
+    for (Collection<int32_t>::iterator level = blockMaxFreq.begin(); level != blockMaxFreq.end(); ++level) {
+        *level = std::max(*level, maxFreq);
+    }
     this->curDoc = doc;
     this->curStorePayloads = storePayloads;
     this->curPayloadLength = payloadLength;
@@ -52,6 +57,7 @@ void DefaultSkipListWriter::resetSkip() {
     MultiLevelSkipListWriter::resetSkip();
     MiscUtils::arrayFill(lastSkipDoc.begin(), 0, lastSkipDoc.size(), 0);
     MiscUtils::arrayFill(lastSkipPayloadLength.begin(), 0, lastSkipPayloadLength.size(), -1); // we don't have to write the first length in the skip list
+    MiscUtils::arrayFill(blockMaxFreq.begin(), 0, blockMaxFreq.size(), 0);
     MiscUtils::arrayFill(lastSkipFreqPointer.begin(), 0, lastSkipFreqPointer.size(), freqOutput->getFilePointer());
     if (proxOutput) {
         MiscUtils::arrayFill(lastSkipProxPointer.begin(), 0, lastSkipProxPointer.size(), proxOutput->getFilePointer());
@@ -79,6 +85,9 @@ void DefaultSkipListWriter::writeSkipData(int32_t level, const IndexOutputPtr& s
     //         if DocSkip is even, then it is assumed that the
     //         current payload length equals the length at the previous
     //         skip point
+    // Both cases are followed by MaxFreq --> VInt, the highest frequency of the term in the documents
+    // since the previous skip point on the same level, which scorers use to skip blocks of documents
+    // that can't score high enough.
     if (curStorePayloads) {
         int32_t delta = curDoc - lastSkipDoc[level];
         if (curPayloadLength == lastSkipPayloadLength[level]) {
@@ -98,8 +107,10 @@ void DefaultSkipListWriter::writeSkipData(int32_t level, const IndexOutputPtr& s
     }
     skipBuffer->writeVInt((int32_t)(curFreqPointer - lastSkipFreqPointer[level]));
     skipBuffer->writeVInt((int32_t)(curProxPointer - lastSkipProxPointer[level]));
+    skipBuffer->writeVInt(blockMaxFreq[level]);
 
     lastSkipDoc[level] = curDoc;
+    blockMaxFreq[level] = 0;
 
     lastSkipFreqPointer[level] = curFreqPointer;
     lastSkipProxPointer[level] = curProxPointer;
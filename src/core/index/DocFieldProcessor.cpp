@@ -10,6 +10,7 @@
 #include "DocFieldConsumerPerThread.h"
 #include "DocFieldConsumer.h"
 #include "StoredFieldsWriter.h"
+#include "DocValuesWriter.h"
 #include "SegmentWriteState.h"
 #include "IndexFileNames.h"
 #include "FieldInfos.h"
@@ -23,6 +24,7 @@ DocFieldProcessor::DocFieldProcessor(const DocumentsWriterPtr& docWriter, const
     this->consumer = consumer;
     consumer->setFieldInfos(fieldInfos);
     fieldsWriter = newLucene<StoredFieldsWriter>(docWriter, fieldInfos);
+    docValuesWriter = newLucene<DocValuesWriter>(docWriter);
 }
 
 DocFieldProcessor::~DocFieldProcessor() {
@@ -43,6 +45,7 @@ void DocFieldProcessor::flush(Collection<DocConsumerPerThreadPtr> threads, const
         perThread->trimFields(state);
     }
     fieldsWriter->flush(state);
+    docValuesWriter->flush(state);
     consumer->flush(childThreadsAndFields, state);
 
     // Important to save after asking consumer to flush so consumer can alter the FieldInfo* if necessary.
@@ -54,6 +57,7 @@ void DocFieldProcessor::flush(Collection<DocConsumerPerThreadPtr> threads, const
 
 void DocFieldProcessor::abort() {
     fieldsWriter->abort();
+    docValuesWriter->abort();
     consumer->abort();
 }
 
@@ -15,6 +15,8 @@
 #include "DocumentsWriter.h"
 #include "StoredFieldsWriter.h"
 #include "StoredFieldsWriterPerThread.h"
+#include "DocValuesWriter.h"
+#include "DocValuesField.h"
 #include "SegmentWriteState.h"
 #include "FieldInfo.h"
 #include "FieldInfos.h"
@@ -209,6 +211,11 @@ DocWriterPtr DocFieldProcessorPerThread::processDocument() {
         fp->fields[fp->fieldCount++] = *field;
         if ((*field)->isStored()) {
             fieldsWriter->addField(*field, fp->fieldInfo);
+        } else if (!(*field)->isIndexed()) {
+            DocValuesFieldPtr docValuesField(boost::dynamic_pointer_cast<DocValuesField>(*field));
+            if (docValuesField) {
+                docFieldProcessor->docValuesWriter->addField(docState->docID, docValuesField);
+            }
         }
     }
 
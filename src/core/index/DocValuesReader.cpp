@@ -0,0 +1,98 @@
+/////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2009-2014 Alan Wright. All rights reserved.
+// Distributable under the terms of either the Apache License (Version 2.0)
+// or the GNU Lesser General Public License.
+/////////////////////////////////////////////////////////////////////////////
+
+#include "LuceneInc.h"
+#include "DocValuesReader.h"
+#include "DocValuesWriter.h"
+#include "DocValuesField.h"
+#include "IndexFileNames.h"
+#include "IndexInput.h"
+#include "Directory.h"
+#include "FieldCache.h"
+#include "PackedInts.h"
+#include "StringUtils.h"
+
+namespace Lucene {
+
+DocValuesReader::DocValuesReader(const DirectoryPtr& directory, const String& segment, int32_t readBufferSize) {
+    types = HashMap<String, int32_t>::newInstance();
+    pointers = HashMap<String, int64_t>::newInstance();
+    numericValues = HashMap<String, PackedValuesPtr>::newInstance();
+    sortedValues = HashMap<String, PackedStringIndexPtr>::newInstance();
+
+    input = directory->openInput(segment + L"." + IndexFileNames::DOC_VALUES_EXTENSION(), readBufferSize);
+    bool success = false;
+    LuceneException finally;
+    try {
+        int32_t format = input->readInt();
+        if (format < DocValuesOutput::FORMAT_CURRENT) {
+            boost::throw_exception(CorruptIndexException(L"Unknown format version: " + StringUtils::toString(format)));
+        }
+        input->seek(input->length() - 8);
+        input->seek(input->readLong());
+        int32_t numFields = input->readVInt();
+        for (int32_t i = 0; i < numFields; ++i) {
+            String field(input->readString());
+            types.put(field, input->readByte());
+            pointers.put(field, input->readLong());
+        }
+        success = true;
+    } catch (LuceneException& e) {
+        finally = e;
+    }
+    if (!success) {
+        input->close();
+    }
+    finally.throwException();
+}
+
+DocValuesReader::~DocValuesReader() {
+}
+
+HashSet<String> DocValuesReader::getFields(int32_t type) {
+    HashSet<String> fields(HashSet<String>::newInstance());
+    for (HashMap<String, int32_t>::iterator field = types.begin(); field != types.end(); ++field) {
+        if (field->second == type) {
+            fields.add(field->first);
+        }
+    }
+    return fields;
+}
+
+PackedValuesPtr DocValuesReader::getNumeric(const String& field) {
+    SyncLock syncLock(this);
+    PackedValuesPtr values(numericValues.get(field));
+    if (!values && types.get(field) == DocValuesField::DOC_VALUES_NUMERIC) {
+        input->seek(pointers.get(field));
+        int64_t minValue = input->readLong();
+        values = newLucene<PackedValues>(minValue, PackedInts::read(input));
+        numericValues.put(field, values);
+    }
+    return values;
+}
+
+PackedStringIndexPtr DocValuesReader::getSorted(const String& field) {
+    SyncLock syncLock(this);
+    PackedStringIndexPtr values(sortedValues.get(field));
+    if (!values && types.get(field) == DocValuesField::DOC_VALUES_SORTED) {
+        input->seek(pointers.get(field));
+        int32_t length = input->readVInt();
+        ByteArray termBytes(ByteArray::newInstance(std::max(length, 1)));
+        input->readBytes(termBytes.get(), 0, length);
+        PackedIntsPtr termOffsets(PackedInts::read(input));
+        PackedIntsPtr order(PackedInts::read(input));
+        values = newLucene<PackedStringIndex>(order, termBytes, termOffsets);
+        sortedValues.put(field, values);
+    }
+    return values;
+}
+
+void DocValuesReader::close() {
+    SyncLock syncLock(this);
+    input->close();
+}
+
+}
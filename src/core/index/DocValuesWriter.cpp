@@ -0,0 +1,228 @@
+/////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2009-2014 Alan Wright. All rights reserved.
+// Distributable under the terms of either the Apache License (Version 2.0)
+// or the GNU Lesser General Public License.
+/////////////////////////////////////////////////////////////////////////////
+
+#include "LuceneInc.h"
+#include "DocValuesWriter.h"
+#include "DocValuesField.h"
+#include "DocumentsWriter.h"
+#include "SegmentWriteState.h"
+#include "IndexFileNames.h"
+#include "IndexOutput.h"
+#include "Directory.h"
+#include "PackedInts.h"
+#include "MiscUtils.h"
+#include "StringUtils.h"
+
+namespace Lucene {
+
+const int32_t DocValuesOutput::FORMAT_CURRENT = -1;
+
+DocValuesWriter::DocValuesWriter(const DocumentsWriterPtr& docWriter) {
+    _docWriter = docWriter;
+    numericFields = HashMap< String, Collection<int64_t> >::newInstance();
+    sortedFields = HashMap< String, Collection<String> >::newInstance();
+    bytesUsed = 0;
+}
+
+DocValuesWriter::~DocValuesWriter() {
+}
+
+void DocValuesWriter::addField(int32_t docID, const DocValuesFieldPtr& field) {
+    int64_t newBytes = 0;
+    {
+        SyncLock syncLock(this);
+        String name(field->name());
+        if (field->getDocValuesType() == DocValuesField::DOC_VALUES_NUMERIC) {
+            if (sortedFields.contains(name)) {
+                boost::throw_exception(IllegalArgumentException(L"field " + name + L" already has sorted doc values"));
+            }
+            Collection<int64_t> values(numericFields.get(name));
+            if (!values) {
+                values = Collection<int64_t>::newInstance();
+                numericFields.put(name, values);
+            }
+            if (docID >= values.size()) {
+                int32_t newSize = MiscUtils::getNextSize(docID + 1);
+                newBytes += (int64_t)(newSize - values.size()) * sizeof(int64_t);
+                values.resize(newSize);
+            }
+            values[docID] = field->getNumericValue();
+        } else {
+            if (numericFields.contains(name)) {
+                boost::throw_exception(IllegalArgumentException(L"field " + name + L" already has numeric doc values"));
+            }
+            Collection<String> values(sortedFields.get(name));
+            if (!values) {
+                values = Collection<String>::newInstance();
+                sortedFields.put(name, values);
+            }
+            if (docID >= values.size()) {
+                int32_t newSize = MiscUtils::getNextSize(docID + 1);
+                newBytes += (int64_t)(newSize - values.size()) * sizeof(String);
+                values.resize(newSize);
+            }
+            values[docID] = field->stringValue();
+            newBytes += (int64_t)values[docID].length() * sizeof(wchar_t);
+        }
+        bytesUsed += newBytes;
+    }
+    // charged outside our lock, as flush takes the DocumentsWriter lock before ours
+    if (newBytes > 0) {
+        DocumentsWriterPtr docWriter(_docWriter);
+        docWriter->bytesAllocated(newBytes);
+        docWriter->bytesUsed(newBytes);
+    }
+}
+
+void DocValuesWriter::flush(const SegmentWriteStatePtr& state) {
+    SyncLock syncLock(this);
+    if (numericFields.empty() && sortedFields.empty()) {
+        return;
+    }
+
+    String fileName(state->segmentFileName(IndexFileNames::DOC_VALUES_EXTENSION()));
+    state->flushedFiles.add(fileName);
+    DocValuesOutputPtr output(newLucene<DocValuesOutput>(state->directory, fileName));
+
+    LuceneException finally;
+    try {
+        for (HashMap< String, Collection<int64_t> >::iterator field = numericFields.begin(); field != numericFields.end(); ++field) {
+            output->addNumeric(field->first, field->second, state->numDocs);
+        }
+        for (HashMap< String, Collection<String> >::iterator field = sortedFields.begin(); field != sortedFields.end(); ++field) {
+            output->addSorted(field->first, field->second, state->numDocs);
+        }
+        output->close();
+    } catch (LuceneException& e) {
+        finally = e;
+    }
+    numericFields.clear();
+    sortedFields.clear();
+    releaseBytes();
+    finally.throwException();
+}
+
+void DocValuesWriter::abort() {
+    SyncLock syncLock(this);
+    numericFields.clear();
+    sortedFields.clear();
+    releaseBytes();
+}
+
+void DocValuesWriter::releaseBytes() {
+    // the DocumentsWriter resets its used bytes after a flush or abort, but the buffers aren't recycled, so
+    // they stop counting as allocated too
+    if (bytesUsed > 0) {
+        DocumentsWriterPtr(_docWriter)->bytesAllocated(-bytesUsed);
+        bytesUsed = 0;
+    }
+}
+
+DocValuesOutput::DocValuesOutput(const DirectoryPtr& directory, const String& fileName) {
+    fields = Collection<String>::newInstance();
+    types = Collection<int32_t>::newInstance();
+    pointers = Collection<int64_t>::newInstance();
+    output = directory->createOutput(fileName);
+    output->writeInt(FORMAT_CURRENT);
+}
+
+DocValuesOutput::~DocValuesOutput() {
+}
+
+void DocValuesOutput::addField(const String& field, int32_t type) {
+    fields.add(field);
+    types.add(type);
+    pointers.add(output->getFilePointer());
+}
+
+void DocValuesOutput::addNumeric(const String& field, Collection<int64_t> values, int32_t numDocs) {
+    int32_t count = std::min(values.size(), numDocs);
+    int64_t minValue = count > 0 ? values[0] : 0;
+    int64_t maxValue = minValue;
+    if (count < numDocs) {
+        // documents without a value read as 0
+        minValue = std::min(minValue, (int64_t)0);
+        maxValue = std::max(maxValue, (int64_t)0);
+    }
+    for (int32_t doc = 0; doc < count; ++doc) {
+        minValue = std::min(minValue, values[doc]);
+        maxValue = std::max(maxValue, values[doc]);
+    }
+
+    PackedIntsPtr deltas(newLucene<PackedInts>(numDocs, PackedInts::bitsRequired((int64_t)((uint64_t)maxValue - (uint64_t)minValue))));
+    for (int32_t doc = 0; doc < numDocs; ++doc) {
+        int64_t value = doc < count ? values[doc] : 0;
+        deltas->set(doc, (int64_t)((uint64_t)value - (uint64_t)minValue));
+    }
+
+    addField(field, DocValuesField::DOC_VALUES_NUMERIC);
+    output->writeLong(minValue);
+    deltas->write(output);
+}
+
+void DocValuesOutput::addSorted(const String& field, Collection<String> values, int32_t numDocs) {
+    int32_t count = std::min(values.size(), numDocs);
+
+    // the unique values, in order, become ordinals 1 and up
+    Collection<String> terms(Collection<String>::newInstance());
+    for (int32_t doc = 0; doc < count; ++doc) {
+        if (!values[doc].empty()) {
+            terms.add(values[doc]);
+        }
+    }
+    std::sort(terms.begin(), terms.end());
+    terms.resize((int32_t)(std::unique(terms.begin(), terms.end()) - terms.begin()));
+
+    ByteArray termBytes(ByteArray::newInstance(1024));
+    PackedIntsPtr termOffsets;
+    {
+        Collection<int32_t> offsets(Collection<int32_t>::newInstance());
+        offsets.add(0);
+        offsets.add(0);
+        int32_t length = 0;
+        for (Collection<String>::iterator term = terms.begin(); term != terms.end(); ++term) {
+            SingleString utf8(StringUtils::toUTF8(*term));
+            if (length + (int32_t)utf8.length() > termBytes.size()) {
+                termBytes.resize(MiscUtils::getNextSize(length + (int32_t)utf8.length()));
+            }
+            MiscUtils::arrayCopy((const uint8_t*)utf8.c_str(), 0, termBytes.get(), length, (int32_t)utf8.length());
+            length += (int32_t)utf8.length();
+            offsets.add(length);
+        }
+        termOffsets = newLucene<PackedInts>(offsets.size(), PackedInts::bitsRequired(length));
+        for (int32_t i = 0; i < offsets.size(); ++i) {
+            termOffsets->set(i, offsets[i]);
+        }
+    }
+
+    PackedIntsPtr order(newLucene<PackedInts>(numDocs, PackedInts::bitsRequired(terms.size())));
+    for (int32_t doc = 0; doc < count; ++doc) {
+        if (!values[doc].empty()) {
+            order->set(doc, (int32_t)(std::lower_bound(terms.begin(), terms.end(), values[doc]) - terms.begin()) + 1);
+        }
+    }
+
+    addField(field, DocValuesField::DOC_VALUES_SORTED);
+    int32_t length = (int32_t)termOffsets->get(termOffsets->size() - 1);
+    output->writeVInt(length);
+    output->writeBytes(termBytes.get(), length);
+    termOffsets->write(output);
+    order->write(output);
+}
+
+void DocValuesOutput::close() {
+    int64_t directoryPointer = output->getFilePointer();
+    output->writeVInt(fields.size());
+    for (int32_t i = 0; i < fields.size(); ++i) {
+        output->writeString(fields[i]);
+        output->writeByte((uint8_t)types[i]);
+        output->writeLong(pointers[i]);
+    }
+    output->writeLong(directoryPointer);
+    output->close();
+}
+
+}
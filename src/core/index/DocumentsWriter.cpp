@@ -42,9 +42,6 @@
 
 namespace Lucene {
 
-/// Max # ThreadState instances; if there are more threads than this they share ThreadStates
-const int32_t DocumentsWriter::MAX_THREAD_STATE = 5;
-
 /// Coarse estimates used to measure RAM usage of buffered deletes
 const int32_t DocumentsWriter::OBJECT_HEADER_BYTES = 8;
 #ifdef LPP_BUILD_64
@@ -136,6 +133,8 @@ void DocumentsWriter::initialize() {
     freeTrigger = (int64_t)(IndexWriter::DEFAULT_RAM_BUFFER_SIZE_MB * 1024.0 * 1024.0 * 1.05);
     freeLevel = (int64_t)(IndexWriter::DEFAULT_RAM_BUFFER_SIZE_MB * 1024.0 * 1024.0 * 0.95);
     maxBufferedDocs = IndexWriter::DEFAULT_MAX_BUFFERED_DOCS;
+    maxThreadStates = IndexWriter::DEFAULT_MAX_THREAD_STATES;
+    storedFieldsChunkSize = 0;
     flushedDocCount = 0;
     closed = false;
     waitQueue = newLucene<WaitQueue>(shared_from_this());
@@ -241,6 +240,31 @@ int32_t DocumentsWriter::getMaxBufferedDocs() {
     return maxBufferedDocs;
 }
 
+void DocumentsWriter::setMaxThreadStates(int32_t maxThreadStates) {
+    SyncLock syncLock(this);
+    this->maxThreadStates = maxThreadStates;
+}
+
+int32_t DocumentsWriter::getMaxThreadStates() {
+    SyncLock syncLock(this);
+    return maxThreadStates;
+}
+
+int32_t DocumentsWriter::getNumThreadStates() {
+    SyncLock syncLock(this);
+    return threadStates.size();
+}
+
+void DocumentsWriter::setStoredFieldsChunkSize(int32_t chunkSize) {
+    SyncLock syncLock(this);
+    storedFieldsChunkSize = chunkSize;
+}
+
+int32_t DocumentsWriter::getStoredFieldsChunkSize() {
+    SyncLock syncLock(this);
+    return storedFieldsChunkSize;
+}
+
 String DocumentsWriter::getSegment() {
     return segment;
 }
@@ -580,7 +604,7 @@ DocumentsWriterThreadStatePtr DocumentsWriter::getThreadState(const DocumentPtr&
                 minThreadState = *threadState;
             }
         }
-        if (minThreadState && (minThreadState->numThreads == 0 || threadStates.size() >= MAX_THREAD_STATE)) {
+        if (minThreadState && (minThreadState->numThreads == 0 || threadStates.size() >= maxThreadStates)) {
             state = minThreadState;
             ++state->numThreads;
         } else {
@@ -734,11 +758,11 @@ MapTermNum DocumentsWriter::getBufferedDeleteTerms() {
 
 void DocumentsWriter::remapDeletes(const SegmentInfosPtr& infos, Collection< Collection<int32_t> > docMaps, Collection<int32_t> delCounts, const OneMergePtr& merge, int32_t mergeDocCount) {
     SyncLock syncLock(this);
-    if (!docMaps) {
-        // The merged segments had no deletes so docIDs did not change and we have nothing to do
+    MergeDocIDRemapperPtr mapper(newLucene<MergeDocIDRemapper>(infos, docMaps, delCounts, merge, mergeDocCount));
+    if (!mapper->changesDocIDs()) {
+        // The merged segments had no deletes and were adjacent, so docIDs did not change and we have nothing to do
         return;
     }
-    MergeDocIDRemapperPtr mapper(newLucene<MergeDocIDRemapper>(infos, docMaps, delCounts, merge, mergeDocCount));
     deletesInRAM->remap(mapper, infos, docMaps, delCounts, merge, mergeDocCount);
     deletesFlushed->remap(mapper, infos, docMaps, delCounts, merge, mergeDocCount);
     flushedDocCount -= mapper->docShift;
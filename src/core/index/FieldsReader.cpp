@@ -6,6 +6,7 @@
 
 #include "LuceneInc.h"
 #include "FieldsReader.h"
+#include "_FieldsReader.h"
 #include "BufferedIndexInput.h"
 #include "IndexFileNames.h"
 #include "FieldsWriter.h"
@@ -16,6 +17,7 @@
 #include "Document.h"
 #include "Field.h"
 #include "CompressionTools.h"
+#include "LZ4.h"
 #include "MiscUtils.h"
 #include "StringUtils.h"
 #include "VariantUtils.h"
@@ -37,6 +39,7 @@ FieldsReader::FieldsReader(const FieldInfosPtr& fieldInfos, int32_t numTotalDocs
     this->cloneableIndexStream = cloneableIndexStream;
     fieldsStream = boost::dynamic_pointer_cast<IndexInput>(cloneableFieldsStream->clone());
     indexStream = boost::dynamic_pointer_cast<IndexInput>(cloneableIndexStream->clone());
+    openChunks();
 }
 
 FieldsReader::FieldsReader(const DirectoryPtr& d, const String& segment, const FieldInfosPtr& fn) {
@@ -82,6 +85,7 @@ void FieldsReader::ConstructReader(const DirectoryPtr& d, const String& segment,
         }
 
         fieldsStream = boost::dynamic_pointer_cast<IndexInput>(cloneableFieldsStream->clone());
+        openChunks();
 
         int64_t indexSize = cloneableIndexStream->length() - formatSize;
 
@@ -127,6 +131,9 @@ void FieldsReader::close() {
         if (fieldsStream) {
             fieldsStream->close();
         }
+        if (chunksStream) {
+            chunksStream->close();
+        }
         if (isOriginal) {
             if (cloneableFieldsStream) {
                 cloneableFieldsStream->close();
@@ -158,10 +165,80 @@ bool FieldsReader::canReadRawDocs() {
     return (format >= FieldsWriter::FORMAT_LUCENE_3_0_NO_COMPRESSED_FIELDS);
 }
 
+bool FieldsReader::isChunked() {
+    return chunkInput.get() != NULL;
+}
+
+void FieldsReader::openChunks() {
+    chunkPointer = -1;
+    chunkDataPointer = 0;
+    chunkDocBase = 0;
+    chunkNumDocs = 0;
+    chunkCompressedLength = 0;
+    chunkDecompressed = false;
+    if (format >= FieldsWriter::FORMAT_CHUNKED_COMPRESSED) {
+        chunksStream = fieldsStream;
+        chunkInput = newLucene<FieldsChunkInput>();
+        fieldsStream = chunkInput;
+    }
+}
+
+void FieldsReader::readChunkHeader(int64_t pointer) {
+    if (pointer == chunkPointer) {
+        chunksStream->seek(chunkDataPointer);
+        return;
+    }
+    chunkPointer = -1;
+    chunkDecompressed = false;
+    chunksStream->seek(pointer);
+    chunkDocBase = chunksStream->readVInt();
+    chunkNumDocs = chunksStream->readVInt();
+    if (!chunkStarts || chunkStarts.size() <= chunkNumDocs) {
+        chunkStarts = IntArray::newInstance(chunkNumDocs + 1);
+    }
+    chunkStarts[0] = 0;
+    for (int32_t i = 0; i < chunkNumDocs; ++i) {
+        chunkStarts[i + 1] = chunkStarts[i] + chunksStream->readVInt();
+    }
+    chunkCompressedLength = chunksStream->readVInt();
+    chunkDataPointer = chunksStream->getFilePointer();
+    chunkPointer = pointer;
+}
+
+void FieldsReader::loadChunk(int64_t pointer) {
+    if (pointer == chunkPointer && chunkDecompressed) {
+        return;
+    }
+    readChunkHeader(pointer);
+    if (!compressedChunk || compressedChunk.size() < chunkCompressedLength) {
+        compressedChunk = ByteArray::newInstance(chunkCompressedLength);
+    }
+    chunksStream->readBytes(compressedChunk.get(), 0, chunkCompressedLength);
+    int32_t length = chunkStarts[chunkNumDocs];
+    int32_t decompressedLength = 0;
+    try {
+        decompressedLength = LZ4::decompress(compressedChunk.get(), chunkCompressedLength, chunkInput->reset(length), length);
+    } catch (CompressionException& e) {
+        boost::throw_exception(CorruptIndexException(L"stored fields chunk at " + StringUtils::toString(pointer) + L" is corrupt: " + e.getError()));
+    }
+    if (decompressedLength != length) {
+        boost::throw_exception(CorruptIndexException(L"stored fields chunk at " + StringUtils::toString(pointer) + L" decompressed to " +
+                               StringUtils::toString(decompressedLength) + L" bytes, expected " + StringUtils::toString(length)));
+    }
+    chunkDecompressed = true;
+}
+
 DocumentPtr FieldsReader::doc(int32_t n, const FieldSelectorPtr& fieldSelector) {
     seekIndex(n);
     int64_t position = indexStream->readLong();
-    fieldsStream->seek(position);
+    if (chunkInput) {
+        loadChunk(position);
+        int32_t chunkDoc = n + docStoreOffset - chunkDocBase;
+        BOOST_ASSERT(chunkDoc >= 0 && chunkDoc < chunkNumDocs);
+        fieldsStream->seek(chunkStarts[chunkDoc]);
+    } else {
+        fieldsStream->seek(position);
+    }
 
     DocumentPtr doc(newLucene<Document>());
     int32_t numFields = fieldsStream->readVInt();
@@ -187,7 +264,12 @@ DocumentPtr FieldsReader::doc(int32_t n, const FieldSelectorPtr& fieldSelector)
             addField(doc, fi, binary, compressed, tokenize);
             break; // Get out of this loop
         } else if (acceptField == FieldSelector::SELECTOR_LAZY_LOAD) {
-            addFieldLazy(doc, fi, binary, compressed, tokenize);
+            // The values of compressed documents are only at hand until the next chunk is loaded
+            if (chunkInput) {
+                addField(doc, fi, binary, compressed, tokenize);
+            } else {
+                addFieldLazy(doc, fi, binary, compressed, tokenize);
+            }
         } else if (acceptField == FieldSelector::SELECTOR_SIZE) {
             skipField(binary, compressed, addFieldSize(doc, fi, binary, compressed));
         } else if (acceptField == FieldSelector::SELECTOR_SIZE_AND_BREAK) {
@@ -478,4 +560,60 @@ ByteArray LazyField::getBinaryValue(ByteArray result) {
     }
 }
 
+FieldsChunkInput::FieldsChunkInput() {
+    bytesLength = 0;
+    position = 0;
+}
+
+FieldsChunkInput::~FieldsChunkInput() {
+}
+
+uint8_t* FieldsChunkInput::reset(int32_t length) {
+    if (!bytes || bytes.size() < length) {
+        bytes = ByteArray::newInstance(MiscUtils::getNextSize(length));
+    }
+    bytesLength = length;
+    position = 0;
+    return bytes.get();
+}
+
+uint8_t FieldsChunkInput::readByte() {
+    if (position >= bytesLength) {
+        boost::throw_exception(IOException(L"Read past EOF"));
+    }
+    return bytes[position++];
+}
+
+void FieldsChunkInput::readBytes(uint8_t* b, int32_t offset, int32_t length) {
+    if (length > bytesLength - position) {
+        boost::throw_exception(IOException(L"Read past EOF"));
+    }
+    MiscUtils::arrayCopy(bytes.get(), position, b, offset, length);
+    position += length;
+}
+
+void FieldsChunkInput::close() {
+}
+
+int64_t FieldsChunkInput::getFilePointer() {
+    return position;
+}
+
+void FieldsChunkInput::seek(int64_t pos) {
+    position = (int32_t)pos;
+}
+
+int64_t FieldsChunkInput::length() {
+    return bytesLength;
+}
+
+LuceneObjectPtr FieldsChunkInput::clone(const LuceneObjectPtr& other) {
+    LuceneObjectPtr clone = IndexInput::clone(other ? other : newLucene<FieldsChunkInput>());
+    FieldsChunkInputPtr cloneInput(boost::dynamic_pointer_cast<FieldsChunkInput>(clone));
+    cloneInput->bytes = bytes;
+    cloneInput->bytesLength = bytesLength;
+    cloneInput->position = position;
+    return cloneInput;
+}
+
 }
@@ -6,14 +6,20 @@
 
 #include "LuceneInc.h"
 #include "FieldsWriter.h"
+#include "FieldsReader.h"
+#include "_FieldsReader.h"
 #include "IndexFileNames.h"
 #include "Directory.h"
 #include "IndexOutput.h"
+#include "RAMFile.h"
+#include "RAMInputStream.h"
 #include "RAMOutputStream.h"
 #include "FieldInfo.h"
 #include "FieldInfos.h"
 #include "Fieldable.h"
 #include "Document.h"
+#include "LZ4.h"
+#include "MiscUtils.h"
 #include "TestPoint.h"
 
 namespace Lucene {
@@ -25,20 +31,33 @@ const uint8_t FieldsWriter::FIELD_IS_COMPRESSED = 0x4;
 const int32_t FieldsWriter::FORMAT = 0; // Original format
 const int32_t FieldsWriter::FORMAT_VERSION_UTF8_LENGTH_IN_BYTES = 1; // Changed strings to UTF8
 const int32_t FieldsWriter::FORMAT_LUCENE_3_0_NO_COMPRESSED_FIELDS = 2; // Lucene 3.0: Removal of compressed fields
+const int32_t FieldsWriter::FORMAT_CHUNKED_COMPRESSED = 3; // Documents compressed together in chunks
 
 // NOTE: if you introduce a new format, make it 1 higher than the current one, and always change this if you
 // switch to a new format!
-const int32_t FieldsWriter::FORMAT_CURRENT = FieldsWriter::FORMAT_LUCENE_3_0_NO_COMPRESSED_FIELDS;
+const int32_t FieldsWriter::FORMAT_CURRENT = FieldsWriter::FORMAT_CHUNKED_COMPRESSED;
 
-FieldsWriter::FieldsWriter(const DirectoryPtr& d, const String& segment, const FieldInfosPtr& fn) {
+const int32_t FieldsWriter::MAX_CHUNK_DOCS = 128;
+
+FieldsWriter::FieldsWriter(const DirectoryPtr& d, const String& segment, const FieldInfosPtr& fn, int32_t chunkSize) {
     fieldInfos = fn;
+    this->chunkSize = chunkSize;
+    chunkDocBase = 0;
+    if (chunkSize > 0) {
+        chunkFile = newLucene<RAMFile>();
+        chunkBuffer = newLucene<RAMOutputStream>(chunkFile);
+        chunkDocEnds = Collection<int32_t>::newInstance();
+    }
+
+    // Documents are only written in chunks when asked to, so that the files stay readable by older versions
+    int32_t format = chunkSize > 0 ? FORMAT_CHUNKED_COMPRESSED : FORMAT_LUCENE_3_0_NO_COMPRESSED_FIELDS;
 
     bool success = false;
     String fieldsName(segment + L"." + IndexFileNames::FIELDS_EXTENSION());
     LuceneException finally;
     try {
         fieldsStream = d->createOutput(fieldsName);
-        fieldsStream->writeInt(FORMAT_CURRENT);
+        fieldsStream->writeInt(format);
         success = true;
     } catch (LuceneException& e) {
         finally = e;
@@ -57,7 +76,7 @@ FieldsWriter::FieldsWriter(const DirectoryPtr& d, const String& segment, const F
     String indexName(segment + L"." + IndexFileNames::FIELDS_INDEX_EXTENSION());
     try {
         indexStream = d->createOutput(indexName);
-        indexStream->writeInt(FORMAT_CURRENT);
+        indexStream->writeInt(format);
         success = true;
     } catch (LuceneException& e) {
         finally = e;
@@ -81,6 +100,8 @@ FieldsWriter::FieldsWriter(const IndexOutputPtr& fdx, const IndexOutputPtr& fdt,
     fieldsStream = fdt;
     indexStream = fdx;
     doClose = false;
+    chunkSize = 0;
+    chunkDocBase = 0;
 }
 
 FieldsWriter::~FieldsWriter() {
@@ -93,16 +114,71 @@ void FieldsWriter::setFieldsStream(const IndexOutputPtr& stream) {
 void FieldsWriter::flushDocument(int32_t numStoredFields, const RAMOutputStreamPtr& buffer) {
     TestScope testScope(L"FieldsWriter", L"flushDocument");
     indexStream->writeLong(fieldsStream->getFilePointer());
-    fieldsStream->writeVInt(numStoredFields);
-    buffer->writeTo(fieldsStream);
+    if (chunkBuffer) {
+        chunkBuffer->writeVInt(numStoredFields);
+        buffer->writeTo(chunkBuffer);
+        finishChunkDocument();
+    } else {
+        fieldsStream->writeVInt(numStoredFields);
+        buffer->writeTo(fieldsStream);
+    }
 }
 
 void FieldsWriter::skipDocument() {
     indexStream->writeLong(fieldsStream->getFilePointer());
-    fieldsStream->writeVInt(0);
+    if (chunkBuffer) {
+        chunkBuffer->writeVInt(0);
+        finishChunkDocument();
+    } else {
+        fieldsStream->writeVInt(0);
+    }
+}
+
+void FieldsWriter::finishChunkDocument() {
+    int32_t end = (int32_t)chunkBuffer->getFilePointer();
+    chunkDocEnds.add(end);
+    if (end >= chunkSize || chunkDocEnds.size() >= MAX_CHUNK_DOCS) {
+        flushChunk();
+    }
+}
+
+void FieldsWriter::flushChunk() {
+    int32_t numDocs = chunkDocEnds.size();
+    if (numDocs == 0) {
+        return;
+    }
+    int32_t length = chunkDocEnds[numDocs - 1];
+    chunkBuffer->flush();
+    if (!chunkBytes || chunkBytes.size() < length) {
+        chunkBytes = ByteArray::newInstance(MiscUtils::getNextSize(length));
+    }
+    newLucene<RAMInputStream>(chunkFile)->readBytes(chunkBytes.get(), 0, length);
+    int32_t maxCompressedLength = LZ4::maxCompressedLength(length);
+    if (!compressedBytes || compressedBytes.size() < maxCompressedLength) {
+        compressedBytes = ByteArray::newInstance(MiscUtils::getNextSize(maxCompressedLength));
+    }
+    int32_t compressedLength = LZ4::compress(chunkBytes.get(), length, compressedBytes.get());
+
+    // Every document of the chunk points at its header in the index stream
+    fieldsStream->writeVInt(chunkDocBase);
+    fieldsStream->writeVInt(numDocs);
+    int32_t start = 0;
+    for (int32_t i = 0; i < numDocs; ++i) {
+        fieldsStream->writeVInt(chunkDocEnds[i] - start);
+        start = chunkDocEnds[i];
+    }
+    fieldsStream->writeVInt(compressedLength);
+    fieldsStream->writeBytes(compressedBytes.get(), compressedLength);
+
+    chunkDocBase += numDocs;
+    chunkDocEnds.clear();
+    chunkBuffer->reset();
 }
 
 void FieldsWriter::flush() {
+    if (chunkBuffer) {
+        flushChunk();
+    }
     indexStream->flush();
     fieldsStream->flush();
 }
@@ -110,11 +186,20 @@ void FieldsWriter::flush() {
 void FieldsWriter::close() {
     if (doClose) {
         LuceneException finally;
+        if (chunkBuffer && fieldsStream && indexStream) {
+            try {
+                flushChunk();
+            } catch (LuceneException& e) {
+                finally = e;
+            }
+        }
         if (fieldsStream) {
             try {
                 fieldsStream->close();
             } catch (LuceneException& e) {
-                finally = e;
+                if (finally.isNull()) { // throw first exception hit
+                    finally = e;
+                }
             }
             fieldsStream.reset();
         }
@@ -133,7 +218,11 @@ void FieldsWriter::close() {
 }
 
 void FieldsWriter::writeField(const FieldInfoPtr& fi, const FieldablePtr& field) {
-    fieldsStream->writeVInt(fi->number);
+    writeField(fieldsStream, fi, field);
+}
+
+void FieldsWriter::writeField(const IndexOutputPtr& out, const FieldInfoPtr& fi, const FieldablePtr& field) {
+    out->writeVInt(fi->number);
     uint8_t bits = 0;
     if (field->isTokenized()) {
         bits |= FIELD_IS_TOKENIZED;
@@ -142,21 +231,29 @@ void FieldsWriter::writeField(const FieldInfoPtr& fi, const FieldablePtr& field)
         bits |= FIELD_IS_BINARY;
     }
 
-    fieldsStream->writeByte(bits);
+    out->writeByte(bits);
 
     if (field->isBinary()) {
         ByteArray data(field->getBinaryValue());
         int32_t len = field->getBinaryLength();
         int32_t offset = field->getBinaryOffset();
 
-        fieldsStream->writeVInt(len);
-        fieldsStream->writeBytes(data.get(), offset, len);
+        out->writeVInt(len);
+        out->writeBytes(data.get(), offset, len);
     } else {
-        fieldsStream->writeString(field->stringValue());
+        out->writeString(field->stringValue());
     }
 }
 
 void FieldsWriter::addRawDocuments(const IndexInputPtr& stream, Collection<int32_t> lengths, int32_t numDocs) {
+    if (chunkBuffer) {
+        for (int32_t i = 0; i < numDocs; ++i) {
+            indexStream->writeLong(fieldsStream->getFilePointer());
+            chunkBuffer->copyBytes(stream, lengths[i]);
+            finishChunkDocument();
+        }
+        return;
+    }
     int64_t position = fieldsStream->getFilePointer();
     int64_t start = position;
     for (int32_t i = 0; i < numDocs; ++i) {
@@ -167,8 +264,52 @@ void FieldsWriter::addRawDocuments(const IndexInputPtr& stream, Collection<int32
     BOOST_ASSERT(fieldsStream->getFilePointer() == position);
 }
 
+void FieldsWriter::addDocuments(const FieldsReaderPtr& reader, int32_t startDocID, int32_t numDocs) {
+    BOOST_ASSERT(reader->isChunked());
+    int32_t endDocID = startDocID + numDocs;
+    for (int32_t docID = startDocID; docID < endDocID;) {
+        reader->seekIndex(docID);
+        int64_t pointer = reader->indexStream->readLong();
+        reader->readChunkHeader(pointer);
+        int32_t chunkStart = reader->chunkDocBase - reader->docStoreOffset;
+        int32_t chunkEnd = chunkStart + reader->chunkNumDocs;
+        if (chunkBuffer && chunkStart == docID && chunkEnd <= endDocID) {
+            // The whole chunk is copied, so there's no need to decompress it
+            flushChunk();
+            int64_t position = fieldsStream->getFilePointer();
+            for (int32_t i = 0; i < reader->chunkNumDocs; ++i) {
+                indexStream->writeLong(position);
+            }
+            fieldsStream->writeVInt(chunkDocBase);
+            fieldsStream->writeVInt(reader->chunkNumDocs);
+            for (int32_t i = 0; i < reader->chunkNumDocs; ++i) {
+                fieldsStream->writeVInt(reader->chunkStarts[i + 1] - reader->chunkStarts[i]);
+            }
+            fieldsStream->writeVInt(reader->chunkCompressedLength);
+            fieldsStream->copyBytes(reader->chunksStream, reader->chunkCompressedLength);
+            chunkDocBase += reader->chunkNumDocs;
+            docID = chunkEnd;
+        } else {
+            reader->loadChunk(pointer);
+            uint8_t* bytes = reader->chunkInput->bytes.get();
+            for (int32_t end = std::min(chunkEnd, endDocID); docID < end; ++docID) {
+                int32_t start = reader->chunkStarts[docID - chunkStart];
+                int32_t length = reader->chunkStarts[docID - chunkStart + 1] - start;
+                indexStream->writeLong(fieldsStream->getFilePointer());
+                if (chunkBuffer) {
+                    chunkBuffer->writeBytes(bytes, start, length);
+                    finishChunkDocument();
+                } else {
+                    fieldsStream->writeBytes(bytes, start, length);
+                }
+            }
+        }
+    }
+}
+
 void FieldsWriter::addDocument(const DocumentPtr& doc) {
     indexStream->writeLong(fieldsStream->getFilePointer());
+    IndexOutputPtr out(chunkBuffer ? chunkBuffer : fieldsStream);
 
     int32_t storedCount = 0;
     Collection<FieldablePtr> fields(doc->getFields());
@@ -177,13 +318,17 @@ void FieldsWriter::addDocument(const DocumentPtr& doc) {
             ++storedCount;
         }
     }
-    fieldsStream->writeVInt(storedCount);
+    out->writeVInt(storedCount);
 
     for (Collection<FieldablePtr>::iterator field = fields.begin(); field != fields.end(); ++field) {
         if ((*field)->isStored()) {
-            writeField(fieldInfos->fieldInfo((*field)->name()), *field);
+            writeField(out, fieldInfos->fieldInfo((*field)->name()), *field);
         }
     }
+
+    if (chunkBuffer) {
+        finishChunkDocument();
+    }
 }
 
 }
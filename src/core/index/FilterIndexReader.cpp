@@ -70,6 +70,16 @@ void FilterIndexReader::doUndeleteAll() {
     in->undeleteAll();
 }
 
+PackedValuesPtr FilterIndexReader::getNumericDocValues(const String& field) {
+    ensureOpen();
+    return in->getNumericDocValues(field);
+}
+
+PackedStringIndexPtr FilterIndexReader::getSortedDocValues(const String& field) {
+    ensureOpen();
+    return in->getSortedDocValues(field);
+}
+
 bool FilterIndexReader::hasNorms(const String& field) {
     ensureOpen();
     return in->hasNorms(field);
@@ -202,6 +212,22 @@ bool FilterTermDocs::skipTo(int32_t target) {
     return in->skipTo(target);
 }
 
+int32_t FilterTermDocs::maxFreq() {
+    return in->maxFreq();
+}
+
+int32_t FilterTermDocs::advanceShallow(int32_t target) {
+    return in->advanceShallow(target);
+}
+
+int32_t FilterTermDocs::blockEnd(int32_t level) {
+    return in->blockEnd(level);
+}
+
+int32_t FilterTermDocs::blockMaxFreq(int32_t level) {
+    return in->blockMaxFreq(level);
+}
+
 void FilterTermDocs::close() {
     in->close();
 }
@@ -26,6 +26,8 @@ namespace Lucene {
 FormatPostingsDocsWriter::FormatPostingsDocsWriter(const SegmentWriteStatePtr& state, const FormatPostingsTermsWriterPtr& parent) {
     this->lastDocID = 0;
     this->df = 0;
+    this->maxFreq = 0;
+    this->blockMaxFreq = 0;
     this->omitTermFreqAndPositions = false;
     this->storePayloads = false;
     this->freqStart = 0;
@@ -68,13 +70,16 @@ FormatPostingsPositionsConsumerPtr FormatPostingsDocsWriter::addDoc(int32_t docI
     }
 
     if ((++df % skipInterval) == 0) {
-        skipListWriter->setSkipData(lastDocID, storePayloads, posWriter->lastPayloadLength);
+        skipListWriter->setSkipData(lastDocID, storePayloads, posWriter->lastPayloadLength, blockMaxFreq);
         skipListWriter->bufferSkip(df);
+        blockMaxFreq = 0;
     }
 
     BOOST_ASSERT(docID < totalNumDocs);
 
     lastDocID = docID;
+    blockMaxFreq = std::max(blockMaxFreq, omitTermFreqAndPositions ? 1 : termDocFreq);
+    maxFreq = std::max(maxFreq, blockMaxFreq);
     if (omitTermFreqAndPositions) {
         out->writeVInt(delta);
     } else if (termDocFreq == 1) {
@@ -90,7 +95,7 @@ FormatPostingsPositionsConsumerPtr FormatPostingsDocsWriter::addDoc(int32_t docI
 void FormatPostingsDocsWriter::finish() {
     int64_t skipPointer = skipListWriter->writeSkip(out);
     FormatPostingsTermsWriterPtr parent(_parent);
-    termInfo->set(df, parent->freqStart, parent->proxStart, (int32_t)(skipPointer - parent->freqStart));
+    termInfo->set(df, parent->freqStart, parent->proxStart, (int32_t)(skipPointer - parent->freqStart), maxFreq);
 
     StringUtils::toUTF8(parent->currentTerm.get() + parent->currentTermStart, parent->currentTerm.size(), utf8);
 
@@ -100,6 +105,8 @@ void FormatPostingsDocsWriter::finish() {
 
     lastDocID = 0;
     df = 0;
+    maxFreq = 0;
+    blockMaxFreq = 0;
 }
 
 void FormatPostingsDocsWriter::close() {
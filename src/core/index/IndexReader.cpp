@@ -181,6 +181,14 @@ bool IndexReader::hasChanges() {
     return _hasChanges;
 }
 
+PackedValuesPtr IndexReader::getNumericDocValues(const String& field) {
+    return PackedValuesPtr();
+}
+
+PackedStringIndexPtr IndexReader::getSortedDocValues(const String& field) {
+    return PackedStringIndexPtr();
+}
+
 bool IndexReader::hasNorms(const String& field) {
     // backward compatible implementation.
     // SegmentReader has an efficient implementation.
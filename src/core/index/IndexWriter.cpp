@@ -57,6 +57,9 @@ const double IndexWriter::DEFAULT_RAM_BUFFER_SIZE_MB = 16.0;
 /// Disabled by default (because IndexWriter flushes by RAM usage by default).
 const int32_t IndexWriter::DEFAULT_MAX_BUFFERED_DELETE_TERMS = IndexWriter::DISABLE_AUTO_FLUSH;
 
+/// Default value is 8.
+const int32_t IndexWriter::DEFAULT_MAX_THREAD_STATES = 8;
+
 /// Default value is 10000.
 const int32_t IndexWriter::DEFAULT_MAX_FIELD_LENGTH = 10000;
 
@@ -156,6 +159,7 @@ void IndexWriter::initialize() {
     mergeScheduler = newLucene<ConcurrentMergeScheduler>();
     similarity = Similarity::getDefault();
     termIndexInterval = DEFAULT_TERM_INDEX_INTERVAL;
+    storedFieldsChunkSize = 0;
     commitLock  = newInstance<Synchronize>();
 
     if (!indexingChain) {
@@ -436,6 +440,21 @@ int32_t IndexWriter::getTermIndexInterval() {
     return termIndexInterval;
 }
 
+void IndexWriter::setStoredFieldsChunkSize(int32_t chunkSize) {
+    ensureOpen();
+    if (chunkSize < 0) {
+        boost::throw_exception(IllegalArgumentException(L"chunkSize must not be negative"));
+    }
+    this->storedFieldsChunkSize = chunkSize;
+    docWriter->setStoredFieldsChunkSize(chunkSize);
+}
+
+int32_t IndexWriter::getStoredFieldsChunkSize() {
+    // We pass false because this method is called by SegmentMerger and DocumentsWriter while we are in the process of closing
+    ensureOpen(false);
+    return storedFieldsChunkSize;
+}
+
 void IndexWriter::setRollbackSegmentInfos(const SegmentInfosPtr& infos) {
     SyncLock syncLock(this);
     rollbackSegmentInfos = boost::dynamic_pointer_cast<SegmentInfos>(infos->clone());
@@ -562,6 +581,22 @@ int32_t IndexWriter::getMaxBufferedDocs() {
     return docWriter->getMaxBufferedDocs();
 }
 
+void IndexWriter::setMaxThreadStates(int32_t maxThreadStates) {
+    ensureOpen();
+    if (maxThreadStates < 1) {
+        boost::throw_exception(IllegalArgumentException(L"maxThreadStates must at least be 1"));
+    }
+    docWriter->setMaxThreadStates(maxThreadStates);
+    if (infoStream) {
+        message(L"setMaxThreadStates " + StringUtils::toString(maxThreadStates));
+    }
+}
+
+int32_t IndexWriter::getMaxThreadStates() {
+    ensureOpen();
+    return docWriter->getMaxThreadStates();
+}
+
 void IndexWriter::setRAMBufferSizeMB(double mb) {
     if (mb > 2048.0) {
         boost::throw_exception(IllegalArgumentException(L"ramBufferSize " + StringUtils::toString(mb) + L" is too large; should be comfortably less than 2048"));
@@ -1056,6 +1091,11 @@ String IndexWriter::newSegmentName() {
     return L"_" + StringUtils::toString(segmentInfos->counter++, StringUtils::CHARACTER_MAX_RADIX);
 }
 
+SetSegmentInfo IndexWriter::getMergingSegments() {
+    SyncLock syncLock(this);
+    return SetSegmentInfo::newInstance(mergingSegments.begin(), mergingSegments.end());
+}
+
 void IndexWriter::optimize() {
     optimize(true);
 }
@@ -2275,31 +2315,22 @@ int32_t IndexWriter::numRamDocs() {
     return docWriter->getNumDocsInRAM();
 }
 
-int32_t IndexWriter::ensureContiguousMerge(const OneMergePtr& merge) {
-    int32_t first = segmentInfos->find(merge->segments->info(0));
-    if (first == -1) {
-        boost::throw_exception(MergeException(L"Could not find segment " + merge->segments->info(0)->name + L" in current index " + segString()));
-    }
-
-    int32_t numSegments = segmentInfos->size();
-    int32_t numSegmentsToMerge = merge->segments->size();
-
-    for (int32_t i = 0; i < numSegmentsToMerge; ++i) {
+int32_t IndexWriter::ensureValidMerge(const OneMergePtr& merge) {
+    int32_t first = -1;
+    for (int32_t i = 0; i < merge->segments->size(); ++i) {
         SegmentInfoPtr info(merge->segments->info(i));
-
-        if (first + i >= numSegments || !segmentInfos->info(first + i)->equals(info)) {
-            if (!segmentInfos->contains(info)) {
-                boost::throw_exception(MergeException(L"MergePolicy selected a segment (" + info->name + L") that is not in the current index " + segString()));
-            } else {
-                boost::throw_exception(MergeException(L"MergePolicy selected non-contiguous segments to merge (" + merge->segString(directory) + L" vs " + segString() + L"), which IndexWriter (currently) cannot handle"));
-            }
+        int32_t pos = segmentInfos->find(info);
+        if (pos == -1) {
+            boost::throw_exception(MergeException(L"MergePolicy selected a segment (" + info->name + L") that is not in the current index " + segString()));
+        }
+        if (first == -1 || pos < first) {
+            first = pos;
         }
     }
-
     return first;
 }
 
-void IndexWriter::commitMergedDeletes(const OneMergePtr& merge, const SegmentReaderPtr& mergeReader) {
+void IndexWriter::commitMergedDeletes(const OneMergePtr& merge, const SegmentMergerPtr& merger, const SegmentReaderPtr& mergeReader) {
     SyncLock syncLock(this);
     BOOST_ASSERT(testPoint(L"startCommitMergeDeletes"));
 
@@ -2313,11 +2344,15 @@ void IndexWriter::commitMergedDeletes(const OneMergePtr& merge, const SegmentRea
     int32_t docUpto = 0;
     int32_t delCount = 0;
 
+    // For a sorted merge, the merged documents of each segment are found through the doc maps
+    Collection< Collection<int32_t> > docMaps(merge->sort ? merger->getDocMaps() : Collection< Collection<int32_t> >());
+
     for (int32_t i = 0; i < sourceSegments->size(); ++i) {
         SegmentInfoPtr info(sourceSegments->info(i));
         int32_t docCount = info->docCount;
         SegmentReaderPtr previousReader(merge->readersClone[i]);
         SegmentReaderPtr currentReader(merge->readers[i]);
+        int32_t docBase = docUpto;
         if (previousReader->hasDeletions()) {
             // There were deletes on this segment when the merge started.  The merge has collapsed away those deletes,
             // but if new deletes were flushed since the merge started, we must now carefully keep any newly flushed
@@ -2330,7 +2365,7 @@ void IndexWriter::commitMergedDeletes(const OneMergePtr& merge, const SegmentRea
                         BOOST_ASSERT(currentReader->isDeleted(j));
                     } else {
                         if (currentReader->isDeleted(j)) {
-                            mergeReader->doDelete(docUpto);
+                            mergeReader->doDelete(docMaps ? docBase + docMaps[i][j] : docUpto);
                             ++delCount;
                         }
                         ++docUpto;
@@ -2343,7 +2378,7 @@ void IndexWriter::commitMergedDeletes(const OneMergePtr& merge, const SegmentRea
             // This segment had no deletes before but now it does
             for (int32_t j = 0; j < docCount; ++j) {
                 if (currentReader->isDeleted(j)) {
-                    mergeReader->doDelete(docUpto);
+                    mergeReader->doDelete(docMaps ? docBase + docMaps[i][j] : docUpto);
                     ++delCount;
                 }
                 ++docUpto;
@@ -2383,9 +2418,9 @@ bool IndexWriter::commitMerge(const OneMergePtr& merge, const SegmentMergerPtr&
         return false;
     }
 
-    int32_t start = ensureContiguousMerge(merge);
+    int32_t start = ensureValidMerge(merge);
 
-    commitMergedDeletes(merge, mergedReader);
+    commitMergedDeletes(merge, merger, mergedReader);
     docWriter->remapDeletes(segmentInfos, merger->getDocMaps(), merger->getDelCounts(), merge, mergedDocCount);
 
     // If the doc store we are using has been closed and is in now compound format (but wasn't when we started),
@@ -2394,7 +2429,12 @@ bool IndexWriter::commitMerge(const OneMergePtr& merge, const SegmentMergerPtr&
 
     merge->info->setHasProx(merger->hasProx());
 
-    segmentInfos->remove(start, start + merge->segments->size());
+    // The merged segment takes the place of the first merged segment, and the segments in between keep their order
+    for (int32_t i = segmentInfos->size() - 1; i >= start; --i) {
+        if (merge->segments->contains(segmentInfos->info(i))) {
+            segmentInfos->remove(i);
+        }
+    }
     BOOST_ASSERT(!segmentInfos->contains(merge->info));
     segmentInfos->add(start, merge->info);
 
@@ -2524,7 +2564,7 @@ bool IndexWriter::registerMerge(const OneMergePtr& merge) {
         }
     }
 
-    ensureContiguousMerge(merge);
+    ensureValidMerge(merge);
 
     pendingMerges.add(merge);
 
@@ -2644,6 +2684,11 @@ void IndexWriter::_mergeInit(const OneMergePtr& merge) {
         }
     }
 
+    // A sorted merge reorders the documents, so it must write its own doc stores
+    if (merge->sort) {
+        mergeDocStores = true;
+    }
+
     // if a mergedSegmentWarmer is installed, we must merge the doc stores because we will open a full
     // SegmentReader on the merged segment
     if (!mergeDocStores && mergedSegmentWarmer && !currentDocStoreSegment.empty() && !lastDocStoreSegment.empty() && lastDocStoreSegment == currentDocStoreSegment) {
@@ -2678,6 +2723,7 @@ void IndexWriter::_mergeInit(const OneMergePtr& merge) {
 
     // Bind a new segment name here so even with ConcurrentMergePolicy we keep deterministic segment names.
     merge->info = newLucene<SegmentInfo>(newSegmentName(), 0, directory, false, true, docStoreOffset, docStoreSegment, docStoreIsCompoundFile, false);
+    merge->info->setIndexSort(merge->sort);
 
     MapStringString details(MapStringString::newInstance());
     details.put(L"optimize", StringUtils::toString(merge->optimize));
@@ -2820,8 +2866,9 @@ int32_t IndexWriter::mergeMiddle(const OneMergePtr& merge) {
         for (int32_t i = 0; i < numSegments; ++i) {
             SegmentInfoPtr info(sourceSegments->info(i));
 
-            // Hold onto the "live" reader; we will use this to commit merged deletes
-            merge->readers[i] = readerPool->get(info, merge->mergeDocStores, MERGE_READ_BUFFER_SIZE, -1);
+            // Hold onto the "live" reader; we will use this to commit merged deletes.  A sorted merge reads the
+            // sort values through the FieldCache, which needs the terms index
+            merge->readers[i] = readerPool->get(info, merge->mergeDocStores, MERGE_READ_BUFFER_SIZE, merge->sort ? readerTermsIndexDivisor : -1);
             SegmentReaderPtr reader(merge->readers[i]);
 
             // We clone the segment readers because other deletes may come in while we're merging so we need readers that will not change
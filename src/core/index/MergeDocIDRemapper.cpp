@@ -14,34 +14,63 @@ namespace Lucene {
 
 MergeDocIDRemapper::MergeDocIDRemapper(const SegmentInfosPtr& infos, Collection< Collection<int32_t> > docMaps, Collection<int32_t> delCounts, const OneMergePtr& merge, int32_t mergedDocCount) {
     this->docMaps = docMaps;
-    SegmentInfoPtr firstSegment(merge->segments->info(0));
-    int32_t i = 0;
-    this->minDocID = 0;
-    while (true) {
+    int32_t numMerged = merge->segments->size();
+
+    // Start of each merged segment's documents within the merged segment
+    Collection<int32_t> mergedStarts(Collection<int32_t>::newInstance(numMerged));
+    int32_t numDocs = 0;
+    for (int32_t j = 0; j < numMerged; ++j) {
+        mergedStarts[j] = j == 0 ? 0 : mergedStarts[j - 1] + merge->segments->info(j - 1)->docCount - (delCounts ? delCounts[j - 1] : 0);
+        numDocs += merge->segments->info(j)->docCount;
+    }
+
+    // The merged segments need not be adjacent: the merged segment takes the place of the first of
+    // them and the segments in between follow it, so everything from the first to the last merged
+    // segment is renumbered
+    int32_t numSegments = infos->size();
+    Collection<int32_t> segmentStarts(Collection<int32_t>::newInstance(numSegments));
+    Collection<int32_t> segmentOrds(Collection<int32_t>::newInstance(numSegments));
+    int32_t first = -1;
+    int32_t last = -1;
+    int32_t docStart = 0;
+    for (int32_t i = 0; i < numSegments; ++i) {
         SegmentInfoPtr info(infos->info(i));
-        if (info->equals(firstSegment)) {
-            break;
+        segmentStarts[i] = docStart;
+        segmentOrds[i] = merge->segments->find(info);
+        if (segmentOrds[i] != -1) {
+            if (first == -1) {
+                first = i;
+            }
+            last = i;
         }
-        minDocID += info->docCount;
-        ++i;
+        docStart += info->docCount;
     }
+    BOOST_ASSERT(first != -1);
 
-    int32_t numDocs = 0;
-    for (int32_t j = 0; j < docMaps.size(); ++i, ++j) {
-        numDocs += infos->info(i)->docCount;
-        BOOST_ASSERT(infos->info(i)->equals(merge->segments->info(j)));
-    }
-    this->maxDocID = minDocID + numDocs;
+    this->minDocID = segmentStarts[first];
+    this->maxDocID = segmentStarts[last] + infos->info(last)->docCount;
 
-    starts = Collection<int32_t>::newInstance(docMaps.size());
-    newStarts = Collection<int32_t>::newInstance(docMaps.size());
+    int32_t count = last - first + 1;
+    starts = Collection<int32_t>::newInstance(count);
+    newStarts = Collection<int32_t>::newInstance(count);
+    mergeOrds = Collection<int32_t>::newInstance(count);
+    reordered = false;
 
-    starts[0] = minDocID;
-    newStarts[0] = minDocID;
-    for (i = 1; i < docMaps.size(); ++i) {
-        int32_t lastDocCount = merge->segments->info(i - 1)->docCount;
-        starts[i] = starts[i - 1] + lastDocCount;
-        newStarts[i] = newStarts[i - 1] + lastDocCount - delCounts[i - 1];
+    int32_t newDocStart = minDocID + mergedDocCount;
+    for (int32_t k = 0; k < count; ++k) {
+        int32_t i = first + k;
+        starts[k] = segmentStarts[i];
+        mergeOrds[k] = segmentOrds[i];
+        if (mergeOrds[k] == -1) {
+            newStarts[k] = newDocStart;
+            newDocStart += infos->info(i)->docCount;
+            reordered = true;
+        } else {
+            newStarts[k] = minDocID + mergedStarts[mergeOrds[k]];
+            if (mergeOrds[k] != k) {
+                reordered = true;
+            }
+        }
     }
     this->docShift = numDocs - mergedDocCount;
 
@@ -50,12 +79,16 @@ MergeDocIDRemapper::MergeDocIDRemapper(const SegmentInfosPtr& infos, Collection<
     // deletions ... so we can't make this assert here: BOOST_ASSERT(docShift > 0);
 
     // Make sure it all adds up
-    BOOST_ASSERT(docShift == maxDocID - (newStarts[docMaps.size() - 1] + merge->segments->info(docMaps.size() - 1)->docCount - delCounts[docMaps.size() - 1]));
+    BOOST_ASSERT(docShift == maxDocID - newDocStart);
 }
 
 MergeDocIDRemapper::~MergeDocIDRemapper() {
 }
 
+bool MergeDocIDRemapper::changesDocIDs() {
+    return (docMaps || reordered);
+}
+
 int32_t MergeDocIDRemapper::remap(int32_t oldDocID) {
     if (oldDocID < minDocID) {
         // Unaffected by merge
@@ -65,13 +98,14 @@ int32_t MergeDocIDRemapper::remap(int32_t oldDocID) {
         return oldDocID - docShift;
     } else {
         // Binary search to locate this document & find its new docID
-        Collection<int32_t>::iterator doc = std::upper_bound(starts.begin(), starts.begin() + docMaps.size(), oldDocID);
-        int32_t docMap = std::distance(starts.begin(), doc) - 1;
+        Collection<int32_t>::iterator doc = std::upper_bound(starts.begin(), starts.end(), oldDocID);
+        int32_t segment = std::distance(starts.begin(), doc) - 1;
+        int32_t ord = mergeOrds[segment];
 
-        if (docMaps[docMap]) {
-            return newStarts[docMap] + docMaps[docMap][oldDocID - starts[docMap]];
+        if (ord != -1 && docMaps && docMaps[ord]) {
+            return newStarts[segment] + docMaps[ord][oldDocID - starts[segment]];
         } else {
-            return newStarts[docMap] + oldDocID - starts[docMap];
+            return newStarts[segment] + oldDocID - starts[segment];
         }
     }
 }
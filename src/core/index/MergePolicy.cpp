@@ -8,6 +8,7 @@
 #include "MergePolicy.h"
 #include "SegmentInfos.h"
 #include "SegmentInfo.h"
+#include "Sort.h"
 #include "StringUtils.h"
 
 namespace Lucene {
@@ -27,6 +28,7 @@ OneMerge::OneMerge(const SegmentInfosPtr& segments, bool useCompoundFile) {
     isExternal = false;
     maxNumSegmentsOptimize = 0;
     aborted = false;
+    paused = false;
 
     if (segments->empty()) {
         boost::throw_exception(RuntimeException(L"segments must include at least one segment"));
@@ -51,6 +53,7 @@ LuceneException OneMerge::getException() {
 void OneMerge::abort() {
     SyncLock syncLock(this);
     aborted = true;
+    notifyAll(); // wake up the merge if it is paused
 }
 
 bool OneMerge::isAborted() {
@@ -58,11 +61,39 @@ bool OneMerge::isAborted() {
     return aborted;
 }
 
+void OneMerge::setPause(bool paused) {
+    SyncLock syncLock(this);
+    this->paused = paused;
+    if (!paused) {
+        notifyAll();
+    }
+}
+
+bool OneMerge::getPause() {
+    SyncLock syncLock(this);
+    return paused;
+}
+
 void OneMerge::checkAborted(const DirectoryPtr& dir) {
     SyncLock syncLock(this);
     if (aborted) {
         boost::throw_exception(MergeAbortedException(L"merge is aborted: " + segString(dir)));
     }
+    while (paused) {
+        wait(1000);
+        if (aborted) {
+            boost::throw_exception(MergeAbortedException(L"merge is aborted: " + segString(dir)));
+        }
+    }
+}
+
+int32_t OneMerge::totalDocCount() {
+    int32_t total = 0;
+    int32_t numSegments = segments->size();
+    for (int32_t i = 0; i < numSegments; ++i) {
+        total += segments->info(i)->docCount;
+    }
+    return total;
 }
 
 String OneMerge::segString(const DirectoryPtr& dir) {
@@ -83,6 +114,9 @@ String OneMerge::segString(const DirectoryPtr& dir) {
     if (mergeDocStores) {
         buffer << L" [mergeDocStores]";
     }
+    if (sort) {
+        buffer << L" [sort=" << sort->toString() << L"]";
+    }
     return buffer.str();
 }
 
@@ -78,6 +78,14 @@ int32_t MultiLevelSkipListReader::skipTo(int32_t target) {
     return numSkipped[0] - skipInterval[0] - 1;
 }
 
+int32_t MultiLevelSkipListReader::getNumberOfSkipLevels() {
+    return numberOfSkipLevels;
+}
+
+int32_t MultiLevelSkipListReader::getSkipDoc(int32_t level) {
+    return skipDoc[level];
+}
+
 bool MultiLevelSkipListReader::loadNextSkip(int32_t level) {
     // we have to skip, the target document is greater than the current skip list entry
     setLastSkipData(level);
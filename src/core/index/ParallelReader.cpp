@@ -252,6 +252,18 @@ void ParallelReader::getTermFreqVector(int32_t docNumber, const TermVectorMapper
     }
 }
 
+PackedValuesPtr ParallelReader::getNumericDocValues(const String& field) {
+    ensureOpen();
+    MapStringIndexReader::iterator reader = fieldToReader.find(field);
+    return reader == fieldToReader.end() ? PackedValuesPtr() : reader->second->getNumericDocValues(field);
+}
+
+PackedStringIndexPtr ParallelReader::getSortedDocValues(const String& field) {
+    ensureOpen();
+    MapStringIndexReader::iterator reader = fieldToReader.find(field);
+    return reader == fieldToReader.end() ? PackedStringIndexPtr() : reader->second->getSortedDocValues(field);
+}
+
 bool ParallelReader::hasNorms(const String& field) {
     ensureOpen();
     MapStringIndexReader::iterator reader = fieldToReader.find(field);
@@ -14,6 +14,8 @@
 #include "IndexFileNames.h"
 #include "IndexFileNameFilter.h"
 #include "BitVector.h"
+#include "Sort.h"
+#include "SortField.h"
 #include "MiscUtils.h"
 #include "UnicodeUtils.h"
 #include "StringUtils.h"
@@ -125,6 +127,20 @@ SegmentInfo::SegmentInfo(const DirectoryPtr& dir, int32_t format, const IndexInp
         } else {
             diagnostics = MapStringString::newInstance();
         }
+
+        if (format <= SegmentInfos::FORMAT_INDEX_SORT) {
+            int32_t numSortFields = input->readInt();
+            if (numSortFields > 0) {
+                Collection<SortFieldPtr> sortFields(Collection<SortFieldPtr>::newInstance(numSortFields));
+                for (int32_t i = 0; i < numSortFields; ++i) {
+                    String field(input->readString());
+                    int32_t type = input->readInt();
+                    bool reverse = (input->readByte() == 1);
+                    sortFields[i] = newLucene<SortField>(field, type, reverse);
+                }
+                indexSort = newLucene<Sort>(sortFields);
+            }
+        }
     } else {
         delGen = CHECK_DIR;
         isCompoundFile = CHECK_DIR;
@@ -158,6 +174,7 @@ void SegmentInfo::reset(const SegmentInfoPtr& src) {
     isCompoundFile = src->isCompoundFile;
     hasSingleNormFile = src->hasSingleNormFile;
     delCount = src->delCount;
+    indexSort = src->indexSort;
 }
 
 void SegmentInfo::setDiagnostics(MapStringString diagnostics) {
@@ -241,6 +258,7 @@ LuceneObjectPtr SegmentInfo::clone(const LuceneObjectPtr& other) {
     si->docStoreOffset = docStoreOffset;
     si->docStoreSegment = docStoreSegment;
     si->docStoreIsCompoundFile = docStoreIsCompoundFile;
+    si->indexSort = indexSort;
     return si;
 }
 
@@ -412,6 +430,17 @@ void SegmentInfo::write(const IndexOutputPtr& output) {
     output->writeInt(delCount);
     output->writeByte((uint8_t)(hasProx ? 1 : 0));
     output->writeStringStringMap(diagnostics);
+    if (!indexSort) {
+        output->writeInt(0);
+    } else {
+        Collection<SortFieldPtr> sortFields(indexSort->getSort());
+        output->writeInt(sortFields.size());
+        for (Collection<SortFieldPtr>::iterator sortField = sortFields.begin(); sortField != sortFields.end(); ++sortField) {
+            output->writeString((*sortField)->getField());
+            output->writeInt((*sortField)->getType());
+            output->writeByte((uint8_t)((*sortField)->getReverse() ? 1 : 0));
+        }
+    }
 }
 
 void SegmentInfo::setHasProx(bool hasProx) {
@@ -423,6 +452,14 @@ bool SegmentInfo::getHasProx() {
     return hasProx;
 }
 
+void SegmentInfo::setIndexSort(const SortPtr& indexSort) {
+    this->indexSort = indexSort;
+}
+
+SortPtr SegmentInfo::getIndexSort() {
+    return indexSort;
+}
+
 void SegmentInfo::addIfExists(HashSet<String> files, const String& fileName) {
     if (dir->fileExists(fileName)) {
         files.add(fileName);
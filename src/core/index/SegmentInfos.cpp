@@ -52,8 +52,11 @@ const int32_t SegmentInfos::FORMAT_USER_DATA = -8;
 /// This format adds optional per-segment string diagnostics storage, and switches userData to Map
 const int32_t SegmentInfos::FORMAT_DIAGNOSTICS = -9;
 
+/// This format adds the sort of the documents of each segment written sorted by a {@link SortingMergePolicy}.
+const int32_t SegmentInfos::FORMAT_INDEX_SORT = -10;
+
 /// This must always point to the most recent file format.
-const int32_t SegmentInfos::CURRENT_FORMAT = SegmentInfos::FORMAT_DIAGNOSTICS;
+const int32_t SegmentInfos::CURRENT_FORMAT = SegmentInfos::FORMAT_INDEX_SORT;
 
 /// Advanced configuration of retry logic in loading segments_N file.
 int32_t SegmentInfos::defaultGenFileRetryCount = 10;
@@ -15,9 +15,15 @@
 #include "FieldsWriter.h"
 #include "IndexFileNames.h"
 #include "CompoundFileWriter.h"
+#include "DocValuesWriter.h"
+#include "FieldCache.h"
+#include "FieldComparator.h"
+#include "Sort.h"
+#include "SortField.h"
 #include "SegmentReader.h"
 #include "_SegmentReader.h"
 #include "Directory.h"
+#include "RateLimitedDirectory.h"
 #include "TermPositions.h"
 #include "TermVectorsReader.h"
 #include "TermVectorsWriter.h"
@@ -41,12 +47,39 @@ const int32_t SegmentMerger::MAX_RAW_MERGE_DOCS = 4192;
 const uint8_t SegmentMerger::NORMS_HEADER[] = {'N', 'R', 'M', static_cast<uint8_t>(-1) };
 const int32_t SegmentMerger::NORMS_HEADER_LENGTH = 4;
 
+/// Orders documents by their sort values, keeping the order of documents with equal values.
+struct lessSortValues {
+    lessSortValues(Collection<FieldComparatorPtr> comparators, Collection<int32_t> reverseMul) : comparators(comparators), reverseMul(reverseMul) {}
+    inline bool operator()(int32_t first, int32_t second) const {
+        for (int32_t i = 0; i < comparators.size(); ++i) {
+            int32_t c = reverseMul[i] * comparators[i]->compare(first, second);
+            if (c != 0) {
+                return (c < 0);
+            }
+        }
+        return false;
+    }
+    Collection<FieldComparatorPtr> comparators;
+    Collection<int32_t> reverseMul;
+};
+
+/// Orders buffered postings by document.
+struct lessPostingDoc {
+    lessPostingDoc(Collection<int32_t> docs) : docs(docs) {}
+    inline bool operator()(int32_t first, int32_t second) const {
+        return (docs[first] < docs[second]);
+    }
+    Collection<int32_t> docs;
+};
+
 SegmentMerger::SegmentMerger(const DirectoryPtr& dir, const String& name) {
     readers = Collection<IndexReaderPtr>::newInstance();
     termIndexInterval = IndexWriter::DEFAULT_TERM_INDEX_INTERVAL;
+    storedFieldsChunkSize = 0;
     mergedDocs = 0;
     mergeDocStores = false;
     omitTermFreqAndPositions = false;
+    hasDocValues = false;
 
     directory = dir;
     segment = name;
@@ -58,16 +91,23 @@ SegmentMerger::SegmentMerger(const IndexWriterPtr& writer, const String& name, c
     mergedDocs = 0;
     mergeDocStores = false;
     omitTermFreqAndPositions = false;
+    hasDocValues = false;
 
     directory = writer->getDirectory();
     segment = name;
 
     if (merge) {
         checkAbort = newLucene<CheckAbort>(merge, directory);
+        sort = merge->sort;
+        if (merge->rateLimiter) {
+            // only the files written are limited, reading the merged segments isn't
+            directory = newLucene<RateLimitedDirectory>(directory, merge->rateLimiter);
+        }
     } else {
         checkAbort = newLucene<CheckAbortNull>();
     }
     termIndexInterval = writer->getTermIndexInterval();
+    storedFieldsChunkSize = writer->getStoredFieldsChunkSize();
 }
 
 SegmentMerger::~SegmentMerger() {
@@ -95,9 +135,17 @@ int32_t SegmentMerger::merge(bool mergeDocStores) {
     // NOTE: it's important to add calls to checkAbort.work(...) if you make any changes to this method that will spend a lot of time.
     // The frequency of this check impacts how long IndexWriter.close(false) takes to actually stop the threads.
 
+    if (sort) {
+        if (!mergeDocStores) {
+            boost::throw_exception(IllegalStateException(L"a sorted merge must merge the doc stores"));
+        }
+        sortDocs();
+    }
+
     mergedDocs = mergeFields();
     mergeTerms();
     mergeNorms();
+    mergeDocValues();
 
     if (mergeDocStores && fieldInfos->hasVectors()) {
         mergeVectors();
@@ -135,6 +183,10 @@ HashSet<String> SegmentMerger::getMergedFiles() {
         }
     }
 
+    if (hasDocValues) {
+        fileSet.add(segment + L"." + IndexFileNames::DOC_VALUES_EXTENSION());
+    }
+
     // Vector files
     if (fieldInfos->hasVectors() && mergeDocStores) {
         for (HashSet<String>::iterator ext = IndexFileNames::VECTOR_EXTENSIONS().begin(); ext != IndexFileNames::VECTOR_EXTENSIONS().end(); ++ext) {
@@ -198,6 +250,71 @@ void SegmentMerger::setMatchingSegmentReaders() {
     rawDocLengths2 = Collection<int32_t>::newInstance(MAX_RAW_MERGE_DOCS);
 }
 
+void SegmentMerger::sortDocs() {
+    Collection<SortFieldPtr> sortFields(sort->getSort());
+    int32_t numReaders = readers.size();
+    int32_t numDocs = 0;
+    for (Collection<IndexReaderPtr>::iterator reader = readers.begin(); reader != readers.end(); ++reader) {
+        numDocs += (*reader)->numDocs();
+    }
+
+    // Copy the sort values of the live documents into one slot per document, in reader order
+    Collection<FieldComparatorPtr> comparators(Collection<FieldComparatorPtr>::newInstance(sortFields.size()));
+    Collection<int32_t> reverseMul(Collection<int32_t>::newInstance(sortFields.size()));
+    for (int32_t i = 0; i < sortFields.size(); ++i) {
+        comparators[i] = sortFields[i]->getComparator(numDocs, i);
+        reverseMul[i] = sortFields[i]->getReverse() ? -1 : 1;
+    }
+    Collection<int32_t> slotReaders(Collection<int32_t>::newInstance(numDocs));
+    Collection<int32_t> slotDocs(Collection<int32_t>::newInstance(numDocs));
+    int32_t slot = 0;
+    for (int32_t i = 0; i < numReaders; ++i) {
+        IndexReaderPtr reader(readers[i]);
+        for (Collection<FieldComparatorPtr>::iterator comparator = comparators.begin(); comparator != comparators.end(); ++comparator) {
+            (*comparator)->setNextReader(reader, slot);
+        }
+        int32_t maxDoc = reader->maxDoc();
+        for (int32_t j = 0; j < maxDoc; ++j) {
+            if (!reader->isDeleted(j)) {
+                for (Collection<FieldComparatorPtr>::iterator comparator = comparators.begin(); comparator != comparators.end(); ++comparator) {
+                    (*comparator)->copy(slot, j);
+                }
+                slotReaders[slot] = i;
+                slotDocs[slot++] = j;
+            }
+        }
+        checkAbort->work(maxDoc);
+    }
+
+    Collection<int32_t> order(Collection<int32_t>::newInstance(numDocs));
+    for (int32_t i = 0; i < numDocs; ++i) {
+        order[i] = i;
+    }
+    std::stable_sort(order.begin(), order.end(), lessSortValues(comparators, reverseMul));
+
+    // Doc maps are relative to the first document of each reader in the merged segment, as for deletions
+    docMaps = Collection< Collection<int32_t> >::newInstance(numReaders);
+    delCounts = Collection<int32_t>::newInstance(numReaders);
+    Collection<int32_t> bases(Collection<int32_t>::newInstance(numReaders));
+    int32_t base = 0;
+    for (int32_t i = 0; i < numReaders; ++i) {
+        int32_t maxDoc = readers[i]->maxDoc();
+        docMaps[i] = Collection<int32_t>::newInstance(maxDoc);
+        MiscUtils::arrayFill(docMaps[i].begin(), 0, maxDoc, -1);
+        delCounts[i] = maxDoc - readers[i]->numDocs();
+        bases[i] = base;
+        base += readers[i]->numDocs();
+    }
+    sortedReaders = Collection<int32_t>::newInstance(numDocs);
+    sortedDocs = Collection<int32_t>::newInstance(numDocs);
+    for (int32_t doc = 0; doc < numDocs; ++doc) {
+        int32_t reader = slotReaders[order[doc]];
+        sortedReaders[doc] = reader;
+        sortedDocs[doc] = slotDocs[order[doc]];
+        docMaps[reader][sortedDocs[doc]] = doc - bases[reader];
+    }
+}
+
 int32_t SegmentMerger::mergeFields() {
     if (!mergeDocStores) {
         // When we are not merging by doc stores, their field name -> number mapping are the same.
@@ -237,24 +354,28 @@ int32_t SegmentMerger::mergeFields() {
 
     if (mergeDocStores) {
         // merge field values
-        FieldsWriterPtr fieldsWriter(newLucene<FieldsWriter>(directory, segment, fieldInfos));
+        FieldsWriterPtr fieldsWriter(newLucene<FieldsWriter>(directory, segment, fieldInfos, storedFieldsChunkSize));
 
         LuceneException finally;
         try {
-            int32_t idx = 0;
-            for (Collection<IndexReaderPtr>::iterator reader = readers.begin(); reader != readers.end(); ++reader) {
-                SegmentReaderPtr matchingSegmentReader(matchingSegmentReaders[idx++]);
-                FieldsReaderPtr matchingFieldsReader;
-                if (matchingSegmentReader) {
-                    FieldsReaderPtr fieldsReader(matchingSegmentReader->getFieldsReader());
-                    if (fieldsReader && fieldsReader->canReadRawDocs()) {
-                        matchingFieldsReader = fieldsReader;
+            if (sort) {
+                docCount = copySortedFields(fieldsWriter);
+            } else {
+                int32_t idx = 0;
+                for (Collection<IndexReaderPtr>::iterator reader = readers.begin(); reader != readers.end(); ++reader) {
+                    SegmentReaderPtr matchingSegmentReader(matchingSegmentReaders[idx++]);
+                    FieldsReaderPtr matchingFieldsReader;
+                    if (matchingSegmentReader) {
+                        FieldsReaderPtr fieldsReader(matchingSegmentReader->getFieldsReader());
+                        if (fieldsReader && fieldsReader->canReadRawDocs()) {
+                            matchingFieldsReader = fieldsReader;
+                        }
+                    }
+                    if ((*reader)->hasDeletions()) {
+                        docCount += copyFieldsWithDeletions(fieldsWriter, *reader, matchingFieldsReader);
+                    } else {
+                        docCount += copyFieldsNoDeletions(fieldsWriter, *reader, matchingFieldsReader);
                     }
-                }
-                if ((*reader)->hasDeletions()) {
-                    docCount += copyFieldsWithDeletions(fieldsWriter, *reader, matchingFieldsReader);
-                } else {
-                    docCount += copyFieldsNoDeletions(fieldsWriter, *reader, matchingFieldsReader);
                 }
             }
         } catch (LuceneException& e) {
@@ -310,8 +431,7 @@ int32_t SegmentMerger::copyFieldsWithDeletions(const FieldsWriterPtr& fieldsWrit
                 }
             } while (numDocs < MAX_RAW_MERGE_DOCS);
 
-            IndexInputPtr stream(matchingFieldsReader->rawDocs(rawDocLengths, start, numDocs));
-            fieldsWriter->addRawDocuments(stream, rawDocLengths, numDocs);
+            copyRawDocuments(fieldsWriter, matchingFieldsReader, start, numDocs);
             docCount += numDocs;
             checkAbort->work(300 * numDocs);
         }
@@ -338,8 +458,7 @@ int32_t SegmentMerger::copyFieldsNoDeletions(const FieldsWriterPtr& fieldsWriter
         // We can bulk-copy because the fieldInfos are "congruent"
         while (docCount < maxDoc) {
             int32_t len = std::min(MAX_RAW_MERGE_DOCS, maxDoc - docCount);
-            IndexInputPtr stream(matchingFieldsReader->rawDocs(rawDocLengths, docCount, len));
-            fieldsWriter->addRawDocuments(stream, rawDocLengths, len);
+            copyRawDocuments(fieldsWriter, matchingFieldsReader, docCount, len);
             docCount += len;
             checkAbort->work(300 * len);
         }
@@ -353,27 +472,72 @@ int32_t SegmentMerger::copyFieldsNoDeletions(const FieldsWriterPtr& fieldsWriter
     return docCount;
 }
 
+int32_t SegmentMerger::copySortedFields(const FieldsWriterPtr& fieldsWriter) {
+    Collection<FieldsReaderPtr> matchingFieldsReaders(Collection<FieldsReaderPtr>::newInstance(readers.size()));
+    for (int32_t i = 0; i < readers.size(); ++i) {
+        if (matchingSegmentReaders[i]) {
+            FieldsReaderPtr fieldsReader(matchingSegmentReaders[i]->getFieldsReader());
+            if (fieldsReader && fieldsReader->canReadRawDocs()) {
+                matchingFieldsReaders[i] = fieldsReader;
+            }
+        }
+    }
+    int32_t numDocs = sortedDocs.size();
+    for (int32_t doc = 0; doc < numDocs;) {
+        int32_t reader = sortedReaders[doc];
+        FieldsReaderPtr matchingFieldsReader(matchingFieldsReaders[reader]);
+        if (matchingFieldsReader) {
+            // We can bulk-copy the documents that are still consecutive in the sorted order
+            int32_t start = sortedDocs[doc];
+            int32_t len = 1;
+            while (doc + len < numDocs && len < MAX_RAW_MERGE_DOCS && sortedReaders[doc + len] == reader && sortedDocs[doc + len] == start + len) {
+                ++len;
+            }
+            copyRawDocuments(fieldsWriter, matchingFieldsReader, start, len);
+            doc += len;
+            checkAbort->work(300 * len);
+        } else {
+            fieldsWriter->addDocument(readers[reader]->document(sortedDocs[doc++]));
+            checkAbort->work(300);
+        }
+    }
+    return numDocs;
+}
+
+void SegmentMerger::copyRawDocuments(const FieldsWriterPtr& fieldsWriter, const FieldsReaderPtr& matchingFieldsReader, int32_t startDocID, int32_t numDocs) {
+    if (matchingFieldsReader->isChunked()) {
+        fieldsWriter->addDocuments(matchingFieldsReader, startDocID, numDocs);
+    } else {
+        IndexInputPtr stream(matchingFieldsReader->rawDocs(rawDocLengths, startDocID, numDocs));
+        fieldsWriter->addRawDocuments(stream, rawDocLengths, numDocs);
+    }
+}
+
 void SegmentMerger::mergeVectors() {
     TermVectorsWriterPtr termVectorsWriter(newLucene<TermVectorsWriter>(directory, segment, fieldInfos));
 
     LuceneException finally;
     try {
-        int32_t idx = 0;
-        for (Collection<IndexReaderPtr>::iterator reader = readers.begin(); reader != readers.end(); ++reader) {
-            SegmentReaderPtr matchingSegmentReader(matchingSegmentReaders[idx++]);
-            TermVectorsReaderPtr matchingVectorsReader;
-            if (matchingSegmentReader) {
-                TermVectorsReaderPtr vectorsReader(matchingSegmentReader->getTermVectorsReaderOrig());
-
-                // If the TV* files are an older format then they cannot read raw docs
-                if (vectorsReader && vectorsReader->canReadRawDocs()) {
-                    matchingVectorsReader = vectorsReader;
+        if (sort) {
+            copySortedVectors(termVectorsWriter);
+        } else {
+            int32_t idx = 0;
+            for (Collection<IndexReaderPtr>::iterator reader = readers.begin(); reader != readers.end(); ++reader) {
+                SegmentReaderPtr matchingSegmentReader(matchingSegmentReaders[idx++]);
+                TermVectorsReaderPtr matchingVectorsReader;
+                if (matchingSegmentReader) {
+                    TermVectorsReaderPtr vectorsReader(matchingSegmentReader->getTermVectorsReaderOrig());
+
+                    // If the TV* files are an older format then they cannot read raw docs
+                    if (vectorsReader && vectorsReader->canReadRawDocs()) {
+                        matchingVectorsReader = vectorsReader;
+                    }
+                }
+                if ((*reader)->hasDeletions()) {
+                    copyVectorsWithDeletions(termVectorsWriter, matchingVectorsReader, *reader);
+                } else {
+                    copyVectorsNoDeletions(termVectorsWriter, matchingVectorsReader, *reader);
                 }
-            }
-            if ((*reader)->hasDeletions()) {
-                copyVectorsWithDeletions(termVectorsWriter, matchingVectorsReader, *reader);
-            } else {
-                copyVectorsNoDeletions(termVectorsWriter, matchingVectorsReader, *reader);
             }
         }
     } catch (LuceneException& e) {
@@ -458,6 +622,38 @@ void SegmentMerger::copyVectorsNoDeletions(const TermVectorsWriterPtr& termVecto
     }
 }
 
+void SegmentMerger::copySortedVectors(const TermVectorsWriterPtr& termVectorsWriter) {
+    Collection<TermVectorsReaderPtr> matchingVectorsReaders(Collection<TermVectorsReaderPtr>::newInstance(readers.size()));
+    for (int32_t i = 0; i < readers.size(); ++i) {
+        if (matchingSegmentReaders[i]) {
+            TermVectorsReaderPtr vectorsReader(matchingSegmentReaders[i]->getTermVectorsReaderOrig());
+            if (vectorsReader && vectorsReader->canReadRawDocs()) {
+                matchingVectorsReaders[i] = vectorsReader;
+            }
+        }
+    }
+    int32_t numDocs = sortedDocs.size();
+    for (int32_t doc = 0; doc < numDocs;) {
+        int32_t reader = sortedReaders[doc];
+        TermVectorsReaderPtr matchingVectorsReader(matchingVectorsReaders[reader]);
+        if (matchingVectorsReader) {
+            // We can bulk-copy the documents that are still consecutive in the sorted order
+            int32_t start = sortedDocs[doc];
+            int32_t len = 1;
+            while (doc + len < numDocs && len < MAX_RAW_MERGE_DOCS && sortedReaders[doc + len] == reader && sortedDocs[doc + len] == start + len) {
+                ++len;
+            }
+            matchingVectorsReader->rawDocs(rawDocLengths, rawDocLengths2, start, len);
+            termVectorsWriter->addRawDocuments(matchingVectorsReader, rawDocLengths, rawDocLengths2, len);
+            doc += len;
+            checkAbort->work(300 * len);
+        } else {
+            termVectorsWriter->addAllDocVectors(readers[reader]->getTermFreqVectors(sortedDocs[doc++]));
+            checkAbort->work(300);
+        }
+    }
+}
+
 void SegmentMerger::mergeTerms() {
     TestScope testScope(L"SegmentMerger", L"mergeTerms");
 
@@ -486,8 +682,9 @@ void SegmentMerger::mergeTermInfos(const FormatPostingsFieldsConsumerPtr& consum
         IndexReaderPtr reader(readers[i]);
         TermEnumPtr termEnum(reader->terms());
         SegmentMergeInfoPtr smi(newLucene<SegmentMergeInfo>(base, termEnum, reader));
+        smi->ord = i;
         Collection<int32_t> docMap(smi->getDocMap());
-        if (docMap) {
+        if (docMap && !sort) { // a sorted merge maps every document, see sortDocs
             if (!docMaps) {
                 docMaps = Collection< Collection<int32_t> >::newInstance(readerCount);
                 delCounts = Collection<int32_t>::newInstance(readerCount);
@@ -558,6 +755,9 @@ Collection<int32_t> SegmentMerger::getDelCounts() {
 }
 
 int32_t SegmentMerger::appendPostings(const FormatPostingsTermsConsumerPtr& termsConsumer, Collection<SegmentMergeInfoPtr> smis, int32_t n) {
+    if (sort) {
+        return appendSortedPostings(termsConsumer, smis, n);
+    }
     FormatPostingsDocsConsumerPtr docConsumer(termsConsumer->addTerm(smis[0]->term->_text));
     int32_t df = 0;
     for (int32_t i = 0; i < n; ++i) {
@@ -603,8 +803,87 @@ int32_t SegmentMerger::appendPostings(const FormatPostingsTermsConsumerPtr& term
     return df;
 }
 
+int32_t SegmentMerger::appendSortedPostings(const FormatPostingsTermsConsumerPtr& termsConsumer, Collection<SegmentMergeInfoPtr> smis, int32_t n) {
+    if (!postingDocs) {
+        postingDocs = Collection<int32_t>::newInstance();
+        postingFreqs = Collection<int32_t>::newInstance();
+        postingStarts = Collection<int32_t>::newInstance();
+        postingPositions = Collection<int32_t>::newInstance();
+        postingPayloadStarts = Collection<int32_t>::newInstance();
+        postingPayloadLengths = Collection<int32_t>::newInstance();
+    }
+    postingDocs.clear();
+    postingFreqs.clear();
+    postingStarts.clear();
+    postingPositions.clear();
+    postingPayloadStarts.clear();
+    postingPayloadLengths.clear();
+    int32_t payloadUpto = 0;
+
+    // buffer the postings of all segments, mapped to the merged documents
+    for (int32_t i = 0; i < n; ++i) {
+        SegmentMergeInfoPtr smi(smis[i]);
+        TermPositionsPtr postings(smi->getPositions());
+        BOOST_ASSERT(postings);
+        int32_t base = smi->base;
+        Collection<int32_t> docMap(docMaps[smi->ord]);
+        postings->seek(smi->termEnum);
+
+        while (postings->next()) {
+            int32_t freq = postings->freq();
+            postingDocs.add(base + docMap[postings->doc()]);
+            postingFreqs.add(freq);
+            postingStarts.add(postingPositions.size());
+
+            if (!omitTermFreqAndPositions) {
+                for (int32_t j = 0; j < freq; ++j) {
+                    postingPositions.add(postings->nextPosition());
+                    int32_t payloadLength = postings->getPayloadLength();
+                    if (payloadLength > 0) {
+                        if (!postingPayloads) {
+                            postingPayloads = ByteArray::newInstance(payloadLength);
+                        }
+                        if (postingPayloads.size() < payloadUpto + payloadLength) {
+                            postingPayloads.resize(MiscUtils::getNextSize(payloadUpto + payloadLength));
+                        }
+                        postings->getPayload(postingPayloads, payloadUpto);
+                    }
+                    postingPayloadStarts.add(payloadUpto);
+                    postingPayloadLengths.add(payloadLength);
+                    payloadUpto += payloadLength;
+                }
+            }
+        }
+    }
+
+    int32_t df = postingDocs.size();
+    Collection<int32_t> order(Collection<int32_t>::newInstance(df));
+    for (int32_t i = 0; i < df; ++i) {
+        order[i] = i;
+    }
+    std::sort(order.begin(), order.end(), lessPostingDoc(postingDocs));
+
+    FormatPostingsDocsConsumerPtr docConsumer(termsConsumer->addTerm(smis[0]->term->_text));
+    for (Collection<int32_t>::iterator posting = order.begin(); posting != order.end(); ++posting) {
+        int32_t freq = postingFreqs[*posting];
+        FormatPostingsPositionsConsumerPtr posConsumer(docConsumer->addDoc(postingDocs[*posting], freq));
+
+        if (!omitTermFreqAndPositions) {
+            int32_t start = postingStarts[*posting];
+            for (int32_t j = start; j < start + freq; ++j) {
+                posConsumer->addPosition(postingPositions[j], postingPayloads, postingPayloadStarts[j], postingPayloadLengths[j]);
+            }
+            posConsumer->finish();
+        }
+    }
+    docConsumer->finish();
+
+    return df;
+}
+
 void SegmentMerger::mergeNorms() {
     ByteArray normBuffer;
+    ByteArray sortedNorms;
     IndexOutputPtr output;
     LuceneException finally;
     try {
@@ -616,8 +895,13 @@ void SegmentMerger::mergeNorms() {
                     output = directory->createOutput(segment + L"." + IndexFileNames::NORMS_EXTENSION());
                     output->writeBytes(NORMS_HEADER, SIZEOF_ARRAY(NORMS_HEADER));
                 }
-                for (Collection<IndexReaderPtr>::iterator reader = readers.begin(); reader != readers.end(); ++reader) {
-                    int32_t maxDoc = (*reader)->maxDoc();
+                if (sort && !sortedNorms) {
+                    sortedNorms = ByteArray::newInstance(mergedDocs);
+                }
+                int32_t base = 0;
+                for (int32_t r = 0; r < readers.size(); ++r) {
+                    IndexReaderPtr reader(readers[r]);
+                    int32_t maxDoc = reader->maxDoc();
 
                     if (!normBuffer) {
                         normBuffer = ByteArray::newInstance(maxDoc);
@@ -626,20 +910,31 @@ void SegmentMerger::mergeNorms() {
                         normBuffer.resize(maxDoc);
                     }
                     MiscUtils::arrayFill(normBuffer.get(), 0, normBuffer.size(), 0);
-                    (*reader)->norms(fi->name, normBuffer, 0);
-                    if (!(*reader)->hasDeletions()) {
+                    reader->norms(fi->name, normBuffer, 0);
+                    if (sort) {
+                        // place the norms of the live docs at their position in the sorted segment
+                        for (int32_t k = 0; k < maxDoc; ++k) {
+                            if (!reader->isDeleted(k)) {
+                                sortedNorms[base + docMaps[r][k]] = normBuffer[k];
+                            }
+                        }
+                        base += reader->numDocs();
+                    } else if (!reader->hasDeletions()) {
                         // optimized case for segments without deleted docs
                         output->writeBytes(normBuffer.get(), maxDoc);
                     } else {
                         // this segment has deleted docs, so we have to check for every doc if it is deleted or not
                         for (int32_t k = 0; k < maxDoc; ++k) {
-                            if (!(*reader)->isDeleted(k)) {
+                            if (!reader->isDeleted(k)) {
                                 output->writeByte(normBuffer[k]);
                             }
                         }
                     }
                     checkAbort->work(maxDoc);
                 }
+                if (sort) {
+                    output->writeBytes(sortedNorms.get(), mergedDocs);
+                }
             }
         }
     } catch (LuceneException& e) {
@@ -651,6 +946,71 @@ void SegmentMerger::mergeNorms() {
     finally.throwException();
 }
 
+void SegmentMerger::mergeDocValues() {
+    HashSet<String> numericFields(HashSet<String>::newInstance());
+    HashSet<String> sortedFields(HashSet<String>::newInstance());
+    for (Collection<IndexReaderPtr>::iterator reader = readers.begin(); reader != readers.end(); ++reader) {
+        HashSet<String> numeric((*reader)->getFieldNames(IndexReader::FIELD_OPTION_NUMERIC_DOC_VALUES));
+        numericFields.addAll(numeric.begin(), numeric.end());
+        HashSet<String> sorted((*reader)->getFieldNames(IndexReader::FIELD_OPTION_SORTED_DOC_VALUES));
+        sortedFields.addAll(sorted.begin(), sorted.end());
+    }
+    if (numericFields.empty() && sortedFields.empty()) {
+        return;
+    }
+
+    DocValuesOutputPtr output(newLucene<DocValuesOutput>(directory, segment + L"." + IndexFileNames::DOC_VALUES_EXTENSION()));
+    hasDocValues = true;
+    LuceneException finally;
+    try {
+        for (HashSet<String>::iterator field = numericFields.begin(); field != numericFields.end(); ++field) {
+            Collection<int64_t> values(Collection<int64_t>::newInstance(mergedDocs));
+            int32_t doc = 0;
+            for (int32_t r = 0; r < readers.size(); ++r) {
+                IndexReaderPtr reader(readers[r]);
+                PackedValuesPtr readerValues(reader->getNumericDocValues(*field));
+                int32_t base = doc;
+                int32_t maxDoc = reader->maxDoc();
+                for (int32_t k = 0; k < maxDoc; ++k) {
+                    if (!reader->isDeleted(k)) {
+                        values[sort ? base + docMaps[r][k] : doc] = readerValues ? readerValues->get(k) : 0;
+                        ++doc;
+                    }
+                }
+                checkAbort->work(maxDoc);
+            }
+            output->addNumeric(*field, values, mergedDocs);
+        }
+        for (HashSet<String>::iterator field = sortedFields.begin(); field != sortedFields.end(); ++field) {
+            if (numericFields.contains(*field)) {
+                continue; // a field must have one type; the numeric values were kept
+            }
+            Collection<String> values(Collection<String>::newInstance(mergedDocs));
+            int32_t doc = 0;
+            for (int32_t r = 0; r < readers.size(); ++r) {
+                IndexReaderPtr reader(readers[r]);
+                PackedStringIndexPtr readerValues(reader->getSortedDocValues(*field));
+                int32_t base = doc;
+                int32_t maxDoc = reader->maxDoc();
+                for (int32_t k = 0; k < maxDoc; ++k) {
+                    if (!reader->isDeleted(k)) {
+                        if (readerValues) {
+                            values[sort ? base + docMaps[r][k] : doc] = readerValues->lookup(readerValues->getOrd(k));
+                        }
+                        ++doc;
+                    }
+                }
+                checkAbort->work(maxDoc);
+            }
+            output->addSorted(*field, values, mergedDocs);
+        }
+    } catch (LuceneException& e) {
+        finally = e;
+    }
+    output->close();
+    finally.throwException();
+}
+
 CheckAbort::CheckAbort(const OneMergePtr& merge, const DirectoryPtr& dir) {
     workCount = 0;
     this->merge = merge;
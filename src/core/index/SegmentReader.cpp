@@ -27,6 +27,8 @@
 #include "AllTermDocs.h"
 #include "DefaultSimilarity.h"
 #include "FieldCache.h"
+#include "DocValuesReader.h"
+#include "DocValuesField.h"
 #include "MiscUtils.h"
 #include "StringUtils.h"
 
@@ -438,6 +440,12 @@ int32_t SegmentReader::maxDoc() {
 HashSet<String> SegmentReader::getFieldNames(FieldOption fieldOption) {
     ensureOpen();
     HashSet<String> fieldSet(HashSet<String>::newInstance());
+    if (fieldOption == FIELD_OPTION_NUMERIC_DOC_VALUES || fieldOption == FIELD_OPTION_SORTED_DOC_VALUES) {
+        if (core->docValues) {
+            fieldSet = core->docValues->getFields(fieldOption == FIELD_OPTION_NUMERIC_DOC_VALUES ? DocValuesField::DOC_VALUES_NUMERIC : DocValuesField::DOC_VALUES_SORTED);
+        }
+        return fieldSet;
+    }
     for (int32_t i = 0; i < core->fieldInfos->size(); ++i) {
         FieldInfoPtr fi(core->fieldInfos->fieldInfo(i));
         if (fieldOption == FIELD_OPTION_ALL) {
@@ -467,6 +475,16 @@ HashSet<String> SegmentReader::getFieldNames(FieldOption fieldOption) {
     return fieldSet;
 }
 
+PackedValuesPtr SegmentReader::getNumericDocValues(const String& field) {
+    ensureOpen();
+    return core->docValues ? core->docValues->getNumeric(field) : PackedValuesPtr();
+}
+
+PackedStringIndexPtr SegmentReader::getSortedDocValues(const String& field) {
+    ensureOpen();
+    return core->docValues ? core->docValues->getSorted(field) : PackedStringIndexPtr();
+}
+
 bool SegmentReader::hasNorms(const String& field) {
     SyncLock syncLock(this);
     ensureOpen();
@@ -485,6 +503,13 @@ ByteArray SegmentReader::norms(const String& field) {
     return getNorms(field);
 }
 
+uint8_t SegmentReader::maxNorm(const String& field) {
+    SyncLock syncLock(this);
+    ensureOpen();
+    NormPtr norm(_norms.get(field));
+    return norm ? norm->maxBytesValue() : 0;
+}
+
 void SegmentReader::doSetNorm(int32_t doc, const String& field, uint8_t value) {
     NormPtr norm(_norms.get(field));
     if (!norm) { // not an indexed field
@@ -770,6 +795,10 @@ CoreReaders::CoreReaders(const SegmentReaderPtr& origInstance, const DirectoryPt
             proxStream = cfsDir->openInput(segment + L"." + IndexFileNames::PROX_EXTENSION(), readBufferSize);
         }
 
+        if (cfsDir->fileExists(segment + L"." + IndexFileNames::DOC_VALUES_EXTENSION())) {
+            docValues = newLucene<DocValuesReader>(cfsDir, segment, readBufferSize);
+        }
+
         success = true;
     } catch (LuceneException& e) {
         finally = e;
@@ -854,6 +883,9 @@ void CoreReaders::decRef() {
         if (proxStream) {
             proxStream->close();
         }
+        if (docValues) {
+            docValues->close();
+        }
         if (termVectorsReaderOrig) {
             termVectorsReaderOrig->close();
         }
@@ -965,6 +997,7 @@ Norm::Norm() {
     this->dirty = false;
     this->rollbackDirty = false;
     this->number = 0;
+    this->maxByte = -1;
 }
 
 Norm::Norm(const SegmentReaderPtr& reader, const IndexInputPtr& in, int32_t number, int64_t normSeek) {
@@ -975,6 +1008,7 @@ Norm::Norm(const SegmentReaderPtr& reader, const IndexInputPtr& in, int32_t numb
     this->in = in;
     this->number = number;
     this->normSeek = normSeek;
+    this->maxByte = -1;
 }
 
 Norm::~Norm() {
@@ -1090,6 +1124,15 @@ ByteArray Norm::bytes() {
     return _bytes;
 }
 
+uint8_t Norm::maxBytesValue() {
+    SyncLock syncLock(this);
+    if (maxByte == -1) {
+        ByteArray normBytes(bytes());
+        maxByte = normBytes.size() == 0 ? 0 : *std::max_element(normBytes.get(), normBytes.get() + normBytes.size());
+    }
+    return (uint8_t)maxByte;
+}
+
 SegmentReaderRefPtr Norm::bytesRef() {
     return _bytesRef;
 }
@@ -1110,6 +1153,7 @@ ByteArray Norm::copyOnWrite() {
         oldRef->decRef();
     }
     dirty = true;
+    maxByte = -1; // the caller is about to change a norm
     return _bytes;
 }
 
@@ -1128,6 +1172,7 @@ LuceneObjectPtr Norm::clone(const LuceneObjectPtr& other) {
     cloneNorm->dirty = dirty;
     cloneNorm->number = number;
     cloneNorm->rollbackDirty = rollbackDirty;
+    cloneNorm->maxByte = maxByte;
 
     cloneNorm->refCount = 1;
 
@@ -11,6 +11,7 @@
 #include "SegmentTermEnum.h"
 #include "IndexInput.h"
 #include "TermInfosReader.h"
+#include "TermInfosWriter.h"
 #include "FieldInfos.h"
 #include "FieldInfo.h"
 #include "Term.h"
@@ -27,6 +28,7 @@ SegmentTermDocs::SegmentTermDocs(const SegmentReaderPtr& parent) {
     this->df = 0;
     this->_doc = 0;
     this->_freq = 0;
+    this->_maxFreq = 0;
     this->freqBasePointer = 0;
     this->proxBasePointer = 0;
     this->skipPointer = 0;
@@ -41,6 +43,7 @@ SegmentTermDocs::SegmentTermDocs(const SegmentReaderPtr& parent) {
     }
     this->skipInterval = parent->core->getTermsReader()->getSkipInterval();
     this->maxSkipLevels = parent->core->getTermsReader()->getMaxSkipLevels();
+    this->hasBlockMaxFreq = parent->core->getTermsReader()->getFormat() <= TermInfosWriter::FORMAT_BLOCK_MAX_FREQ;
 }
 
 SegmentTermDocs::~SegmentTermDocs() {
@@ -77,8 +80,10 @@ void SegmentTermDocs::seek(const TermInfoPtr& ti, const TermPtr& term) {
     currentFieldStoresPayloads = fi ? fi->storePayloads : false;
     if (!ti) {
         df = 0;
+        _maxFreq = 0;
     } else {
         df = ti->docFreq;
+        _maxFreq = currentFieldOmitTermFreqAndPositions ? 1 : ti->maxFreq;
         _doc = 0;
         freqBasePointer = ti->freqPointer;
         proxBasePointer = ti->proxPointer;
@@ -103,6 +108,10 @@ int32_t SegmentTermDocs::freq() {
     return _freq;
 }
 
+int32_t SegmentTermDocs::maxFreq() {
+    return _maxFreq;
+}
+
 void SegmentTermDocs::skippingDoc() {
 }
 
@@ -135,6 +144,14 @@ bool SegmentTermDocs::next() {
     return true;
 }
 
+int32_t* SegmentTermDocs::readDocCodes(int32_t count) {
+    if (!docCodes || docCodes.size() < count) {
+        docCodes.resize(MiscUtils::getNextSize(count));
+    }
+    _freqStream->readVInts(docCodes.get(), count);
+    return docCodes.get();
+}
+
 int32_t SegmentTermDocs::read(Collection<int32_t> docs, Collection<int32_t> freqs) {
     int32_t length = docs.size();
     if (currentFieldOmitTermFreqAndPositions) {
@@ -142,20 +159,28 @@ int32_t SegmentTermDocs::read(Collection<int32_t> docs, Collection<int32_t> freq
     } else {
         int32_t i = 0;
         while (i < length && count < df) {
-            // manually inlined call to next() for speed
-            int32_t docCode = _freqStream->readVInt();
-            _doc += MiscUtils::unsignedShift(docCode, 1); // shift off low bit
-            if ((docCode & 1) != 0) { // if low bit is set
-                _freq = 1;    // freq is one
-            } else {
-                _freq = _freqStream->readVInt();    // else read freq
-            }
-            ++count;
-
-            if (!deletedDocs || !deletedDocs->get(_doc)) {
-                docs[i] = _doc;
-                freqs[i] = _freq;
-                ++i;
+            // each remaining document starts with a doc code, so decoding this many vints never reads
+            // past the end of this term's postings
+            int32_t batch = std::min(length - i, df - count);
+            int32_t* codes = readDocCodes(batch);
+            int32_t code = 0;
+            while (code < batch) {
+                int32_t docCode = codes[code++];
+                _doc += MiscUtils::unsignedShift(docCode, 1); // shift off low bit
+                if ((docCode & 1) != 0) { // if low bit is set
+                    _freq = 1;    // freq is one
+                } else if (code < batch) {
+                    _freq = codes[code++];    // else freq is the next code
+                } else {
+                    _freq = _freqStream->readVInt();    // or follows the batch
+                }
+                ++count;
+
+                if (!deletedDocs || !deletedDocs->get(_doc)) {
+                    docs[i] = _doc;
+                    freqs[i] = _freq;
+                    ++i;
+                }
             }
         }
         return i;
@@ -165,16 +190,19 @@ int32_t SegmentTermDocs::read(Collection<int32_t> docs, Collection<int32_t> freq
 int32_t SegmentTermDocs::readNoTf(Collection<int32_t> docs, Collection<int32_t> freqs, int32_t length) {
     int32_t i = 0;
     while (i < length && count < df) {
-        // manually inlined call to next() for speed
-        _doc += _freqStream->readVInt();
-        ++count;
+        int32_t batch = std::min(length - i, df - count);
+        int32_t* codes = readDocCodes(batch);
+        for (int32_t code = 0; code < batch; ++code) {
+            _doc += codes[code];
+            ++count;
 
-        if (!deletedDocs || !deletedDocs->get(_doc)) {
-            docs[i] = _doc;
+            if (!deletedDocs || !deletedDocs->get(_doc)) {
+                docs[i] = _doc;
 
-            // Hardware freq to 1 when term freqs were not stored in the index
-            freqs[i] = 1;
-            ++i;
+                // Hardware freq to 1 when term freqs were not stored in the index
+                freqs[i] = 1;
+                ++i;
+            }
         }
     }
     return i;
@@ -183,19 +211,25 @@ int32_t SegmentTermDocs::readNoTf(Collection<int32_t> docs, Collection<int32_t>
 void SegmentTermDocs::skipProx(int64_t proxPointer, int32_t payloadLength) {
 }
 
+void SegmentTermDocs::initSkipListReader() {
+    if (!skipListReader) {
+        skipListReader = newLucene<DefaultSkipListReader>(boost::dynamic_pointer_cast<IndexInput>(_freqStream->clone()), maxSkipLevels, skipInterval, hasBlockMaxFreq);    // lazily clone
+    }
+
+    if (!haveSkipped) { // lazily initialize skip stream
+        skipListReader->init(skipPointer, freqBasePointer, proxBasePointer, df, currentFieldStoresPayloads);
+        haveSkipped = true;
+    }
+}
+
 bool SegmentTermDocs::skipTo(int32_t target) {
     if (df >= skipInterval) { // optimized case
-        if (!skipListReader) {
-            skipListReader = newLucene<DefaultSkipListReader>(boost::dynamic_pointer_cast<IndexInput>(_freqStream->clone()), maxSkipLevels, skipInterval);    // lazily clone
-        }
-
-        if (!haveSkipped) { // lazily initialize skip stream
-            skipListReader->init(skipPointer, freqBasePointer, proxBasePointer, df, currentFieldStoresPayloads);
-            haveSkipped = true;
-        }
+        initSkipListReader();
 
         int32_t newCount = skipListReader->skipTo(target);
-        if (newCount > count) {
+
+        // advanceShallow may have moved the skip list beyond the target, in which case we scan
+        if (newCount > count && skipListReader->getDoc() < target) {
             _freqStream->seek(skipListReader->getFreqPointer());
             skipProx(skipListReader->getProxPointer(), skipListReader->getPayloadLength());
 
@@ -213,6 +247,24 @@ bool SegmentTermDocs::skipTo(int32_t target) {
     return true;
 }
 
+int32_t SegmentTermDocs::advanceShallow(int32_t target) {
+    if (df < skipInterval || !hasBlockMaxFreq) {
+        return 0;
+    }
+    initSkipListReader();
+    // the first block also holds doc 0, which is before the first skip entry
+    skipListReader->skipTo(std::max(target, 1));
+    return skipListReader->getNumberOfSkipLevels();
+}
+
+int32_t SegmentTermDocs::blockEnd(int32_t level) {
+    return skipListReader->getSkipDoc(level);
+}
+
+int32_t SegmentTermDocs::blockMaxFreq(int32_t level) {
+    return currentFieldOmitTermFreqAndPositions ? 1 : skipListReader->getMaxFreq(level);
+}
+
 IndexInputPtr SegmentTermDocs::freqStream() {
     return _freqStream;
 }
@@ -156,6 +156,8 @@ bool SegmentTermEnum::next() {
         _termInfo->skipOffset = input->readVInt();
     }
 
+    _termInfo->maxFreq = format <= TermInfosWriter::FORMAT_MAX_FREQ ? input->readVInt() : 0;
+
     if (isIndex) {
         indexPointer += input->readVLong();    // read index pointer
     }
@@ -180,6 +182,10 @@ TermPtr SegmentTermEnum::prev() {
     return prevBuffer->toTerm();
 }
 
+int32_t SegmentTermEnum::getFormat() {
+    return format;
+}
+
 TermInfoPtr SegmentTermEnum::termInfo() {
     return newLucene<TermInfo>(_termInfo);
 }
@@ -0,0 +1,102 @@
+/////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2009-2014 Alan Wright. All rights reserved.
+// Distributable under the terms of either the Apache License (Version 2.0)
+// or the GNU Lesser General Public License.
+/////////////////////////////////////////////////////////////////////////////
+
+#include "LuceneInc.h"
+#include "SortingMergePolicy.h"
+#include "SegmentInfos.h"
+#include "SegmentInfo.h"
+#include "Sort.h"
+#include "SortField.h"
+
+namespace Lucene {
+
+SortingMergePolicy::SortingMergePolicy(const IndexWriterPtr& writer, const MergePolicyPtr& mergePolicy, const SortPtr& sort) : MergePolicy(writer) {
+    if (!mergePolicy) {
+        boost::throw_exception(NullPointerException(L"MergePolicy must be non-null"));
+    }
+    if (!sort || sort->getSort().empty()) {
+        boost::throw_exception(IllegalArgumentException(L"Sort must contain at least one field"));
+    }
+    Collection<SortFieldPtr> sortFields(sort->getSort());
+    for (Collection<SortFieldPtr>::iterator sortField = sortFields.begin(); sortField != sortFields.end(); ++sortField) {
+        int32_t type = (*sortField)->getType();
+        bool recordable = (type == SortField::STRING || type == SortField::STRING_VAL || type == SortField::BYTE ||
+                           type == SortField::SHORT || type == SortField::INT || type == SortField::LONG ||
+                           type == SortField::FLOAT || type == SortField::DOUBLE);
+
+        // the sort is recorded in the segments, which can't hold custom parsers or comparators
+        if (!recordable || (*sortField)->getParser() || (*sortField)->getLocale() || (*sortField)->getComparatorSource()) {
+            boost::throw_exception(IllegalArgumentException(L"Segments can't be sorted by " + (*sortField)->toString()));
+        }
+    }
+    this->mergePolicy = mergePolicy;
+    this->sort = sort;
+}
+
+SortingMergePolicy::~SortingMergePolicy() {
+}
+
+MergeSpecificationPtr SortingMergePolicy::findMerges(const SegmentInfosPtr& segmentInfos) {
+    return sortMerges(mergePolicy->findMerges(segmentInfos));
+}
+
+MergeSpecificationPtr SortingMergePolicy::findMergesForOptimize(const SegmentInfosPtr& segmentInfos, int32_t maxSegmentCount, SetSegmentInfo segmentsToOptimize) {
+    MergeSpecificationPtr spec(mergePolicy->findMergesForOptimize(segmentInfos, maxSegmentCount, segmentsToOptimize));
+    if (!spec) {
+        // The index is optimized as far as the wrapped policy is concerned, but its segments may not be sorted
+        int32_t numSegments = segmentInfos->size();
+        for (int32_t i = 0; i < numSegments; ++i) {
+            SegmentInfoPtr info(segmentInfos->info(i));
+            if (segmentsToOptimize.contains(info) && !isSorted(info)) {
+                if (!spec) {
+                    spec = newLucene<MergeSpecification>();
+                }
+                spec->add(newLucene<OneMerge>(segmentInfos->range(i, i + 1), mergePolicy->useCompoundFile(segmentInfos, info)));
+            }
+        }
+    }
+    return sortMerges(spec);
+}
+
+MergeSpecificationPtr SortingMergePolicy::findMergesToExpungeDeletes(const SegmentInfosPtr& segmentInfos) {
+    return sortMerges(mergePolicy->findMergesToExpungeDeletes(segmentInfos));
+}
+
+void SortingMergePolicy::close() {
+    mergePolicy->close();
+}
+
+bool SortingMergePolicy::useCompoundFile(const SegmentInfosPtr& segments, const SegmentInfoPtr& newSegment) {
+    return mergePolicy->useCompoundFile(segments, newSegment);
+}
+
+bool SortingMergePolicy::useCompoundDocStore(const SegmentInfosPtr& segments) {
+    return mergePolicy->useCompoundDocStore(segments);
+}
+
+MergePolicyPtr SortingMergePolicy::getMergePolicy() {
+    return mergePolicy;
+}
+
+SortPtr SortingMergePolicy::getSort() {
+    return sort;
+}
+
+bool SortingMergePolicy::isSorted(const SegmentInfoPtr& info) {
+    SortPtr indexSort(info->getIndexSort());
+    return (indexSort && indexSort->getSort().equals(sort->getSort(), luceneEquals<SortFieldPtr>()));
+}
+
+MergeSpecificationPtr SortingMergePolicy::sortMerges(const MergeSpecificationPtr& spec) {
+    if (spec) {
+        for (Collection<OneMergePtr>::iterator merge = spec->merges.begin(); merge != spec->merges.end(); ++merge) {
+            (*merge)->sort = sort;
+        }
+    }
+    return spec;
+}
+
+}
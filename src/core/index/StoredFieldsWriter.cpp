@@ -57,7 +57,7 @@ void StoredFieldsWriter::initFieldsWriter() {
         DocumentsWriterPtr docWriter(_docWriter);
         String docStoreSegment(docWriter->getDocStoreSegment());
         if (!docStoreSegment.empty()) {
-            fieldsWriter = newLucene<FieldsWriter>(docWriter->directory, docStoreSegment, fieldInfos);
+            fieldsWriter = newLucene<FieldsWriter>(docWriter->directory, docStoreSegment, fieldInfos, docWriter->getStoredFieldsChunkSize());
             docWriter->addOpenFile(docStoreSegment + L"." + IndexFileNames::FIELDS_EXTENSION());
             docWriter->addOpenFile(docStoreSegment + L"." + IndexFileNames::FIELDS_INDEX_EXTENSION());
             lastDocID = 0;
@@ -47,6 +47,22 @@ bool TermDocs::skipTo(int32_t target) {
     return false; // override
 }
 
+int32_t TermDocs::maxFreq() {
+    return 0; // not known
+}
+
+int32_t TermDocs::advanceShallow(int32_t target) {
+    return 0; // no blocks
+}
+
+int32_t TermDocs::blockEnd(int32_t level) {
+    return INT_MAX;
+}
+
+int32_t TermDocs::blockMaxFreq(int32_t level) {
+    return maxFreq();
+}
+
 void TermDocs::close() {
     BOOST_ASSERT(false);
     // override
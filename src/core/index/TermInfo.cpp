@@ -18,16 +18,18 @@ TermInfo::TermInfo(int32_t df, int64_t fp, int64_t pp) {
     freqPointer = fp;
     proxPointer = pp;
     skipOffset = 0;
+    maxFreq = 0;
 }
 
 TermInfo::~TermInfo() {
 }
 
-void TermInfo::set(int32_t docFreq, int64_t freqPointer, int64_t proxPointer, int32_t skipOffset) {
+void TermInfo::set(int32_t docFreq, int64_t freqPointer, int64_t proxPointer, int32_t skipOffset, int32_t maxFreq) {
     this->docFreq = docFreq;
     this->freqPointer = freqPointer;
     this->proxPointer = proxPointer;
     this->skipOffset = skipOffset;
+    this->maxFreq = maxFreq;
 }
 
 void TermInfo::set(const TermInfoPtr& ti) {
@@ -35,6 +37,7 @@ void TermInfo::set(const TermInfoPtr& ti) {
     freqPointer = ti->freqPointer;
     proxPointer = ti->proxPointer;
     skipOffset = ti->skipOffset;
+    maxFreq = ti->maxFreq;
 }
 
 }
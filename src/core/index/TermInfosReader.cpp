@@ -6,6 +6,7 @@
 
 #include "LuceneInc.h"
 #include "TermInfosReader.h"
+#include "TermInfosReaderIndex.h"
 #include "SegmentTermEnum.h"
 #include "Directory.h"
 #include "IndexFileNames.h"
@@ -38,23 +39,7 @@ TermInfosReader::TermInfosReader(const DirectoryPtr& dir, const String& seg, con
             SegmentTermEnumPtr indexEnum(newLucene<SegmentTermEnum>(directory->openInput(segment + L"." + IndexFileNames::TERMS_INDEX_EXTENSION(), readBufferSize), fieldInfos, true));
 
             try {
-                int32_t indexSize = 1 + ((int32_t)indexEnum->size - 1) / indexDivisor; // otherwise read index
-
-                indexTerms = Collection<TermPtr>::newInstance(indexSize);
-                indexInfos = Collection<TermInfoPtr>::newInstance(indexSize);
-                indexPointers = Collection<int64_t>::newInstance(indexSize);
-
-                for (int32_t i = 0; indexEnum->next(); ++i) {
-                    indexTerms[i] = indexEnum->term();
-                    indexInfos[i] = indexEnum->termInfo();
-                    indexPointers[i] = indexEnum->indexPointer;
-
-                    for (int32_t j = 1; j < indexDivisor; ++j) {
-                        if (!indexEnum->next()) {
-                            break;
-                        }
-                    }
-                }
+                index = newLucene<TermInfosReaderIndex>(indexEnum, indexDivisor, totalIndexInterval, fieldInfos);
             } catch (LuceneException& e) {
                 finally = e;
             }
@@ -86,6 +71,10 @@ int32_t TermInfosReader::getSkipInterval() {
     return origEnum->skipInterval;
 }
 
+int32_t TermInfosReader::getFormat() {
+    return origEnum->getFormat();
+}
+
 void TermInfosReader::close() {
     if (origEnum) {
         origEnum->close();
@@ -110,16 +99,6 @@ TermInfosReaderThreadResourcesPtr TermInfosReader::getThreadResources() {
     return resources;
 }
 
-int32_t TermInfosReader::getIndexOffset(const TermPtr& term) {
-    // binary search indexTerms
-    Collection<TermPtr>::iterator indexTerm = std::upper_bound(indexTerms.begin(), indexTerms.end(), term, luceneCompare<TermPtr>());
-    return (std::distance(indexTerms.begin(), indexTerm) - 1);
-}
-
-void TermInfosReader::seekEnum(const SegmentTermEnumPtr& enumerator, int32_t indexOffset) {
-    enumerator->seek(indexPointers[indexOffset], ((int64_t)indexOffset * (int64_t)totalIndexInterval) - 1, indexTerms[indexOffset], indexInfos[indexOffset]);
-}
-
 TermInfoPtr TermInfosReader::get(const TermPtr& term) {
     return get(term, true);
 }
@@ -151,8 +130,8 @@ TermInfoPtr TermInfosReader::get(const TermPtr& term, bool useCache) {
             ((enumerator->prev() && term->compareTo(enumerator->prev()) > 0) ||
              term->compareTo(enumerator->term()) >= 0)) {
         int32_t enumOffset = (int32_t)(enumerator->position / totalIndexInterval ) + 1;
-        if (indexTerms.size() == enumOffset || // but before end of block
-                term->compareTo(indexTerms[enumOffset]) < 0) {
+        if (index->length() == enumOffset || // but before end of block
+                index->compareTo(term, enumOffset) < 0) {
             // no need to seek
             int32_t numScans = enumerator->scanTo(term);
             if (enumerator->term() && term->compareTo(enumerator->term()) == 0) {
@@ -171,7 +150,7 @@ TermInfoPtr TermInfosReader::get(const TermPtr& term, bool useCache) {
     }
 
     // random-access: must seek
-    seekEnum(enumerator, getIndexOffset(term));
+    index->seekEnum(enumerator, index->getIndexOffset(term));
     enumerator->scanTo(term);
     if (enumerator->term() && term->compareTo(enumerator->term()) == 0) {
         ti = enumerator->termInfo();
@@ -185,7 +164,7 @@ TermInfoPtr TermInfosReader::get(const TermPtr& term, bool useCache) {
 }
 
 void TermInfosReader::ensureIndexIsRead() {
-    if (!indexTerms) {
+    if (!index) {
         boost::throw_exception(IllegalStateException(L"terms index was not loaded when this reader was created"));
     }
 }
@@ -196,10 +175,10 @@ int64_t TermInfosReader::getPosition(const TermPtr& term) {
     }
 
     ensureIndexIsRead();
-    int32_t indexOffset = getIndexOffset(term);
+    int32_t indexOffset = index->getIndexOffset(term);
 
     SegmentTermEnumPtr enumerator(getThreadResources()->termEnum);
-    seekEnum(enumerator, indexOffset);
+    index->seekEnum(enumerator, indexOffset);
 
     while (term->compareTo(enumerator->term()) > 0 && enumerator->next()) {
     }
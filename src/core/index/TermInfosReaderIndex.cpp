@@ -0,0 +1,261 @@
+/////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2009-2014 Alan Wright. All rights reserved.
+// Distributable under the terms of either the Apache License (Version 2.0)
+// or the GNU Lesser General Public License.
+/////////////////////////////////////////////////////////////////////////////
+
+#include "LuceneInc.h"
+#include "TermInfosReaderIndex.h"
+#include "SegmentTermEnum.h"
+#include "TermInfo.h"
+#include "Term.h"
+#include "FieldInfos.h"
+#include "PackedInts.h"
+#include "MiscUtils.h"
+#include "StringUtils.h"
+
+namespace Lucene {
+
+/// Reads a variable-length encoded int from the buffer, advancing the position.
+static inline int32_t readVInt(const uint8_t* data, int32_t& pos) {
+    uint8_t b = data[pos++];
+    int32_t i = (b & 0x7f);
+    for (int32_t shift = 7; (b & 0x80) != 0; shift += 7) {
+        b = data[pos++];
+        i |= (b & 0x7f) << shift;
+    }
+    return i;
+}
+
+/// Reads a variable-length encoded long from the buffer, advancing the position.
+static inline int64_t readVLong(const uint8_t* data, int32_t& pos) {
+    uint8_t b = data[pos++];
+    int64_t i = (b & 0x7f);
+    for (int32_t shift = 7; (b & 0x80) != 0; shift += 7) {
+        b = data[pos++];
+        i |= (int64_t)(b & 0x7f) << shift;
+    }
+    return i;
+}
+
+/// Compares two UTF-8 byte sequences in the same order as the equivalent unicode strings.
+static inline int32_t compareUTF8(const uint8_t* bytes1, int32_t len1, const uint8_t* bytes2, int32_t len2) {
+    int32_t end = std::min(len1, len2);
+    for (int32_t i = 0; i < end; ++i) {
+        int32_t b1 = bytes1[i];
+        int32_t b2 = bytes2[i];
+        if (b1 != b2) {
+#ifdef LPP_UNICODE_CHAR_SIZE_2
+            // strings compare in UTF-16 code unit order, so fix up the bytes that encode surrogate pairs
+            if (b1 >= 0xee && b2 >= 0xee) {
+                if ((b1 & 0xfe) == 0xee) {
+                    b1 += 0xe;
+                }
+                if ((b2 & 0xfe) == 0xee) {
+                    b2 += 0xe;
+                }
+            }
+#endif
+            return b1 - b2;
+        }
+    }
+    return len1 - len2;
+}
+
+TermInfosReaderIndex::TermInfosReaderIndex(const SegmentTermEnumPtr& indexEnum, int32_t indexDivisor, int32_t totalIndexInterval, const FieldInfosPtr& fieldInfos) {
+    this->totalIndexInterval = totalIndexInterval;
+    this->skipInterval = indexEnum->skipInterval;
+    this->indexSize = 1 + ((int32_t)indexEnum->size - 1) / indexDivisor;
+    this->dataLength = 0;
+    this->offsetsAverage = 0;
+    this->offsetsMinimum = 0;
+
+    int32_t numFields = fieldInfos->size();
+    fieldNames = Collection<String>::newInstance(numFields);
+    for (int32_t i = 0; i < numFields; ++i) {
+        fieldNames[i] = fieldInfos->fieldName(i);
+    }
+
+    Collection<int32_t> entryOffsets(Collection<int32_t>::newInstance(indexSize));
+    data = ByteArray::newInstance(std::max(indexSize * 16, 64));
+
+    String currentField;
+    int32_t currentFieldNumber = -1;
+    int32_t i = 0;
+    for (; indexEnum->next(); ++i) {
+        // the first entry of the index is the empty term, which has no field
+        TermPtr term(indexEnum->term());
+        SingleString termBytes;
+        if (!term) {
+            currentFieldNumber = -1;
+        } else {
+            if (currentFieldNumber == -1 || term->field() != currentField) {
+                currentField = term->field();
+                currentFieldNumber = fieldInfos->fieldNumber(currentField);
+            }
+            termBytes = StringUtils::toUTF8(term->text());
+        }
+        TermInfoPtr termInfo(indexEnum->termInfo());
+
+        entryOffsets[i] = dataLength;
+        writeVInt(currentFieldNumber + 1);
+        writeVInt((int32_t)termBytes.length());
+        writeBytes((const uint8_t*)termBytes.c_str(), (int32_t)termBytes.length());
+        writeVInt(termInfo->docFreq);
+        if (termInfo->docFreq >= skipInterval) {
+            writeVInt(termInfo->skipOffset);
+        }
+        writeVInt(termInfo->maxFreq);
+        writeVLong(termInfo->freqPointer);
+        writeVLong(termInfo->proxPointer);
+        writeVLong(indexEnum->indexPointer);
+
+        for (int32_t j = 1; j < indexDivisor; ++j) {
+            if (!indexEnum->next()) {
+                break;
+            }
+        }
+    }
+    indexSize = i;
+
+    // trim the data block to its final size
+    data.resize(std::max(dataLength, 1));
+
+    // offsets grow almost linearly, so only store the deviation from the average entry length
+    if (indexSize > 1) {
+        offsetsAverage = (double)entryOffsets[indexSize - 1] / (double)(indexSize - 1);
+    }
+    int64_t maxDelta = 0;
+    for (int32_t entry = 0; entry < indexSize; ++entry) {
+        int64_t delta = (int64_t)entryOffsets[entry] - (int64_t)(offsetsAverage * (double)entry);
+        offsetsMinimum = std::min(offsetsMinimum, delta);
+        maxDelta = std::max(maxDelta, delta);
+    }
+    offsets = newLucene<PackedInts>(std::max(indexSize, 1), PackedInts::bitsRequired(maxDelta - offsetsMinimum));
+    for (int32_t entry = 0; entry < indexSize; ++entry) {
+        int64_t delta = (int64_t)entryOffsets[entry] - (int64_t)(offsetsAverage * (double)entry);
+        offsets->set(entry, delta - offsetsMinimum);
+    }
+}
+
+TermInfosReaderIndex::~TermInfosReaderIndex() {
+}
+
+int32_t TermInfosReaderIndex::length() {
+    return indexSize;
+}
+
+int64_t TermInfosReaderIndex::ramBytesUsed() {
+    return (int64_t)data.size() + offsets->ramBytesUsed();
+}
+
+void TermInfosReaderIndex::ensureCapacity(int32_t length) {
+    if (dataLength + length > data.size()) {
+        data.resize(std::max(dataLength + length, (int32_t)(1.5 * (double)data.size())));
+    }
+}
+
+void TermInfosReaderIndex::writeVInt(int32_t i) {
+    ensureCapacity(5);
+    uint8_t* bytes = data.get();
+    while ((i & ~0x7f) != 0) {
+        bytes[dataLength++] = (uint8_t)((i & 0x7f) | 0x80);
+        i = MiscUtils::unsignedShift(i, 7);
+    }
+    bytes[dataLength++] = (uint8_t)i;
+}
+
+void TermInfosReaderIndex::writeVLong(int64_t i) {
+    ensureCapacity(10);
+    uint8_t* bytes = data.get();
+    while ((i & ~0x7fLL) != 0) {
+        bytes[dataLength++] = (uint8_t)((i & 0x7f) | 0x80);
+        i = MiscUtils::unsignedShift(i, (int64_t)7);
+    }
+    bytes[dataLength++] = (uint8_t)i;
+}
+
+void TermInfosReaderIndex::writeBytes(const uint8_t* b, int32_t length) {
+    ensureCapacity(length);
+    MiscUtils::arrayCopy(b, 0, data.get(), dataLength, length);
+    dataLength += length;
+}
+
+int32_t TermInfosReaderIndex::getOffset(int32_t indexOffset) {
+    return (int32_t)(offsets->get(indexOffset) + offsetsMinimum + (int64_t)(offsetsAverage * (double)indexOffset));
+}
+
+void TermInfosReaderIndex::seekEnum(const SegmentTermEnumPtr& enumerator, int32_t indexOffset) {
+    const uint8_t* bytes = data.get();
+    int32_t pos = getOffset(indexOffset);
+
+    int32_t fieldNumber = readVInt(bytes, pos) - 1;
+    int32_t termLength = readVInt(bytes, pos);
+    TermPtr term;
+    if (fieldNumber != -1) {
+        term = newLucene<Term>(fieldNames[fieldNumber], StringUtils::toUnicode(bytes + pos, termLength));
+    }
+    pos += termLength;
+
+    TermInfoPtr termInfo(newLucene<TermInfo>());
+    termInfo->docFreq = readVInt(bytes, pos);
+    termInfo->skipOffset = termInfo->docFreq >= skipInterval ? readVInt(bytes, pos) : 0;
+    termInfo->maxFreq = readVInt(bytes, pos);
+    termInfo->freqPointer = readVLong(bytes, pos);
+    termInfo->proxPointer = readVLong(bytes, pos);
+    int64_t pointer = readVLong(bytes, pos);
+
+    enumerator->seek(pointer, ((int64_t)indexOffset * (int64_t)totalIndexInterval) - 1, term, termInfo);
+}
+
+int32_t TermInfosReaderIndex::getIndexOffset(const TermPtr& term) {
+    String field(term->field());
+    SingleString termBytes(StringUtils::toUTF8(term->text()));
+    int32_t lo = 0;
+    int32_t hi = indexSize - 1;
+    while (hi >= lo) {
+        int32_t mid = MiscUtils::unsignedShift(lo + hi, 1);
+        int32_t delta = compareTo(field, termBytes, mid);
+        if (delta < 0) {
+            hi = mid - 1;
+        } else if (delta > 0) {
+            lo = mid + 1;
+        } else {
+            return mid;
+        }
+    }
+    return hi;
+}
+
+int32_t TermInfosReaderIndex::compareTo(const TermPtr& term, int32_t indexOffset) {
+    return compareTo(term->field(), StringUtils::toUTF8(term->text()), indexOffset);
+}
+
+int32_t TermInfosReaderIndex::compareTo(const String& field, const SingleString& termBytes, int32_t indexOffset) {
+    const uint8_t* bytes = data.get();
+    int32_t pos = getOffset(indexOffset);
+
+    int32_t fieldNumber = readVInt(bytes, pos) - 1;
+    if (fieldNumber == -1) {
+        return 1; // every term is greater than the empty term
+    }
+    if (field != fieldNames[fieldNumber]) {
+        return field.compare(fieldNames[fieldNumber]);
+    }
+
+    int32_t termLength = readVInt(bytes, pos);
+    return compareUTF8((const uint8_t*)termBytes.c_str(), (int32_t)termBytes.length(), bytes + pos, termLength);
+}
+
+TermPtr TermInfosReaderIndex::getTerm(int32_t indexOffset) {
+    const uint8_t* bytes = data.get();
+    int32_t pos = getOffset(indexOffset);
+    int32_t fieldNumber = readVInt(bytes, pos) - 1;
+    if (fieldNumber == -1) {
+        return TermPtr();
+    }
+    int32_t termLength = readVInt(bytes, pos);
+    return newLucene<Term>(fieldNames[fieldNumber], StringUtils::toUnicode(bytes + pos, termLength));
+}
+
+}
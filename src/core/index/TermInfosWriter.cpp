@@ -23,8 +23,14 @@ const int32_t TermInfosWriter::FORMAT = -3;
 /// Changed strings to true utf8 with length-in-bytes not length-in-chars.
 const int32_t TermInfosWriter::FORMAT_VERSION_UTF8_LENGTH_IN_BYTES = -4;
 
+/// Added the highest frequency of each term in a document, used to bound its scores.
+const int32_t TermInfosWriter::FORMAT_MAX_FREQ = -5;
+
+/// Added the highest frequency of the term in the block of documents before each skip entry.
+const int32_t TermInfosWriter::FORMAT_BLOCK_MAX_FREQ = -6;
+
 /// NOTE: always change this if you switch to a new format.
-const int32_t TermInfosWriter::FORMAT_CURRENT = TermInfosWriter::FORMAT_VERSION_UTF8_LENGTH_IN_BYTES;
+const int32_t TermInfosWriter::FORMAT_CURRENT = TermInfosWriter::FORMAT_BLOCK_MAX_FREQ;
 
 TermInfosWriter::TermInfosWriter(const DirectoryPtr& directory, const String& segment, const FieldInfosPtr& fis, int32_t interval) {
     initialize(directory, segment, fis, interval, false);
@@ -125,6 +131,7 @@ void TermInfosWriter::add(int32_t fieldNumber, ByteArray termBytes, int32_t term
     if (ti->docFreq >= skipInterval) {
         output->writeVInt(ti->skipOffset);
     }
+    output->writeVInt(ti->maxFreq);
 
     if (isIndex) {
         output->writeVLong(other->output->getFilePointer() - lastIndexPointer);
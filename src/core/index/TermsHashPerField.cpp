@@ -121,48 +121,125 @@ void TermsHashPerField::compactPostings() {
     postingsCompacted = true;
 }
 
-struct comparePostings {
-    comparePostings(Collection<CharArray> buffers) {
-        this->buffers = buffers;
+/// The term text of a posting being sorted, with two characters of the term cached inline
+struct PostingSortEntry {
+    const wchar_t* text;
+    uint64_t key;
+    int32_t ord;
+};
+
+/// Ranges smaller than this are sorted by insertion sort
+static const int32_t POSTINGS_INSERTION_SORT_THRESHOLD = 16;
+
+/// Maps a character of term text to its sort order, where the terminator sorts before any character
+static inline uint32_t postingSortChar(wchar_t c) {
+    return c == UTF8Base::UNICODE_TERMINATOR ? 0 : (uint32_t)c + 1;
+}
+
+/// The two characters of term text starting at depth, packed so they compare as one integer; the
+/// characters following the terminator are 0
+static inline uint64_t postingSortKey(const wchar_t* text, int32_t depth) {
+    uint32_t c1 = postingSortChar(text[depth]);
+    if (c1 == 0) {
+        return 0;
     }
+    return ((uint64_t)c1 << 32) | postingSortChar(text[depth + 1]);
+}
 
-    /// Compares term text for two Posting instance
-    inline bool operator()(const RawPostingListPtr& first, const RawPostingListPtr& second) const {
-        if (first == second) {
-            return false;
+/// Compares term text for two postings that share the first depth characters
+static inline bool postingTextLessThan(const wchar_t* text1, const wchar_t* text2, int32_t depth) {
+    for (;; ++depth) {
+        uint32_t c1 = postingSortChar(text1[depth]);
+        uint32_t c2 = postingSortChar(text2[depth]);
+        if (c1 != c2) {
+            return (c1 < c2);
         }
+        // This method should never compare equal postings
+        BOOST_ASSERT(c1 != 0);
+    }
+}
 
-        wchar_t* text1 = buffers[first->textStart >> DocumentsWriter::CHAR_BLOCK_SHIFT].get();
-        int32_t pos1 = (first->textStart & DocumentsWriter::CHAR_BLOCK_MASK);
-        wchar_t* text2 = buffers[second->textStart >> DocumentsWriter::CHAR_BLOCK_SHIFT].get();
-        int32_t pos2 = (second->textStart & DocumentsWriter::CHAR_BLOCK_MASK);
-
-        BOOST_ASSERT(text1 != text2 || pos1 != pos2);
-
-        while (true) {
-            wchar_t c1 = text1[pos1++];
-            wchar_t c2 = text2[pos2++];
-            if (c1 != c2) {
-                if (c2 == UTF8Base::UNICODE_TERMINATOR) {
-                    return false;
-                } else if (c1 == UTF8Base::UNICODE_TERMINATOR) {
-                    return true;
-                } else {
-                    return (c1 < c2);
-                }
+static void insertionSortPostings(PostingSortEntry* entries, int32_t count, int32_t depth) {
+    for (int32_t i = 1; i < count; ++i) {
+        PostingSortEntry entry(entries[i]);
+        int32_t j = i;
+        for (; j > 0 && postingTextLessThan(entry.text, entries[j - 1].text, depth); --j) {
+            entries[j] = entries[j - 1];
+        }
+        entries[j] = entry;
+    }
+}
+
+/// Multi-key quicksort of postings sharing the first depth characters of their term text.  Each pass
+/// caches the next two characters of every term in the range, so that partitioning reads the entries
+/// sequentially rather than chasing each term into the char pool for every comparison.
+static void sortPostingEntries(PostingSortEntry* entries, int32_t count, int32_t depth, bool keysCached) {
+    while (count > POSTINGS_INSERTION_SORT_THRESHOLD) {
+        if (!keysCached) {
+            for (int32_t i = 0; i < count; ++i) {
+                entries[i].key = postingSortKey(entries[i].text, depth);
+            }
+        }
+
+        // Median of three pivot
+        uint64_t a = entries[0].key;
+        uint64_t b = entries[count >> 1].key;
+        uint64_t c = entries[count - 1].key;
+        uint64_t pivot = a < b ? (b < c ? b : (a < c ? c : a)) : (a < c ? a : (b < c ? c : b));
+
+        // Three way partition into keys less than, equal to and greater than the pivot
+        int32_t lt = 0;
+        int32_t gt = count;
+        for (int32_t i = 0; i < gt;) {
+            if (entries[i].key < pivot) {
+                std::swap(entries[lt++], entries[i++]);
+            } else if (entries[i].key > pivot) {
+                std::swap(entries[i], entries[--gt]);
             } else {
-                // This method should never compare equal postings unless first == second
-                BOOST_ASSERT(c1 != UTF8Base::UNICODE_TERMINATOR);
+                ++i;
             }
         }
-    }
 
-    Collection<CharArray> buffers;
-};
+        sortPostingEntries(entries, lt, depth, true);
+        sortPostingEntries(entries + gt, count - gt, depth, true);
+
+        // The terms in the middle share the two characters; if these end the terms then the terms are
+        // equal, which can only be a single posting
+        if ((pivot & 0xffffffff) == 0) {
+            BOOST_ASSERT(gt - lt == 1);
+            return;
+        }
+        entries += lt;
+        count = gt - lt;
+        depth += 2;
+        keysCached = false;
+    }
+    insertionSortPostings(entries, count, depth);
+}
 
 Collection<RawPostingListPtr> TermsHashPerField::sortPostings() {
     compactPostings();
-    std::sort(postingsHash.begin(), postingsHash.begin() + numPostings, comparePostings(charPool->buffers));
+    if (numPostings > 1) {
+        Collection<CharArray> buffers(charPool->buffers);
+        Collection<PostingSortEntry> entries(Collection<PostingSortEntry>::newInstance(numPostings));
+        for (int32_t i = 0; i < numPostings; ++i) {
+            int32_t textStart = postingsHash[i]->textStart;
+            entries[i].text = buffers[textStart >> DocumentsWriter::CHAR_BLOCK_SHIFT].get() + (textStart & DocumentsWriter::CHAR_BLOCK_MASK);
+            entries[i].key = 0;
+            entries[i].ord = i;
+        }
+
+        sortPostingEntries(&entries[0], numPostings, 0, false);
+
+        // Swapping moves the postings into sorted order without touching their reference counts
+        Collection<RawPostingListPtr> sorted(Collection<RawPostingListPtr>::newInstance(numPostings));
+        for (int32_t i = 0; i < numPostings; ++i) {
+            sorted[i].swap(postingsHash[entries[i].ord]);
+        }
+        for (int32_t i = 0; i < numPostings; ++i) {
+            postingsHash[i].swap(sorted[i]);
+        }
+    }
     return postingsHash;
 }
 
@@ -0,0 +1,494 @@
+/////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2009-2014 Alan Wright. All rights reserved.
+// Distributable under the terms of either the Apache License (Version 2.0)
+// or the GNU Lesser General Public License.
+/////////////////////////////////////////////////////////////////////////////
+
+#include "LuceneInc.h"
+#include "TieredMergePolicy.h"
+#include "IndexWriter.h"
+#include "SegmentInfo.h"
+#include "StringUtils.h"
+
+namespace Lucene {
+
+typedef HashMap< SegmentInfoPtr, int64_t, luceneHash<SegmentInfoPtr>, luceneEquals<SegmentInfoPtr> > MapSegmentInfoLong;
+
+/// Orders segments by decreasing size, then by name
+struct moreSegmentSize {
+    moreSegmentSize(MapSegmentInfoLong sizes) : sizes(sizes) {}
+    inline bool operator()(const SegmentInfoPtr& first, const SegmentInfoPtr& second) const {
+        int64_t firstSize = sizes.get(first);
+        int64_t secondSize = sizes.get(second);
+        if (firstSize != secondSize) {
+            return (firstSize > secondSize);
+        }
+        return (first->name < second->name);
+    }
+    MapSegmentInfoLong sizes;
+};
+
+TieredMergePolicy::TieredMergePolicy(const IndexWriterPtr& writer) : MergePolicy(writer) {
+    maxMergeAtOnce = 10;
+    maxMergedSegmentBytes = (int64_t)5 * 1024 * 1024 * 1024;
+    maxMergeAtOnceExplicit = 30;
+    floorSegmentBytes = 2 * 1024 * 1024;
+    segsPerTier = 10.0;
+    expungeDeletesPctAllowed = 10.0;
+    _useCompoundFile = true;
+    noCFSRatio = 0.1;
+    reclaimDeletesWeight = 2.0;
+}
+
+TieredMergePolicy::~TieredMergePolicy() {
+}
+
+void TieredMergePolicy::setMaxMergeAtOnce(int32_t maxMergeAtOnce) {
+    if (maxMergeAtOnce < 2) {
+        boost::throw_exception(IllegalArgumentException(L"maxMergeAtOnce must be > 1 (got " + StringUtils::toString(maxMergeAtOnce) + L")"));
+    }
+    this->maxMergeAtOnce = maxMergeAtOnce;
+}
+
+int32_t TieredMergePolicy::getMaxMergeAtOnce() {
+    return maxMergeAtOnce;
+}
+
+void TieredMergePolicy::setMaxMergeAtOnceExplicit(int32_t maxMergeAtOnceExplicit) {
+    if (maxMergeAtOnceExplicit < 2) {
+        boost::throw_exception(IllegalArgumentException(L"maxMergeAtOnceExplicit must be > 1 (got " + StringUtils::toString(maxMergeAtOnceExplicit) + L")"));
+    }
+    this->maxMergeAtOnceExplicit = maxMergeAtOnceExplicit;
+}
+
+int32_t TieredMergePolicy::getMaxMergeAtOnceExplicit() {
+    return maxMergeAtOnceExplicit;
+}
+
+void TieredMergePolicy::setMaxMergedSegmentMB(double maxMergedSegmentMB) {
+    if (maxMergedSegmentMB < 0.0) {
+        boost::throw_exception(IllegalArgumentException(L"maxMergedSegmentMB must be >= 0 (got " + StringUtils::toString(maxMergedSegmentMB) + L")"));
+    }
+    maxMergedSegmentBytes = (int64_t)(maxMergedSegmentMB * 1024.0 * 1024.0);
+}
+
+double TieredMergePolicy::getMaxMergedSegmentMB() {
+    return (double)maxMergedSegmentBytes / 1024.0 / 1024.0;
+}
+
+void TieredMergePolicy::setReclaimDeletesWeight(double reclaimDeletesWeight) {
+    if (reclaimDeletesWeight < 0.0) {
+        boost::throw_exception(IllegalArgumentException(L"reclaimDeletesWeight must be >= 0.0 (got " + StringUtils::toString(reclaimDeletesWeight) + L")"));
+    }
+    this->reclaimDeletesWeight = reclaimDeletesWeight;
+}
+
+double TieredMergePolicy::getReclaimDeletesWeight() {
+    return reclaimDeletesWeight;
+}
+
+void TieredMergePolicy::setFloorSegmentMB(double floorSegmentMB) {
+    if (floorSegmentMB <= 0.0) {
+        boost::throw_exception(IllegalArgumentException(L"floorSegmentMB must be > 0.0 (got " + StringUtils::toString(floorSegmentMB) + L")"));
+    }
+    floorSegmentBytes = (int64_t)(floorSegmentMB * 1024.0 * 1024.0);
+}
+
+double TieredMergePolicy::getFloorSegmentMB() {
+    return (double)floorSegmentBytes / 1024.0 / 1024.0;
+}
+
+void TieredMergePolicy::setExpungeDeletesPctAllowed(double expungeDeletesPctAllowed) {
+    if (expungeDeletesPctAllowed < 0.0 || expungeDeletesPctAllowed > 100.0) {
+        boost::throw_exception(IllegalArgumentException(L"expungeDeletesPctAllowed must be between 0.0 and 100.0 inclusive (got " + StringUtils::toString(expungeDeletesPctAllowed) + L")"));
+    }
+    this->expungeDeletesPctAllowed = expungeDeletesPctAllowed;
+}
+
+double TieredMergePolicy::getExpungeDeletesPctAllowed() {
+    return expungeDeletesPctAllowed;
+}
+
+void TieredMergePolicy::setSegmentsPerTier(double segsPerTier) {
+    if (segsPerTier < 2.0) {
+        boost::throw_exception(IllegalArgumentException(L"segmentsPerTier must be >= 2.0 (got " + StringUtils::toString(segsPerTier) + L")"));
+    }
+    this->segsPerTier = segsPerTier;
+}
+
+double TieredMergePolicy::getSegmentsPerTier() {
+    return segsPerTier;
+}
+
+void TieredMergePolicy::setUseCompoundFile(bool useCompoundFile) {
+    _useCompoundFile = useCompoundFile;
+}
+
+bool TieredMergePolicy::getUseCompoundFile() {
+    return _useCompoundFile;
+}
+
+void TieredMergePolicy::setNoCFSRatio(double noCFSRatio) {
+    if (noCFSRatio < 0.0 || noCFSRatio > 1.0) {
+        boost::throw_exception(IllegalArgumentException(L"noCFSRatio must be 0.0 to 1.0 inclusive; got " + StringUtils::toString(noCFSRatio)));
+    }
+    this->noCFSRatio = noCFSRatio;
+}
+
+double TieredMergePolicy::getNoCFSRatio() {
+    return noCFSRatio;
+}
+
+bool TieredMergePolicy::verbose() {
+    return (!_writer.expired() && IndexWriterPtr(_writer)->verbose());
+}
+
+void TieredMergePolicy::message(const String& message) {
+    if (verbose()) {
+        IndexWriterPtr(_writer)->message(L"TMP: " + message);
+    }
+}
+
+MergeSpecificationPtr TieredMergePolicy::findMerges(const SegmentInfosPtr& segmentInfos) {
+    message(L"findMerges: " + StringUtils::toString(segmentInfos->size()) + L" segments");
+    if (segmentInfos->size() == 0) {
+        return MergeSpecificationPtr();
+    }
+
+    SetSegmentInfo merging(IndexWriterPtr(_writer)->getMergingSegments());
+    SetSegmentInfo toBeMerged(SetSegmentInfo::newInstance());
+
+    Collection<SegmentInfoPtr> infosSorted(Collection<SegmentInfoPtr>::newInstance(segmentInfos->size()));
+    for (int32_t i = 0; i < segmentInfos->size(); ++i) {
+        infosSorted[i] = segmentInfos->info(i);
+    }
+    infosSorted = sortBySize(infosSorted);
+
+    // Compute total index bytes & print details about the index
+    int64_t totIndexBytes = 0;
+    int64_t minSegmentBytes = LLONG_MAX;
+    for (Collection<SegmentInfoPtr>::iterator info = infosSorted.begin(); info != infosSorted.end(); ++info) {
+        int64_t segBytes = size(*info);
+        if (verbose()) {
+            String extra(merging.contains(*info) ? L" [merging]" : L"");
+            if ((double)segBytes >= (double)maxMergedSegmentBytes / 2.0) {
+                extra += L" [skip: too large]";
+            } else if (segBytes < floorSegmentBytes) {
+                extra += L" [floored]";
+            }
+            message(L"  seg=" + (*info)->segString(IndexWriterPtr(_writer)->getDirectory()) + L" size=" + StringUtils::toString((double)segBytes / 1024.0 / 1024.0) + L" MB" + extra);
+        }
+        minSegmentBytes = std::min(segBytes, minSegmentBytes);
+        // Accum total byte size
+        totIndexBytes += segBytes;
+    }
+
+    // If we have too-large segments, grace them out of the maxSegmentCount
+    int32_t tooBigCount = 0;
+    while (tooBigCount < infosSorted.size() && (double)size(infosSorted[tooBigCount]) >= (double)maxMergedSegmentBytes / 2.0) {
+        totIndexBytes -= size(infosSorted[tooBigCount]);
+        ++tooBigCount;
+    }
+
+    minSegmentBytes = floorSize(minSegmentBytes);
+
+    // Compute max allowed segs in the index
+    int64_t levelSize = minSegmentBytes;
+    int64_t bytesLeft = totIndexBytes;
+    double allowedSegCount = 0;
+    while (true) {
+        double segCountLevel = (double)bytesLeft / (double)levelSize;
+        if (segCountLevel < segsPerTier) {
+            allowedSegCount += std::ceil(segCountLevel);
+            break;
+        }
+        allowedSegCount += segsPerTier;
+        bytesLeft -= (int64_t)(segsPerTier * (double)levelSize);
+        levelSize *= maxMergeAtOnce;
+    }
+    int32_t allowedSegCountInt = (int32_t)allowedSegCount;
+
+    MergeSpecificationPtr spec;
+
+    // Cycle to possibly select more than one merge
+    while (true) {
+        int64_t mergingBytes = 0;
+
+        // Gather eligible segments for merging, ie segments not already being merged and not already
+        // picked (by prior iteration of this loop) for merging
+        Collection<SegmentInfoPtr> eligible(Collection<SegmentInfoPtr>::newInstance());
+        for (int32_t idx = tooBigCount; idx < infosSorted.size(); ++idx) {
+            SegmentInfoPtr info(infosSorted[idx]);
+            if (merging.contains(info)) {
+                mergingBytes += info->sizeInBytes();
+            } else if (!toBeMerged.contains(info)) {
+                eligible.add(info);
+            }
+        }
+
+        bool maxMergeIsRunning = (mergingBytes >= maxMergedSegmentBytes);
+
+        message(L"  allowedSegmentCount=" + StringUtils::toString(allowedSegCountInt) + L" vs count=" + StringUtils::toString(infosSorted.size()) + L" (eligible count=" + StringUtils::toString(eligible.size()) + L") tooBigCount=" + StringUtils::toString(tooBigCount));
+
+        if (eligible.empty() || eligible.size() < allowedSegCountInt) {
+            return spec;
+        }
+
+        // OK we are over budget -- find best merge
+        Collection<SegmentInfoPtr> best;
+        double bestScore = 0.0;
+        bool bestTooLarge = false;
+        int64_t bestMergeBytes = 0;
+
+        // Consider all merge starts
+        for (int32_t startIdx = 0; startIdx <= eligible.size() - maxMergeAtOnce; ++startIdx) {
+            int64_t totAfterMergeBytes = 0;
+            Collection<SegmentInfoPtr> candidate(Collection<SegmentInfoPtr>::newInstance());
+            bool hitTooLarge = false;
+            for (int32_t idx = startIdx; idx < eligible.size() && candidate.size() < maxMergeAtOnce; ++idx) {
+                SegmentInfoPtr info(eligible[idx]);
+                int64_t segBytes = size(info);
+
+                if (totAfterMergeBytes + segBytes > maxMergedSegmentBytes) {
+                    hitTooLarge = true;
+                    // NOTE: we continue, so that we can try "packing" smaller segments into this merge
+                    // to see if we can get closer to the max size; this in general is not perfect since
+                    // this is really "bin packing" and we'd have to try different permutations
+                    continue;
+                }
+                candidate.add(info);
+                totAfterMergeBytes += segBytes;
+            }
+
+            double mergeScore = score(candidate, hitTooLarge);
+            message(L"  maybe=" + segString(candidate) + L" score=" + StringUtils::toString(mergeScore) + L" tooLarge=" + StringUtils::toString(hitTooLarge) + L" size=" + StringUtils::toString((double)totAfterMergeBytes / 1024.0 / 1024.0) + L" MB");
+
+            // If we are already running a max sized merge (maxMergeIsRunning), don't allow another
+            // max sized merge to kick off
+            if ((!best || mergeScore < bestScore) && (!hitTooLarge || !maxMergeIsRunning)) {
+                best = candidate;
+                bestScore = mergeScore;
+                bestTooLarge = hitTooLarge;
+                bestMergeBytes = totAfterMergeBytes;
+            }
+        }
+
+        if (!best) {
+            return spec;
+        }
+
+        if (!spec) {
+            spec = newLucene<MergeSpecification>();
+        }
+        spec->add(makeOneMerge(segmentInfos, best));
+        for (Collection<SegmentInfoPtr>::iterator info = best.begin(); info != best.end(); ++info) {
+            toBeMerged.add(*info);
+        }
+        message(L"  add merge=" + segString(best) + L" size=" + StringUtils::toString((double)bestMergeBytes / 1024.0 / 1024.0) + L" MB score=" + StringUtils::toString(bestScore) + (bestTooLarge ? L" [max merge]" : L""));
+    }
+}
+
+double TieredMergePolicy::score(Collection<SegmentInfoPtr> candidate, bool hitTooLarge) {
+    int64_t totBeforeMergeBytes = 0;
+    int64_t totAfterMergeBytes = 0;
+    int64_t totAfterMergeBytesFloored = 0;
+    for (Collection<SegmentInfoPtr>::iterator info = candidate.begin(); info != candidate.end(); ++info) {
+        int64_t segBytes = size(*info);
+        totAfterMergeBytes += segBytes;
+        totAfterMergeBytesFloored += floorSize(segBytes);
+        totBeforeMergeBytes += (*info)->sizeInBytes();
+    }
+
+    // Measure "skew" of the merge, which can range from 1.0/numSegsBeingMerged (good) to 1.0 (poor)
+    double skew;
+    if (hitTooLarge) {
+        // Pretend the merge has perfect skew; skew doesn't matter in this case because this merge will
+        // not "cascade" and so it cannot lead to N^2 merge cost over time
+        skew = 1.0 / (double)maxMergeAtOnce;
+    } else {
+        skew = (double)floorSize(size(candidate[0])) / (double)totAfterMergeBytesFloored;
+    }
+
+    // Strongly favor merges with less skew (smaller mergeScore is better)
+    double mergeScore = skew;
+
+    // Gently favor smaller merges over bigger ones.  We don't want to make this exponent too large else
+    // we can end up doing poor merges of small segments in order to avoid the large merges
+    mergeScore *= std::pow((double)totAfterMergeBytes, 0.05);
+
+    // Strongly favor merges that reclaim deletes
+    double nonDelRatio = totBeforeMergeBytes == 0 ? 1.0 : (double)totAfterMergeBytes / (double)totBeforeMergeBytes;
+    mergeScore *= std::pow(nonDelRatio, reclaimDeletesWeight);
+
+    return mergeScore;
+}
+
+MergeSpecificationPtr TieredMergePolicy::findMergesForOptimize(const SegmentInfosPtr& segmentInfos, int32_t maxSegmentCount, SetSegmentInfo segmentsToOptimize) {
+    message(L"findMergesForOptimize maxSegmentCount=" + StringUtils::toString(maxSegmentCount) + L" segmentsToOptimize=" + StringUtils::toString(segmentsToOptimize.size()));
+
+    Collection<SegmentInfoPtr> eligible(Collection<SegmentInfoPtr>::newInstance());
+    bool optimizeMergeRunning = false;
+    SetSegmentInfo merging(IndexWriterPtr(_writer)->getMergingSegments());
+    for (int32_t i = 0; i < segmentInfos->size(); ++i) {
+        SegmentInfoPtr info(segmentInfos->info(i));
+        if (segmentsToOptimize.contains(info)) {
+            if (!merging.contains(info)) {
+                eligible.add(info);
+            } else {
+                optimizeMergeRunning = true;
+            }
+        }
+    }
+
+    if (eligible.empty()) {
+        return MergeSpecificationPtr();
+    }
+
+    if ((maxSegmentCount > 1 && eligible.size() <= maxSegmentCount) || (maxSegmentCount == 1 && eligible.size() == 1 && isOptimized(eligible[0]))) {
+        message(L"already optimized");
+        return MergeSpecificationPtr();
+    }
+
+    eligible = sortBySize(eligible);
+
+    int32_t end = eligible.size();
+    MergeSpecificationPtr spec;
+
+    // Do full merges, first, backwards
+    while (end >= maxMergeAtOnceExplicit + maxSegmentCount - 1) {
+        if (!spec) {
+            spec = newLucene<MergeSpecification>();
+        }
+        Collection<SegmentInfoPtr> candidate(Collection<SegmentInfoPtr>::newInstance(eligible.begin() + end - maxMergeAtOnceExplicit, eligible.begin() + end));
+        message(L"add merge=" + segString(candidate));
+        spec->add(makeOneMerge(segmentInfos, candidate));
+        end -= maxMergeAtOnceExplicit;
+    }
+
+    if (!spec && !optimizeMergeRunning) {
+        // Do final merge
+        int32_t numToMerge = end - maxSegmentCount + 1;
+        Collection<SegmentInfoPtr> candidate(Collection<SegmentInfoPtr>::newInstance(eligible.begin() + end - numToMerge, eligible.begin() + end));
+        message(L"add final merge=" + segString(candidate));
+        spec = newLucene<MergeSpecification>();
+        spec->add(makeOneMerge(segmentInfos, candidate));
+    }
+
+    return spec;
+}
+
+MergeSpecificationPtr TieredMergePolicy::findMergesToExpungeDeletes(const SegmentInfosPtr& segmentInfos) {
+    message(L"findMergesToExpungeDeletes infos=" + StringUtils::toString(segmentInfos->size()) + L" expungeDeletesPctAllowed=" + StringUtils::toString(expungeDeletesPctAllowed));
+
+    IndexWriterPtr writer(_writer);
+    Collection<SegmentInfoPtr> eligible(Collection<SegmentInfoPtr>::newInstance());
+    SetSegmentInfo merging(writer->getMergingSegments());
+    for (int32_t i = 0; i < segmentInfos->size(); ++i) {
+        SegmentInfoPtr info(segmentInfos->info(i));
+        double pctDeletes = info->docCount <= 0 ? 0.0 : 100.0 * (double)writer->numDeletedDocs(info) / (double)info->docCount;
+        if (pctDeletes > expungeDeletesPctAllowed && !merging.contains(info)) {
+            eligible.add(info);
+        }
+    }
+
+    if (eligible.empty()) {
+        return MergeSpecificationPtr();
+    }
+
+    eligible = sortBySize(eligible);
+
+    message(L"eligible=" + segString(eligible));
+
+    MergeSpecificationPtr spec(newLucene<MergeSpecification>());
+    int32_t start = 0;
+    while (start < eligible.size()) {
+        int32_t end = std::min(start + maxMergeAtOnceExplicit, eligible.size());
+        Collection<SegmentInfoPtr> candidate(Collection<SegmentInfoPtr>::newInstance(eligible.begin() + start, eligible.begin() + end));
+        message(L"add merge=" + segString(candidate));
+        spec->add(makeOneMerge(segmentInfos, candidate));
+        start = end;
+    }
+
+    return spec;
+}
+
+bool TieredMergePolicy::useCompoundFile(const SegmentInfosPtr& segments, const SegmentInfoPtr& newSegment) {
+    return _useCompoundFile;
+}
+
+bool TieredMergePolicy::useCompoundDocStore(const SegmentInfosPtr& segments) {
+    return _useCompoundFile;
+}
+
+void TieredMergePolicy::close() {
+}
+
+int64_t TieredMergePolicy::size(const SegmentInfoPtr& info) {
+    int64_t byteSize = info->sizeInBytes();
+    if (info->docCount <= 0) {
+        return byteSize;
+    }
+    int32_t delCount = IndexWriterPtr(_writer)->numDeletedDocs(info);
+    double delRatio = (double)delCount / (double)info->docCount;
+    return (int64_t)((double)byteSize * (1.0 - delRatio));
+}
+
+int64_t TieredMergePolicy::floorSize(int64_t bytes) {
+    return std::max(floorSegmentBytes, bytes);
+}
+
+bool TieredMergePolicy::isOptimized(const SegmentInfoPtr& info) {
+    IndexWriterPtr writer(_writer);
+    bool hasDeletions = (writer->numDeletedDocs(info) > 0);
+    return (!hasDeletions && !info->hasSeparateNorms() && info->dir == writer->getDirectory() && (info->getUseCompoundFile() == _useCompoundFile || noCFSRatio < 1.0));
+}
+
+Collection<SegmentInfoPtr> TieredMergePolicy::sortBySize(Collection<SegmentInfoPtr> infos) {
+    MapSegmentInfoLong sizes(MapSegmentInfoLong::newInstance());
+    for (Collection<SegmentInfoPtr>::iterator info = infos.begin(); info != infos.end(); ++info) {
+        sizes.put(*info, size(*info));
+    }
+    Collection<SegmentInfoPtr> sorted(Collection<SegmentInfoPtr>::newInstance(infos.begin(), infos.end()));
+    std::sort(sorted.begin(), sorted.end(), moreSegmentSize(sizes));
+    return sorted;
+}
+
+OneMergePtr TieredMergePolicy::makeOneMerge(const SegmentInfosPtr& infos, Collection<SegmentInfoPtr> candidate) {
+    // List the merged segments in index order, so that merging adjacent segments keeps their documents in order
+    SegmentInfosPtr infosToMerge(newLucene<SegmentInfos>());
+    int64_t totSize = 0;
+    int64_t mergeSize = 0;
+    for (int32_t i = 0; i < infos->size(); ++i) {
+        SegmentInfoPtr info(infos->info(i));
+        int64_t segBytes = size(info);
+        totSize += segBytes;
+        if (candidate.contains_if(luceneEqualTo<SegmentInfoPtr>(info))) {
+            infosToMerge->add(info);
+            mergeSize += segBytes;
+        }
+    }
+
+    bool doCFS;
+    if (!_useCompoundFile) {
+        doCFS = false;
+    } else if (noCFSRatio == 1.0) {
+        doCFS = true;
+    } else {
+        doCFS = ((double)mergeSize <= noCFSRatio * (double)totSize);
+    }
+    return newLucene<OneMerge>(infosToMerge, doCFS);
+}
+
+String TieredMergePolicy::segString(Collection<SegmentInfoPtr> infos) {
+    String segString;
+    DirectoryPtr dir(IndexWriterPtr(_writer)->getDirectory());
+    for (Collection<SegmentInfoPtr>::iterator info = infos.begin(); info != infos.end(); ++info) {
+        if (!segString.empty()) {
+            segString += L" ";
+        }
+        segString += (*info)->segString(dir);
+    }
+    return segString;
+}
+
+}
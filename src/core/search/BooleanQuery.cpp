@@ -9,7 +9,10 @@
 #include "_BooleanQuery.h"
 #include "BooleanScorer.h"
 #include "BooleanScorer2.h"
+#include "MaxScoreScorer.h"
+#include "TermScorer.h"
 #include "ComplexExplanation.h"
+#include "Searcher.h"
 #include "MiscUtils.h"
 #include "StringUtils.h"
 
@@ -204,7 +207,7 @@ BooleanWeight::BooleanWeight(const BooleanQueryPtr& query, const SearcherPtr& se
     this->similarity = query->getSimilarity(searcher);
     weights = Collection<WeightPtr>::newInstance();
     for (Collection<BooleanClausePtr>::iterator clause = query->clauses.begin(); clause != query->clauses.end(); ++clause) {
-        weights.add((*clause)->getQuery()->createWeight(searcher));
+        weights.add(searcher->createNodeWeight((*clause)->getQuery()));
     }
 }
 
@@ -327,6 +330,29 @@ ScorerPtr BooleanWeight::scorer(const IndexReaderPtr& reader, bool scoreDocsInOr
         }
     }
 
+    // A disjunction of terms scored in order from the top can skip documents that can't compete, as term
+    // scores are bounded
+    if (scoreDocsInOrder && topScorer && required.empty() && prohibited.empty() && query->minNrShouldMatch == 0 &&
+            optional.size() > 1 && optional.size() <= MaxScoreScorer::MAX_CLAUSES) {
+        Collection<double> maxScores(Collection<double>::newInstance(optional.size()));
+        bool bounded = true;
+        for (int32_t i = 0; i < optional.size() && bounded; ++i) {
+            TermScorerPtr termScorer(boost::dynamic_pointer_cast<TermScorer>(optional[i]));
+            if (termScorer) {
+                maxScores[i] = termScorer->maxScore();
+            } else {
+                bounded = false;
+            }
+        }
+        if (bounded) {
+            Collection<double> coordFactors(Collection<double>::newInstance(optional.size() + 1));
+            for (int32_t i = 0; i <= optional.size(); ++i) {
+                coordFactors[i] = similarity->coord(i, optional.size());
+            }
+            return newLucene<MaxScoreScorer>(similarity, optional, maxScores, coordFactors);
+        }
+    }
+
     // Check if we can return a BooleanScorer
     if (!scoreDocsInOrder && topScorer && required.empty() && prohibited.size() < 32) {
         return newLucene<BooleanScorer>(similarity, query->minNrShouldMatch, optional, prohibited);
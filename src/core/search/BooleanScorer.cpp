@@ -5,26 +5,52 @@
 /////////////////////////////////////////////////////////////////////////////
 
 #include "LuceneInc.h"
+#include <boost/thread/tss.hpp>
 #include "BooleanScorer.h"
 #include "Similarity.h"
+#include "TermScorer.h"
 
 namespace Lucene {
 
+/// Number of documents read from a term clause at a time.
+static const int32_t BATCH_SIZE = 256;
+
+/// Bucket table of the last BooleanScorer destroyed on this thread, taken by the next one created rather than
+/// allocating a table for every segment of every query.
+static boost::thread_specific_ptr<BucketTablePtr>& freeBucketTable() {
+    static boost::thread_specific_ptr<BucketTablePtr>* table = new boost::thread_specific_ptr<BucketTablePtr>();
+    return *table;
+}
+
 BooleanScorer::BooleanScorer(const SimilarityPtr& similarity, int32_t minNrShouldMatch, Collection<ScorerPtr> optionalScorers, Collection<ScorerPtr> prohibitedScorers) : Scorer(similarity) {
-    this->bucketTable = newLucene<BucketTable>();
+    BucketTablePtr* freeTable = freeBucketTable().get();
+    if (freeTable == NULL) {
+        freeTable = new BucketTablePtr();
+        freeBucketTable().reset(freeTable);
+    }
+    if (*freeTable) {
+        this->bucketTable = *freeTable;
+        freeTable->reset();
+        this->bucketTable->clear();
+    } else {
+        this->bucketTable = newLucene<BucketTable>();
+    }
     this->maxCoord = 1;
     this->requiredMask = 0;
     this->prohibitedMask = 0;
     this->nextMask = 1;
     this->minNrShouldMatch = minNrShouldMatch;
     this->end = 0;
+    this->current = -1;
     this->doc = -1;
+    this->docBuffer = Collection<int32_t>::newInstance(BATCH_SIZE);
+    this->scoreBuffer = Collection<double>::newInstance(BATCH_SIZE);
 
     if (optionalScorers && !optionalScorers.empty()) {
         for (Collection<ScorerPtr>::iterator scorer = optionalScorers.begin(); scorer != optionalScorers.end(); ++scorer) {
             ++maxCoord;
             if ((*scorer)->nextDoc() != NO_MORE_DOCS) {
-                scorers = newLucene<SubScorer>(*scorer, false, false, bucketTable->newCollector(0), scorers);
+                scorers = newLucene<SubScorer>(*scorer, false, false, 0, bucketTable->newCollector(0), scorers);
             }
         }
     }
@@ -35,7 +61,7 @@ BooleanScorer::BooleanScorer(const SimilarityPtr& similarity, int32_t minNrShoul
             nextMask = nextMask << 1;
             prohibitedMask |= mask; // update prohibited mask
             if ((*scorer)->nextDoc() != NO_MORE_DOCS) {
-                scorers = newLucene<SubScorer>(*scorer, false, true, bucketTable->newCollector(mask), scorers);
+                scorers = newLucene<SubScorer>(*scorer, false, true, mask, bucketTable->newCollector(mask), scorers);
             }
         }
     }
@@ -48,50 +74,77 @@ BooleanScorer::BooleanScorer(const SimilarityPtr& similarity, int32_t minNrShoul
 }
 
 BooleanScorer::~BooleanScorer() {
+    // the collectors of the sub-scorers only hold weak references to the table
+    BucketTablePtr* freeTable = freeBucketTable().get();
+    if (freeTable != NULL && !*freeTable && bucketTable.unique()) {
+        *freeTable = bucketTable;
+    }
 }
 
 bool BooleanScorer::score(const CollectorPtr& collector, int32_t max, int32_t firstDocID) {
     bool more = false;
-    BucketPtr tmp;
+    int32_t tmp;
     BucketScorerPtr bs(newLucene<BucketScorer>());
     // The internal loop will set the score and doc before calling collect.
     collector->setScorer(bs);
+    Collection<int32_t> docs(bucketTable->docs);
+    Collection<double> scores(bucketTable->scores);
+    Collection<int32_t> bits(bucketTable->bits);
+    Collection<int32_t> coords(bucketTable->coords);
+    Collection<int32_t> next(bucketTable->next);
     do {
-        bucketTable->first.reset();
+        bucketTable->first = -1;
 
-        while (current) { // more queued
+        while (current != -1) { // more queued
             // check prohibited & required
-            if ((current->bits & prohibitedMask) == 0 && (current->bits & requiredMask) == requiredMask) {
-                if (current->doc >= max) {
+            if ((bits[current] & prohibitedMask) == 0 && (bits[current] & requiredMask) == requiredMask) {
+                if (docs[current] >= max) {
                     tmp = current;
-                    current = current->_next.lock();
-                    tmp->_next = bucketTable->first;
+                    current = next[current];
+                    next[tmp] = bucketTable->first;
                     bucketTable->first = tmp;
                     continue;
                 }
 
-                if (current->coord >= minNrShouldMatch) {
-                    bs->_score = current->score * coordFactors[current->coord];
-                    bs->doc = current->doc;
-                    bs->freq = current->coord;
-                    collector->collect(current->doc);
+                if (coords[current] >= minNrShouldMatch) {
+                    bs->_score = scores[current] * coordFactors[coords[current]];
+                    bs->doc = docs[current];
+                    bs->freq = coords[current];
+                    collector->collect(docs[current]);
                 }
             }
 
-            current = current->_next.lock(); // pop the queue
+            current = next[current]; // pop the queue
         }
 
-        if (bucketTable->first) {
+        if (bucketTable->first != -1) {
             current = bucketTable->first;
-            bucketTable->first = current->_next.lock();
+            bucketTable->first = next[current];
             return true;
         }
 
         // refill the queue
-        more = false;
-        end += BucketTable::SIZE;
+        more = fillWindow();
+        current = bucketTable->first;
+    } while (current != -1 || more);
+
+    return false;
+}
+
+bool BooleanScorer::fillWindow() {
+    bool more = false;
+    end += BucketTable::SIZE;
 
-        for (SubScorerPtr sub(scorers); sub; sub = sub->next) {
+    for (SubScorerPtr sub(scorers); sub; sub = sub->next) {
+        if (sub->termScorer) {
+            int32_t count;
+            while ((count = sub->termScorer->nextScores(end, docBuffer, scoreBuffer)) > 0) {
+                bucketTable->add(docBuffer, scoreBuffer, count, sub->mask);
+            }
+            if (sub->termScorer->docID() != NO_MORE_DOCS) {
+                more = true;
+            }
+        } else {
             int32_t subScorerDocID = sub->scorer->docID();
             if (subScorerDocID != NO_MORE_DOCS) {
                 if (sub->scorer->score(sub->collector, end, subScorerDocID)) {
@@ -99,10 +152,8 @@ bool BooleanScorer::score(const CollectorPtr& collector, int32_t max, int32_t fi
                 }
             }
         }
-        current = bucketTable->first;
-    } while (current || more);
-
-    return false;
+    }
+    return more;
 }
 
 int32_t BooleanScorer::advance(int32_t target) {
@@ -117,41 +168,28 @@ int32_t BooleanScorer::docID() {
 int32_t BooleanScorer::nextDoc() {
     bool more = false;
     do {
-        while (bucketTable->first) { // more queued
+        while (bucketTable->first != -1) { // more queued
             current = bucketTable->first;
-            bucketTable->first = current->_next.lock(); // pop the queue
+            bucketTable->first = bucketTable->next[current]; // pop the queue
 
             // check prohibited & required and minNrShouldMatch
-            if ((current->bits & prohibitedMask) == 0 && (current->bits & requiredMask) == requiredMask && current->coord >= minNrShouldMatch) {
-                doc = current->doc;
+            int32_t bits = bucketTable->bits[current];
+            if ((bits & prohibitedMask) == 0 && (bits & requiredMask) == requiredMask && bucketTable->coords[current] >= minNrShouldMatch) {
+                doc = bucketTable->docs[current];
                 return doc;
             }
         }
 
         // refill the queue
-        more = false;
-        end += BucketTable::SIZE;
-
-        for (SubScorerPtr sub(scorers); sub; sub = sub->next) {
-            ScorerPtr scorer(sub->scorer);
-            sub->collector->setScorer(scorer);
-            int32_t doc = scorer->docID();
-            while (doc < end) {
-                sub->collector->collect(doc);
-                doc = scorer->nextDoc();
-            }
-            if (doc != NO_MORE_DOCS) {
-                more = true;
-            }
-        }
-    } while (bucketTable->first || more);
+        more = fillWindow();
+    } while (bucketTable->first != -1 || more);
 
     doc = NO_MORE_DOCS;
     return doc;
 }
 
 double BooleanScorer::score() {
-    return current->score * coordFactors[current->coord];
+    return bucketTable->scores[current] * coordFactors[bucketTable->coords[current]];
 }
 
 void BooleanScorer::score(const CollectorPtr& collector) {
@@ -177,27 +215,7 @@ BooleanScorerCollector::~BooleanScorerCollector() {
 }
 
 void BooleanScorerCollector::collect(int32_t doc) {
-    BucketTablePtr table(_bucketTable);
-    int32_t i = doc & BucketTable::MASK;
-    BucketPtr bucket(table->buckets[i]);
-    if (!bucket) {
-        bucket = newLucene<Bucket>();
-        table->buckets[i] = bucket;
-    }
-
-    if (bucket->doc != doc) { // invalid bucket
-        bucket->doc = doc; // set doc
-        bucket->score = ScorerPtr(_scorer)->score(); // initialize score
-        bucket->bits = mask; // initialize mask
-        bucket->coord = 1; // initialize coord
-
-        bucket->_next = table->first; // push onto valid list
-        table->first = bucket;
-    } else {
-        bucket->score += ScorerPtr(_scorer)->score(); // increment score
-        bucket->bits |= mask; // add bits in mask
-        ++bucket->coord; // increment coord
-    }
+    BucketTablePtr(_bucketTable)->add(doc, ScorerPtr(_scorer)->score(), mask);
 }
 
 void BooleanScorerCollector::setNextReader(const IndexReaderPtr& reader, int32_t docBase) {
@@ -236,26 +254,26 @@ double BucketScorer::score() {
     return _score;
 }
 
-Bucket::Bucket() {
-    doc = -1;
-    score = 0;
-    bits = 0;
-    coord = 0;
-}
-
-Bucket::~Bucket() {
-}
-
-const int32_t BucketTable::SIZE = 1 << 11;
+const int32_t BucketTable::SIZE = 1 << 12;
 const int32_t BucketTable::MASK = BucketTable::SIZE - 1;
 
 BucketTable::BucketTable() {
-    buckets = Collection<BucketPtr>::newInstance(SIZE);
+    docs = Collection<int32_t>::newInstance(SIZE);
+    scores = Collection<double>::newInstance(SIZE);
+    bits = Collection<int32_t>::newInstance(SIZE);
+    coords = Collection<int32_t>::newInstance(SIZE);
+    next = Collection<int32_t>::newInstance(SIZE);
+    clear();
 }
 
 BucketTable::~BucketTable() {
 }
 
+void BucketTable::clear() {
+    std::fill(docs.begin(), docs.end(), -1);
+    first = -1;
+}
+
 CollectorPtr BucketTable::newCollector(int32_t mask) {
     return newLucene<BooleanScorerCollector>(mask, shared_from_this());
 }
@@ -264,8 +282,16 @@ int32_t BucketTable::size() {
     return SIZE;
 }
 
-SubScorer::SubScorer(const ScorerPtr& scorer, bool required, bool prohibited, const CollectorPtr& collector, const SubScorerPtr& next) {
+void BucketTable::add(Collection<int32_t> docBuffer, Collection<double> scoreBuffer, int32_t count, int32_t mask) {
+    for (int32_t i = 0; i < count; ++i) {
+        add(docBuffer[i], scoreBuffer[i], mask);
+    }
+}
+
+SubScorer::SubScorer(const ScorerPtr& scorer, bool required, bool prohibited, int32_t mask, const CollectorPtr& collector, const SubScorerPtr& next) {
     this->scorer = scorer;
+    this->termScorer = boost::dynamic_pointer_cast<TermScorer>(scorer);
+    this->mask = mask;
     this->required = required;
     this->prohibited = prohibited;
     this->collector = collector;
@@ -136,7 +136,7 @@ DisjunctionMaxWeight::DisjunctionMaxWeight(const DisjunctionMaxQueryPtr& query,
     this->similarity = searcher->getSimilarity();
     this->weights = Collection<WeightPtr>::newInstance();
     for (Collection<QueryPtr>::iterator disjunctQuery = query->disjuncts.begin(); disjunctQuery != query->disjuncts.end(); ++disjunctQuery) {
-        this->weights.add((*disjunctQuery)->createWeight(searcher));
+        this->weights.add(searcher->createNodeWeight(*disjunctQuery));
     }
 }
 
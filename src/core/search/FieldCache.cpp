@@ -10,6 +10,7 @@
 #include "FieldCacheImpl.h"
 #include "NumericUtils.h"
 #include "StringUtils.h"
+#include "MiscUtils.h"
 
 namespace Lucene {
 
@@ -141,6 +142,31 @@ StringIndexPtr FieldCache::getStringIndex(const IndexReaderPtr& reader, const St
     return StringIndexPtr(); // override
 }
 
+PackedValuesPtr FieldCache::getPackedInts(const IndexReaderPtr& reader, const String& field) {
+    BOOST_ASSERT(false);
+    return PackedValuesPtr(); // override
+}
+
+PackedValuesPtr FieldCache::getPackedInts(const IndexReaderPtr& reader, const String& field, const IntParserPtr& parser) {
+    BOOST_ASSERT(false);
+    return PackedValuesPtr(); // override
+}
+
+PackedValuesPtr FieldCache::getPackedLongs(const IndexReaderPtr& reader, const String& field) {
+    BOOST_ASSERT(false);
+    return PackedValuesPtr(); // override
+}
+
+PackedValuesPtr FieldCache::getPackedLongs(const IndexReaderPtr& reader, const String& field, const LongParserPtr& parser) {
+    BOOST_ASSERT(false);
+    return PackedValuesPtr(); // override
+}
+
+PackedStringIndexPtr FieldCache::getPackedStringIndex(const IndexReaderPtr& reader, const String& field) {
+    BOOST_ASSERT(false);
+    return PackedStringIndexPtr(); // override
+}
+
 void FieldCache::setInfoStream(const InfoStreamPtr& stream) {
     BOOST_ASSERT(false);
     // override
@@ -168,6 +194,84 @@ int32_t StringIndex::binarySearchLookup(const String& key) {
     return (search == lookup.end() || key < *search) ? -(keyPos + 1) : keyPos;
 }
 
+PackedValues::PackedValues(int64_t minValue, const PackedIntsPtr& deltas) {
+    this->minValue = minValue;
+    this->deltas = deltas;
+}
+
+PackedValues::~PackedValues() {
+}
+
+int32_t PackedValues::size() {
+    return deltas->size();
+}
+
+int64_t PackedValues::getMinValue() {
+    return minValue;
+}
+
+int32_t PackedValues::getBitsPerValue() {
+    return deltas->getBitsPerValue();
+}
+
+int64_t PackedValues::ramBytesUsed() {
+    return deltas->ramBytesUsed();
+}
+
+PackedStringIndex::PackedStringIndex(const PackedIntsPtr& order, ByteArray termBytes, const PackedIntsPtr& termOffsets) {
+    this->order = order;
+    this->termBytes = termBytes;
+    this->termOffsets = termOffsets;
+}
+
+PackedStringIndex::~PackedStringIndex() {
+}
+
+int32_t PackedStringIndex::numOrds() {
+    return termOffsets->size() - 1;
+}
+
+String PackedStringIndex::lookup(int32_t ord) {
+    int32_t length = 0;
+    const uint8_t* utf8 = lookupUTF8(ord, length);
+    return length == 0 ? L"" : StringUtils::toUnicode(utf8, length);
+}
+
+const uint8_t* PackedStringIndex::lookupUTF8(int32_t ord, int32_t& length) {
+    int32_t start = (int32_t)termOffsets->get(ord);
+    length = (int32_t)termOffsets->get(ord + 1) - start;
+    return termBytes.get() + start;
+}
+
+int32_t PackedStringIndex::binarySearchLookup(const String& key) {
+    return binarySearchLookup(key, 0, numOrds() - 1);
+}
+
+int32_t PackedStringIndex::binarySearchLookup(const String& key, int32_t low, int32_t high) {
+    // terms are decoded for the comparison, since UTF-8 byte order is not the order of wide strings
+    // on every platform
+    while (low <= high) {
+        int32_t mid = MiscUtils::unsignedShift(low + high, 1);
+        int32_t cmp = lookup(mid).compare(key);
+        if (cmp < 0) {
+            low = mid + 1;
+        } else if (cmp > 0) {
+            high = mid - 1;
+        } else {
+            return mid;
+        }
+    }
+    return -(low + 1);
+}
+
+int32_t PackedStringIndex::size() {
+    return order->size();
+}
+
+int64_t PackedStringIndex::ramBytesUsed() {
+    return order->ramBytesUsed() + termBytes.size() + termOffsets->ramBytesUsed();
+}
+
 Parser::~Parser() {
 }
 
@@ -13,6 +13,9 @@
 #include "TermDocs.h"
 #include "Term.h"
 #include "StringUtils.h"
+#include "MiscUtils.h"
+#include "OpenBitSet.h"
+#include "ReaderUtil.h"
 #include "VariantUtils.h"
 
 namespace Lucene {
@@ -31,6 +34,9 @@ void FieldCacheImpl::initialize() {
     caches.put(CACHE_DOUBLE, newLucene<DoubleCache>(shared_from_this()));
     caches.put(CACHE_STRING, newLucene<StringCache>(shared_from_this()));
     caches.put(CACHE_STRING_INDEX, newLucene<StringIndexCache>(shared_from_this()));
+    caches.put(CACHE_PACKED_INT, newLucene<PackedIntCache>(shared_from_this()));
+    caches.put(CACHE_PACKED_LONG, newLucene<PackedLongCache>(shared_from_this()));
+    caches.put(CACHE_PACKED_STRING_INDEX, newLucene<PackedStringIndexCache>(shared_from_this()));
 }
 
 void FieldCacheImpl::purgeAllCaches() {
@@ -100,6 +106,26 @@ StringIndexPtr FieldCacheImpl::getStringIndex(const IndexReaderPtr& reader, cons
     return VariantUtils::get< StringIndexPtr >(caches.get(CACHE_STRING_INDEX)->get(reader, newLucene<Entry>(field, ParserPtr())));
 }
 
+PackedValuesPtr FieldCacheImpl::getPackedInts(const IndexReaderPtr& reader, const String& field) {
+    return getPackedInts(reader, field, IntParserPtr());
+}
+
+PackedValuesPtr FieldCacheImpl::getPackedInts(const IndexReaderPtr& reader, const String& field, const IntParserPtr& parser) {
+    return VariantUtils::get< PackedValuesPtr >(caches.get(CACHE_PACKED_INT)->get(reader, newLucene<Entry>(field, parser)));
+}
+
+PackedValuesPtr FieldCacheImpl::getPackedLongs(const IndexReaderPtr& reader, const String& field) {
+    return getPackedLongs(reader, field, LongParserPtr());
+}
+
+PackedValuesPtr FieldCacheImpl::getPackedLongs(const IndexReaderPtr& reader, const String& field, const LongParserPtr& parser) {
+    return VariantUtils::get< PackedValuesPtr >(caches.get(CACHE_PACKED_LONG)->get(reader, newLucene<Entry>(field, parser)));
+}
+
+PackedStringIndexPtr FieldCacheImpl::getPackedStringIndex(const IndexReaderPtr& reader, const String& field) {
+    return VariantUtils::get< PackedStringIndexPtr >(caches.get(CACHE_PACKED_STRING_INDEX)->get(reader, newLucene<Entry>(field, ParserPtr())));
+}
+
 void FieldCacheImpl::setInfoStream(const InfoStreamPtr& stream) {
     infoStream = stream;
 }
@@ -206,6 +232,107 @@ void Cache::printNewInsanity(const InfoStreamPtr& infoStream, const boost::any&
     }
 }
 
+/// Doc values are held by segment readers only.  For a composite reader, the columns of its segments are
+/// joined into one covering all of its documents, since the field may have no terms to un-invert.
+static PackedValuesPtr getNumericDocValues(const IndexReaderPtr& reader, const String& field) {
+    PackedValuesPtr docValues(reader->getNumericDocValues(field));
+    if (docValues || !reader->getSequentialSubReaders() || !reader->getFieldNames(IndexReader::FIELD_OPTION_NUMERIC_DOC_VALUES).contains(field)) {
+        return docValues;
+    }
+    Collection<IndexReaderPtr> subReaders(Collection<IndexReaderPtr>::newInstance());
+    ReaderUtil::gatherSubReaders(subReaders, reader);
+    Collection<PackedValuesPtr> subValues(Collection<PackedValuesPtr>::newInstance(subReaders.size()));
+    int64_t minValue = std::numeric_limits<int64_t>::max();
+    int64_t maxValue = std::numeric_limits<int64_t>::min();
+    for (int32_t i = 0; i < subReaders.size(); ++i) {
+        subValues[i] = subReaders[i]->getNumericDocValues(field);
+        if (!subValues[i]) { // documents of segments without the column read as 0
+            minValue = std::min(minValue, (int64_t)0);
+            maxValue = std::max(maxValue, (int64_t)0);
+            continue;
+        }
+        for (int32_t doc = 0; doc < subValues[i]->size(); ++doc) {
+            int64_t value = subValues[i]->get(doc);
+            minValue = std::min(minValue, value);
+            maxValue = std::max(maxValue, value);
+        }
+    }
+    if (minValue > maxValue) { // no documents
+        minValue = 0;
+        maxValue = 0;
+    }
+    PackedIntsPtr deltas(newLucene<PackedInts>(reader->maxDoc(), PackedInts::bitsRequired((int64_t)((uint64_t)maxValue - (uint64_t)minValue))));
+    int32_t docBase = 0;
+    for (int32_t i = 0; i < subReaders.size(); ++i) {
+        int32_t subMaxDoc = subReaders[i]->maxDoc();
+        for (int32_t doc = 0; doc < subMaxDoc; ++doc) {
+            int64_t value = subValues[i] ? subValues[i]->get(doc) : 0;
+            deltas->set(docBase + doc, (int64_t)((uint64_t)value - (uint64_t)minValue));
+        }
+        docBase += subMaxDoc;
+    }
+    return newLucene<PackedValues>(minValue, deltas);
+}
+
+/// Sorted doc values of a composite reader, joined from its segments as for numeric values.  The ordinals
+/// of each segment are mapped onto the sorted union of the segments' values.
+static PackedStringIndexPtr getSortedDocValues(const IndexReaderPtr& reader, const String& field) {
+    PackedStringIndexPtr docValues(reader->getSortedDocValues(field));
+    if (docValues || !reader->getSequentialSubReaders() || !reader->getFieldNames(IndexReader::FIELD_OPTION_SORTED_DOC_VALUES).contains(field)) {
+        return docValues;
+    }
+    Collection<IndexReaderPtr> subReaders(Collection<IndexReaderPtr>::newInstance());
+    ReaderUtil::gatherSubReaders(subReaders, reader);
+    Collection<PackedStringIndexPtr> subValues(Collection<PackedStringIndexPtr>::newInstance(subReaders.size()));
+    Collection<String> terms(Collection<String>::newInstance());
+    for (int32_t i = 0; i < subReaders.size(); ++i) {
+        subValues[i] = subReaders[i]->getSortedDocValues(field);
+        if (subValues[i]) {
+            for (int32_t ord = 1; ord < subValues[i]->numOrds(); ++ord) {
+                terms.add(subValues[i]->lookup(ord));
+            }
+        }
+    }
+    std::sort(terms.begin(), terms.end());
+    terms.resize((int32_t)(std::unique(terms.begin(), terms.end()) - terms.begin()));
+
+    ByteArray termBytes(ByteArray::newInstance(1024));
+    Collection<int32_t> offsets(Collection<int32_t>::newInstance());
+    offsets.add(0);
+    offsets.add(0);
+    int32_t length = 0;
+    for (Collection<String>::iterator term = terms.begin(); term != terms.end(); ++term) {
+        SingleString utf8(StringUtils::toUTF8(*term));
+        if (length + (int32_t)utf8.length() > termBytes.size()) {
+            termBytes.resize(MiscUtils::getNextSize(length + (int32_t)utf8.length()));
+        }
+        MiscUtils::arrayCopy((const uint8_t*)utf8.c_str(), 0, termBytes.get(), length, (int32_t)utf8.length());
+        length += (int32_t)utf8.length();
+        offsets.add(length);
+    }
+    termBytes.resize(std::max(length, 1)); // trim, keeping the array valid if there are no terms
+    PackedIntsPtr termOffsets(newLucene<PackedInts>(offsets.size(), PackedInts::bitsRequired(length)));
+    for (int32_t i = 0; i < offsets.size(); ++i) {
+        termOffsets->set(i, offsets[i]);
+    }
+
+    PackedIntsPtr order(newLucene<PackedInts>(reader->maxDoc(), PackedInts::bitsRequired(terms.size())));
+    int32_t docBase = 0;
+    for (int32_t i = 0; i < subReaders.size(); ++i) {
+        if (subValues[i]) {
+            Collection<int32_t> ordMap(Collection<int32_t>::newInstance(subValues[i]->numOrds()));
+            for (int32_t ord = 1; ord < ordMap.size(); ++ord) {
+                ordMap[ord] = (int32_t)(std::lower_bound(terms.begin(), terms.end(), subValues[i]->lookup(ord)) - terms.begin()) + 1;
+            }
+            for (int32_t doc = 0; doc < subValues[i]->size(); ++doc) {
+                order->set(docBase + doc, ordMap[subValues[i]->getOrd(doc)]);
+            }
+        }
+        docBase += subReaders[i]->maxDoc();
+    }
+    return newLucene<PackedStringIndex>(order, termBytes, termOffsets);
+}
+
 ByteCache::ByteCache(const FieldCachePtr& wrapper) : Cache(wrapper) {
 }
 
@@ -251,11 +378,36 @@ IntCache::IntCache(const FieldCachePtr& wrapper) : Cache(wrapper) {
 IntCache::~IntCache() {
 }
 
+/// Doc values columns hold longs; rather than silently narrowing them, int caches refuse columns with values
+/// outside the int range.
+static void checkIntDocValues(const String& field, const PackedValuesPtr& docValues) {
+    int64_t minValue = docValues->getMinValue();
+    int32_t bits = docValues->getBitsPerValue();
+    if (minValue >= INT_MIN && bits < 32 && minValue + ((int64_t)1 << bits) - 1 <= INT_MAX) {
+        return; // no value the column can hold is out of range
+    }
+    for (int32_t doc = 0; doc < docValues->size(); ++doc) {
+        int64_t value = docValues->get(doc);
+        if (value < INT_MIN || value > INT_MAX) {
+            boost::throw_exception(IllegalStateException(L"doc values of field " + field + L" don't fit in an int, use getLongs"));
+        }
+    }
+}
+
 boost::any IntCache::createValue(const IndexReaderPtr& reader, const EntryPtr& key) {
     EntryPtr entry(key);
     String field(entry->field);
     IntParserPtr parser(VariantUtils::get<IntParserPtr>(entry->custom));
     if (!parser) {
+        PackedValuesPtr docValues(getNumericDocValues(reader, field));
+        if (docValues) {
+            checkIntDocValues(field, docValues);
+            Collection<int32_t> retArray(Collection<int32_t>::newInstance(docValues->size()));
+            for (int32_t doc = 0; doc < retArray.size(); ++doc) {
+                retArray[doc] = (int32_t)docValues->get(doc);
+            }
+            return retArray;
+        }
         FieldCachePtr wrapper(_wrapper);
         boost::any ints;
         try {
@@ -308,6 +460,14 @@ boost::any LongCache::createValue(const IndexReaderPtr& reader, const EntryPtr&
     String field(entry->field);
     LongParserPtr parser(VariantUtils::get<LongParserPtr>(entry->custom));
     if (!parser) {
+        PackedValuesPtr docValues(getNumericDocValues(reader, field));
+        if (docValues) {
+            Collection<int64_t> retArray(Collection<int64_t>::newInstance(docValues->size()));
+            for (int32_t doc = 0; doc < retArray.size(); ++doc) {
+                retArray[doc] = docValues->get(doc);
+            }
+            return retArray;
+        }
         FieldCachePtr wrapper(_wrapper);
         boost::any longs;
         try {
@@ -411,6 +571,13 @@ boost::any StringCache::createValue(const IndexReaderPtr& reader, const EntryPtr
     EntryPtr entry(key);
     String field(entry->field);
     Collection<String> retArray(Collection<String>::newInstance(reader->maxDoc()));
+    PackedStringIndexPtr docValues(getSortedDocValues(reader, field));
+    if (docValues) {
+        for (int32_t doc = 0; doc < retArray.size(); ++doc) {
+            retArray[doc] = docValues->lookup(docValues->getOrd(doc));
+        }
+        return retArray;
+    }
     TermDocsPtr termDocs(reader->termDocs());
     TermEnumPtr termEnum(reader->terms(newLucene<Term>(field)));
     LuceneException finally;
@@ -444,6 +611,18 @@ StringIndexCache::~StringIndexCache() {
 boost::any StringIndexCache::createValue(const IndexReaderPtr& reader, const EntryPtr& key) {
     EntryPtr entry(key);
     String field(entry->field);
+    PackedStringIndexPtr docValues(getSortedDocValues(reader, field));
+    if (docValues) {
+        Collection<int32_t> order(Collection<int32_t>::newInstance(docValues->size()));
+        for (int32_t doc = 0; doc < order.size(); ++doc) {
+            order[doc] = docValues->getOrd(doc);
+        }
+        Collection<String> lookup(Collection<String>::newInstance(docValues->numOrds()));
+        for (int32_t ord = 0; ord < lookup.size(); ++ord) {
+            lookup[ord] = docValues->lookup(ord);
+        }
+        return newLucene<StringIndex>(order, lookup);
+    }
     Collection<int32_t> retArray(Collection<int32_t>::newInstance(reader->maxDoc()));
     Collection<String> mterms(Collection<String>::newInstance(reader->maxDoc() + 1));
     TermDocsPtr termDocs(reader->termDocs());
@@ -491,6 +670,235 @@ boost::any StringIndexCache::createValue(const IndexReaderPtr& reader, const Ent
     return newLucene<StringIndex>(retArray, mterms);
 }
 
+/// Parses term text as an int, for {@link #packValues}.
+struct PackedIntParser {
+    PackedIntParser(const IntParserPtr& parser) : parser(parser) {}
+    IntParserPtr parser;
+    int64_t operator()(const String& text) const {
+        return parser->parseInt(text);
+    }
+};
+
+/// Parses term text as a long, for {@link #packValues}.
+struct PackedLongParser {
+    PackedLongParser(const LongParserPtr& parser) : parser(parser) {}
+    LongParserPtr parser;
+    int64_t operator()(const String& text) const {
+        return parser->parseLong(text);
+    }
+};
+
+/// Reads the values of a numeric field in two passes: over the terms alone, to find the range of values,
+/// then over their documents to fill an array packed to that range.  The full width array is never built.
+template <typename PARSER>
+static PackedValuesPtr packValues(const IndexReaderPtr& reader, const String& field, const PARSER& parser) {
+    int64_t minValue = std::numeric_limits<int64_t>::max();
+    int64_t maxValue = std::numeric_limits<int64_t>::min();
+    TermEnumPtr termEnum(reader->terms(newLucene<Term>(field)));
+    LuceneException finally;
+    try {
+        do {
+            TermPtr term(termEnum->term());
+            if (!term || term->field() != field) {
+                break;
+            }
+            int64_t termval = parser(term->text());
+            minValue = std::min(minValue, termval);
+            maxValue = std::max(maxValue, termval);
+        } while (termEnum->next());
+    } catch (StopFillCacheException&) {
+    } catch (LuceneException& e) {
+        finally = e;
+    }
+    termEnum->close();
+    finally.throwException();
+
+    int32_t maxDoc = reader->maxDoc();
+    if (minValue > maxValue) { // no values
+        return newLucene<PackedValues>(0, newLucene<PackedInts>(maxDoc, 1));
+    }
+
+    PackedIntsPtr deltas(newLucene<PackedInts>(maxDoc, PackedInts::bitsRequired((int64_t)((uint64_t)maxValue - (uint64_t)minValue))));
+    OpenBitSetPtr docsWithValue(newLucene<OpenBitSet>(maxDoc));
+    TermDocsPtr termDocs(reader->termDocs());
+    termEnum = reader->terms(newLucene<Term>(field));
+    try {
+        do {
+            TermPtr term(termEnum->term());
+            if (!term || term->field() != field) {
+                break;
+            }
+            int64_t delta = (int64_t)((uint64_t)parser(term->text()) - (uint64_t)minValue);
+            termDocs->seek(termEnum);
+            while (termDocs->next()) {
+                deltas->set(termDocs->doc(), delta);
+                docsWithValue->fastSet(termDocs->doc());
+            }
+        } while (termEnum->next());
+    } catch (StopFillCacheException&) {
+    } catch (LuceneException& e) {
+        finally = e;
+    }
+    termDocs->close();
+    termEnum->close();
+    finally.throwException();
+
+    if (docsWithValue->cardinality() < reader->numDocs()) {
+        // documents without a value read as 0, so if 0 is out of range the values are packed again to a
+        // range that includes it
+        int64_t newMinValue = std::min(minValue, (int64_t)0);
+        int64_t newMaxValue = std::max(maxValue, (int64_t)0);
+        if (newMinValue != minValue || newMaxValue != maxValue) {
+            PackedIntsPtr newDeltas(newLucene<PackedInts>(maxDoc, PackedInts::bitsRequired((int64_t)((uint64_t)newMaxValue - (uint64_t)newMinValue))));
+            for (int32_t doc = 0; doc < maxDoc; ++doc) {
+                int64_t value = docsWithValue->fastGet(doc) ? (int64_t)((uint64_t)minValue + (uint64_t)deltas->get(doc)) : 0;
+                newDeltas->set(doc, (int64_t)((uint64_t)value - (uint64_t)newMinValue));
+            }
+            minValue = newMinValue;
+            deltas = newDeltas;
+        }
+    }
+    return newLucene<PackedValues>(minValue, deltas);
+}
+
+PackedIntCache::PackedIntCache(const FieldCachePtr& wrapper) : Cache(wrapper) {
+}
+
+PackedIntCache::~PackedIntCache() {
+}
+
+boost::any PackedIntCache::createValue(const IndexReaderPtr& reader, const EntryPtr& key) {
+    EntryPtr entry(key);
+    String field(entry->field);
+    IntParserPtr parser(VariantUtils::get<IntParserPtr>(entry->custom));
+    if (!parser) {
+        PackedValuesPtr docValues(getNumericDocValues(reader, field));
+        if (docValues) {
+            checkIntDocValues(field, docValues);
+            return docValues;
+        }
+        FieldCachePtr wrapper(_wrapper);
+        boost::any ints;
+        try {
+            ints = wrapper->getPackedInts(reader, field, FieldCache::DEFAULT_INT_PARSER());
+        } catch (NumberFormatException&) {
+            ints = wrapper->getPackedInts(reader, field, FieldCache::NUMERIC_UTILS_INT_PARSER());
+        }
+        return ints;
+    }
+    return packValues(reader, field, PackedIntParser(parser));
+}
+
+PackedLongCache::PackedLongCache(const FieldCachePtr& wrapper) : Cache(wrapper) {
+}
+
+PackedLongCache::~PackedLongCache() {
+}
+
+boost::any PackedLongCache::createValue(const IndexReaderPtr& reader, const EntryPtr& key) {
+    EntryPtr entry(key);
+    String field(entry->field);
+    LongParserPtr parser(VariantUtils::get<LongParserPtr>(entry->custom));
+    if (!parser) {
+        PackedValuesPtr docValues(getNumericDocValues(reader, field));
+        if (docValues) {
+            return docValues;
+        }
+        FieldCachePtr wrapper(_wrapper);
+        boost::any longs;
+        try {
+            longs = wrapper->getPackedLongs(reader, field, FieldCache::DEFAULT_LONG_PARSER());
+        } catch (NumberFormatException&) {
+            longs = wrapper->getPackedLongs(reader, field, FieldCache::NUMERIC_UTILS_LONG_PARSER());
+        }
+        return longs;
+    }
+    return packValues(reader, field, PackedLongParser(parser));
+}
+
+PackedStringIndexCache::PackedStringIndexCache(const FieldCachePtr& wrapper) : Cache(wrapper) {
+}
+
+PackedStringIndexCache::~PackedStringIndexCache() {
+}
+
+boost::any PackedStringIndexCache::createValue(const IndexReaderPtr& reader, const EntryPtr& key) {
+    EntryPtr entry(key);
+    String field(entry->field);
+    PackedStringIndexPtr docValues(getSortedDocValues(reader, field));
+    if (docValues) {
+        return docValues;
+    }
+    int32_t maxDoc = reader->maxDoc();
+
+    // first pass: append the UTF-8 of each term to a single block, ordinal 0 being the empty value of
+    // documents with no term in this field.  Every term is kept, so the ordinals are packed to the bits the
+    // actual number of terms needs.
+    ByteArray termBytes(ByteArray::newInstance(1024));
+    Collection<int32_t> offsets(Collection<int32_t>::newInstance());
+    offsets.add(0);
+    offsets.add(0);
+    int32_t length = 0;
+    TermEnumPtr termEnum(reader->terms(newLucene<Term>(field)));
+    LuceneException finally;
+    try {
+        do {
+            TermPtr term(termEnum->term());
+            if (!term || term->field() != field) {
+                break;
+            }
+            SingleString utf8(StringUtils::toUTF8(term->text()));
+            if (length + (int32_t)utf8.length() > termBytes.size()) {
+                termBytes.resize(MiscUtils::getNextSize(length + (int32_t)utf8.length()));
+            }
+            MiscUtils::arrayCopy((const uint8_t*)utf8.c_str(), 0, termBytes.get(), length, (int32_t)utf8.length());
+            length += (int32_t)utf8.length();
+            offsets.add(length);
+        } while (termEnum->next());
+    } catch (LuceneException& e) {
+        finally = e;
+    }
+    termEnum->close();
+    finally.throwException();
+
+    termBytes.resize(std::max(length, 1)); // trim, keeping the array valid if there are no terms
+    PackedIntsPtr termOffsets(newLucene<PackedInts>(offsets.size(), PackedInts::bitsRequired(length)));
+    for (int32_t i = 0; i < offsets.size(); ++i) {
+        termOffsets->set(i, offsets[i]);
+    }
+    int32_t numOrds = offsets.size() - 1;
+    offsets.clear();
+
+    // second pass: the ordinal of each document, packed to the number of terms
+    PackedIntsPtr order(newLucene<PackedInts>(maxDoc, PackedInts::bitsRequired(numOrds - 1)));
+    TermDocsPtr termDocs(reader->termDocs());
+    termEnum = reader->terms(newLucene<Term>(field));
+    try {
+        int32_t ord = 1;
+        do {
+            TermPtr term(termEnum->term());
+            if (!term || term->field() != field) {
+                break;
+            }
+            if (ord >= numOrds) {
+                boost::throw_exception(RuntimeException(L"more terms in field " + field + L" than counted when sizing its ordinals"));
+            }
+            termDocs->seek(termEnum);
+            while (termDocs->next()) {
+                order->set(termDocs->doc(), ord);
+            }
+            ++ord;
+        } while (termEnum->next());
+    } catch (LuceneException& e) {
+        finally = e;
+    }
+    termDocs->close();
+    termEnum->close();
+    finally.throwException();
+
+    return newLucene<PackedStringIndex>(order, termBytes, termOffsets);
+}
+
 FieldCacheEntryImpl::FieldCacheEntryImpl(const LuceneObjectPtr& readerKey, const String& fieldName, int32_t cacheType, const boost::any& custom, const boost::any& value) {
     this->readerKey = readerKey;
     this->fieldName = fieldName;
@@ -117,6 +117,159 @@ void LongComparator::setNextReader(const IndexReaderPtr& reader, int32_t docBase
     currentReaderValues = FieldCache::DEFAULT()->getLongs(reader, field, parser);
 }
 
+PackedIntComparator::PackedIntComparator(int32_t numHits, const String& field, const ParserPtr& parser) : NumericComparator<int32_t>(numHits, field) {
+    this->parser = boost::dynamic_pointer_cast<IntParser>(parser);
+    if (parser && !this->parser) {
+        boost::throw_exception(IllegalArgumentException(L"PackedIntComparator needs an IntParser: got " + parser->toString()));
+    }
+}
+
+PackedIntComparator::~PackedIntComparator() {
+}
+
+int32_t PackedIntComparator::compare(int32_t slot1, int32_t slot2) {
+    int32_t v1 = values[slot1];
+    int32_t v2 = values[slot2];
+    return v1 > v2 ? 1 : (v1 < v2 ? -1 : 0);
+}
+
+int32_t PackedIntComparator::compareBottom(int32_t doc) {
+    int32_t v2 = (int32_t)currentReaderPacked->get(doc);
+    return bottom > v2 ? 1 : (bottom < v2 ? -1 : 0);
+}
+
+void PackedIntComparator::copy(int32_t slot, int32_t doc) {
+    values[slot] = (int32_t)currentReaderPacked->get(doc);
+}
+
+void PackedIntComparator::setNextReader(const IndexReaderPtr& reader, int32_t docBase) {
+    currentReaderPacked = FieldCache::DEFAULT()->getPackedInts(reader, field, parser);
+}
+
+PackedLongComparator::PackedLongComparator(int32_t numHits, const String& field, const ParserPtr& parser) : NumericComparator<int64_t>(numHits, field) {
+    this->parser = boost::dynamic_pointer_cast<LongParser>(parser);
+    if (parser && !this->parser) {
+        boost::throw_exception(IllegalArgumentException(L"PackedLongComparator needs a LongParser: got " + parser->toString()));
+    }
+}
+
+PackedLongComparator::~PackedLongComparator() {
+}
+
+int32_t PackedLongComparator::compare(int32_t slot1, int32_t slot2) {
+    int64_t v1 = values[slot1];
+    int64_t v2 = values[slot2];
+    return v1 > v2 ? 1 : (v1 < v2 ? -1 : 0);
+}
+
+int32_t PackedLongComparator::compareBottom(int32_t doc) {
+    int64_t v2 = currentReaderPacked->get(doc);
+    return bottom > v2 ? 1 : (bottom < v2 ? -1 : 0);
+}
+
+void PackedLongComparator::copy(int32_t slot, int32_t doc) {
+    values[slot] = currentReaderPacked->get(doc);
+}
+
+void PackedLongComparator::setNextReader(const IndexReaderPtr& reader, int32_t docBase) {
+    currentReaderPacked = FieldCache::DEFAULT()->getPackedLongs(reader, field, parser);
+}
+
+PackedStringOrdValComparator::PackedStringOrdValComparator(int32_t numHits, const String& field, int32_t sortPos, bool reversed) {
+    this->ords = Collection<int32_t>::newInstance(numHits);
+    this->values = Collection<String>::newInstance(numHits);
+    this->readerGen = Collection<int32_t>::newInstance(numHits);
+    this->sortPos = sortPos;
+    this->reversed = reversed;
+    this->field = field;
+    this->currentReaderGen = -1;
+    this->bottomSlot = -1;
+    this->bottomOrd = 0;
+}
+
+PackedStringOrdValComparator::~PackedStringOrdValComparator() {
+}
+
+int32_t PackedStringOrdValComparator::compare(int32_t slot1, int32_t slot2) {
+    if (readerGen[slot1] == readerGen[slot2]) {
+        int32_t cmp = ords[slot1] - ords[slot2];
+        if (cmp != 0) {
+            return cmp;
+        }
+    }
+    return values[slot1].compare(values[slot2]);
+}
+
+int32_t PackedStringOrdValComparator::compareBottom(int32_t doc) {
+    BOOST_ASSERT(bottomSlot != -1);
+    int32_t order = index->getOrd(doc);
+    int32_t cmp = bottomOrd - order;
+    if (cmp != 0) {
+        return cmp;
+    }
+    return bottomValue.compare(index->lookup(order));
+}
+
+void PackedStringOrdValComparator::convert(int32_t slot) {
+    readerGen[slot] = currentReaderGen;
+    int32_t ord = 0;
+    String value(values[slot]);
+    if (value.empty()) {
+        ords[slot] = 0;
+        return;
+    }
+
+    if (sortPos == 0 && bottomSlot != -1 && bottomSlot != slot) {
+        // Since we are the primary sort, the entries in the queue are bounded by bottomOrd
+        BOOST_ASSERT(bottomOrd < index->numOrds());
+        if (reversed) {
+            ord = index->binarySearchLookup(value, bottomOrd, index->numOrds() - 1);
+        } else {
+            ord = index->binarySearchLookup(value, 0, bottomOrd);
+        }
+    } else {
+        // Full binary search
+        ord = index->binarySearchLookup(value);
+    }
+
+    if (ord < 0) {
+        ord = -ord - 2;
+    }
+
+    ords[slot] = ord;
+}
+
+void PackedStringOrdValComparator::copy(int32_t slot, int32_t doc) {
+    int32_t ord = index->getOrd(doc);
+    ords[slot] = ord;
+    values[slot] = index->lookup(ord);
+    readerGen[slot] = currentReaderGen;
+}
+
+void PackedStringOrdValComparator::setNextReader(const IndexReaderPtr& reader, int32_t docBase) {
+    index = FieldCache::DEFAULT()->getPackedStringIndex(reader, field);
+    ++currentReaderGen;
+    if (bottomSlot != -1) {
+        convert(bottomSlot);
+        bottomOrd = ords[bottomSlot];
+    }
+}
+
+void PackedStringOrdValComparator::setBottom(int32_t slot) {
+    bottomSlot = slot;
+    if (readerGen[slot] != currentReaderGen) {
+        convert(bottomSlot);
+    }
+    bottomOrd = ords[slot];
+    BOOST_ASSERT(bottomOrd >= 0);
+    BOOST_ASSERT(bottomOrd < index->numOrds());
+    bottomValue = values[slot];
+}
+
+ComparableValue PackedStringOrdValComparator::value(int32_t slot) {
+    return values[slot];
+}
+
 RelevanceComparator::RelevanceComparator(int32_t numHits) : NumericComparator<double>(numHits) {
 }
 
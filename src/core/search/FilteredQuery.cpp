@@ -10,6 +10,7 @@
 #include "Explanation.h"
 #include "Filter.h"
 #include "DocIdSet.h"
+#include "Searcher.h"
 #include "MiscUtils.h"
 
 namespace Lucene {
@@ -23,7 +24,7 @@ FilteredQuery::~FilteredQuery() {
 }
 
 WeightPtr FilteredQuery::createWeight(const SearcherPtr& searcher) {
-    WeightPtr weight(query->createWeight(searcher));
+    WeightPtr weight(searcher->createNodeWeight(query));
     SimilarityPtr similarity(query->getSimilarity(searcher));
     return newLucene<FilteredQueryWeight>(shared_from_this(), weight, similarity);
 }
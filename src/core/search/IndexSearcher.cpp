@@ -16,6 +16,13 @@
 #include "Filter.h"
 #include "Query.h"
 #include "ReaderUtil.h"
+#include "ThreadPool.h"
+#include "_MultiSearcher.h"
+#include "HitQueue.h"
+#include "FieldDocSortedHitQueue.h"
+#include "FieldDoc.h"
+#include "QueryProfiler.h"
+#include "MiscUtils.h"
 
 namespace Lucene {
 
@@ -27,9 +34,14 @@ IndexSearcher::IndexSearcher(const IndexReaderPtr& reader) {
     ConstructSearcher(reader, false);
 }
 
+IndexSearcher::IndexSearcher(const IndexReaderPtr& reader, const ThreadPoolPtr& threadPool) {
+    ConstructSearcher(reader, false, threadPool);
+}
+
 IndexSearcher::IndexSearcher(const IndexReaderPtr& reader, Collection<IndexReaderPtr> subReaders, Collection<int32_t> docStarts) {
     this->fieldSortDoTrackScores = false;
     this->fieldSortDoMaxScore = false;
+    this->trackTotalHits = true;
     this->reader = reader;
     this->subReaders = subReaders;
     this->docStarts = docStarts;
@@ -39,11 +51,13 @@ IndexSearcher::IndexSearcher(const IndexReaderPtr& reader, Collection<IndexReade
 IndexSearcher::~IndexSearcher() {
 }
 
-void IndexSearcher::ConstructSearcher(const IndexReaderPtr& reader, bool closeReader) {
+void IndexSearcher::ConstructSearcher(const IndexReaderPtr& reader, bool closeReader, const ThreadPoolPtr& threadPool) {
     this->fieldSortDoTrackScores = false;
     this->fieldSortDoMaxScore = false;
+    this->trackTotalHits = true;
     this->reader = reader;
     this->closeReader = closeReader;
+    this->threadPool = threadPool;
 
     Collection<IndexReaderPtr> subReadersList(Collection<IndexReaderPtr>::newInstance());
     gatherSubReaders(subReadersList, reader);
@@ -54,6 +68,12 @@ void IndexSearcher::ConstructSearcher(const IndexReaderPtr& reader, bool closeRe
         docStarts[i] = maxDoc;
         maxDoc += subReaders[i]->maxDoc();
     }
+    if (threadPool) {
+        subSearchers = Collection<IndexSearcherPtr>::newInstance(subReaders.size());
+        for (int32_t i = 0; i < subReaders.size(); ++i) {
+            subSearchers[i] = newLucene<IndexSearcher>(subReaders[i]);
+        }
+    }
 }
 
 void IndexSearcher::gatherSubReaders(Collection<IndexReaderPtr> allSubReaders, const IndexReaderPtr& reader) {
@@ -64,6 +84,14 @@ IndexReaderPtr IndexSearcher::getIndexReader() {
     return reader;
 }
 
+Collection<IndexReaderPtr> IndexSearcher::getSubReaders() {
+    return subReaders;
+}
+
+Collection<int32_t> IndexSearcher::getDocStarts() {
+    return docStarts;
+}
+
 void IndexSearcher::close() {
     if (closeReader) {
         reader->close();
@@ -86,11 +114,42 @@ int32_t IndexSearcher::maxDoc() {
     return reader->maxDoc();
 }
 
+bool IndexSearcher::searchConcurrently() {
+    return (threadPool && subSearchers && subSearchers.size() > 1);
+}
+
 TopDocsPtr IndexSearcher::search(const WeightPtr& weight, const FilterPtr& filter, int32_t n) {
     if (n <= 0) {
         boost::throw_exception(IllegalArgumentException(L"n must be > 0"));
     }
-    TopScoreDocCollectorPtr collector(TopScoreDocCollector::create(std::min(n, reader->maxDoc()), !weight->scoresDocsOutOfOrder()));
+    if (searchConcurrently()) {
+        HitQueuePtr hq(newLucene<HitQueue>(std::min(n, reader->maxDoc()), false));
+        SynchronizePtr lock(newInstance<Synchronize>());
+        Collection<FuturePtr> searchThreads(Collection<FuturePtr>::newInstance(subSearchers.size()));
+        Collection<MultiSearcherCallableNoSortPtr> segmentSearcher(Collection<MultiSearcherCallableNoSortPtr>::newInstance(subSearchers.size()));
+        for (int32_t i = 0; i < subSearchers.size(); ++i) { // search each segment
+            segmentSearcher[i] = newLucene<MultiSearcherCallableNoSort>(lock, subSearchers[i], weight, filter, n, hq, i, docStarts);
+            searchThreads[i] = threadPool->scheduleTask(boost::protect(boost::bind<TopDocsPtr>(boost::mem_fn(&MultiSearcherCallableNoSort::call), segmentSearcher[i])));
+        }
+
+        int32_t totalHits = 0;
+        double maxScore = std::numeric_limits<double>::quiet_NaN();
+        for (int32_t i = 0; i < searchThreads.size(); ++i) {
+            TopDocsPtr topDocs(searchThreads[i]->get<TopDocsPtr>());
+            totalHits += topDocs->totalHits;
+            if (!MiscUtils::isNaN(topDocs->maxScore)) {
+                maxScore = MiscUtils::isNaN(maxScore) ? topDocs->maxScore : std::max(maxScore, topDocs->maxScore);
+            }
+        }
+
+        Collection<ScoreDocPtr> scoreDocs(Collection<ScoreDocPtr>::newInstance(hq->size()));
+        for (int32_t i = hq->size() - 1; i >= 0; --i) { // put docs in array
+            scoreDocs[i] = hq->pop();
+        }
+        return newLucene<TopDocs>(totalHits, scoreDocs, maxScore);
+    }
+
+    TopScoreDocCollectorPtr collector(TopScoreDocCollector::create(std::min(n, reader->maxDoc()), !weight->scoresDocsOutOfOrder(), trackTotalHits));
     search(weight, filter, collector);
     return collector->topDocs();
 }
@@ -100,26 +159,78 @@ TopFieldDocsPtr IndexSearcher::search(const WeightPtr& weight, const FilterPtr&
 }
 
 TopFieldDocsPtr IndexSearcher::search(const WeightPtr& weight, const FilterPtr& filter, int32_t n, const SortPtr& sort, bool fillFields) {
-    TopFieldCollectorPtr collector(TopFieldCollector::create(sort, std::min(n, reader->maxDoc()), fillFields, fieldSortDoTrackScores, fieldSortDoMaxScore, !weight->scoresDocsOutOfOrder()));
+    // merging the per segment results needs the sort field values
+    if (fillFields && searchConcurrently()) {
+        FieldDocSortedHitQueuePtr hq(newLucene<FieldDocSortedHitQueue>(std::min(n, reader->maxDoc())));
+        SynchronizePtr lock(newInstance<Synchronize>());
+        Collection<FuturePtr> searchThreads(Collection<FuturePtr>::newInstance(subSearchers.size()));
+        Collection<MultiSearcherCallableWithSortPtr> segmentSearcher(Collection<MultiSearcherCallableWithSortPtr>::newInstance(subSearchers.size()));
+        for (int32_t i = 0; i < subSearchers.size(); ++i) { // search each segment
+            segmentSearcher[i] = newLucene<MultiSearcherCallableWithSort>(lock, subSearchers[i], weight, filter, n, hq, sort, i, docStarts);
+            searchThreads[i] = threadPool->scheduleTask(boost::protect(boost::bind<TopFieldDocsPtr>(boost::mem_fn(&MultiSearcherCallableWithSort::call), segmentSearcher[i])));
+        }
+
+        int32_t totalHits = 0;
+        double maxScore = std::numeric_limits<double>::quiet_NaN();
+        for (int32_t i = 0; i < searchThreads.size(); ++i) {
+            TopFieldDocsPtr topDocs(searchThreads[i]->get<TopFieldDocsPtr>());
+            totalHits += topDocs->totalHits;
+            if (!MiscUtils::isNaN(topDocs->maxScore)) {
+                maxScore = MiscUtils::isNaN(maxScore) ? topDocs->maxScore : std::max(maxScore, topDocs->maxScore);
+            }
+        }
+
+        Collection<ScoreDocPtr> scoreDocs(Collection<ScoreDocPtr>::newInstance(hq->size()));
+        for (int32_t i = hq->size() - 1; i >= 0; --i) { // put docs in array
+            scoreDocs[i] = hq->pop();
+        }
+        return newLucene<TopFieldDocs>(totalHits, scoreDocs, hq->getFields(), maxScore);
+    }
+
+    TopFieldCollectorPtr collector(TopFieldCollector::create(sort, std::min(n, reader->maxDoc()), fillFields, fieldSortDoTrackScores, fieldSortDoMaxScore, !weight->scoresDocsOutOfOrder(), trackTotalHits));
     search(weight, filter, collector);
     return boost::dynamic_pointer_cast<TopFieldDocs>(collector->topDocs());
 }
 
-void IndexSearcher::search(const WeightPtr& weight, const FilterPtr& filter, const CollectorPtr& results) {
-    if (!filter) {
-        for (int32_t i = 0; i < subReaders.size(); ++i) { // search each subreader
-            results->setNextReader(subReaders[i], docStarts[i]);
-            ScorerPtr scorer(weight->scorer(subReaders[i], !results->acceptsDocsOutOfOrder(), true));
-            if (scorer) {
-                scorer->score(results);
+void IndexSearcher::search(const WeightPtr& weight, const FilterPtr& filter, const CollectorPtr& collector) {
+    QueryProfilerPtr profiler(this->profiler);
+    CollectorPtr results(profiler ? profiler->wrapCollector(collector) : collector);
+    LuceneException finally;
+    try {
+        if (!filter) {
+            for (int32_t i = 0; i < subReaders.size(); ++i) { // search each subreader
+                results->setNextReader(subReaders[i], docStarts[i]);
+                ScorerPtr scorer(weight->scorer(subReaders[i], !results->acceptsDocsOutOfOrder(), true));
+                if (scorer) {
+                    try {
+                        scorer->score(results);
+                    } catch (CollectionTerminatedException&) {
+                        // the collector has all the documents it needs from this segment
+                    }
+                }
+            }
+        } else {
+            for (int32_t i = 0; i < subReaders.size(); ++i) { // search each subreader
+                results->setNextReader(subReaders[i], docStarts[i]);
+                try {
+                    searchWithFilter(subReaders[i], weight, filter, results);
+                } catch (CollectionTerminatedException&) {
+                    // the collector has all the documents it needs from this segment
+                }
             }
         }
-    } else {
-        for (int32_t i = 0; i < subReaders.size(); ++i) { // search each subreader
-            results->setNextReader(subReaders[i], docStarts[i]);
-            searchWithFilter(subReaders[i], weight, filter, results);
+    } catch (LuceneException& e) {
+        finally = e;
+    } catch (...) {
+        if (profiler) {
+            profiler->endCollection(results);
         }
+        throw;
+    }
+    if (profiler) {
+        profiler->endCollection(results);
     }
+    finally.throwException();
 }
 
 void IndexSearcher::searchWithFilter(const IndexReaderPtr& reader, const WeightPtr& weight, const FilterPtr& filter, const CollectorPtr& collector) {
@@ -183,6 +294,43 @@ ExplanationPtr IndexSearcher::explain(const WeightPtr& weight, int32_t doc) {
 void IndexSearcher::setDefaultFieldSortScoring(bool doTrackScores, bool doMaxScore) {
     fieldSortDoTrackScores = doTrackScores;
     fieldSortDoMaxScore = doMaxScore;
+    if (subSearchers) {
+        // sub-searchers are shared by concurrent searches, so they only change along with this searcher
+        for (Collection<IndexSearcherPtr>::iterator subSearcher = subSearchers.begin(); subSearcher != subSearchers.end(); ++subSearcher) {
+            (*subSearcher)->setDefaultFieldSortScoring(doTrackScores, doMaxScore);
+        }
+    }
+}
+
+bool IndexSearcher::getFieldSortDoTrackScores() {
+    return fieldSortDoTrackScores;
+}
+
+bool IndexSearcher::getFieldSortDoMaxScore() {
+    return fieldSortDoMaxScore;
+}
+
+void IndexSearcher::setTrackTotalHits(bool trackTotalHits) {
+    this->trackTotalHits = trackTotalHits;
+    if (subSearchers) {
+        for (Collection<IndexSearcherPtr>::iterator subSearcher = subSearchers.begin(); subSearcher != subSearchers.end(); ++subSearcher) {
+            (*subSearcher)->setTrackTotalHits(trackTotalHits);
+        }
+    }
+}
+
+bool IndexSearcher::getTrackTotalHits() {
+    return trackTotalHits;
+}
+
+void IndexSearcher::setProfiler(const QueryProfilerPtr& profiler) {
+    Searcher::setProfiler(profiler);
+    if (subSearchers) {
+        // segments searched concurrently collect through their own searcher
+        for (Collection<IndexSearcherPtr>::iterator subSearcher = subSearchers.begin(); subSearcher != subSearchers.end(); ++subSearcher) {
+            (*subSearcher)->setProfiler(profiler);
+        }
+    }
 }
 
 }
@@ -0,0 +1,295 @@
+/////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2009-2014 Alan Wright. All rights reserved.
+// Distributable under the terms of either the Apache License (Version 2.0)
+// or the GNU Lesser General Public License.
+/////////////////////////////////////////////////////////////////////////////
+
+#include "LuceneInc.h"
+#include "LRUFilterCache.h"
+#include "_LRUFilterCache.h"
+#include "RoaringDocIdSet.h"
+#include "OpenBitSet.h"
+#include "SortedVIntList.h"
+#include "IndexReader.h"
+
+namespace Lucene {
+
+const int32_t LRUFilterCache::DEFAULT_MAX_SIZE = 1000;
+const int64_t LRUFilterCache::DEFAULT_MAX_RAM_BYTES_USED = 32 * 1024 * 1024;
+const int32_t LRUFilterCache::DEFAULT_MIN_SEGMENT_SIZE = 10000;
+
+/// Approximate memory used by an entry besides its set: the key, the entry and their map nodes.
+static const int64_t ENTRY_BYTES_USED = 128;
+
+LRUFilterCache::LRUFilterCache(int32_t maxSize, int64_t maxRamBytesUsed) {
+    cache = MapKeyEntry::newInstance();
+    lru = MapLongKey::newInstance();
+    this->maxSize = maxSize;
+    this->maxRamBytesUsed = maxRamBytesUsed;
+    this->minSegmentSize = DEFAULT_MIN_SEGMENT_SIZE;
+    this->useCount = 0;
+    this->ramBytesUsed = 0;
+    this->hitCount = 0;
+    this->missCount = 0;
+    this->cacheCount = 0;
+    this->evictionCount = 0;
+}
+
+LRUFilterCache::~LRUFilterCache() {
+}
+
+LRUFilterCachePtr LRUFilterCache::getInstance() {
+    static LRUFilterCachePtr instance;
+    if (!instance) {
+        instance = newLucene<LRUFilterCache>();
+        CycleCheck::addStatic(instance);
+    }
+    return instance;
+}
+
+FilterPtr LRUFilterCache::doCache(const FilterPtr& filter) {
+    return newLucene<LRUCachedFilter>(shared_from_this(), filter);
+}
+
+DocIdSetPtr LRUFilterCache::getDocIdSet(const FilterPtr& filter, const IndexReaderPtr& reader) {
+    if (reader->maxDoc() < getMinSegmentSize()) {
+        SyncLock syncLock(this);
+        ++missCount;
+        return filter->getDocIdSet(reader);
+    }
+
+    LRUFilterCacheKeyPtr key(newLucene<LRUFilterCacheKey>(filter, reader->getFieldCacheKey()));
+    {
+        SyncLock syncLock(this);
+        LRUFilterCacheEntryPtr entry(cache.get(key));
+        if (entry) {
+            ++hitCount;
+            lru.remove(entry->lastUse);
+            entry->lastUse = useCount++;
+            lru.put(entry->lastUse, key);
+            return entry->docIdSet;
+        }
+        ++missCount;
+    }
+
+    // compute the set without holding the lock, other filters may be in use meanwhile
+    DocIdSetPtr docIdSet(docIdSetToCache(filter->getDocIdSet(reader)));
+    int64_t bytesUsed = ENTRY_BYTES_USED + docIdSetBytesUsed(docIdSet, reader->maxDoc());
+
+    SyncLock syncLock(this);
+    if (bytesUsed <= maxRamBytesUsed && !cache.contains(key)) {
+        purgeClosedSegments();
+        putEntry(key, docIdSet, bytesUsed);
+        evictIfNecessary();
+    }
+    return docIdSet;
+}
+
+DocIdSetPtr LRUFilterCache::docIdSetToCache(const DocIdSetPtr& docIdSet) {
+    if (!docIdSet) {
+        return DocIdSet::EMPTY_DOCIDSET();
+    } else if (docIdSet->isCacheable()) {
+        return docIdSet;
+    } else {
+        DocIdSetIteratorPtr it(docIdSet->iterator());
+        return !it ? DocIdSet::EMPTY_DOCIDSET() : newLucene<RoaringDocIdSet>(it);
+    }
+}
+
+int64_t LRUFilterCache::docIdSetBytesUsed(const DocIdSetPtr& docIdSet, int32_t maxDoc) {
+    if (docIdSet == DocIdSet::EMPTY_DOCIDSET()) {
+        return 0;
+    }
+    RoaringDocIdSetPtr roaring(boost::dynamic_pointer_cast<RoaringDocIdSet>(docIdSet));
+    if (roaring) {
+        return roaring->ramBytesUsed();
+    }
+    OpenBitSetPtr bits(boost::dynamic_pointer_cast<OpenBitSet>(docIdSet));
+    if (bits) {
+        return (int64_t)bits->getBits().size() * sizeof(int64_t);
+    }
+    SortedVIntListPtr list(boost::dynamic_pointer_cast<SortedVIntList>(docIdSet));
+    if (list) {
+        return list->getByteSize();
+    }
+    return maxDoc / 8;
+}
+
+void LRUFilterCache::putEntry(const LRUFilterCacheKeyPtr& key, const DocIdSetPtr& docIdSet, int64_t bytesUsed) {
+    LRUFilterCacheEntryPtr entry(newLucene<LRUFilterCacheEntry>(docIdSet, bytesUsed, useCount++));
+    cache.put(key, entry);
+    lru.put(entry->lastUse, key);
+    ramBytesUsed += bytesUsed;
+    ++cacheCount;
+}
+
+void LRUFilterCache::removeEntry(const LRUFilterCacheKeyPtr& key) {
+    LRUFilterCacheEntryPtr entry(cache.get(key));
+    if (entry) {
+        cache.remove(key);
+        lru.remove(entry->lastUse);
+        ramBytesUsed -= entry->bytesUsed;
+    }
+}
+
+void LRUFilterCache::evictIfNecessary() {
+    while (!lru.empty() && (cache.size() > maxSize || ramBytesUsed > maxRamBytesUsed)) {
+        removeEntry(lru.begin()->second);
+        ++evictionCount;
+    }
+}
+
+void LRUFilterCache::purgeClosedSegments() {
+    Collection<LRUFilterCacheKeyPtr> closed(Collection<LRUFilterCacheKeyPtr>::newInstance());
+    for (MapKeyEntry::iterator entry = cache.begin(); entry != cache.end(); ++entry) {
+        if (entry->first->isClosed()) {
+            closed.add(entry->first);
+        }
+    }
+    for (Collection<LRUFilterCacheKeyPtr>::iterator key = closed.begin(); key != closed.end(); ++key) {
+        removeEntry(*key);
+    }
+}
+
+void LRUFilterCache::setMaxSize(int32_t maxSize) {
+    SyncLock syncLock(this);
+    this->maxSize = maxSize;
+    evictIfNecessary();
+}
+
+int32_t LRUFilterCache::getMaxSize() {
+    SyncLock syncLock(this);
+    return maxSize;
+}
+
+void LRUFilterCache::setMaxRamBytesUsed(int64_t maxRamBytesUsed) {
+    SyncLock syncLock(this);
+    this->maxRamBytesUsed = maxRamBytesUsed;
+    evictIfNecessary();
+}
+
+int64_t LRUFilterCache::getMaxRamBytesUsed() {
+    SyncLock syncLock(this);
+    return maxRamBytesUsed;
+}
+
+void LRUFilterCache::setMinSegmentSize(int32_t minSegmentSize) {
+    SyncLock syncLock(this);
+    this->minSegmentSize = minSegmentSize;
+}
+
+int32_t LRUFilterCache::getMinSegmentSize() {
+    SyncLock syncLock(this);
+    return minSegmentSize;
+}
+
+void LRUFilterCache::clear() {
+    SyncLock syncLock(this);
+    cache.clear();
+    lru.clear();
+    ramBytesUsed = 0;
+}
+
+int32_t LRUFilterCache::getCacheSize() {
+    SyncLock syncLock(this);
+    return cache.size();
+}
+
+int64_t LRUFilterCache::getRamBytesUsed() {
+    SyncLock syncLock(this);
+    return ramBytesUsed;
+}
+
+int64_t LRUFilterCache::getHitCount() {
+    SyncLock syncLock(this);
+    return hitCount;
+}
+
+int64_t LRUFilterCache::getMissCount() {
+    SyncLock syncLock(this);
+    return missCount;
+}
+
+int64_t LRUFilterCache::getCacheCount() {
+    SyncLock syncLock(this);
+    return cacheCount;
+}
+
+int64_t LRUFilterCache::getEvictionCount() {
+    SyncLock syncLock(this);
+    return evictionCount;
+}
+
+LRUFilterCacheKey::LRUFilterCacheKey(const FilterPtr& filter, const LuceneObjectPtr& coreKey) {
+    this->filter = filter;
+    this->_coreKey = coreKey;
+    this->hash = filter->hashCode() * 31 + coreKey->hashCode();
+}
+
+LRUFilterCacheKey::~LRUFilterCacheKey() {
+}
+
+bool LRUFilterCacheKey::isClosed() {
+    return _coreKey.expired();
+}
+
+bool LRUFilterCacheKey::equals(const LuceneObjectPtr& other) {
+    if (LuceneObject::equals(other)) {
+        return true;
+    }
+    LRUFilterCacheKeyPtr otherKey(boost::dynamic_pointer_cast<LRUFilterCacheKey>(other));
+    if (!otherKey) {
+        return false;
+    }
+    // compare the cores by identity, which still works once they have gone
+    bool sameCore = !_coreKey.owner_before(otherKey->_coreKey) && !otherKey->_coreKey.owner_before(_coreKey);
+    return sameCore && filter->equals(otherKey->filter);
+}
+
+int32_t LRUFilterCacheKey::hashCode() {
+    return hash;
+}
+
+LRUFilterCacheEntry::LRUFilterCacheEntry(const DocIdSetPtr& docIdSet, int64_t bytesUsed, int64_t lastUse) {
+    this->docIdSet = docIdSet;
+    this->bytesUsed = bytesUsed;
+    this->lastUse = lastUse;
+}
+
+LRUFilterCacheEntry::~LRUFilterCacheEntry() {
+}
+
+LRUCachedFilter::LRUCachedFilter(const LRUFilterCachePtr& cache, const FilterPtr& filter) {
+    this->cache = cache;
+    this->filter = filter;
+}
+
+LRUCachedFilter::~LRUCachedFilter() {
+}
+
+DocIdSetPtr LRUCachedFilter::getDocIdSet(const IndexReaderPtr& reader) {
+    return cache->getDocIdSet(filter, reader);
+}
+
+String LRUCachedFilter::toString() {
+    return L"LRUCachedFilter(" + filter->toString() + L")";
+}
+
+bool LRUCachedFilter::equals(const LuceneObjectPtr& other) {
+    if (Filter::equals(other)) {
+        return true;
+    }
+
+    LRUCachedFilterPtr otherFilter(boost::dynamic_pointer_cast<LRUCachedFilter>(other));
+    if (!otherFilter) {
+        return false;
+    }
+
+    return (cache == otherFilter->cache && filter->equals(otherFilter->filter));
+}
+
+int32_t LRUCachedFilter::hashCode() {
+    return filter->hashCode() ^ 0x2f8a51c3;
+}
+
+}
@@ -0,0 +1,156 @@
+/////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2009-2014 Alan Wright. All rights reserved.
+// Distributable under the terms of either the Apache License (Version 2.0)
+// or the GNU Lesser General Public License.
+/////////////////////////////////////////////////////////////////////////////
+
+#include "LuceneInc.h"
+#include "MaxScoreScorer.h"
+#include "TermScorer.h"
+
+namespace Lucene {
+
+const int32_t MaxScoreScorer::MAX_CLAUSES = 16;
+
+/// Orders clauses by their bound, keeping query order between equal bounds.
+struct lessMaxScore {
+    lessMaxScore(Collection<double> maxScores) : maxScores(maxScores) {}
+    inline bool operator()(int32_t first, int32_t second) const {
+        return maxScores[first] < maxScores[second];
+    }
+    Collection<double> maxScores;
+};
+
+MaxScoreScorer::MaxScoreScorer(const SimilarityPtr& similarity, Collection<ScorerPtr> subScorers, Collection<double> maxScores, Collection<double> coordFactors) : Scorer(similarity) {
+    this->subScorers = subScorers;
+    this->coordFactors = coordFactors;
+    this->firstEssential = 0;
+    this->minCompetitiveScore = -std::numeric_limits<double>::infinity();
+    this->doc = -1;
+    this->currentScore = 0;
+
+    int32_t numScorers = subScorers.size();
+    this->maxCoord = 0;
+    for (int32_t i = 1; i <= numScorers; ++i) {
+        maxCoord = std::max(maxCoord, coordFactors[i]);
+    }
+
+    this->maxScores = Collection<double>::newInstance(numScorers);
+    this->order = Collection<int32_t>::newInstance(numScorers);
+    this->termScorers = Collection<TermScorerPtr>::newInstance(numScorers);
+    this->candidateMaxScores = Collection<double>::newInstance(numScorers);
+    double finiteSum = 0;
+    for (int32_t i = 0; i < numScorers; ++i) {
+        this->maxScores[i] = maxScores[i] * maxCoord;
+        this->order[i] = i;
+        this->termScorers[i] = boost::dynamic_pointer_cast<TermScorer>(subScorers[i]);
+        if (this->maxScores[i] != std::numeric_limits<double>::infinity()) {
+            finiteSum += this->maxScores[i];
+        }
+    }
+    std::stable_sort(order.begin(), order.end(), lessMaxScore(this->maxScores));
+
+    this->sumMaxScores = Collection<double>::newInstance(numScorers);
+    double sum = 0;
+    for (int32_t i = 0; i < numScorers; ++i) {
+        sum += this->maxScores[order[i]];
+        sumMaxScores[i] = sum;
+    }
+    this->slack = finiteSum * 1e-9;
+}
+
+MaxScoreScorer::~MaxScoreScorer() {
+}
+
+int32_t MaxScoreScorer::docID() {
+    return doc;
+}
+
+int32_t MaxScoreScorer::nextDoc() {
+    return doc == NO_MORE_DOCS ? doc : advance(doc + 1);
+}
+
+int32_t MaxScoreScorer::advance(int32_t target) {
+    while (true) {
+        // the next candidate is the first document at or after target matching an essential clause
+        int32_t candidate = NO_MORE_DOCS;
+        for (int32_t i = firstEssential; i < subScorers.size(); ++i) {
+            ScorerPtr scorer(subScorers[order[i]]);
+            int32_t scorerDoc = scorer->docID();
+            if (scorerDoc < target) {
+                scorerDoc = scorer->advance(target);
+            }
+            candidate = std::min(candidate, scorerDoc);
+        }
+        if (candidate == NO_MORE_DOCS || scoreCandidate(candidate)) {
+            doc = candidate;
+            return doc;
+        }
+        target = candidate + 1;
+    }
+}
+
+bool MaxScoreScorer::scoreCandidate(int32_t candidate) {
+    if (minCompetitiveScore != -std::numeric_limits<double>::infinity()) {
+        // highest score the candidate can reach from the clauses known to match and the non-essential ones
+        double bound = 0;
+        for (int32_t i = 0; i < subScorers.size(); ++i) {
+            int32_t clause = order[i];
+            if (i < firstEssential || subScorers[clause]->docID() == candidate) {
+                candidateMaxScores[clause] = candidateMaxScore(clause, candidate);
+                bound += candidateMaxScores[clause];
+            }
+        }
+        if (bound + slack < minCompetitiveScore) {
+            return false;
+        }
+
+        // check the non-essential clauses with the highest bounds first, stopping once the candidate can't compete
+        for (int32_t i = firstEssential - 1; i >= 0; --i) {
+            ScorerPtr scorer(subScorers[order[i]]);
+            if (scorer->docID() < candidate) {
+                scorer->advance(candidate);
+            }
+            if (scorer->docID() != candidate) {
+                bound -= candidateMaxScores[order[i]];
+                if (bound + slack < minCompetitiveScore) {
+                    return false;
+                }
+            }
+        }
+    }
+
+    // sum in query order, all clauses are now positioned at or after the candidate
+    double sum = 0;
+    int32_t matchers = 0;
+    for (int32_t i = 0; i < subScorers.size(); ++i) {
+        if (subScorers[i]->docID() == candidate) {
+            sum += subScorers[i]->score();
+            ++matchers;
+        }
+    }
+    currentScore = sum * coordFactors[matchers];
+    return currentScore > minCompetitiveScore;
+}
+
+double MaxScoreScorer::candidateMaxScore(int32_t clause, int32_t candidate) {
+    if (!termScorers[clause]) {
+        return maxScores[clause];
+    }
+    return std::min(maxScores[clause], termScorers[clause]->maxScore(candidate) * maxCoord);
+}
+
+double MaxScoreScorer::score() {
+    return currentScore;
+}
+
+void MaxScoreScorer::setMinCompetitiveScore(double minScore) {
+    minCompetitiveScore = minScore;
+    // clauses whose bounds add up to less than the minimum competitive score can't produce a competitive
+    // document on their own
+    while (firstEssential < subScorers.size() && sumMaxScores[firstEssential] + slack < minCompetitiveScore) {
+        ++firstEssential;
+    }
+}
+
+}
@@ -0,0 +1,58 @@
+/////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2009-2014 Alan Wright. All rights reserved.
+// Distributable under the terms of either the Apache License (Version 2.0)
+// or the GNU Lesser General Public License.
+/////////////////////////////////////////////////////////////////////////////
+
+#include "LuceneInc.h"
+#include "PackedComparatorSource.h"
+#include "FieldComparator.h"
+#include "FieldCache.h"
+#include "SortField.h"
+#include "StringUtils.h"
+
+namespace Lucene {
+
+PackedComparatorSource::PackedComparatorSource(int32_t type, const ParserPtr& parser) {
+    if (type != SortField::INT && type != SortField::SHORT && type != SortField::LONG && type != SortField::STRING) {
+        boost::throw_exception(IllegalArgumentException(L"Packed sorting supports INT, SHORT, LONG and STRING: got " + StringUtils::toString(type)));
+    }
+    if (parser && type == SortField::STRING) {
+        boost::throw_exception(IllegalArgumentException(L"Packed STRING sorting does not take a parser"));
+    }
+    this->type = type;
+    this->parser = parser;
+}
+
+PackedComparatorSource::~PackedComparatorSource() {
+}
+
+FieldComparatorPtr PackedComparatorSource::newComparator(const String& fieldname, int32_t numHits, int32_t sortPos, bool reversed) {
+    if (type == SortField::LONG) {
+        return newLucene<PackedLongComparator>(numHits, fieldname, parser);
+    } else if (type == SortField::STRING) {
+        return newLucene<PackedStringOrdValComparator>(numHits, fieldname, sortPos, reversed);
+    }
+    return newLucene<PackedIntComparator>(numHits, fieldname, parser);
+}
+
+bool PackedComparatorSource::equals(const LuceneObjectPtr& other) {
+    if (LuceneObject::equals(other)) {
+        return true;
+    }
+    PackedComparatorSourcePtr otherSource(boost::dynamic_pointer_cast<PackedComparatorSource>(other));
+    if (!otherSource) {
+        return false;
+    }
+    return (type == otherSource->type && (parser ? parser->equals(otherSource->parser) : !otherSource->parser));
+}
+
+int32_t PackedComparatorSource::hashCode() {
+    return type ^ 0x5a3c9e17 ^ (parser ? parser->hashCode() : 0);
+}
+
+String PackedComparatorSource::toString() {
+    return L"packed(" + StringUtils::toString(type) + L")";
+}
+
+}
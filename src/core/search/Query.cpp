@@ -9,6 +9,7 @@
 #include "BooleanQuery.h"
 #include "Searcher.h"
 #include "Similarity.h"
+#include "QueryProfiler.h"
 #include "MiscUtils.h"
 
 namespace Lucene {
@@ -42,8 +43,13 @@ WeightPtr Query::createWeight(const SearcherPtr& searcher) {
 }
 
 WeightPtr Query::weight(const SearcherPtr& searcher) {
+    QueryProfilerPtr profiler(searcher->getProfiler());
+    int64_t rewriteStart = profiler ? MiscUtils::nanoTime() : 0;
     QueryPtr query(searcher->rewrite(shared_from_this()));
-    WeightPtr weight(query->createWeight(searcher));
+    if (profiler) {
+        profiler->addRewriteTime(MiscUtils::nanoTime() - rewriteStart);
+    }
+    WeightPtr weight(searcher->createNodeWeight(query));
     double sum = weight->sumOfSquaredWeights();
     double norm = getSimilarity(searcher)->queryNorm(sum);
     if (MiscUtils::isInfinite(norm) || MiscUtils::isNaN(norm)) {
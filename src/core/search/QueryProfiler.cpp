@@ -0,0 +1,330 @@
+/////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2009-2014 Alan Wright. All rights reserved.
+// Distributable under the terms of either the Apache License (Version 2.0)
+// or the GNU Lesser General Public License.
+/////////////////////////////////////////////////////////////////////////////
+
+#include "LuceneInc.h"
+#include "QueryProfiler.h"
+#include "_QueryProfiler.h"
+#include "Query.h"
+#include "SegmentReader.h"
+#include "MiscUtils.h"
+
+namespace Lucene {
+
+/// Format a time in nanoseconds as microseconds.
+static String formatNanos(int64_t nanos) {
+    StringStream buffer;
+    buffer << (nanos / 1000) << L"us";
+    return buffer.str();
+}
+
+ProfileTimer::ProfileTimer(int64_t& nanos) : nanos(nanos) {
+    this->start = MiscUtils::nanoTime();
+}
+
+ProfileTimer::~ProfileTimer() {
+    nanos += MiscUtils::nanoTime() - start;
+}
+
+ProfileScope::ProfileScope(Collection<QueryProfileNodePtr> stack, const QueryProfileNodePtr& node) {
+    this->stack = stack;
+    stack.add(node);
+}
+
+ProfileScope::~ProfileScope() {
+    stack.removeLast();
+}
+
+QueryProfileSegment::QueryProfileSegment(const String& segment) {
+    this->segment = segment;
+    this->scorerNanos = 0;
+    this->nextDocCount = 0;
+    this->nextDocNanos = 0;
+    this->advanceCount = 0;
+    this->advanceNanos = 0;
+    this->scoreCount = 0;
+    this->scoreNanos = 0;
+    this->bulkScoreNanos = 0;
+}
+
+QueryProfileSegment::~QueryProfileSegment() {
+}
+
+String QueryProfileSegment::toString() {
+    StringStream buffer;
+    buffer << segment << L": scorer=" << formatNanos(scorerNanos);
+    buffer << L" nextDoc=" << nextDocCount << L"/" << formatNanos(nextDocNanos);
+    buffer << L" advance=" << advanceCount << L"/" << formatNanos(advanceNanos);
+    buffer << L" score=" << scoreCount << L"/" << formatNanos(scoreNanos);
+    if (bulkScoreNanos > 0) {
+        buffer << L" bulkScore=" << formatNanos(bulkScoreNanos);
+    }
+    return buffer.str();
+}
+
+QueryProfileNode::QueryProfileNode(const QueryPtr& query) {
+    this->type = query->getClassName();
+    this->description = query->toString();
+    this->weightNanos = 0;
+    this->segments = Collection<QueryProfileSegmentPtr>::newInstance();
+    this->children = Collection<QueryProfileNodePtr>::newInstance();
+}
+
+QueryProfileNode::~QueryProfileNode() {
+}
+
+QueryProfileSegmentPtr QueryProfileNode::addSegment(const String& segment) {
+    QueryProfileSegmentPtr profileSegment(newLucene<QueryProfileSegment>(segment));
+    SyncLock syncLock(this);
+    segments.add(profileSegment);
+    return profileSegment;
+}
+
+String QueryProfileNode::toString() {
+    return toString(0);
+}
+
+String QueryProfileNode::toString(int32_t depth) {
+    String indent(depth * 2, L' ');
+    StringStream buffer;
+    buffer << indent << type << L" [" << description << L"] weight=" << formatNanos(weightNanos) << L"\n";
+    {
+        SyncLock syncLock(this);
+        for (Collection<QueryProfileSegmentPtr>::iterator segment = segments.begin(); segment != segments.end(); ++segment) {
+            buffer << indent << L"  - " << (*segment)->toString() << L"\n";
+        }
+    }
+    for (Collection<QueryProfileNodePtr>::iterator child = children.begin(); child != children.end(); ++child) {
+        buffer << (*child)->toString(depth + 1);
+    }
+    return buffer.str();
+}
+
+QueryProfiler::QueryProfiler() {
+    this->profiles = Collection<QueryProfileNodePtr>::newInstance();
+    this->rewriteNanos = 0;
+    this->collectCount = 0;
+    this->collectNanos = 0;
+}
+
+QueryProfiler::~QueryProfiler() {
+}
+
+QueryProfileNodePtr QueryProfiler::getProfile() {
+    SyncLock syncLock(this);
+    return profiles.empty() ? QueryProfileNodePtr() : profiles[profiles.size() - 1];
+}
+
+Collection<QueryProfileNodePtr> QueryProfiler::getProfiles() {
+    SyncLock syncLock(this);
+    return Collection<QueryProfileNodePtr>::newInstance(profiles.begin(), profiles.end());
+}
+
+int64_t QueryProfiler::getRewriteNanos() {
+    SyncLock syncLock(this);
+    return rewriteNanos;
+}
+
+int64_t QueryProfiler::getCollectCount() {
+    SyncLock syncLock(this);
+    return collectCount;
+}
+
+int64_t QueryProfiler::getCollectNanos() {
+    SyncLock syncLock(this);
+    return collectNanos;
+}
+
+void QueryProfiler::reset() {
+    SyncLock syncLock(this);
+    profiles.clear();
+    rewriteNanos = 0;
+    collectCount = 0;
+    collectNanos = 0;
+}
+
+String QueryProfiler::toString() {
+    SyncLock syncLock(this);
+    StringStream buffer;
+    buffer << L"rewrite=" << formatNanos(rewriteNanos) << L" collect=" << collectCount << L"/" << formatNanos(collectNanos) << L"\n";
+    for (Collection<QueryProfileNodePtr>::iterator profile = profiles.begin(); profile != profiles.end(); ++profile) {
+        buffer << (*profile)->toString();
+    }
+    return buffer.str();
+}
+
+WeightPtr QueryProfiler::createWeight(const QueryPtr& query, const SearcherPtr& searcher) {
+    boost::shared_ptr< Collection<QueryProfileNodePtr> > stack(stacks.get());
+    if (!stack) {
+        stack.reset(new Collection<QueryProfileNodePtr>(Collection<QueryProfileNodePtr>::newInstance()));
+        stacks.set(stack);
+    }
+    QueryProfileNodePtr node(newLucene<QueryProfileNode>(query));
+    {
+        SyncLock syncLock(this);
+        if (stack->empty()) {
+            profiles.add(node);
+        } else {
+            (*stack)[stack->size() - 1]->children.add(node);
+        }
+    }
+    WeightPtr weight;
+    {
+        ProfileScope scope(*stack, node);
+        ProfileTimer timer(node->weightNanos);
+        weight = query->createWeight(searcher);
+    }
+    return newLucene<ProfilingWeight>(weight, node);
+}
+
+CollectorPtr QueryProfiler::wrapCollector(const CollectorPtr& collector) {
+    return newLucene<ProfilingCollector>(collector, shared_from_this());
+}
+
+void QueryProfiler::endCollection(const CollectorPtr& collector) {
+    ProfilingCollectorPtr profilingCollector(boost::dynamic_pointer_cast<ProfilingCollector>(collector));
+    if (profilingCollector) {
+        profilingCollector->finish();
+    }
+}
+
+void QueryProfiler::addRewriteTime(int64_t nanos) {
+    SyncLock syncLock(this);
+    rewriteNanos += nanos;
+}
+
+void QueryProfiler::addCollectTime(int64_t count, int64_t nanos) {
+    SyncLock syncLock(this);
+    collectCount += count;
+    collectNanos += nanos;
+}
+
+ProfilingWeight::ProfilingWeight(const WeightPtr& weight, const QueryProfileNodePtr& node) {
+    this->weight = weight;
+    this->node = node;
+}
+
+ProfilingWeight::~ProfilingWeight() {
+}
+
+ExplanationPtr ProfilingWeight::explain(const IndexReaderPtr& reader, int32_t doc) {
+    return weight->explain(reader, doc);
+}
+
+QueryPtr ProfilingWeight::getQuery() {
+    return weight->getQuery();
+}
+
+double ProfilingWeight::getValue() {
+    return weight->getValue();
+}
+
+void ProfilingWeight::normalize(double norm) {
+    weight->normalize(norm);
+}
+
+ScorerPtr ProfilingWeight::scorer(const IndexReaderPtr& reader, bool scoreDocsInOrder, bool topScorer) {
+    SegmentReaderPtr segmentReader(boost::dynamic_pointer_cast<SegmentReader>(reader));
+    QueryProfileSegmentPtr segment(node->addSegment(segmentReader ? segmentReader->getSegmentName() : reader->getClassName()));
+    ScorerPtr scorer;
+    {
+        ProfileTimer timer(segment->scorerNanos);
+        scorer = weight->scorer(reader, scoreDocsInOrder, topScorer);
+    }
+    return scorer ? newLucene<ProfilingScorer>(scorer, segment) : scorer;
+}
+
+double ProfilingWeight::sumOfSquaredWeights() {
+    return weight->sumOfSquaredWeights();
+}
+
+bool ProfilingWeight::scoresDocsOutOfOrder() {
+    return weight->scoresDocsOutOfOrder();
+}
+
+ProfilingScorer::ProfilingScorer(const ScorerPtr& scorer, const QueryProfileSegmentPtr& segment) : Scorer(scorer->getSimilarity()) {
+    this->weight = scorer->weight;
+    this->scorer = scorer;
+    this->segment = segment;
+}
+
+ProfilingScorer::~ProfilingScorer() {
+}
+
+int32_t ProfilingScorer::docID() {
+    return scorer->docID();
+}
+
+int32_t ProfilingScorer::nextDoc() {
+    ProfileTimer timer(segment->nextDocNanos);
+    ++segment->nextDocCount;
+    return scorer->nextDoc();
+}
+
+int32_t ProfilingScorer::advance(int32_t target) {
+    ProfileTimer timer(segment->advanceNanos);
+    ++segment->advanceCount;
+    return scorer->advance(target);
+}
+
+double ProfilingScorer::score() {
+    ProfileTimer timer(segment->scoreNanos);
+    ++segment->scoreCount;
+    return scorer->score();
+}
+
+void ProfilingScorer::score(const CollectorPtr& collector) {
+    ProfileTimer timer(segment->bulkScoreNanos);
+    scorer->score(collector);
+}
+
+float ProfilingScorer::termFreq() {
+    return scorer->termFreq();
+}
+
+void ProfilingScorer::setMinCompetitiveScore(double minScore) {
+    scorer->setMinCompetitiveScore(minScore);
+}
+
+bool ProfilingScorer::score(const CollectorPtr& collector, int32_t max, int32_t firstDocID) {
+    ProfileTimer timer(segment->bulkScoreNanos);
+    return scorer->score(collector, max, firstDocID);
+}
+
+ProfilingCollector::ProfilingCollector(const CollectorPtr& collector, const QueryProfilerPtr& profiler) {
+    this->collector = collector;
+    this->profiler = profiler;
+    this->collectCount = 0;
+    this->collectNanos = 0;
+}
+
+ProfilingCollector::~ProfilingCollector() {
+}
+
+void ProfilingCollector::finish() {
+    profiler->addCollectTime(collectCount, collectNanos);
+    collectCount = 0;
+    collectNanos = 0;
+}
+
+void ProfilingCollector::setScorer(const ScorerPtr& scorer) {
+    collector->setScorer(scorer);
+}
+
+void ProfilingCollector::collect(int32_t doc) {
+    ProfileTimer timer(collectNanos);
+    collector->collect(doc);
+    ++collectCount;
+}
+
+void ProfilingCollector::setNextReader(const IndexReaderPtr& reader, int32_t docBase) {
+    collector->setNextReader(reader, docBase);
+}
+
+bool ProfilingCollector::acceptsDocsOutOfOrder() {
+    return collector->acceptsDocsOutOfOrder();
+}
+
+}
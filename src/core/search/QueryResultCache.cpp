@@ -0,0 +1,317 @@
+/////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2009-2014 Alan Wright. All rights reserved.
+// Distributable under the terms of either the Apache License (Version 2.0)
+// or the GNU Lesser General Public License.
+/////////////////////////////////////////////////////////////////////////////
+
+#include "LuceneInc.h"
+#include "QueryResultCache.h"
+#include "_QueryResultCache.h"
+#include "IndexSearcher.h"
+#include "IndexReader.h"
+#include "Query.h"
+#include "Filter.h"
+#include "Sort.h"
+#include "Similarity.h"
+#include "SortField.h"
+#include "TopFieldDocs.h"
+#include "FieldDoc.h"
+#include "FieldDocSortedHitQueue.h"
+#include "MiscUtils.h"
+#include "StringUtils.h"
+#include "VariantUtils.h"
+
+namespace Lucene {
+
+const int32_t QueryResultCache::DEFAULT_MAX_SIZE = 1000;
+
+/// Searcher settings recorded in the keys.
+static const int32_t TRACK_TOTAL_HITS = 1;
+static const int32_t TRACK_SCORES = 2;
+static const int32_t TRACK_MAX_SCORE = 4;
+
+QueryResultCache::QueryResultCache(int32_t maxSize) {
+    cache = MapKeyEntry::newInstance();
+    lru = MapLongKey::newInstance();
+    this->maxSize = maxSize;
+    this->useCount = 0;
+    this->hitCount = 0;
+    this->missCount = 0;
+    this->evictionCount = 0;
+}
+
+QueryResultCache::~QueryResultCache() {
+}
+
+static int32_t searcherOptions(const IndexSearcherPtr& searcher) {
+    int32_t options = 0;
+    if (searcher->getTrackTotalHits()) {
+        options |= TRACK_TOTAL_HITS;
+    }
+    if (searcher->getFieldSortDoTrackScores()) {
+        options |= TRACK_SCORES;
+    }
+    if (searcher->getFieldSortDoMaxScore()) {
+        options |= TRACK_MAX_SCORE;
+    }
+    return options;
+}
+
+TopDocsPtr QueryResultCache::search(const IndexSearcherPtr& searcher, const QueryPtr& query, const FilterPtr& filter, int32_t n) {
+    QueryResultCacheKeyPtr key(newLucene<QueryResultCacheKey>(query, filter, SortPtr(), n, searcher->getSimilarity(), searcherOptions(searcher), searcher->getSubReaders()));
+    TopDocsPtr topDocs(getEntry(key));
+    if (!topDocs) {
+        topDocs = searcher->search(query, filter, n);
+        putEntry(key, topDocs);
+    }
+    return topDocs;
+}
+
+TopFieldDocsPtr QueryResultCache::search(const IndexSearcherPtr& searcher, const QueryPtr& query, const FilterPtr& filter, int32_t n, const SortPtr& sort) {
+    if (searchPerSegment(searcher, sort)) {
+        return searchSegments(searcher, query, filter, n, sort);
+    }
+    QueryResultCacheKeyPtr key(newLucene<QueryResultCacheKey>(query, filter, sort, n, searcher->getSimilarity(), searcherOptions(searcher), searcher->getSubReaders()));
+    TopDocsPtr topDocs(getEntry(key));
+    if (!topDocs) {
+        topDocs = searcher->search(query, filter, n, sort);
+        putEntry(key, topDocs);
+    }
+    return boost::dynamic_pointer_cast<TopFieldDocs>(topDocs);
+}
+
+bool QueryResultCache::searchPerSegment(const IndexSearcherPtr& searcher, const SortPtr& sort) {
+    if (searcher->getSubReaders().empty() || searcher->getFieldSortDoTrackScores() || searcher->getFieldSortDoMaxScore()) {
+        return false;
+    }
+    Collection<SortFieldPtr> sortFields(sort->getSort());
+    for (Collection<SortFieldPtr>::iterator sortField = sortFields.begin(); sortField != sortFields.end(); ++sortField) {
+        if ((*sortField)->getType() == SortField::SCORE) {
+            return false;
+        }
+    }
+    return true;
+}
+
+TopFieldDocsPtr QueryResultCache::searchSegments(const IndexSearcherPtr& searcher, const QueryPtr& query, const FilterPtr& filter, int32_t n, const SortPtr& sort) {
+    Collection<IndexReaderPtr> subReaders(searcher->getSubReaders());
+    Collection<int32_t> docStarts(searcher->getDocStarts());
+    int32_t options = searcherOptions(searcher);
+    FieldDocSortedHitQueuePtr hq(newLucene<FieldDocSortedHitQueue>(std::min(n, searcher->maxDoc())));
+    int32_t totalHits = 0;
+    for (int32_t i = 0; i < subReaders.size(); ++i) {
+        QueryResultCacheKeyPtr key(newLucene<QueryResultCacheKey>(query, filter, sort, n, searcher->getSimilarity(), options, newCollection<IndexReaderPtr>(subReaders[i])));
+        TopFieldDocsPtr docs(boost::dynamic_pointer_cast<TopFieldDocs>(getEntry(key)));
+        if (!docs) {
+            IndexSearcherPtr segmentSearcher(newLucene<IndexSearcher>(subReaders[i]));
+            segmentSearcher->setSimilarity(searcher->getSimilarity());
+            segmentSearcher->setTrackTotalHits(searcher->getTrackTotalHits());
+            docs = segmentSearcher->search(query, filter, n, sort);
+            putEntry(key, docs);
+        }
+        totalHits += docs->totalHits;
+        hq->setFields(docs->fields);
+
+        // a DOC sort field breaks ties by doc id, which has to be rebased like the doc itself
+        int32_t docField = -1;
+        for (int32_t j = 0; j < docs->fields.size(); ++j) {
+            if (docs->fields[j]->getType() == SortField::DOC) {
+                docField = j;
+                break;
+            }
+        }
+        for (int32_t j = 0; j < docs->scoreDocs.size(); ++j) { // merge the cached hits, leaving them unchanged
+            FieldDocPtr fieldDoc(boost::dynamic_pointer_cast<FieldDoc>(docs->scoreDocs[j]));
+            Collection<ComparableValue> fields(fieldDoc->fields);
+            if (docField != -1) {
+                fields = Collection<ComparableValue>::newInstance(fields.begin(), fields.end());
+                fields[docField] = VariantUtils::get<int32_t>(fields[docField]) + docStarts[i];
+            }
+            FieldDocPtr rebased(newLucene<FieldDoc>(fieldDoc->doc + docStarts[i], fieldDoc->score, fields));
+            if (rebased == hq->addOverflow(rebased)) {
+                break;
+            }
+        }
+    }
+
+    Collection<ScoreDocPtr> scoreDocs(Collection<ScoreDocPtr>::newInstance(hq->size()));
+    for (int32_t i = hq->size() - 1; i >= 0; --i) { // put docs in array
+        scoreDocs[i] = hq->pop();
+    }
+    return newLucene<TopFieldDocs>(totalHits, scoreDocs, hq->getFields(), std::numeric_limits<double>::quiet_NaN());
+}
+
+TopDocsPtr QueryResultCache::getEntry(const QueryResultCacheKeyPtr& key) {
+    SyncLock syncLock(this);
+    QueryResultCacheEntryPtr entry(cache.get(key));
+    if (!entry) {
+        ++missCount;
+        return TopDocsPtr();
+    }
+    ++hitCount;
+    lru.remove(entry->lastUse);
+    entry->lastUse = useCount++;
+    lru.put(entry->lastUse, key);
+    return entry->topDocs;
+}
+
+void QueryResultCache::putEntry(const QueryResultCacheKeyPtr& key, const TopDocsPtr& topDocs) {
+    SyncLock syncLock(this);
+    if (cache.contains(key)) {
+        return;
+    }
+    purgeClosedSegments();
+    QueryResultCacheEntryPtr entry(newLucene<QueryResultCacheEntry>(topDocs, useCount++));
+    cache.put(key, entry);
+    lru.put(entry->lastUse, key);
+    evictIfNecessary();
+}
+
+void QueryResultCache::removeEntry(const QueryResultCacheKeyPtr& key) {
+    QueryResultCacheEntryPtr entry(cache.get(key));
+    if (entry) {
+        cache.remove(key);
+        lru.remove(entry->lastUse);
+    }
+}
+
+void QueryResultCache::evictIfNecessary() {
+    while (!lru.empty() && cache.size() > maxSize) {
+        removeEntry(lru.begin()->second);
+        ++evictionCount;
+    }
+}
+
+void QueryResultCache::purgeClosedSegments() {
+    Collection<QueryResultCacheKeyPtr> closed(Collection<QueryResultCacheKeyPtr>::newInstance());
+    for (MapKeyEntry::iterator entry = cache.begin(); entry != cache.end(); ++entry) {
+        if (entry->first->isClosed()) {
+            closed.add(entry->first);
+        }
+    }
+    for (Collection<QueryResultCacheKeyPtr>::iterator key = closed.begin(); key != closed.end(); ++key) {
+        removeEntry(*key);
+    }
+}
+
+void QueryResultCache::setMaxSize(int32_t maxSize) {
+    SyncLock syncLock(this);
+    this->maxSize = maxSize;
+    evictIfNecessary();
+}
+
+int32_t QueryResultCache::getMaxSize() {
+    SyncLock syncLock(this);
+    return maxSize;
+}
+
+void QueryResultCache::clear() {
+    SyncLock syncLock(this);
+    cache.clear();
+    lru.clear();
+}
+
+int32_t QueryResultCache::getCacheSize() {
+    SyncLock syncLock(this);
+    return cache.size();
+}
+
+int64_t QueryResultCache::getHitCount() {
+    SyncLock syncLock(this);
+    return hitCount;
+}
+
+int64_t QueryResultCache::getMissCount() {
+    SyncLock syncLock(this);
+    return missCount;
+}
+
+int64_t QueryResultCache::getEvictionCount() {
+    SyncLock syncLock(this);
+    return evictionCount;
+}
+
+QueryResultCacheKey::QueryResultCacheKey(const QueryPtr& query, const FilterPtr& filter, const SortPtr& sort, int32_t n, const SimilarityPtr& similarity, int32_t options, Collection<IndexReaderPtr> readers) {
+    // the caller may change the query once the search is done
+    this->query = boost::dynamic_pointer_cast<Query>(query->clone());
+    this->filter = filter;
+    this->sort = sort;
+    this->n = n;
+    this->similarity = similarity;
+    this->options = options;
+    this->readerKeys = Collection<LuceneObjectWeakPtr>::newInstance();
+    this->hash = this->query->hashCode();
+    this->hash = hash * 31 + (filter ? filter->hashCode() : 0);
+    this->hash = hash * 31 + (sort ? sort->hashCode() : 0);
+    this->hash = hash * 31 + n * 8 + options;
+    this->hash = hash * 31 + similarity->hashCode();
+    for (Collection<IndexReaderPtr>::iterator reader = readers.begin(); reader != readers.end(); ++reader) {
+        LuceneObjectPtr coreKey((*reader)->getFieldCacheKey());
+        LuceneObjectPtr deletesKey((*reader)->getDeletesCacheKey());
+        if (!deletesKey) {
+            // no deletions, the core identifies them
+            deletesKey = coreKey;
+        }
+        readerKeys.add(coreKey);
+        readerKeys.add(deletesKey);
+        hash = hash * 31 + coreKey->hashCode();
+        hash = hash * 31 + deletesKey->hashCode();
+    }
+}
+
+QueryResultCacheKey::~QueryResultCacheKey() {
+}
+
+bool QueryResultCacheKey::isClosed() {
+    for (Collection<LuceneObjectWeakPtr>::iterator readerKey = readerKeys.begin(); readerKey != readerKeys.end(); ++readerKey) {
+        if (readerKey->expired()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool QueryResultCacheKey::equals(const LuceneObjectPtr& other) {
+    if (LuceneObject::equals(other)) {
+        return true;
+    }
+    QueryResultCacheKeyPtr otherKey(boost::dynamic_pointer_cast<QueryResultCacheKey>(other));
+    if (!otherKey) {
+        return false;
+    }
+    if (hash != otherKey->hash || n != otherKey->n || options != otherKey->options || readerKeys.size() != otherKey->readerKeys.size()) {
+        return false;
+    }
+
+    // compare the segments by identity, which still works once they have gone
+    for (int32_t i = 0; i < readerKeys.size(); ++i) {
+        if (readerKeys[i].owner_before(otherKey->readerKeys[i]) || otherKey->readerKeys[i].owner_before(readerKeys[i])) {
+            return false;
+        }
+    }
+
+    if (similarity != otherKey->similarity && !similarity->equals(otherKey->similarity)) {
+        return false;
+    }
+    if (filter != otherKey->filter && (!filter || !otherKey->filter || !filter->equals(otherKey->filter))) {
+        return false;
+    }
+    if (sort != otherKey->sort && (!sort || !otherKey->sort || !sort->getSort().equals(otherKey->sort->getSort(), luceneEquals<SortFieldPtr>()))) {
+        return false;
+    }
+    return query->equals(otherKey->query);
+}
+
+int32_t QueryResultCacheKey::hashCode() {
+    return hash;
+}
+
+QueryResultCacheEntry::QueryResultCacheEntry(const TopDocsPtr& topDocs, int64_t lastUse) {
+    this->topDocs = topDocs;
+    this->lastUse = lastUse;
+}
+
+QueryResultCacheEntry::~QueryResultCacheEntry() {
+}
+
+}
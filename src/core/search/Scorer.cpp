@@ -33,6 +33,9 @@ namespace Lucene {
         }
     }
     
+    void Scorer::setMinCompetitiveScore(double minScore) {
+    }
+    
     bool Scorer::score(const CollectorPtr& collector, int32_t max, int32_t firstDocID) {
         collector->setScorer(shared_from_this());
         int32_t doc = firstDocID;
@@ -9,6 +9,7 @@
 #include "Similarity.h"
 #include "Query.h"
 #include "Collector.h"
+#include "QueryProfiler.h"
 
 namespace Lucene {
 
@@ -55,6 +56,21 @@ WeightPtr Searcher::createWeight(const QueryPtr& query) {
     return query->weight(shared_from_this());
 }
 
+void Searcher::setProfiler(const QueryProfilerPtr& profiler) {
+    this->profiler = profiler;
+}
+
+QueryProfilerPtr Searcher::getProfiler() {
+    return profiler;
+}
+
+WeightPtr Searcher::createNodeWeight(const QueryPtr& query) {
+    if (profiler) {
+        return profiler->createWeight(query, shared_from_this());
+    }
+    return query->createWeight(shared_from_this());
+}
+
 Collection<int32_t> Searcher::docFreqs(Collection<TermPtr> terms) {
     Collection<int32_t> result(Collection<int32_t>::newInstance(terms.size()));
     for (int32_t i = 0; i < terms.size(); ++i) {
@@ -0,0 +1,236 @@
+/////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2009-2014 Alan Wright. All rights reserved.
+// Distributable under the terms of either the Apache License (Version 2.0)
+// or the GNU Lesser General Public License.
+/////////////////////////////////////////////////////////////////////////////
+
+#include "LuceneInc.h"
+#include "SearcherManager.h"
+#include "_SearcherManager.h"
+#include "IndexSearcher.h"
+#include "IndexReader.h"
+#include "IndexWriter.h"
+
+namespace Lucene {
+
+SearcherManager::SearcherManager(const IndexWriterPtr& writer, const IndexReaderWarmerPtr& warmer) {
+    this->warmer = warmer;
+    ConstructManager(writer->getReader());
+}
+
+SearcherManager::SearcherManager(const DirectoryPtr& directory, const IndexReaderWarmerPtr& warmer) {
+    this->warmer = warmer;
+    ConstructManager(IndexReader::open(directory, true));
+}
+
+SearcherManager::~SearcherManager() {
+}
+
+void SearcherManager::ConstructManager(const IndexReaderPtr& reader) {
+    this->refreshing = false;
+    this->closed = false;
+    this->refreshMillis = 0;
+
+    LuceneException finally;
+    try {
+        warmNewSegments(reader, IndexReaderPtr());
+    } catch (LuceneException& e) {
+        finally = e;
+    } catch (...) {
+        reader->decRef();
+        throw;
+    }
+    if (!finally.isNull()) {
+        reader->decRef();
+        finally.throwException();
+    }
+    this->current = newLucene<IndexSearcher>(reader);
+}
+
+IndexSearcherPtr SearcherManager::acquire() {
+    SyncLock syncLock(this);
+    if (closed) {
+        boost::throw_exception(AlreadyClosedException(L"this SearcherManager is closed"));
+    }
+    // the reader can't be closed meanwhile, the previous searcher is only released under this lock
+    current->getIndexReader()->incRef();
+    return current;
+}
+
+void SearcherManager::release(const IndexSearcherPtr& searcher) {
+    searcher->getIndexReader()->decRef();
+}
+
+bool SearcherManager::maybeRefresh() {
+    {
+        SyncLock syncLock(this);
+        if (refreshing) {
+            return false;
+        }
+        refreshing = true;
+    }
+
+    bool refreshed = false;
+    LuceneException finally;
+    try {
+        IndexSearcherPtr searcher(acquire());
+        IndexReaderPtr reader(searcher->getIndexReader());
+        IndexReaderPtr newReader;
+        try {
+            // Readers of IndexWriter::getReader always reopen as a new reader, even when nothing changed
+            newReader = reader->isCurrent() ? reader : reader->reopen();
+        } catch (LuceneException& e) {
+            finally = e;
+        } catch (...) {
+            release(searcher);
+            throw;
+        }
+        release(searcher);
+        finally.throwException();
+
+        if (newReader != reader) {
+            try {
+                warmNewSegments(newReader, reader);
+            } catch (LuceneException& e) {
+                finally = e;
+            } catch (...) {
+                newReader->decRef();
+                throw;
+            }
+            if (!finally.isNull()) {
+                newReader->decRef();
+                finally.throwException();
+            }
+
+            IndexSearcherPtr newSearcher(newLucene<IndexSearcher>(newReader));
+            IndexSearcherPtr previous;
+            {
+                SyncLock syncLock(this);
+                if (closed) {
+                    previous = newSearcher;
+                } else {
+                    previous = current;
+                    current = newSearcher;
+                    refreshed = true;
+                }
+            }
+            release(previous);
+        }
+    } catch (LuceneException& e) {
+        finally = e;
+    } catch (...) {
+        // let the next refresh run, whatever the warmer threw
+        SyncLock syncLock(this);
+        refreshing = false;
+        throw;
+    }
+
+    {
+        SyncLock syncLock(this);
+        refreshing = false;
+    }
+    finally.throwException();
+    return refreshed;
+}
+
+void SearcherManager::warmNewSegments(const IndexReaderPtr& reader, const IndexReaderPtr& previousReader) {
+    if (!warmer) {
+        return;
+    }
+    HashSet<LuceneObjectPtr> previousCores(HashSet<LuceneObjectPtr>::newInstance());
+    if (previousReader) {
+        Collection<IndexReaderPtr> previousSegments(getSegments(previousReader));
+        for (Collection<IndexReaderPtr>::iterator segment = previousSegments.begin(); segment != previousSegments.end(); ++segment) {
+            previousCores.add((*segment)->getFieldCacheKey());
+        }
+    }
+    // a segment that only has new deletions shares its core, and what was loaded for it, with the previous reader
+    Collection<IndexReaderPtr> segments(getSegments(reader));
+    for (Collection<IndexReaderPtr>::iterator segment = segments.begin(); segment != segments.end(); ++segment) {
+        if (!previousCores.contains((*segment)->getFieldCacheKey())) {
+            warmer->warm(*segment);
+        }
+    }
+}
+
+Collection<IndexReaderPtr> SearcherManager::getSegments(const IndexReaderPtr& reader) {
+    Collection<IndexReaderPtr> segments(Collection<IndexReaderPtr>::newInstance());
+    Collection<IndexReaderPtr> subReaders(reader->getSequentialSubReaders());
+    if (!subReaders) {
+        segments.add(reader);
+        return segments;
+    }
+    for (Collection<IndexReaderPtr>::iterator subReader = subReaders.begin(); subReader != subReaders.end(); ++subReader) {
+        Collection<IndexReaderPtr> subSegments(getSegments(*subReader));
+        segments.addAll(subSegments.begin(), subSegments.end());
+    }
+    return segments;
+}
+
+void SearcherManager::startRefreshing(int32_t refreshMillis) {
+    SyncLock syncLock(this);
+    if (closed) {
+        boost::throw_exception(AlreadyClosedException(L"this SearcherManager is closed"));
+    }
+    if (refreshThread) {
+        boost::throw_exception(IllegalStateException(L"already refreshing in the background"));
+    }
+    if (refreshMillis <= 0) {
+        boost::throw_exception(IllegalArgumentException(L"refreshMillis must be positive"));
+    }
+    this->refreshMillis = refreshMillis;
+    refreshThread = newLucene<SearcherRefreshThread>(shared_from_this());
+    refreshThread->start();
+}
+
+bool SearcherManager::waitForRefresh() {
+    SyncLock syncLock(this);
+    if (!closed) {
+        wait(refreshMillis);
+    }
+    return !closed;
+}
+
+void SearcherManager::close() {
+    SearcherRefreshThreadPtr thread;
+    IndexSearcherPtr searcher;
+    {
+        SyncLock syncLock(this);
+        if (closed) {
+            return;
+        }
+        closed = true;
+        notifyAll();
+        thread = refreshThread;
+        refreshThread.reset();
+        searcher = current;
+        current.reset();
+    }
+    if (thread) {
+        thread->join();
+    }
+    release(searcher);
+}
+
+SearcherRefreshThread::SearcherRefreshThread(const SearcherManagerPtr& manager) {
+    this->_manager = manager;
+}
+
+SearcherRefreshThread::~SearcherRefreshThread() {
+}
+
+void SearcherRefreshThread::run() {
+    while (true) {
+        SearcherManagerPtr manager(_manager.lock());
+        if (!manager || !manager->waitForRefresh()) {
+            break;
+        }
+        try {
+            manager->maybeRefresh();
+        } catch (...) {
+            // keep the current searcher, the next refresh tries again
+        }
+    }
+}
+
+}
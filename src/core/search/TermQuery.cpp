@@ -9,6 +9,7 @@
 #include "_TermQuery.h"
 #include "TermScorer.h"
 #include "IndexReader.h"
+#include "SegmentReader.h"
 #include "ComplexExplanation.h"
 #include "Term.h"
 #include "TermDocs.h"
@@ -110,7 +111,14 @@ void TermWeight::normalize(double norm) {
 
 ScorerPtr TermWeight::scorer(const IndexReaderPtr& reader, bool scoreDocsInOrder, bool topScorer) {
     TermDocsPtr termDocs(reader->termDocs(query->term));
-    return termDocs ? newLucene<TermScorer>(shared_from_this(), termDocs, similarity, reader->norms(query->term->field())) : ScorerPtr();
+    if (!termDocs) {
+        return ScorerPtr();
+    }
+    String field(query->term->field());
+    // segments keep the highest norm of each field, so score bounds don't need a pass over the norms
+    SegmentReaderPtr segmentReader(boost::dynamic_pointer_cast<SegmentReader>(reader));
+    double maxNorm = segmentReader ? Similarity::decodeNorm(segmentReader->maxNorm(field)) : -1.0;
+    return newLucene<TermScorer>(shared_from_this(), termDocs, similarity, reader->norms(field), maxNorm);
 }
 
 ExplanationPtr TermWeight::explain(const IndexReaderPtr& reader, int32_t doc) {
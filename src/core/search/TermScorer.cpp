@@ -15,17 +15,22 @@ namespace Lucene {
 
 const int32_t TermScorer::SCORE_CACHE_SIZE = 32;
 
-TermScorer::TermScorer(const WeightPtr& weight, const TermDocsPtr& td, const SimilarityPtr& similarity, ByteArray norms) : Scorer(similarity) {
+/// Number of docs decoded per call to {@link TermDocs#read(Collection<int32_t>, Collection<int32_t>)}.
+const int32_t TermScorer::DOCS_BUFFER_SIZE = 128;
+
+TermScorer::TermScorer(const WeightPtr& weight, const TermDocsPtr& td, const SimilarityPtr& similarity, ByteArray norms, double maxNorm) : Scorer(similarity) {
     this->weight = weight;
     this->termDocs = td;
     this->norms = norms;
     this->weightValue = weight->getValue();
     this->doc = -1;
-    this->docs = Collection<int32_t>::newInstance(32);
-    this->freqs = Collection<int32_t>::newInstance(32);
+    this->docs = Collection<int32_t>::newInstance(DOCS_BUFFER_SIZE);
+    this->freqs = Collection<int32_t>::newInstance(DOCS_BUFFER_SIZE);
     this->pointer = 0;
     this->pointerMax = 0;
     this->scoreCache = Collection<double>::newInstance(SCORE_CACHE_SIZE);
+    this->maxNorm = maxNorm;
+    this->minCompetitiveScore = -std::numeric_limits<double>::infinity();
 
     for (int32_t i = 0; i < SCORE_CACHE_SIZE; ++i) {
         scoreCache[i] = getSimilarity()->tf(i) * weightValue;
@@ -49,6 +54,14 @@ bool TermScorer::score(const CollectorPtr& collector, int32_t max, int32_t first
     while (doc < max) { // for docs in window
         collector->collect(doc);
 
+        if (minCompetitiveScore != -std::numeric_limits<double>::infinity()) {
+            // the collector has a threshold, skip blocks that can't reach it
+            if (advance(doc + 1) == NO_MORE_DOCS) {
+                return false;
+            }
+            continue;
+        }
+
         if (++pointer >= pointerMax) {
             pointerMax = termDocs->read(docs, freqs); // refill buffers
             if (pointerMax != 0) {
@@ -65,11 +78,39 @@ bool TermScorer::score(const CollectorPtr& collector, int32_t max, int32_t first
     return true;
 }
 
+int32_t TermScorer::nextScores(int32_t max, Collection<int32_t> docBuffer, Collection<double> scoreBuffer) {
+    Collection<double> normDecoder(SIM_NORM_DECODER());
+    int32_t size = docBuffer.size();
+    int32_t count = 0;
+    while (doc < max && count < size) {
+        double raw = freq < SCORE_CACHE_SIZE ? scoreCache[freq] : getSimilarity()->tf(freq) * weightValue;
+        docBuffer[count] = doc;
+        scoreBuffer[count++] = norms ? raw * normDecoder[norms[doc] & 0xff] : raw;
+
+        if (++pointer >= pointerMax) {
+            pointerMax = termDocs->read(docs, freqs); // refill buffers
+            if (pointerMax != 0) {
+                pointer = 0;
+            } else {
+                termDocs->close(); // close stream
+                doc = NO_MORE_DOCS;
+                break;
+            }
+        }
+        doc = docs[pointer];
+        freq = freqs[pointer];
+    }
+    return count;
+}
+
 int32_t TermScorer::docID() {
     return doc;
 }
 
 int32_t TermScorer::nextDoc() {
+    if (minCompetitiveScore != -std::numeric_limits<double>::infinity()) {
+        return doc == NO_MORE_DOCS ? doc : advance(doc + 1);
+    }
     ++pointer;
     if (pointer >= pointerMax) {
         pointerMax = termDocs->read(docs, freqs); // refill buffer
@@ -93,13 +134,86 @@ double TermScorer::score() {
     return norms ? raw * SIM_NORM_DECODER()[norms[doc] & 0xff] : raw; // normalize for field
 }
 
+double TermScorer::maxScore() {
+    return maxScoreForFreq(termDocs->maxFreq());
+}
+
+double TermScorer::maxScore(int32_t target) {
+    return maxScoreForFreq(termDocs->advanceShallow(target) > 0 ? termDocs->blockMaxFreq(0) : termDocs->maxFreq());
+}
+
+double TermScorer::maxScoreForFreq(int32_t maxFreq) {
+    if (maxFreq <= 0 || weightValue < 0) {
+        return std::numeric_limits<double>::infinity();
+    }
+    double raw = 0;
+    for (int32_t i = 1; i < SCORE_CACHE_SIZE && i <= maxFreq; ++i) {
+        raw = std::max(raw, scoreCache[i]);
+    }
+    if (maxFreq >= SCORE_CACHE_SIZE) {
+        raw = std::max(raw, getSimilarity()->tf(maxFreq) * weightValue);
+    }
+    if (!norms || norms.size() == 0) {
+        return raw;
+    }
+    if (maxNorm < 0) {
+        // decoded norms grow with their encoded byte
+        maxNorm = SIM_NORM_DECODER()[*std::max_element(norms.get(), norms.get() + norms.size())];
+    }
+    return raw * maxNorm;
+}
+
+void TermScorer::setMinCompetitiveScore(double minScore) {
+    minCompetitiveScore = minScore;
+}
+
+int32_t TermScorer::competitiveTarget(int32_t target) {
+    while (true) {
+        int32_t levels = termDocs->advanceShallow(target);
+        if (levels == 0) {
+            // past the last skip entry, only the bound of the whole term is known
+            return maxScore() <= minCompetitiveScore ? NO_MORE_DOCS : target;
+        }
+        // a block contains the blocks below it, so find the largest non-competitive one
+        int32_t upTo = -1;
+        for (int32_t level = 0; level < levels && maxScoreForFreq(termDocs->blockMaxFreq(level)) <= minCompetitiveScore; ++level) {
+            upTo = termDocs->blockEnd(level);
+        }
+        if (upTo == -1) {
+            return target;
+        }
+        target = upTo + 1;
+    }
+}
+
 int32_t TermScorer::advance(int32_t target) {
+    if (minCompetitiveScore == -std::numeric_limits<double>::infinity()) {
+        advanceDoc(target);
+        return doc;
+    }
+    target = competitiveTarget(target);
+    while (target != NO_MORE_DOCS) {
+        advanceDoc(target);
+        if (doc == NO_MORE_DOCS) {
+            break;
+        }
+        // the document may be in a later block, which needs checking too
+        target = competitiveTarget(doc);
+        if (target == doc) {
+            return doc;
+        }
+    }
+    doc = NO_MORE_DOCS;
+    return doc;
+}
+
+void TermScorer::advanceDoc(int32_t target) {
     // first scan in cache
     for (++pointer; pointer < pointerMax; ++pointer) {
         if (docs[pointer] >= target) {
             doc = docs[pointer];
             freq = freqs[pointer];
-            return doc;
+            return;
         }
     }
 
@@ -114,7 +228,6 @@ int32_t TermScorer::advance(int32_t target) {
     } else {
         doc = NO_MORE_DOCS;
     }
-    return doc;
 }
 
 String TermScorer::toString() {
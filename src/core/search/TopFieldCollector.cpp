@@ -12,6 +12,9 @@
 #include "FieldDoc.h"
 #include "Scorer.h"
 #include "Sort.h"
+#include "SortField.h"
+#include "SegmentReader.h"
+#include "SegmentInfo.h"
 #include "TopFieldDocs.h"
 
 namespace Lucene {
@@ -22,6 +25,8 @@ TopFieldCollector::TopFieldCollector(const HitQueueBasePtr& pq, int32_t numHits,
     this->maxScore = std::numeric_limits<double>::quiet_NaN();
     this->queueFull = false;
     this->docBase = 0;
+    this->earlyTerminate = false;
+    this->segmentSorted = false;
 }
 
 TopFieldCollector::~TopFieldCollector() {
@@ -81,6 +86,15 @@ TopFieldCollectorPtr TopFieldCollector::create(const SortPtr& sort, int32_t numH
     }
 }
 
+TopFieldCollectorPtr TopFieldCollector::create(const SortPtr& sort, int32_t numHits, bool fillFields, bool trackDocScores, bool trackMaxScore, bool docsScoredInOrder, bool trackTotalHits) {
+    if (trackTotalHits || trackMaxScore) {
+        return create(sort, numHits, fillFields, trackDocScores, trackMaxScore, docsScoredInOrder);
+    }
+    TopFieldCollectorPtr collector(create(sort, numHits, fillFields, trackDocScores, false, true));
+    collector->earlyTerminate = true;
+    return collector;
+}
+
 void TopFieldCollector::add(int32_t slot, int32_t doc, double score) {
     bottom = boost::static_pointer_cast<FieldValueHitQueueEntry>(pq->add(newLucene<FieldValueHitQueueEntry>(slot, docBase + doc, score)));
     queueFull = (totalHits == numHits);
@@ -115,6 +129,32 @@ bool TopFieldCollector::acceptsDocsOutOfOrder() {
     return false;
 }
 
+bool TopFieldCollector::isSortedSegment(const IndexReaderPtr& reader) {
+    SegmentReaderPtr segmentReader(boost::dynamic_pointer_cast<SegmentReader>(reader));
+    SortPtr indexSort(segmentReader ? segmentReader->getSegmentInfo()->getIndexSort() : SortPtr());
+    if (!indexSort) {
+        return false;
+    }
+    Collection<SortFieldPtr> fields(boost::static_pointer_cast<FieldValueHitQueue>(pq)->getFields());
+    Collection<SortFieldPtr> indexFields(indexSort->getSort());
+    for (int32_t i = 0; i < fields.size(); ++i) {
+        if (fields[i]->getType() == SortField::DOC && !fields[i]->getReverse()) {
+            return true; // documents with equal values are in doc Id order anyway
+        }
+        if (i >= indexFields.size() || !fields[i]->equals(indexFields[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void TopFieldCollector::notCompetitive() {
+    if (segmentSorted) {
+        // the following documents of the segment sort after this one, so they aren't competitive either
+        boost::throw_exception(CollectionTerminatedException());
+    }
+}
+
 OneComparatorNonScoringCollector::OneComparatorNonScoringCollector(const FieldValueHitQueuePtr& queue, int32_t numHits, bool fillFields) : TopFieldCollector(queue, numHits, fillFields) {
 }
 
@@ -140,6 +180,7 @@ void OneComparatorNonScoringCollector::collect(int32_t doc) {
         if ((reverseMul * comparator->compareBottom(doc)) <= 0) {
             // since docs are visited in doc Id order, if compare is 0, it means this document is largest
             // than anything else in the queue, and therefore not competitive.
+            notCompetitive();
             return;
         }
 
@@ -161,6 +202,7 @@ void OneComparatorNonScoringCollector::collect(int32_t doc) {
 
 void OneComparatorNonScoringCollector::setNextReader(const IndexReaderPtr& reader, int32_t docBase) {
     this->docBase = docBase;
+    segmentSorted = earlyTerminate && isSortedSegment(reader);
     comparator->setNextReader(reader, docBase);
 }
 
@@ -221,6 +263,7 @@ void OneComparatorScoringNoMaxScoreCollector::collect(int32_t doc) {
         if ((reverseMul * comparator->compareBottom(doc)) <= 0) {
             // since docs are visited in doc Id order, if compare is 0, it means this document is largest
             // than anything else in the queue, and therefore not competitive.
+            notCompetitive();
             return;
         }
 
@@ -406,6 +449,7 @@ void MultiComparatorNonScoringCollector::collect(int32_t doc) {
             int32_t c = reverseMul[i] * comparators[i]->compareBottom(doc);
             if (c < 0) {
                 // Definitely not competitive.
+                notCompetitive();
                 return;
             } else if (c > 0) {
                 // Definitely competitive.
@@ -414,6 +458,7 @@ void MultiComparatorNonScoringCollector::collect(int32_t doc) {
                 // Here c=0. If we're at the last comparator, this doc is not competitive, since docs are
                 // visited in doc Id order, which means this doc cannot compete with any other document
                 // in the queue.
+                notCompetitive();
                 return;
             }
         }
@@ -446,6 +491,7 @@ void MultiComparatorNonScoringCollector::collect(int32_t doc) {
 
 void MultiComparatorNonScoringCollector::setNextReader(const IndexReaderPtr& reader, int32_t docBase) {
     this->docBase = docBase;
+    segmentSorted = earlyTerminate && isSortedSegment(reader);
     for (Collection<FieldComparatorPtr>::iterator cmp = comparators.begin(); cmp != comparators.end(); ++cmp) {
         (*cmp)->setNextReader(reader, docBase);
     }
@@ -667,6 +713,7 @@ void MultiComparatorScoringNoMaxScoreCollector::collect(int32_t doc) {
             int32_t c = reverseMul[i] * comparators[i]->compareBottom(doc);
             if (c < 0) {
                 // Definitely not competitive.
+                notCompetitive();
                 return;
             } else if (c > 0) {
                 // Definitely competitive.
@@ -675,6 +722,7 @@ void MultiComparatorScoringNoMaxScoreCollector::collect(int32_t doc) {
                 // Here c=0. If we're at the last comparator, this doc is not competitive, since docs are
                 // visited in doc Id order, which means this doc cannot compete with any other document
                 // in the queue.
+                notCompetitive();
                 return;
             }
         }
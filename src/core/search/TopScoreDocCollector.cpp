@@ -25,8 +25,10 @@ TopScoreDocCollector::TopScoreDocCollector(int32_t numHits) : TopDocsCollector(n
 TopScoreDocCollector::~TopScoreDocCollector() {
 }
 
-TopScoreDocCollectorPtr TopScoreDocCollector::create(int32_t numHits, bool docsScoredInOrder) {
-    if (docsScoredInOrder) {
+TopScoreDocCollectorPtr TopScoreDocCollector::create(int32_t numHits, bool docsScoredInOrder, bool trackTotalHits) {
+    if (!trackTotalHits) {
+        return newLucene<PruningTopScoreDocCollector>(numHits);
+    } else if (docsScoredInOrder) {
         return newLucene<InOrderTopScoreDocCollector>(numHits);
     } else {
         return newLucene<OutOfOrderTopScoreDocCollector>(numHits);
@@ -91,6 +93,28 @@ bool InOrderTopScoreDocCollector::acceptsDocsOutOfOrder() {
     return false;
 }
 
+PruningTopScoreDocCollector::PruningTopScoreDocCollector(int32_t numHits) : InOrderTopScoreDocCollector(numHits) {
+}
+
+PruningTopScoreDocCollector::~PruningTopScoreDocCollector() {
+}
+
+void PruningTopScoreDocCollector::setScorer(const ScorerPtr& scorer) {
+    InOrderTopScoreDocCollector::setScorer(scorer);
+    // the queue may already be full from previous segments
+    if (pqTop->score != -std::numeric_limits<double>::infinity()) {
+        scorer->setMinCompetitiveScore(pqTop->score);
+    }
+}
+
+void PruningTopScoreDocCollector::collect(int32_t doc) {
+    double minScore = pqTop->score;
+    InOrderTopScoreDocCollector::collect(doc);
+    if (pqTop->score != minScore && pqTop->score != -std::numeric_limits<double>::infinity()) {
+        ScorerPtr(_scorer)->setMinCompetitiveScore(pqTop->score);
+    }
+}
+
 OutOfOrderTopScoreDocCollector::OutOfOrderTopScoreDocCollector(int32_t numHits) : TopScoreDocCollector(numHits) {
 }
 
@@ -8,6 +8,7 @@
 #include "CustomScoreQuery.h"
 #include "_CustomScoreQuery.h"
 #include "ValueSourceQuery.h"
+#include "Searcher.h"
 #include "ComplexExplanation.h"
 #include "MiscUtils.h"
 #include "StringUtils.h"
@@ -208,7 +209,7 @@ CustomWeight::CustomWeight(const CustomScoreQueryPtr& query, const SearcherPtr&
     this->subQueryWeight = query->subQuery->weight(searcher);
     this->valSrcWeights = Collection<WeightPtr>::newInstance(query->valSrcQueries.size());
     for (int32_t i = 0; i < query->valSrcQueries.size(); ++i) {
-        this->valSrcWeights[i] = query->valSrcQueries[i]->createWeight(searcher);
+        this->valSrcWeights[i] = searcher->createNodeWeight(query->valSrcQueries[i]);
     }
     this->qStrict = query->strict;
 }
@@ -31,6 +31,31 @@ uint8_t BufferedIndexInput::readByte() {
     return buffer[bufferPosition++];
 }
 
+int32_t BufferedIndexInput::readVInt() {
+    if (bufferLength - bufferPosition >= 5) {
+        int32_t i = 0;
+        int32_t bytesRead = 0;
+        MiscUtils::decodeVInts(buffer.get() + bufferPosition, bufferLength - bufferPosition, &i, 1, bytesRead);
+        bufferPosition += bytesRead;
+        return i;
+    }
+    return IndexInput::readVInt();
+}
+
+void BufferedIndexInput::readVInts(int32_t* values, int32_t count) {
+    int32_t decoded = 0;
+    while (decoded < count) {
+        if (bufferLength - bufferPosition < 5) {
+            // value may straddle the end of the buffer
+            values[decoded++] = IndexInput::readVInt();
+            continue;
+        }
+        int32_t bytesRead = 0;
+        decoded += MiscUtils::decodeVInts(buffer.get() + bufferPosition, bufferLength - bufferPosition, values + decoded, count - decoded, bytesRead);
+        bufferPosition += bytesRead;
+    }
+}
+
 void BufferedIndexInput::setBufferSize(int32_t newSize) {
     if (newSize != bufferSize) {
         bufferSize = newSize;
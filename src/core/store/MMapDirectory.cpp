@@ -12,18 +12,61 @@
 #include "MiscUtils.h"
 #include "FileUtils.h"
 #include "StringUtils.h"
+#include "FileSwitchDirectory.h"
+
+#if !defined(_WIN32)
+#include <sys/mman.h>
+#endif
 
 namespace Lucene {
 
+/// Default maximum chunk size.  This is a conditional default based on operating system.
+#ifdef LPP_BUILD_64
+const int32_t MMapDirectory::DEFAULT_MAX_CHUNK_SIZE = 1 << 30; // 1gb
+#else
+const int32_t MMapDirectory::DEFAULT_MAX_CHUNK_SIZE = 1 << 28; // 256mb
+#endif
+
 MMapDirectory::MMapDirectory(const String& path, const LockFactoryPtr& lockFactory) : FSDirectory(path, lockFactory) {
+    chunkSizePower = 0;
+    advices = MapStringInt::newInstance();
+    setMaxChunkSize(DEFAULT_MAX_CHUNK_SIZE);
 }
 
 MMapDirectory::~MMapDirectory() {
 }
 
+void MMapDirectory::setMaxChunkSize(int32_t maxChunkSize) {
+    if (maxChunkSize <= 0) {
+        boost::throw_exception(IllegalArgumentException(L"Maximum chunk size for mmap must be > 0"));
+    }
+    // chunk offsets must be a multiple of the platform mapping alignment
+    int32_t alignment = boost::iostreams::mapped_file_source::alignment();
+    maxChunkSize = std::max(maxChunkSize, alignment);
+    int32_t power = 0;
+    while (power < 30 && (1 << (power + 1)) <= maxChunkSize) {
+        ++power;
+    }
+    chunkSizePower = power;
+}
+
+int32_t MMapDirectory::getMaxChunkSize() {
+    return 1 << chunkSizePower;
+}
+
+void MMapDirectory::setAdvice(const String& extension, MMapAdvice advice) {
+    SyncLock syncLock(this);
+    advices.put(extension, advice);
+}
+
+MMapDirectory::MMapAdvice MMapDirectory::getAdvice(const String& extension) {
+    SyncLock syncLock(this);
+    return (MMapAdvice)advices.get(extension);
+}
+
 IndexInputPtr MMapDirectory::openInput(const String& name, int32_t bufferSize) {
     ensureOpen();
-    return newLucene<MMapIndexInput>(FileUtils::joinPath(directory, name));
+    return newLucene<MMapIndexInput>(FileUtils::joinPath(directory, name), chunkSizePower, getAdvice(FileSwitchDirectory::getExtension(name)));
 }
 
 IndexOutputPtr MMapDirectory::createOutput(const String& name) {
@@ -31,70 +74,155 @@ IndexOutputPtr MMapDirectory::createOutput(const String& name) {
     return newLucene<SimpleFSIndexOutput>(FileUtils::joinPath(directory, name));
 }
 
-MMapIndexInput::MMapIndexInput(const String& path) {
-    _length = path.empty() ? 0 : (int32_t)FileUtils::fileLength(path);
-    bufferPosition = 0;
+MMapIndexInput::MMapIndexInput(const String& path, int32_t chunkSizePower, int32_t advice) {
+    this->chunkSizePower = chunkSizePower;
+    this->chunkMask = ((int64_t)1 << chunkSizePower) - 1;
+    _length = 0;
     if (!path.empty()) {
+        if (!FileUtils::fileExists(path)) {
+            boost::throw_exception(FileNotFoundException(path));
+        }
+        _length = FileUtils::fileLength(path);
+        int64_t chunkSize = (int64_t)1 << chunkSizePower;
         try {
-            file.open(boost::filesystem::wpath(path), _length);
+            for (int64_t offset = 0; offset < _length; offset += chunkSize) {
+                int64_t size = std::min(chunkSize, _length - offset);
+                chunks.push_back(boost::iostreams::mapped_file_source(boost::filesystem::path(path), (size_t)size, (boost::intmax_t)offset));
+                adviseChunk(chunks.back(), advice);
+            }
         } catch (...) {
+            chunks.clear();
             boost::throw_exception(FileNotFoundException(path));
         }
     }
     isClone = false;
+    closed = false;
+    setChunk(0, 0);
 }
 
 MMapIndexInput::~MMapIndexInput() {
 }
 
+void MMapIndexInput::adviseChunk(const boost::iostreams::mapped_file_source& chunk, int32_t advice) {
+#if !defined(_WIN32)
+    int flag = 0;
+    switch (advice) {
+    case MMapDirectory::ADVICE_RANDOM:
+        flag = MADV_RANDOM;
+        break;
+    case MMapDirectory::ADVICE_SEQUENTIAL:
+        flag = MADV_SEQUENTIAL;
+        break;
+    case MMapDirectory::ADVICE_WILLNEED:
+        flag = MADV_WILLNEED;
+        break;
+    default:
+        return;
+    }
+    // the hint is advisory only, so failures are ignored
+    ::madvise((void*)chunk.data(), chunk.size(), flag);
+#endif
+}
+
+void MMapIndexInput::setChunk(int32_t index, int32_t position) {
+    curChunkIndex = index;
+    curChunkPosition = position;
+    if (index < (int32_t)chunks.size()) {
+        curChunk = (const uint8_t*)chunks[index].data();
+        curChunkLength = (int32_t)chunks[index].size();
+    } else {
+        curChunk = NULL;
+        curChunkLength = 0;
+    }
+}
+
 uint8_t MMapIndexInput::readByte() {
-    try {
-        return file.data()[bufferPosition++];
-    } catch (...) {
-        boost::throw_exception(IOException(L"Read past EOF"));
-        return 0;
+    if (curChunkPosition >= curChunkLength) {
+        if (curChunkIndex + 1 >= (int32_t)chunks.size()) {
+            boost::throw_exception(IOException(L"Read past EOF"));
+        }
+        setChunk(curChunkIndex + 1, 0);
     }
+    return curChunk[curChunkPosition++];
 }
 
 void MMapIndexInput::readBytes(uint8_t* b, int32_t offset, int32_t length) {
-    try {
-        MiscUtils::arrayCopy(file.data(), bufferPosition, b, offset, length);
-        bufferPosition += length;
-    } catch (...) {
-        boost::throw_exception(IOException(L"Read past EOF"));
+    while (length > 0) {
+        if (curChunkPosition >= curChunkLength) {
+            if (curChunkIndex + 1 >= (int32_t)chunks.size()) {
+                boost::throw_exception(IOException(L"Read past EOF"));
+            }
+            setChunk(curChunkIndex + 1, 0);
+        }
+        int32_t available = std::min(length, curChunkLength - curChunkPosition);
+        MiscUtils::arrayCopy(curChunk, curChunkPosition, b, offset, available);
+        curChunkPosition += available;
+        offset += available;
+        length -= available;
+    }
+}
+
+void MMapIndexInput::readVInts(int32_t* values, int32_t count) {
+    int32_t decoded = 0;
+    while (decoded < count) {
+        if (curChunkLength - curChunkPosition < 5) {
+            // value may straddle the end of the chunk
+            values[decoded++] = readVInt();
+            continue;
+        }
+        int32_t bytesRead = 0;
+        decoded += MiscUtils::decodeVInts(curChunk + curChunkPosition, curChunkLength - curChunkPosition, values + decoded, count - decoded, bytesRead);
+        curChunkPosition += bytesRead;
     }
 }
 
 int64_t MMapIndexInput::getFilePointer() {
-    return bufferPosition;
+    return ((int64_t)curChunkIndex << chunkSizePower) + curChunkPosition;
 }
 
 void MMapIndexInput::seek(int64_t pos) {
-    bufferPosition = (int32_t)pos;
+    int32_t index = (int32_t)(pos >> chunkSizePower);
+    int32_t position = (int32_t)(pos & chunkMask);
+    // stay at the end of the previous chunk when seeking to a chunk boundary, so reads detect EOF correctly
+    if (index > 0 && position == 0 && index >= (int32_t)chunks.size()) {
+        --index;
+        position = 1 << chunkSizePower;
+    }
+    setChunk(index, position);
 }
 
 int64_t MMapIndexInput::length() {
-    return (int64_t)_length;
+    return _length;
+}
+
+void MMapIndexInput::ensureOpen() {
+    if (closed) {
+        boost::throw_exception(AlreadyClosedException(L"MMapIndexInput already closed"));
+    }
 }
 
 void MMapIndexInput::close() {
-    if (isClone || !file.is_open()) {
+    if (isClone || closed) {
         return;
     }
+    closed = true;
     _length = 0;
-    bufferPosition = 0;
-    file.close();
+    for (chunk_vector::iterator chunk = chunks.begin(); chunk != chunks.end(); ++chunk) {
+        chunk->close();
+    }
+    chunks.clear();
+    setChunk(0, 0);
 }
 
 LuceneObjectPtr MMapIndexInput::clone(const LuceneObjectPtr& other) {
-    if (!file.is_open()) {
-        boost::throw_exception(AlreadyClosedException(L"MMapIndexInput already closed"));
-    }
+    ensureOpen();
     LuceneObjectPtr clone = IndexInput::clone(other ? other : newLucene<MMapIndexInput>());
     MMapIndexInputPtr cloneIndexInput(boost::dynamic_pointer_cast<MMapIndexInput>(clone));
     cloneIndexInput->_length = _length;
-    cloneIndexInput->file = file;
-    cloneIndexInput->bufferPosition = bufferPosition;
+    cloneIndexInput->chunks = chunks;
+    cloneIndexInput->chunkSizePower = chunkSizePower;
+    cloneIndexInput->chunkMask = chunkMask;
+    cloneIndexInput->setChunk(curChunkIndex, curChunkPosition);
     cloneIndexInput->isClone = true;
     return cloneIndexInput;
 }
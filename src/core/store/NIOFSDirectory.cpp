@@ -0,0 +1,178 @@
+/////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2009-2014 Alan Wright. All rights reserved.
+// Distributable under the terms of either the Apache License (Version 2.0)
+// or the GNU Lesser General Public License.
+/////////////////////////////////////////////////////////////////////////////
+
+#include "LuceneInc.h"
+#include "NIOFSDirectory.h"
+#include "_NIOFSDirectory.h"
+#include "_SimpleFSDirectory.h"
+#include "FileReader.h"
+#include "FileUtils.h"
+#include <cerrno>
+
+#if defined(_WIN32)
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <unistd.h>
+#endif
+
+namespace Lucene {
+
+NIOFSDirectory::NIOFSDirectory(const String& path, const LockFactoryPtr& lockFactory) : FSDirectory(path, lockFactory) {
+}
+
+NIOFSDirectory::~NIOFSDirectory() {
+}
+
+IndexInputPtr NIOFSDirectory::openInput(const String& name, int32_t bufferSize) {
+    ensureOpen();
+    return newLucene<NIOFSIndexInput>(FileUtils::joinPath(directory, name), bufferSize, getReadChunkSize());
+}
+
+IndexOutputPtr NIOFSDirectory::createOutput(const String& name) {
+    initOutput(name);
+    return newLucene<SimpleFSIndexOutput>(FileUtils::joinPath(directory, name));
+}
+
+const int32_t PositionalInputFile::FILE_EOF = FileReader::FILE_EOF;
+const int32_t PositionalInputFile::FILE_ERROR = FileReader::FILE_ERROR;
+
+PositionalInputFile::PositionalInputFile(const String& path) {
+#if defined(_WIN32)
+    handle = ::CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (handle == INVALID_HANDLE_VALUE) {
+        handle = NULL;
+        boost::throw_exception(FileNotFoundException(path));
+    }
+#else
+    fd = ::open(boost::filesystem::path(path).c_str(), O_RDONLY);
+    if (fd < 0) {
+        boost::throw_exception(FileNotFoundException(path));
+    }
+#endif
+    length = FileUtils::fileLength(path);
+}
+
+PositionalInputFile::~PositionalInputFile() {
+    close();
+}
+
+int64_t PositionalInputFile::getLength() {
+    return length;
+}
+
+int32_t PositionalInputFile::read(uint8_t* b, int32_t offset, int32_t length, int64_t position) {
+    if (position >= this->length) {
+        return FILE_EOF;
+    }
+#if defined(_WIN32)
+    if (handle == NULL) {
+        return FILE_ERROR;
+    }
+    OVERLAPPED overlapped;
+    ZeroMemory(&overlapped, sizeof(overlapped));
+    overlapped.Offset = (DWORD)(position & 0xffffffff);
+    overlapped.OffsetHigh = (DWORD)(position >> 32);
+    DWORD readCount = 0;
+    if (!::ReadFile((HANDLE)handle, b + offset, (DWORD)length, &readCount, &overlapped)) {
+        return ::GetLastError() == ERROR_HANDLE_EOF ? FILE_EOF : FILE_ERROR;
+    }
+    return readCount == 0 ? FILE_EOF : (int32_t)readCount;
+#else
+    if (fd < 0) {
+        return FILE_ERROR;
+    }
+    ssize_t readCount;
+    do {
+        readCount = ::pread(fd, b + offset, (size_t)length, (off_t)position);
+    } while (readCount < 0 && errno == EINTR);
+    if (readCount < 0) {
+        return FILE_ERROR;
+    }
+    return readCount == 0 ? FILE_EOF : (int32_t)readCount;
+#endif
+}
+
+void PositionalInputFile::close() {
+#if defined(_WIN32)
+    if (handle != NULL) {
+        ::CloseHandle((HANDLE)handle);
+        handle = NULL;
+    }
+#else
+    if (fd >= 0) {
+        ::close(fd);
+        fd = -1;
+    }
+#endif
+}
+
+bool PositionalInputFile::isValid() {
+#if defined(_WIN32)
+    return (handle != NULL);
+#else
+    return (fd >= 0);
+#endif
+}
+
+NIOFSIndexInput::NIOFSIndexInput() {
+    this->chunkSize = 0;
+    this->isClone = false;
+}
+
+NIOFSIndexInput::NIOFSIndexInput(const String& path, int32_t bufferSize, int32_t chunkSize) : BufferedIndexInput(bufferSize) {
+    this->file = newLucene<PositionalInputFile>(path);
+    this->chunkSize = chunkSize;
+    this->isClone = false;
+}
+
+NIOFSIndexInput::~NIOFSIndexInput() {
+}
+
+void NIOFSIndexInput::readInternal(uint8_t* b, int32_t offset, int32_t length) {
+    int64_t position = getFilePointer();
+    int32_t total = 0;
+
+    while (total < length) {
+        int32_t readLength = total + chunkSize > length ? length - total : chunkSize;
+
+        int32_t i = file->read(b, offset + total, readLength, position + total);
+        if (i == PositionalInputFile::FILE_EOF) {
+            boost::throw_exception(IOException(L"Read past EOF"));
+        } else if (i == PositionalInputFile::FILE_ERROR) {
+            boost::throw_exception(IOException(L"Error reading file"));
+        }
+        total += i;
+    }
+}
+
+void NIOFSIndexInput::seekInternal(int64_t pos) {
+}
+
+int64_t NIOFSIndexInput::length() {
+    return file->getLength();
+}
+
+void NIOFSIndexInput::close() {
+    if (!isClone) {
+        file->close();
+    }
+}
+
+bool NIOFSIndexInput::isValid() {
+    return file->isValid();
+}
+
+LuceneObjectPtr NIOFSIndexInput::clone(const LuceneObjectPtr& other) {
+    LuceneObjectPtr clone = BufferedIndexInput::clone(other ? other : newLucene<NIOFSIndexInput>());
+    NIOFSIndexInputPtr cloneIndexInput(boost::dynamic_pointer_cast<NIOFSIndexInput>(clone));
+    cloneIndexInput->file = file;
+    cloneIndexInput->chunkSize = chunkSize;
+    cloneIndexInput->isClone = true;
+    return cloneIndexInput;
+}
+
+}
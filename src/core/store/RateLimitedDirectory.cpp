@@ -0,0 +1,87 @@
+/////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2009-2014 Alan Wright. All rights reserved.
+// Distributable under the terms of either the Apache License (Version 2.0)
+// or the GNU Lesser General Public License.
+/////////////////////////////////////////////////////////////////////////////
+
+#include "LuceneInc.h"
+#include "RateLimitedDirectory.h"
+#include "RateLimitedIndexOutput.h"
+#include "RateLimiter.h"
+
+namespace Lucene {
+
+RateLimitedDirectory::RateLimitedDirectory(const DirectoryPtr& dir, const RateLimiterPtr& rateLimiter) {
+    this->dir = dir;
+    this->rateLimiter = rateLimiter;
+    this->lockFactory = dir->getLockFactory();
+}
+
+RateLimitedDirectory::~RateLimitedDirectory() {
+}
+
+DirectoryPtr RateLimitedDirectory::getDirectory() {
+    return dir;
+}
+
+RateLimiterPtr RateLimitedDirectory::getRateLimiter() {
+    return rateLimiter;
+}
+
+void RateLimitedDirectory::close() {
+    dir->close();
+}
+
+HashSet<String> RateLimitedDirectory::listAll() {
+    return dir->listAll();
+}
+
+bool RateLimitedDirectory::fileExists(const String& name) {
+    return dir->fileExists(name);
+}
+
+uint64_t RateLimitedDirectory::fileModified(const String& name) {
+    return dir->fileModified(name);
+}
+
+void RateLimitedDirectory::touchFile(const String& name) {
+    dir->touchFile(name);
+}
+
+void RateLimitedDirectory::deleteFile(const String& name) {
+    dir->deleteFile(name);
+}
+
+int64_t RateLimitedDirectory::fileLength(const String& name) {
+    return dir->fileLength(name);
+}
+
+IndexOutputPtr RateLimitedDirectory::createOutput(const String& name) {
+    return newLucene<RateLimitedIndexOutput>(dir->createOutput(name), rateLimiter);
+}
+
+void RateLimitedDirectory::sync(const String& name) {
+    dir->sync(name);
+}
+
+IndexInputPtr RateLimitedDirectory::openInput(const String& name) {
+    return dir->openInput(name);
+}
+
+IndexInputPtr RateLimitedDirectory::openInput(const String& name, int32_t bufferSize) {
+    return dir->openInput(name, bufferSize);
+}
+
+LockPtr RateLimitedDirectory::makeLock(const String& name) {
+    return dir->makeLock(name);
+}
+
+String RateLimitedDirectory::getLockID() {
+    return dir->getLockID();
+}
+
+String RateLimitedDirectory::toString() {
+    return L"RateLimitedDirectory(" + dir->toString() + L")";
+}
+
+}
@@ -0,0 +1,67 @@
+/////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2009-2014 Alan Wright. All rights reserved.
+// Distributable under the terms of either the Apache License (Version 2.0)
+// or the GNU Lesser General Public License.
+/////////////////////////////////////////////////////////////////////////////
+
+#include "LuceneInc.h"
+#include "RateLimitedIndexOutput.h"
+#include "RateLimiter.h"
+
+namespace Lucene {
+
+const int32_t RateLimitedIndexOutput::PAUSE_BYTES = 16384;
+
+RateLimitedIndexOutput::RateLimitedIndexOutput(const IndexOutputPtr& main, const RateLimiterPtr& rateLimiter) {
+    this->main = main;
+    this->rateLimiter = rateLimiter;
+    this->pendingBytes = 0;
+}
+
+RateLimitedIndexOutput::~RateLimitedIndexOutput() {
+}
+
+void RateLimitedIndexOutput::writeByte(uint8_t b) {
+    main->writeByte(b);
+    if (++pendingBytes >= PAUSE_BYTES) {
+        pause();
+    }
+}
+
+void RateLimitedIndexOutput::writeBytes(const uint8_t* b, int32_t offset, int32_t length) {
+    main->writeBytes(b, offset, length);
+    pendingBytes += length;
+    if (pendingBytes >= PAUSE_BYTES) {
+        pause();
+    }
+}
+
+void RateLimitedIndexOutput::flush() {
+    main->flush();
+}
+
+void RateLimitedIndexOutput::close() {
+    main->close();
+    pause();
+}
+
+int64_t RateLimitedIndexOutput::getFilePointer() {
+    return main->getFilePointer();
+}
+
+void RateLimitedIndexOutput::seek(int64_t pos) {
+    main->seek(pos);
+}
+
+int64_t RateLimitedIndexOutput::length() {
+    return main->length();
+}
+
+void RateLimitedIndexOutput::pause() {
+    if (pendingBytes > 0) {
+        rateLimiter->pause(pendingBytes);
+        pendingBytes = 0;
+    }
+}
+
+}
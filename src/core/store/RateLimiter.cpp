@@ -0,0 +1,53 @@
+/////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2009-2014 Alan Wright. All rights reserved.
+// Distributable under the terms of either the Apache License (Version 2.0)
+// or the GNU Lesser General Public License.
+/////////////////////////////////////////////////////////////////////////////
+
+#include "LuceneInc.h"
+#include "RateLimiter.h"
+#include "LuceneThread.h"
+#include "MiscUtils.h"
+
+namespace Lucene {
+
+RateLimiter::RateLimiter(double mbPerSec) {
+    setMbPerSec(mbPerSec);
+    lastNS = MiscUtils::nanoTime();
+}
+
+RateLimiter::~RateLimiter() {
+}
+
+void RateLimiter::setMbPerSec(double mbPerSec) {
+    SyncLock syncLock(this);
+    if (mbPerSec <= 0.0) {
+        boost::throw_exception(IllegalArgumentException(L"mbPerSec must be positive"));
+    }
+    this->mbPerSec = mbPerSec;
+    nsPerByte = 1000000000.0 / (1024.0 * 1024.0 * mbPerSec);
+}
+
+double RateLimiter::getMbPerSec() {
+    SyncLock syncLock(this);
+    return mbPerSec;
+}
+
+void RateLimiter::pause(int64_t bytes) {
+    int64_t curNS = MiscUtils::nanoTime();
+    int64_t targetNS;
+    {
+        SyncLock syncLock(this);
+        // don't credit the time spent idle since the previous write
+        lastNS = std::max(lastNS, curNS) + (int64_t)((double)bytes * nsPerByte);
+        targetNS = lastNS;
+    }
+
+    // sleeps are rounded down to milliseconds, what is left carries over in lastNS to the next pause
+    int64_t pauseMillis = (targetNS - curNS) / 1000000;
+    if (pauseMillis > 0) {
+        LuceneThread::threadSleep((int32_t)pauseMillis);
+    }
+}
+
+}
@@ -0,0 +1,63 @@
+/////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2009-2014 Alan Wright. All rights reserved.
+// Distributable under the terms of either the Apache License (Version 2.0)
+// or the GNU Lesser General Public License.
+/////////////////////////////////////////////////////////////////////////////
+
+#include "LuceneInc.h"
+#include <boost/thread/tss.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/unordered_map.hpp>
+#include "CloseableThreadLocal.h"
+
+namespace Lucene {
+
+/// Slot table owned by a single thread.
+struct ThreadSlotTable {
+    ThreadSlotTable() : purgeSize(32) {}
+
+    typedef boost::unordered_map< int64_t, boost::weak_ptr<void> > slot_map;
+    slot_map slots;
+    size_t purgeSize; // table size at which released slots are next purged
+};
+
+static boost::thread_specific_ptr<ThreadSlotTable> threadSlots;
+
+static boost::mutex nextIdMutex;
+static int64_t nextId = 0;
+
+int64_t ThreadLocalSlots::newId() {
+    boost::mutex::scoped_lock idLock(nextIdMutex);
+    return nextId++;
+}
+
+boost::shared_ptr<void> ThreadLocalSlots::get(int64_t id) {
+    ThreadSlotTable* table = threadSlots.get();
+    if (table == NULL) {
+        return boost::shared_ptr<void>();
+    }
+    ThreadSlotTable::slot_map::iterator slot = table->slots.find(id);
+    return slot == table->slots.end() ? boost::shared_ptr<void>() : slot->second.lock();
+}
+
+void ThreadLocalSlots::set(int64_t id, const boost::shared_ptr<void>& value) {
+    ThreadSlotTable* table = threadSlots.get();
+    if (table == NULL) {
+        table = new ThreadSlotTable();
+        threadSlots.reset(table);
+    }
+    table->slots[id] = value;
+    if (table->slots.size() >= table->purgeSize) {
+        // drop slots whose thread-local has been closed or destroyed
+        for (ThreadSlotTable::slot_map::iterator slot = table->slots.begin(); slot != table->slots.end();) {
+            if (slot->second.expired()) {
+                slot = table->slots.erase(slot);
+            } else {
+                ++slot;
+            }
+        }
+        table->purgeSize = std::max((size_t)32, table->slots.size() * 2);
+    }
+}
+
+}
@@ -0,0 +1,191 @@
+/////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2009-2014 Alan Wright. All rights reserved.
+// Distributable under the terms of either the Apache License (Version 2.0)
+// or the GNU Lesser General Public License.
+/////////////////////////////////////////////////////////////////////////////
+
+#include "LuceneInc.h"
+#include "LZ4.h"
+#include "MiscUtils.h"
+
+namespace Lucene {
+
+/// Shortest back reference
+const int32_t LZ4::MIN_MATCH = 4;
+
+/// Furthest back reference, as offsets are written in 2 bytes
+const int32_t LZ4::MAX_DISTANCE = 0xffff;
+
+/// The last bytes of the input are always literals
+const int32_t LZ4::LAST_LITERALS = 5;
+
+/// The last match must start at least this many bytes before the end of the input
+const int32_t LZ4::MF_LIMIT = 12;
+
+/// Log2 of the number of entries of the hash table
+const int32_t LZ4::HASH_LOG = 12;
+
+LZ4::~LZ4() {
+}
+
+static inline uint32_t readInt(const uint8_t* bytes) {
+    return (uint32_t)bytes[0] | ((uint32_t)bytes[1] << 8) | ((uint32_t)bytes[2] << 16) | ((uint32_t)bytes[3] << 24);
+}
+
+static inline int32_t hashInt(uint32_t i, int32_t hashLog) {
+    return (int32_t)((i * 2654435761U) >> (32 - hashLog));
+}
+
+int32_t LZ4::maxCompressedLength(int32_t length) {
+    return length + length / 255 + 16;
+}
+
+int32_t LZ4::writeLength(uint8_t* dest, int32_t out, int32_t length) {
+    while (length >= 0xff) {
+        dest[out++] = 0xff;
+        length -= 0xff;
+    }
+    dest[out++] = (uint8_t)length;
+    return out;
+}
+
+int32_t LZ4::compress(const uint8_t* src, int32_t length, uint8_t* dest) {
+    int32_t out = 0;
+    int32_t anchor = 0;
+
+    if (length > MF_LIMIT) {
+        // Positions of recent 4 byte sequences, plus 1 so that 0 is empty
+        IntArray hashTable(IntArray::newInstance(1 << HASH_LOG));
+        MiscUtils::arrayFill(hashTable.get(), 0, hashTable.size(), 0);
+
+        int32_t limit = length - MF_LIMIT;
+        int32_t matchLimit = length - LAST_LITERALS;
+        int32_t pos = 0;
+        while (pos < limit) {
+            uint32_t sequence = readInt(src + pos);
+            int32_t hash = hashInt(sequence, HASH_LOG);
+            int32_t ref = hashTable[hash] - 1;
+            hashTable[hash] = pos + 1;
+            if (ref < 0 || pos - ref > MAX_DISTANCE || readInt(src + ref) != sequence) {
+                // Skip faster over incompressible data
+                pos += 1 + ((pos - anchor) >> 6);
+                continue;
+            }
+
+            // Extend the match backwards over pending literals, then forwards
+            while (pos > anchor && ref > 0 && src[pos - 1] == src[ref - 1]) {
+                --pos;
+                --ref;
+            }
+            int32_t matchLength = MIN_MATCH;
+            while (pos + matchLength < matchLimit && src[ref + matchLength] == src[pos + matchLength]) {
+                ++matchLength;
+            }
+
+            // Token with the literal length and match length, each 15 meaning more length bytes follow
+            int32_t literalLength = pos - anchor;
+            int32_t token = out++;
+            dest[token] = (uint8_t)(std::min(literalLength, 0xf) << 4);
+            if (literalLength >= 0xf) {
+                out = writeLength(dest, out, literalLength - 0xf);
+            }
+            MiscUtils::arrayCopy(src, anchor, dest, out, literalLength);
+            out += literalLength;
+
+            int32_t offset = pos - ref;
+            dest[out++] = (uint8_t)offset;
+            dest[out++] = (uint8_t)(offset >> 8);
+
+            int32_t extraLength = matchLength - MIN_MATCH;
+            dest[token] |= (uint8_t)std::min(extraLength, 0xf);
+            if (extraLength >= 0xf) {
+                out = writeLength(dest, out, extraLength - 0xf);
+            }
+
+            pos += matchLength;
+            anchor = pos;
+        }
+    }
+
+    // The remaining literals
+    int32_t literalLength = length - anchor;
+    dest[out++] = (uint8_t)(std::min(literalLength, 0xf) << 4);
+    if (literalLength >= 0xf) {
+        out = writeLength(dest, out, literalLength - 0xf);
+    }
+    MiscUtils::arrayCopy(src, anchor, dest, out, literalLength);
+    out += literalLength;
+
+    BOOST_ASSERT(out <= maxCompressedLength(length));
+    return out;
+}
+
+int32_t LZ4::decompress(const uint8_t* src, int32_t srcLength, uint8_t* dest, int32_t destLength) {
+    int32_t in = 0;
+    int32_t out = 0;
+    while (in < srcLength) {
+        int32_t token = src[in++];
+
+        int32_t literalLength = token >> 4;
+        if (literalLength == 0xf) {
+            uint8_t length;
+            do {
+                if (in >= srcLength) {
+                    boost::throw_exception(CompressionException(L"LZ4: truncated literal length"));
+                }
+                length = src[in++];
+                literalLength += length;
+            } while (length == 0xff);
+        }
+        if (literalLength > srcLength - in || literalLength > destLength - out) {
+            boost::throw_exception(CompressionException(L"LZ4: literals out of bounds"));
+        }
+        MiscUtils::arrayCopy(src, in, dest, out, literalLength);
+        in += literalLength;
+        out += literalLength;
+
+        if (in == srcLength) {
+            // The last sequence has no match
+            break;
+        }
+
+        if (in + 2 > srcLength) {
+            boost::throw_exception(CompressionException(L"LZ4: truncated match offset"));
+        }
+        int32_t offset = (int32_t)src[in] | ((int32_t)src[in + 1] << 8);
+        in += 2;
+        if (offset == 0 || offset > out) {
+            boost::throw_exception(CompressionException(L"LZ4: match offset out of bounds"));
+        }
+
+        int32_t matchLength = token & 0xf;
+        if (matchLength == 0xf) {
+            uint8_t length;
+            do {
+                if (in >= srcLength) {
+                    boost::throw_exception(CompressionException(L"LZ4: truncated match length"));
+                }
+                length = src[in++];
+                matchLength += length;
+            } while (length == 0xff);
+        }
+        matchLength += MIN_MATCH;
+        if (matchLength > destLength - out) {
+            boost::throw_exception(CompressionException(L"LZ4: match out of bounds"));
+        }
+
+        // The match may overlap the bytes it produces, repeating them
+        int32_t ref = out - offset;
+        if (offset >= matchLength) {
+            MiscUtils::arrayCopy(dest, ref, dest, out, matchLength);
+        } else {
+            for (int32_t i = 0; i < matchLength; ++i) {
+                dest[out + i] = dest[ref + i];
+            }
+        }
+        out += matchLength;
+    }
+    return out;
+}
+
+}
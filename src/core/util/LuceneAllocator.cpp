@@ -5,16 +5,155 @@
 /////////////////////////////////////////////////////////////////////////////
 
 #include "LuceneInc.h"
+#include <set>
+#include <boost/thread/tss.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/atomic.hpp>
+#include <boost/smart_ptr/detail/atomic_count.hpp>
 #include "LuceneAllocator.h"
 
 namespace Lucene {
 
-void* AllocMemory(size_t size) {
+/// Header in front of every block returned by AllocMemory.  Keeps the data 16 byte aligned.
+struct MemoryBlock {
+    MemoryAllocator* owner;
+    size_t size;
+#ifdef LPP_BUILD_32
+    uint8_t padding[8];
+#endif
+};
+
+static const size_t BLOCK_HEADER_SIZE = sizeof(MemoryBlock);
+
+static inline void* initBlock(void* raw, MemoryAllocator* owner, size_t size) {
+    MemoryBlock* block = static_cast<MemoryBlock*>(raw);
+    block->owner = owner;
+    block->size = size;
+    return static_cast<uint8_t*>(raw) + BLOCK_HEADER_SIZE;
+}
+
+static inline MemoryBlock* getBlock(void* memory) {
+    return reinterpret_cast<MemoryBlock*>(static_cast<uint8_t*>(memory) - BLOCK_HEADER_SIZE);
+}
+
+/// Default allocator, forwards to the system heap.
+class MallocMemoryAllocator : public MemoryAllocator {
+public:
+    virtual void* allocate(size_t size) {
 #if (defined(_WIN32) || defined(_WIN64)) && !defined(NDEBUG)
-    return _malloc_dbg(size, _NORMAL_BLOCK, __FILE__, __LINE__);
+        return _malloc_dbg(size, _NORMAL_BLOCK, __FILE__, __LINE__);
+#else
+        return malloc(size);
+#endif
+    }
+
+    virtual void release(void* memory, size_t size) {
+#if defined(_WIN32) && !defined(NDEBUG)
+        _free_dbg(memory, _NORMAL_BLOCK);
+#else
+        free(memory);
+#endif
+    }
+
+    virtual void* reallocate(void* memory, size_t size, size_t newSize) {
+#if defined(_WIN32) && !defined(NDEBUG)
+        return _realloc_dbg(memory, newSize, _NORMAL_BLOCK, __FILE__, __LINE__);
+#else
+        return realloc(memory, newSize);
+#endif
+    }
+};
+
+/// Owner of blocks carved from arena chunks.  Each chunk starts with a count of its live blocks, plus one while
+/// it is the current chunk of an arena; the chunk is freed when the count drops to zero.
+class ArenaChunkAllocator : public MemoryAllocator {
+public:
+    struct ChunkHeader {
+        ChunkHeader() : live(1) {}
+        boost::detail::atomic_count live;
+    };
+
+    static const size_t CHUNK_HEADER_SIZE = (sizeof(ChunkHeader) + 15) & ~(size_t)15;
+
+    virtual void* allocate(size_t size) {
+        return NULL; // blocks are only carved by MemoryArena
+    }
+
+    virtual void release(void* memory, size_t size) {
+        // chunks are aligned to their size, so the chunk of a block is found by masking its address
+        releaseChunk(reinterpret_cast<ChunkHeader*>((size_t)memory & ~((size_t)MemoryArena::CHUNK_SIZE - 1)));
+    }
+
+    static void* newChunk() {
+        void* chunk = NULL;
+#if defined(_WIN32) || defined(_WIN64)
+        chunk = _aligned_malloc(MemoryArena::CHUNK_SIZE, MemoryArena::CHUNK_SIZE);
+#else
+        if (posix_memalign(&chunk, MemoryArena::CHUNK_SIZE, MemoryArena::CHUNK_SIZE) != 0) {
+            chunk = NULL;
+        }
+#endif
+        if (chunk != NULL) {
+            new(chunk) ChunkHeader();
+        }
+        return chunk;
+    }
+
+    static void releaseChunk(ChunkHeader* chunk) {
+        if (--chunk->live == 0) {
+            chunk->~ChunkHeader();
+#if defined(_WIN32) || defined(_WIN64)
+            _aligned_free(chunk);
 #else
-    return malloc(size);
+            free(chunk);
 #endif
+        }
+    }
+};
+
+static MallocMemoryAllocator* mallocAllocator() {
+    static MallocMemoryAllocator* allocator = new MallocMemoryAllocator();
+    return allocator;
+}
+
+static ArenaChunkAllocator* arenaChunkAllocator() {
+    static ArenaChunkAllocator* allocator = new ArenaChunkAllocator();
+    return allocator;
+}
+
+static void noCleanup(MemoryArena*) {
+}
+
+static boost::thread_specific_ptr<MemoryArena>* currentArena() {
+    static boost::thread_specific_ptr<MemoryArena>* arena = new boost::thread_specific_ptr<MemoryArena>(noCleanup);
+    return arena;
+}
+
+static void noCleanup(MemoryAllocator*) {
+}
+
+static boost::thread_specific_ptr<MemoryAllocator>* scopedAllocator() {
+    static boost::thread_specific_ptr<MemoryAllocator>* allocator = new boost::thread_specific_ptr<MemoryAllocator>(noCleanup);
+    return allocator;
+}
+
+static boost::atomic<MemoryAllocator*> installedAllocator(NULL);
+static boost::detail::atomic_count activeArenas(0);
+static boost::detail::atomic_count activeScopes(0);
+
+void* AllocMemory(size_t size) {
+    if (activeArenas > 0) {
+        MemoryArena* arena = currentArena()->get();
+        if (arena != NULL) {
+            void* memory = arena->allocate(size);
+            if (memory != NULL) {
+                return memory;
+            }
+        }
+    }
+    MemoryAllocator* allocator = GetMemoryAllocator();
+    void* raw = allocator->allocate(size + BLOCK_HEADER_SIZE);
+    return raw == NULL ? NULL : initBlock(raw, allocator, size);
 }
 
 void* ReallocMemory(void* memory, size_t size) {
@@ -25,22 +164,237 @@ void* ReallocMemory(void* memory, size_t size) {
         FreeMemory(memory);
         return NULL;
     }
-#if defined(_WIN32) && !defined(NDEBUG)
-    return _realloc_dbg(memory, size, _NORMAL_BLOCK, __FILE__, __LINE__);
-#else
-    return realloc(memory, size);
-#endif
+    MemoryBlock* block = getBlock(memory);
+    MemoryAllocator* owner = block->owner;
+    size_t oldSize = block->size;
+    void* raw = owner->reallocate(block, oldSize + BLOCK_HEADER_SIZE, size + BLOCK_HEADER_SIZE);
+    if (raw != NULL) {
+        return initBlock(raw, owner, size);
+    }
+    void* newMemory = AllocMemory(size);
+    if (newMemory != NULL) {
+        std::memcpy(newMemory, memory, std::min(oldSize, size));
+        FreeMemory(memory);
+    }
+    return newMemory;
 }
 
 void FreeMemory(void* memory) {
     if (memory == NULL) {
         return;
     }
-#if defined(_WIN32) && !defined(NDEBUG)
-    _free_dbg(memory, _NORMAL_BLOCK);
-#else
-    free(memory);
-#endif
+    MemoryBlock* block = getBlock(memory);
+    block->owner->release(block, block->size + BLOCK_HEADER_SIZE);
+}
+
+MemoryAllocator::~MemoryAllocator() {
+}
+
+void* MemoryAllocator::reallocate(void* memory, size_t size, size_t newSize) {
+    return NULL;
+}
+
+MemoryAllocator* SetMemoryAllocator(MemoryAllocator* allocator) {
+    return installedAllocator.exchange(allocator, boost::memory_order_acq_rel);
+}
+
+MemoryAllocator* GetMemoryAllocator() {
+    if (activeScopes > 0) {
+        MemoryAllocator* allocator = scopedAllocator()->get();
+        if (allocator != NULL) {
+            return allocator;
+        }
+    }
+    MemoryAllocator* allocator = installedAllocator.load(boost::memory_order_acquire);
+    return allocator == NULL ? mallocAllocator() : allocator;
+}
+
+ScopedMemoryAllocator::ScopedMemoryAllocator(MemoryAllocator* allocator) {
+    this->previous = scopedAllocator()->get();
+    scopedAllocator()->reset(allocator == NULL ? mallocAllocator() : allocator);
+    ++activeScopes;
+}
+
+ScopedMemoryAllocator::~ScopedMemoryAllocator() {
+    scopedAllocator()->reset(previous);
+    --activeScopes;
+}
+
+const int32_t PoolMemoryAllocator::MAX_POOLED_SIZE = 512;
+const int32_t PoolMemoryAllocator::DEFAULT_MAX_BLOCKS_PER_CLASS = 1024;
+
+struct PoolThreadCache;
+
+/// Caches of every thread that has released a block to a pool, so the pool can empty them all when it is
+/// destroyed.  Shared by the pool and its caches, since a thread may exit after the pool is gone.
+struct PoolRegistry {
+    boost::mutex mutex;
+    std::set<PoolThreadCache*> caches;
+};
+
+typedef boost::shared_ptr<PoolRegistry> PoolRegistryPtr;
+
+/// Free lists owned by a single thread.
+struct PoolThreadCache {
+    static const int32_t NUM_CLASSES = 512 / 16;
+
+    PoolThreadCache(const PoolRegistryPtr& registry) : registry(registry) {
+        for (int32_t i = 0; i < NUM_CLASSES; ++i) {
+            freeLists[i] = NULL;
+            freeCounts[i] = 0;
+        }
+    }
+
+    ~PoolThreadCache() {
+        clear();
+    }
+
+    void clear() {
+        for (int32_t i = 0; i < NUM_CLASSES; ++i) {
+            while (freeLists[i] != NULL) {
+                void* next = *static_cast<void**>(freeLists[i]);
+                free(freeLists[i]);
+                freeLists[i] = next;
+            }
+            freeCounts[i] = 0;
+        }
+    }
+
+    PoolRegistryPtr registry;
+    void* freeLists[NUM_CLASSES];
+    int32_t freeCounts[NUM_CLASSES];
+};
+
+/// Called when a thread exits, or for the calling thread when the pool is destroyed.
+static void releaseThreadCache(PoolThreadCache* cache) {
+    PoolRegistryPtr registry(cache->registry);
+    {
+        boost::mutex::scoped_lock lock(registry->mutex);
+        registry->caches.erase(cache);
+    }
+    delete cache;
+}
+
+typedef boost::thread_specific_ptr<PoolThreadCache> PoolThreadCachePtr;
+
+/// State behind the opaque threadCaches pointer of PoolMemoryAllocator.
+struct PoolThreadCaches {
+    PoolThreadCaches() : current(releaseThreadCache), registry(new PoolRegistry()) {}
+
+    PoolThreadCachePtr current;
+    PoolRegistryPtr registry;
+};
+
+PoolMemoryAllocator::PoolMemoryAllocator(int32_t maxBlocksPerClass) {
+    this->threadCaches = new PoolThreadCaches();
+    this->maxBlocksPerClass = maxBlocksPerClass;
+}
+
+PoolMemoryAllocator::~PoolMemoryAllocator() {
+    PoolThreadCaches* caches = static_cast<PoolThreadCaches*>(threadCaches);
+    {
+        // empty the caches of all threads; each cache itself is deleted when its thread exits
+        boost::mutex::scoped_lock lock(caches->registry->mutex);
+        for (std::set<PoolThreadCache*>::iterator cache = caches->registry->caches.begin(); cache != caches->registry->caches.end(); ++cache) {
+            (*cache)->clear();
+        }
+    }
+    delete caches;
+}
+
+void* PoolMemoryAllocator::allocate(size_t size) {
+    if (size > (size_t)MAX_POOLED_SIZE) {
+        return malloc(size);
+    }
+    int32_t sizeClass = (int32_t)((size + 15) >> 4) - 1;
+    PoolThreadCache* cache = static_cast<PoolThreadCaches*>(threadCaches)->current.get();
+    if (cache != NULL && cache->freeLists[sizeClass] != NULL) {
+        void* memory = cache->freeLists[sizeClass];
+        cache->freeLists[sizeClass] = *static_cast<void**>(memory);
+        --cache->freeCounts[sizeClass];
+        return memory;
+    }
+    return malloc((size_t)(sizeClass + 1) << 4);
+}
+
+void PoolMemoryAllocator::release(void* memory, size_t size) {
+    if (size > (size_t)MAX_POOLED_SIZE) {
+        free(memory);
+        return;
+    }
+    int32_t sizeClass = (int32_t)((size + 15) >> 4) - 1;
+    PoolThreadCaches& caches = *static_cast<PoolThreadCaches*>(threadCaches);
+    PoolThreadCache* cache = caches.current.get();
+    if (cache == NULL) {
+        cache = new PoolThreadCache(caches.registry);
+        {
+            boost::mutex::scoped_lock lock(caches.registry->mutex);
+            caches.registry->caches.insert(cache);
+        }
+        caches.current.reset(cache);
+    }
+    if (cache->freeCounts[sizeClass] >= maxBlocksPerClass) {
+        free(memory);
+        return;
+    }
+    *static_cast<void**>(memory) = cache->freeLists[sizeClass];
+    cache->freeLists[sizeClass] = memory;
+    ++cache->freeCounts[sizeClass];
+}
+
+void PoolMemoryAllocator::reset() {
+    PoolThreadCache* cache = static_cast<PoolThreadCaches*>(threadCaches)->current.get();
+    if (cache != NULL) {
+        cache->clear();
+    }
+}
+
+const int32_t MemoryArena::CHUNK_SIZE = 64 * 1024;
+
+MemoryArena::MemoryArena() {
+    this->chunk = NULL;
+    this->chunkPosition = 0;
+    this->previous = currentArena()->get();
+    currentArena()->reset(this);
+    ++activeArenas;
+}
+
+MemoryArena::~MemoryArena() {
+    reset();
+    currentArena()->reset(previous);
+    --activeArenas;
+}
+
+MemoryArena* MemoryArena::current() {
+    return currentArena()->get();
+}
+
+void MemoryArena::reset() {
+    if (chunk != NULL) {
+        ArenaChunkAllocator::releaseChunk(reinterpret_cast<ArenaChunkAllocator::ChunkHeader*>(chunk));
+        chunk = NULL;
+    }
+}
+
+void* MemoryArena::allocate(size_t size) {
+    // rounded to keep 16 byte alignment, large blocks are left to the heap
+    size_t blockSize = (size + BLOCK_HEADER_SIZE + 15) & ~(size_t)15;
+    if (blockSize > (size_t)CHUNK_SIZE / 4) {
+        return NULL;
+    }
+    if (chunk == NULL || chunkPosition + blockSize > (size_t)CHUNK_SIZE) {
+        reset();
+        chunk = static_cast<uint8_t*>(ArenaChunkAllocator::newChunk());
+        if (chunk == NULL) {
+            return NULL;
+        }
+        chunkPosition = (int32_t)ArenaChunkAllocator::CHUNK_HEADER_SIZE;
+    }
+    ArenaChunkAllocator::ChunkHeader* header = reinterpret_cast<ArenaChunkAllocator::ChunkHeader*>(chunk);
+    ++header->live;
+    uint8_t* raw = chunk + chunkPosition;
+    chunkPosition += (int32_t)blockSize;
+    return initBlock(raw, arenaChunkAllocator(), size);
 }
 
 }
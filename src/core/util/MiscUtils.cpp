@@ -8,6 +8,15 @@
 #include "MiscUtils.h"
 #include "LuceneObject.h"
 
+#if !defined(_WIN32) && !defined(_WIN64)
+#include <time.h>
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define LPP_HAVE_SSE2
+#endif
+
 namespace Lucene {
 
 const uint32_t MiscUtils::SINGLE_EXPONENT_MASK = 0x7f800000;
@@ -27,6 +36,22 @@ uint64_t MiscUtils::currentTimeMillis() {
     return getTimeMillis(boost::posix_time::microsec_clock::universal_time());
 }
 
+int64_t MiscUtils::nanoTime() {
+#if defined(_WIN32) || defined(_WIN64)
+    static LARGE_INTEGER frequency = {0};
+    if (frequency.QuadPart == 0) {
+        QueryPerformanceFrequency(&frequency);
+    }
+    LARGE_INTEGER counter;
+    QueryPerformanceCounter(&counter);
+    return (int64_t)((double)counter.QuadPart * 1000000000.0 / (double)frequency.QuadPart);
+#else
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (int64_t)now.tv_sec * 1000000000LL + (int64_t)now.tv_nsec;
+#endif
+}
+
 int32_t MiscUtils::getNextSize(int32_t targetSize) {
     return (targetSize >> 3) + (targetSize < 9 ? 3 : 6) + targetSize;
 }
@@ -132,4 +157,54 @@ int32_t MiscUtils::unsignedShift(int32_t num, int32_t shift) {
     return (shift & 0x1f) == 0 ? num : (((uint32_t)num >> 1) & 0x7fffffff) >> ((shift & 0x1f) - 1);
 }
 
+int32_t MiscUtils::decodeVInts(const uint8_t* bytes, int32_t length, int32_t* values, int32_t count, int32_t& bytesRead) {
+    int32_t pos = 0;
+    int32_t decoded = 0;
+    while (decoded < count) {
+#ifdef LPP_HAVE_SSE2
+        if (count - decoded >= 16 && length - pos >= 16) {
+            __m128i chunk = _mm_loadu_si128((const __m128i*)(bytes + pos));
+            if (_mm_movemask_epi8(chunk) == 0) {
+                // 16 single byte values, widen straight into the output
+                __m128i zero = _mm_setzero_si128();
+                __m128i low = _mm_unpacklo_epi8(chunk, zero);
+                __m128i high = _mm_unpackhi_epi8(chunk, zero);
+                __m128i* out = (__m128i*)(values + decoded);
+                _mm_storeu_si128(out, _mm_unpacklo_epi16(low, zero));
+                _mm_storeu_si128(out + 1, _mm_unpackhi_epi16(low, zero));
+                _mm_storeu_si128(out + 2, _mm_unpacklo_epi16(high, zero));
+                _mm_storeu_si128(out + 3, _mm_unpackhi_epi16(high, zero));
+                decoded += 16;
+                pos += 16;
+                continue;
+            }
+        }
+#endif
+        if (length - pos < 5) {
+            break;
+        }
+        uint8_t b = bytes[pos++];
+        int32_t i = (b & 0x7f);
+        if ((b & 0x80) != 0) {
+            b = bytes[pos++];
+            i |= (b & 0x7f) << 7;
+            if ((b & 0x80) != 0) {
+                b = bytes[pos++];
+                i |= (b & 0x7f) << 14;
+                if ((b & 0x80) != 0) {
+                    b = bytes[pos++];
+                    i |= (b & 0x7f) << 21;
+                    if ((b & 0x80) != 0) {
+                        b = bytes[pos++];
+                        i |= (b & 0x7f) << 28;
+                    }
+                }
+            }
+        }
+        values[decoded++] = i;
+    }
+    bytesRead = pos;
+    return decoded;
+}
+
 }
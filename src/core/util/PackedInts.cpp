@@ -0,0 +1,88 @@
+/////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2009-2014 Alan Wright. All rights reserved.
+// Distributable under the terms of either the Apache License (Version 2.0)
+// or the GNU Lesser General Public License.
+/////////////////////////////////////////////////////////////////////////////
+
+#include "LuceneInc.h"
+#include "PackedInts.h"
+#include "IndexInput.h"
+#include "IndexOutput.h"
+#include "MiscUtils.h"
+#include "StringUtils.h"
+
+namespace Lucene {
+
+PackedInts::PackedInts(int32_t valueCount, int32_t bitsPerValue) {
+    if (bitsPerValue < 1 || bitsPerValue > 64) {
+        boost::throw_exception(IllegalArgumentException(L"bitsPerValue must be between 1 and 64: got " + StringUtils::toString(bitsPerValue)));
+    }
+    this->valueCount = valueCount;
+    this->bitsPerValue = bitsPerValue;
+    this->maskRight = bitsPerValue == 64 ? -1LL : (int64_t)(((uint64_t)1 << bitsPerValue) - 1);
+    // one extra block, so reading a value never needs to check for the end of the array
+    int32_t numBlocks = (int32_t)(((int64_t)valueCount * bitsPerValue + 63) >> 6) + 1;
+    blocks = LongArray::newInstance(numBlocks);
+    MiscUtils::arrayFill(blocks.get(), 0, blocks.size(), 0LL);
+}
+
+PackedInts::~PackedInts() {
+}
+
+int32_t PackedInts::bitsRequired(int64_t maxValue) {
+    if (maxValue < 0) {
+        return 64;
+    }
+    int32_t bits = 1;
+    while (bits < 63 && (maxValue >> bits) != 0) {
+        ++bits;
+    }
+    return bits;
+}
+
+void PackedInts::set(int32_t index, int64_t value) {
+    int64_t bitPosition = (int64_t)index * bitsPerValue;
+    int32_t block = (int32_t)(bitPosition >> 6);
+    int32_t shift = (int32_t)(bitPosition & 63);
+    uint64_t mask = (uint64_t)maskRight;
+    uint64_t bits = (uint64_t)value & mask;
+    blocks[block] = (int64_t)(((uint64_t)blocks[block] & ~(mask << shift)) | (bits << shift));
+    int32_t end = shift + bitsPerValue;
+    if (end > 64) {
+        int32_t spill = 64 - shift;
+        blocks[block + 1] = (int64_t)(((uint64_t)blocks[block + 1] & ~(mask >> spill)) | (bits >> spill));
+    }
+}
+
+int32_t PackedInts::size() {
+    return valueCount;
+}
+
+int32_t PackedInts::getBitsPerValue() {
+    return bitsPerValue;
+}
+
+int64_t PackedInts::ramBytesUsed() {
+    return (int64_t)blocks.size() * sizeof(int64_t);
+}
+
+void PackedInts::write(const IndexOutputPtr& output) {
+    output->writeVInt(valueCount);
+    output->writeVInt(bitsPerValue);
+    // the extra block is always 0, so it is not written
+    for (int32_t i = 0; i < blocks.size() - 1; ++i) {
+        output->writeLong(blocks[i]);
+    }
+}
+
+PackedIntsPtr PackedInts::read(const IndexInputPtr& input) {
+    int32_t valueCount = input->readVInt();
+    int32_t bitsPerValue = input->readVInt();
+    PackedIntsPtr packed(newLucene<PackedInts>(valueCount, bitsPerValue));
+    for (int32_t i = 0; i < packed->blocks.size() - 1; ++i) {
+        packed->blocks[i] = input->readLong();
+    }
+    return packed;
+}
+
+}
@@ -0,0 +1,365 @@
+/////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2009-2014 Alan Wright. All rights reserved.
+// Distributable under the terms of either the Apache License (Version 2.0)
+// or the GNU Lesser General Public License.
+/////////////////////////////////////////////////////////////////////////////
+
+#include "LuceneInc.h"
+#include "RoaringDocIdSet.h"
+#include "_RoaringDocIdSet.h"
+#include "BitUtil.h"
+#include "MiscUtils.h"
+
+namespace Lucene {
+
+RoaringDocIdSet::RoaringDocIdSet(const DocIdSetIteratorPtr& docIdSetIterator) {
+    keys = Collection<int32_t>::newInstance();
+    containers = Collection<RoaringContainerPtr>::newInstance();
+    cardinality = 0;
+
+    Array<uint16_t> buffer(Array<uint16_t>::newInstance(RoaringContainer::BLOCK_SIZE));
+    int32_t key = -1;
+    int32_t count = 0;
+    for (int32_t doc = docIdSetIterator->nextDoc(); doc != DocIdSetIterator::NO_MORE_DOCS; doc = docIdSetIterator->nextDoc()) {
+        int32_t docKey = (int32_t)((uint32_t)doc >> 16);
+        if (docKey != key) {
+            if (count > 0) {
+                keys.add(key);
+                containers.add(RoaringContainer::create(buffer.get(), count));
+                cardinality += count;
+            }
+            key = docKey;
+            count = 0;
+        }
+        buffer[count++] = (uint16_t)(doc & 0xffff);
+    }
+    if (count > 0) {
+        keys.add(key);
+        containers.add(RoaringContainer::create(buffer.get(), count));
+        cardinality += count;
+    }
+}
+
+RoaringDocIdSet::RoaringDocIdSet(Collection<int32_t> keys, Collection<RoaringContainerPtr> containers) {
+    this->keys = keys;
+    this->containers = containers;
+    this->cardinality = 0;
+    for (Collection<RoaringContainerPtr>::iterator container = containers.begin(); container != containers.end(); ++container) {
+        cardinality += (*container)->cardinality();
+    }
+}
+
+RoaringDocIdSet::~RoaringDocIdSet() {
+}
+
+int32_t RoaringDocIdSet::size() {
+    return cardinality;
+}
+
+bool RoaringDocIdSet::contains(int32_t doc) {
+    Collection<int32_t>::iterator key = std::lower_bound(keys.begin(), keys.end(), (int32_t)((uint32_t)doc >> 16));
+    if (key == keys.end() || *key != (int32_t)((uint32_t)doc >> 16)) {
+        return false;
+    }
+    return containers[(int32_t)(key - keys.begin())]->contains(doc & 0xffff);
+}
+
+RoaringDocIdSetPtr RoaringDocIdSet::intersect(const RoaringDocIdSetPtr& other) {
+    Collection<int32_t> newKeys(Collection<int32_t>::newInstance());
+    Collection<RoaringContainerPtr> newContainers(Collection<RoaringContainerPtr>::newInstance());
+    Array<uint16_t> buffer(Array<uint16_t>::newInstance(RoaringContainer::BLOCK_SIZE));
+    int32_t i = 0;
+    int32_t j = 0;
+    while (i < keys.size() && j < other->keys.size()) {
+        if (keys[i] < other->keys[j]) {
+            ++i;
+        } else if (keys[i] > other->keys[j]) {
+            ++j;
+        } else {
+            int32_t count = containers[i]->intersect(other->containers[j], buffer.get());
+            if (count > 0) {
+                newKeys.add(keys[i]);
+                newContainers.add(RoaringContainer::create(buffer.get(), count));
+            }
+            ++i;
+            ++j;
+        }
+    }
+    return newLucene<RoaringDocIdSet>(newKeys, newContainers);
+}
+
+int64_t RoaringDocIdSet::ramBytesUsed() {
+    int64_t bytes = (int64_t)keys.size() * (sizeof(int32_t) + sizeof(RoaringContainerPtr));
+    for (Collection<RoaringContainerPtr>::iterator container = containers.begin(); container != containers.end(); ++container) {
+        bytes += (*container)->ramBytesUsed();
+    }
+    return bytes;
+}
+
+bool RoaringDocIdSet::isCacheable() {
+    return true;
+}
+
+DocIdSetIteratorPtr RoaringDocIdSet::iterator() {
+    return newLucene<RoaringDocIdSetIterator>(shared_from_this());
+}
+
+const int32_t RoaringContainer::BLOCK_SIZE = 65536;
+const int32_t RoaringContainer::MAX_ARRAY_SIZE = 4096;
+
+RoaringContainer::~RoaringContainer() {
+}
+
+RoaringContainerPtr RoaringContainer::create(const uint16_t* values, int32_t count) {
+    int32_t numRuns = 1;
+    for (int32_t i = 1; i < count; ++i) {
+        if (values[i] != values[i - 1] + 1) {
+            ++numRuns;
+        }
+    }
+    // bytes used: 4 per run, 2 per value in an array, 8192 for a bitmap
+    if (numRuns * 2 < std::min(count, MAX_ARRAY_SIZE)) {
+        return newLucene<RoaringRunContainer>(values, count, numRuns);
+    } else if (count <= MAX_ARRAY_SIZE) {
+        return newLucene<RoaringArrayContainer>(values, count);
+    } else {
+        return newLucene<RoaringBitmapContainer>(values, count);
+    }
+}
+
+int32_t RoaringContainer::intersect(const RoaringContainerPtr& other, uint16_t* values) {
+    RoaringContainerPtr smaller(shared_from_this());
+    RoaringContainerPtr larger(other);
+    if (larger->cardinality() < smaller->cardinality()) {
+        std::swap(smaller, larger);
+    }
+    int32_t count = smaller->getValues(values);
+    int32_t matches = 0;
+    for (int32_t i = 0; i < count; ++i) {
+        if (larger->contains(values[i])) {
+            values[matches++] = values[i];
+        }
+    }
+    return matches;
+}
+
+RoaringArrayContainer::RoaringArrayContainer(const uint16_t* values, int32_t count) {
+    this->values = Array<uint16_t>::newInstance(count);
+    MiscUtils::arrayCopy(values, 0, this->values.get(), 0, count);
+}
+
+RoaringArrayContainer::~RoaringArrayContainer() {
+}
+
+int32_t RoaringArrayContainer::cardinality() {
+    return values.size();
+}
+
+bool RoaringArrayContainer::contains(int32_t value) {
+    return std::binary_search(values.get(), values.get() + values.size(), (uint16_t)value);
+}
+
+int32_t RoaringArrayContainer::advance(int32_t& index, int32_t target) {
+    int32_t size = values.size();
+    // the next value is usually the target when iterating, so check it before searching
+    if (index < size && values[index] < target) {
+        ++index;
+        if (index < size && values[index] < target) {
+            index = (int32_t)(std::lower_bound(values.get() + index, values.get() + size, (uint16_t)target) - values.get());
+        }
+    }
+    return index < size ? values[index] : -1;
+}
+
+int32_t RoaringArrayContainer::getValues(uint16_t* values) {
+    MiscUtils::arrayCopy(this->values.get(), 0, values, 0, this->values.size());
+    return this->values.size();
+}
+
+int64_t RoaringArrayContainer::ramBytesUsed() {
+    return (int64_t)values.size() * sizeof(uint16_t);
+}
+
+const int32_t RoaringBitmapContainer::NUM_WORDS = 1024;
+
+RoaringBitmapContainer::RoaringBitmapContainer(const uint16_t* values, int32_t count) {
+    this->words = LongArray::newInstance(NUM_WORDS);
+    MiscUtils::arrayFill(words.get(), 0, NUM_WORDS, 0LL);
+    for (int32_t i = 0; i < count; ++i) {
+        words[values[i] >> 6] |= (int64_t)((uint64_t)1 << (values[i] & 63));
+    }
+    this->count = count;
+}
+
+RoaringBitmapContainer::RoaringBitmapContainer(LongArray words, int32_t count) {
+    this->words = words;
+    this->count = count;
+}
+
+RoaringBitmapContainer::~RoaringBitmapContainer() {
+}
+
+int32_t RoaringBitmapContainer::cardinality() {
+    return count;
+}
+
+bool RoaringBitmapContainer::contains(int32_t value) {
+    return (((uint64_t)words[value >> 6] >> (value & 63)) & 1) != 0;
+}
+
+int32_t RoaringBitmapContainer::advance(int32_t& index, int32_t target) {
+    int32_t word = target >> 6;
+    if (word >= NUM_WORDS) {
+        return -1;
+    }
+    uint64_t bits = (uint64_t)words[word] >> (target & 63);
+    if (bits != 0) {
+        return target + BitUtil::ntz((int64_t)bits);
+    }
+    while (++word < NUM_WORDS) {
+        if (words[word] != 0) {
+            return (word << 6) + BitUtil::ntz(words[word]);
+        }
+    }
+    return -1;
+}
+
+int32_t RoaringBitmapContainer::getValues(uint16_t* values) {
+    int32_t n = 0;
+    for (int32_t word = 0; word < NUM_WORDS; ++word) {
+        uint64_t bits = (uint64_t)words[word];
+        while (bits != 0) {
+            values[n++] = (uint16_t)((word << 6) + BitUtil::ntz((int64_t)bits));
+            bits &= bits - 1;
+        }
+    }
+    return n;
+}
+
+int64_t RoaringBitmapContainer::ramBytesUsed() {
+    return (int64_t)NUM_WORDS * sizeof(int64_t);
+}
+
+int32_t RoaringBitmapContainer::intersect(const RoaringContainerPtr& other, uint16_t* values) {
+    RoaringBitmapContainerPtr bitmap(boost::dynamic_pointer_cast<RoaringBitmapContainer>(other));
+    if (!bitmap) {
+        return RoaringContainer::intersect(other, values);
+    }
+    int32_t n = 0;
+    for (int32_t word = 0; word < NUM_WORDS; ++word) {
+        uint64_t bits = (uint64_t)words[word] & (uint64_t)bitmap->words[word];
+        while (bits != 0) {
+            values[n++] = (uint16_t)((word << 6) + BitUtil::ntz((int64_t)bits));
+            bits &= bits - 1;
+        }
+    }
+    return n;
+}
+
+RoaringRunContainer::RoaringRunContainer(const uint16_t* values, int32_t count, int32_t numRuns) {
+    this->runs = Array<uint16_t>::newInstance(numRuns * 2);
+    this->numRuns = numRuns;
+    this->count = count;
+    int32_t run = 0;
+    runs[0] = values[0];
+    for (int32_t i = 1; i < count; ++i) {
+        if (values[i] != values[i - 1] + 1) {
+            runs[run * 2 + 1] = values[i - 1];
+            ++run;
+            runs[run * 2] = values[i];
+        }
+    }
+    runs[run * 2 + 1] = values[count - 1];
+}
+
+RoaringRunContainer::~RoaringRunContainer() {
+}
+
+int32_t RoaringRunContainer::cardinality() {
+    return count;
+}
+
+int32_t RoaringRunContainer::findRun(int32_t from, int32_t value) {
+    int32_t low = from;
+    int32_t high = numRuns;
+    while (low < high) {
+        int32_t mid = MiscUtils::unsignedShift(low + high, 1);
+        if (runs[mid * 2 + 1] < value) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return low;
+}
+
+bool RoaringRunContainer::contains(int32_t value) {
+    int32_t run = findRun(0, value);
+    return run < numRuns && runs[run * 2] <= value;
+}
+
+int32_t RoaringRunContainer::advance(int32_t& index, int32_t target) {
+    if (index < numRuns && runs[index * 2 + 1] < target) {
+        index = findRun(index + 1, target);
+    }
+    return index < numRuns ? std::max((int32_t)runs[index * 2], target) : -1;
+}
+
+int32_t RoaringRunContainer::getValues(uint16_t* values) {
+    int32_t n = 0;
+    for (int32_t run = 0; run < numRuns; ++run) {
+        for (int32_t value = runs[run * 2]; value <= runs[run * 2 + 1]; ++value) {
+            values[n++] = (uint16_t)value;
+        }
+    }
+    return n;
+}
+
+int64_t RoaringRunContainer::ramBytesUsed() {
+    return (int64_t)runs.size() * sizeof(uint16_t);
+}
+
+RoaringDocIdSetIterator::RoaringDocIdSetIterator(const RoaringDocIdSetPtr& set) {
+    this->set = set;
+    this->container = 0;
+    this->index = 0;
+    this->doc = -1;
+}
+
+RoaringDocIdSetIterator::~RoaringDocIdSetIterator() {
+}
+
+int32_t RoaringDocIdSetIterator::docID() {
+    return doc;
+}
+
+int32_t RoaringDocIdSetIterator::nextDoc() {
+    return doc == NO_MORE_DOCS ? doc : advance(doc + 1);
+}
+
+int32_t RoaringDocIdSetIterator::advance(int32_t target) {
+    if (doc == NO_MORE_DOCS) {
+        return doc;
+    }
+    int32_t key = (int32_t)((uint32_t)target >> 16);
+    int32_t numContainers = set->keys.size();
+    if (container < numContainers && set->keys[container] < key) {
+        // skip the containers before the target without looking at them
+        container = (int32_t)(std::lower_bound(set->keys.begin() + container, set->keys.end(), key) - set->keys.begin());
+        index = 0;
+    }
+    while (container < numContainers) {
+        int32_t containerKey = set->keys[container];
+        int32_t value = set->containers[container]->advance(index, containerKey == key ? (target & 0xffff) : 0);
+        if (value != -1) {
+            doc = (containerKey << 16) | value;
+            return doc;
+        }
+        ++container;
+        index = 0;
+    }
+    doc = NO_MORE_DOCS;
+    return doc;
+}
+
+}
@@ -5,25 +5,97 @@
 /////////////////////////////////////////////////////////////////////////////
 
 #include "LuceneInc.h"
+#include <boost/thread/tss.hpp>
 #include "ThreadPool.h"
 
 namespace Lucene {
 
+/// Identifies the pool and queue owned by the current worker thread.
+struct WorkerContext {
+    WorkerContext(ThreadPool* pool, int32_t index) : pool(pool), index(index) {}
+    ThreadPool* pool;
+    int32_t index;
+};
+
+static boost::thread_specific_ptr<WorkerContext> workerContext;
+
+Future::Future(const ThreadPoolPtr& pool) {
+    this->_pool = pool;
+    this->done = false;
+}
+
 Future::~Future() {
 }
 
-const int32_t ThreadPool::THREADPOOL_SIZE = 5;
+void Future::set(const boost::any& value) {
+    {
+        boost::mutex::scoped_lock futureLock(futureMutex);
+        this->value = value;
+        done = true;
+    }
+    futureCondition.notify_all();
+}
+
+void Future::setException(const LuceneException& error) {
+    {
+        boost::mutex::scoped_lock futureLock(futureMutex);
+        this->error = error;
+        done = true;
+    }
+    futureCondition.notify_all();
+}
+
+bool Future::isDone() {
+    boost::mutex::scoped_lock futureLock(futureMutex);
+    return done;
+}
+
+void Future::waitForCompletion() {
+    ThreadPoolPtr pool(_pool.lock());
+    if (pool && pool->isWorkerThread()) {
+        // help out rather than block a worker that may be needed to run the task we are waiting for
+        while (!isDone()) {
+            if (!pool->runPendingTask()) {
+                break;
+            }
+        }
+    }
+    boost::mutex::scoped_lock futureLock(futureMutex);
+    while (!done) {
+        futureCondition.wait(futureLock);
+    }
+}
 
-ThreadPool::ThreadPool() {
-    work.reset(new boost::asio::io_service::work(io_service));
-    for (int32_t i = 0; i < THREADPOOL_SIZE; ++i) {
-        threadGroup.create_thread(boost::bind(&boost::asio::io_service::run, &io_service));
+ThreadPool::ThreadPool(int32_t numThreads) {
+    if (numThreads < 0) {
+        boost::throw_exception(IllegalArgumentException(L"numThreads must be >= 0"));
+    }
+    if (numThreads == 0) {
+        numThreads = availableProcessors();
+    }
+    pendingTasks = 0;
+    idleThreads = 0;
+    nextQueue = 0;
+    shutdown = false;
+    for (int32_t i = 0; i < numThreads; ++i) {
+        queues.push_back(WorkQueuePtr(new WorkQueue()));
+    }
+    for (int32_t i = 0; i < numThreads; ++i) {
+        threads.push_back(ThreadPtr(new boost::thread(boost::bind(&ThreadPool::workerRun, this, i))));
     }
 }
 
 ThreadPool::~ThreadPool() {
-    work.reset(); // stop all threads
-    threadGroup.join_all(); // wait for all competition
+    close();
+    // a worker that destroyed the pool must not touch it again once its task returns
+    WorkerContext* context = workerContext.get();
+    if (context != NULL && context->pool == this) {
+        context->pool = NULL;
+    }
+}
+
+int32_t ThreadPool::availableProcessors() {
+    return std::max((int32_t)boost::thread::hardware_concurrency(), 1);
 }
 
 ThreadPoolPtr ThreadPool::getInstance() {
@@ -35,4 +107,133 @@ ThreadPoolPtr ThreadPool::getInstance() {
     return threadPool;
 }
 
+int32_t ThreadPool::getNumThreads() {
+    return (int32_t)queues.size();
+}
+
+void ThreadPool::execute(const Task& task) {
+    int32_t index = workerIndex();
+    {
+        boost::mutex::scoped_lock poolLock(poolMutex);
+        if (shutdown) {
+            boost::throw_exception(IllegalStateException(L"ThreadPool is closed"));
+        }
+        if (index == -1) {
+            index = nextQueue;
+            nextQueue = (nextQueue + 1) % (int32_t)queues.size();
+        }
+    }
+    {
+        boost::mutex::scoped_lock queueLock(queues[index]->queueMutex);
+        queues[index]->tasks.push_back(task);
+    }
+    boost::mutex::scoped_lock poolLock(poolMutex);
+    ++pendingTasks;
+    if (idleThreads > 0) {
+        poolCondition.notify_one();
+    }
+}
+
+bool ThreadPool::popTask(int32_t index, Task& task) {
+    int32_t numQueues = (int32_t)queues.size();
+    bool found = false;
+    if (index != -1) {
+        // newest task from our own queue
+        boost::mutex::scoped_lock queueLock(queues[index]->queueMutex);
+        if (!queues[index]->tasks.empty()) {
+            task = queues[index]->tasks.back();
+            queues[index]->tasks.pop_back();
+            found = true;
+        }
+    }
+    for (int32_t i = 1; !found && i <= numQueues; ++i) {
+        // steal the oldest task from another queue
+        int32_t victim = ((index == -1 ? 0 : index) + i) % numQueues;
+        boost::mutex::scoped_lock queueLock(queues[victim]->queueMutex);
+        if (!queues[victim]->tasks.empty()) {
+            task = queues[victim]->tasks.front();
+            queues[victim]->tasks.pop_front();
+            found = true;
+        }
+    }
+    if (found) {
+        boost::mutex::scoped_lock poolLock(poolMutex);
+        --pendingTasks;
+    }
+    return found;
+}
+
+bool ThreadPool::runPendingTask() {
+    Task task;
+    if (!popTask(workerIndex(), task)) {
+        return false;
+    }
+    try {
+        task();
+    } catch (...) {
+    }
+    return true;
+}
+
+bool ThreadPool::isWorkerThread() {
+    return (workerIndex() != -1);
+}
+
+int32_t ThreadPool::workerIndex() {
+    WorkerContext* context = workerContext.get();
+    return (context != NULL && context->pool == this) ? context->index : -1;
+}
+
+void ThreadPool::workerRun(int32_t index) {
+    workerContext.reset(new WorkerContext(this, index));
+    while (true) {
+        bool ran = false;
+        {
+            Task task;
+            if (popTask(index, task)) {
+                ran = true;
+                try {
+                    task();
+                } catch (...) {
+                }
+            }
+        } // the task may hold the last reference to the pool
+        if (workerContext->pool == NULL) {
+            return; // pool destroyed from this thread
+        }
+        if (ran) {
+            continue;
+        }
+        boost::mutex::scoped_lock poolLock(poolMutex);
+        if (pendingTasks > 0) {
+            continue;
+        }
+        if (shutdown) {
+            break;
+        }
+        ++idleThreads;
+        poolCondition.wait(poolLock);
+        --idleThreads;
+    }
+}
+
+void ThreadPool::close() {
+    {
+        boost::mutex::scoped_lock poolLock(poolMutex);
+        if (shutdown) {
+            return;
+        }
+        shutdown = true;
+        poolCondition.notify_all();
+    }
+    boost::thread::id self = boost::this_thread::get_id();
+    for (std::vector<ThreadPtr>::iterator thread = threads.begin(); thread != threads.end(); ++thread) {
+        if ((*thread)->get_id() == self) {
+            (*thread)->detach(); // a worker can't join itself
+        } else {
+            (*thread)->join(); // wait for all competition
+        }
+    }
+}
+
 }
@@ -19,9 +19,13 @@
 #include "LogDocMergePolicy.h"
 #include "Term.h"
 #include "SegmentInfos.h"
+#include "SegmentInfo.h"
+#include "MergePolicy.h"
 #include "IndexFileDeleter.h"
 #include "KeepOnlyLastCommitDeletionPolicy.h"
 #include "TestPoint.h"
+#include "ThreadPool.h"
+#include "RateLimiter.h"
 
 using namespace Lucene;
 
@@ -214,6 +218,36 @@ TEST_F(ConcurrentMergeSchedulerTest, testNoExtraFiles) {
     directory->close();
 }
 
+TEST_F(ConcurrentMergeSchedulerTest, testThreadPool) {
+    RAMDirectoryPtr directory = newLucene<MockRAMDirectory>();
+    ThreadPoolPtr threadPool = newLucene<ThreadPool>(2);
+
+    IndexWriterPtr writer = newLucene<IndexWriter>(directory, newLucene<SimpleAnalyzer>(), true, IndexWriter::MaxFieldLengthUNLIMITED);
+    ConcurrentMergeSchedulerPtr cms = newLucene<ConcurrentMergeScheduler>();
+    cms->setThreadPool(threadPool);
+    cms->setMaxThreadCount(2);
+    EXPECT_EQ(cms->getThreadPool(), threadPool);
+    writer->setMergeScheduler(cms);
+    writer->setMaxBufferedDocs(2);
+    writer->setMergeFactor(3);
+
+    for (int32_t j = 0; j < 201; ++j) {
+        DocumentPtr doc = newLucene<Document>();
+        doc->add(newLucene<Field>(L"content", L"a b c", Field::STORE_NO, Field::INDEX_ANALYZED));
+        writer->addDocument(doc);
+    }
+
+    writer->close();
+    checkNoUnreferencedFiles(directory);
+
+    IndexReaderPtr reader = IndexReader::open(directory, true);
+    EXPECT_EQ(201, reader->numDocs());
+    reader->close();
+
+    threadPool->close();
+    directory->close();
+}
+
 TEST_F(ConcurrentMergeSchedulerTest, testNoWaitClose) {
     RAMDirectoryPtr directory = newLucene<MockRAMDirectory>();
 
@@ -346,3 +380,148 @@ TEST_F(ConcurrentMergeSchedulerTest, testSubclassConcurrentMergeScheduler) {
     dir->close();
     EXPECT_TRUE(ConcurrentMergeScheduler::anyUnhandledExceptions());
 }
+
+TEST_F(ConcurrentMergeSchedulerTest, testMaxMergeCount) {
+    ConcurrentMergeSchedulerPtr cms = newLucene<ConcurrentMergeScheduler>();
+    EXPECT_TRUE(cms->getMaxThreadCount() >= 1 && cms->getMaxThreadCount() <= 3);
+    EXPECT_EQ(cms->getMaxThreadCount() + 2, cms->getMaxMergeCount());
+
+    cms->setMaxThreadCount(8);
+    EXPECT_EQ(8, cms->getMaxMergeCount());
+    try {
+        cms->setMaxMergeCount(7);
+    } catch (IllegalArgumentException& e) {
+        EXPECT_TRUE(check_exception(LuceneException::IllegalArgument)(e));
+    }
+    cms->setMaxThreadCount(1);
+    cms->setMaxMergeCount(2);
+    EXPECT_EQ(2, cms->getMaxMergeCount());
+
+    EXPECT_EQ(0.0, cms->getMergeWriteMBPerSec());
+    try {
+        cms->setMergeWriteMBPerSec(-1.0);
+    } catch (IllegalArgumentException& e) {
+        EXPECT_TRUE(check_exception(LuceneException::IllegalArgument)(e));
+    }
+}
+
+namespace TestPausedMerge {
+
+DECLARE_SHARED_PTR(CheckAbortedThread)
+
+class CheckAbortedThread : public LuceneThread {
+public:
+    CheckAbortedThread(const OneMergePtr& merge) {
+        this->merge = merge;
+        this->aborted = false;
+    }
+
+    virtual ~CheckAbortedThread() {
+    }
+
+    LUCENE_CLASS(CheckAbortedThread);
+
+public:
+    OneMergePtr merge;
+    bool aborted;
+
+public:
+    virtual void run() {
+        try {
+            merge->checkAborted(DirectoryPtr());
+        } catch (MergeAbortedException&) {
+            aborted = true;
+        }
+    }
+};
+
+}
+
+TEST_F(ConcurrentMergeSchedulerTest, testPausedMerge) {
+    SegmentInfosPtr infos = newLucene<SegmentInfos>();
+    infos->add(newLucene<SegmentInfo>(L"_0", 10, newLucene<MockRAMDirectory>()));
+
+    // a paused merge waits until it is resumed
+    OneMergePtr merge = newLucene<OneMerge>(infos, false);
+    merge->setPause(true);
+    TestPausedMerge::CheckAbortedThreadPtr thread = newLucene<TestPausedMerge::CheckAbortedThread>(merge);
+    thread->start();
+    LuceneThread::threadSleep(100);
+    EXPECT_TRUE(thread->isAlive());
+    merge->setPause(false);
+    thread->join();
+    EXPECT_TRUE(!thread->aborted);
+
+    // or aborted
+    merge->setPause(true);
+    thread = newLucene<TestPausedMerge::CheckAbortedThread>(merge);
+    thread->start();
+    LuceneThread::threadSleep(100);
+    EXPECT_TRUE(thread->isAlive());
+    merge->abort();
+    thread->join();
+    EXPECT_TRUE(thread->aborted);
+}
+
+namespace TestMergeWriteRateLimit {
+
+DECLARE_SHARED_PTR(LimiterRecordingMergeScheduler)
+
+/// Remembers the rate limiters merges were written with.
+class LimiterRecordingMergeScheduler : public ConcurrentMergeScheduler {
+public:
+    LimiterRecordingMergeScheduler() {
+        limiters = HashSet<RateLimiterPtr>::newInstance();
+    }
+
+    virtual ~LimiterRecordingMergeScheduler() {
+    }
+
+    LUCENE_CLASS(LimiterRecordingMergeScheduler);
+
+public:
+    HashSet<RateLimiterPtr> limiters;
+
+protected:
+    virtual void doMerge(const OneMergePtr& merge) {
+        ConcurrentMergeScheduler::doMerge(merge);
+        SyncLock syncLock(this);
+        limiters.add(merge->rateLimiter);
+    }
+};
+
+}
+
+TEST_F(ConcurrentMergeSchedulerTest, testMergeWriteRateLimit) {
+    MockRAMDirectoryPtr directory = newLucene<MockRAMDirectory>();
+    IndexWriterPtr writer = newLucene<IndexWriter>(directory, newLucene<SimpleAnalyzer>(), true, IndexWriter::MaxFieldLengthUNLIMITED);
+    TestMergeWriteRateLimit::LimiterRecordingMergeSchedulerPtr cms = newLucene<TestMergeWriteRateLimit::LimiterRecordingMergeScheduler>();
+    cms->setMaxThreadCount(2);
+    cms->setMaxMergeCount(4);
+    cms->setMergeWriteMBPerSec(20.0);
+    EXPECT_EQ(20.0, cms->getMergeWriteMBPerSec());
+    writer->setMergeScheduler(cms);
+    writer->setMaxBufferedDocs(2);
+    writer->setMergeFactor(3);
+
+    for (int32_t j = 0; j < 201; ++j) {
+        DocumentPtr doc = newLucene<Document>();
+        doc->add(newLucene<Field>(L"id", StringUtils::toString(j), Field::STORE_YES, Field::INDEX_NOT_ANALYZED));
+        doc->add(newLucene<Field>(L"content", L"a b c", Field::STORE_NO, Field::INDEX_ANALYZED));
+        writer->addDocument(doc);
+    }
+    writer->optimize();
+    writer->close();
+    checkNoUnreferencedFiles(directory);
+    EXPECT_TRUE(checkIndex(directory));
+
+    // all merges shared one limiter, so together they wrote at most 20 MB per second
+    EXPECT_EQ(1, cms->limiters.size());
+    EXPECT_EQ(20.0, (*cms->limiters.begin())->getMbPerSec());
+
+    IndexReaderPtr reader = IndexReader::open(directory, true);
+    EXPECT_EQ(201, reader->numDocs());
+    EXPECT_EQ(L"200", reader->document(200)->get(L"id"));
+    reader->close();
+    directory->close();
+}
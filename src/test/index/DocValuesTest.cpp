@@ -0,0 +1,236 @@
+/////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2009-2014 Alan Wright. All rights reserved.
+// Distributable under the terms of either the Apache License (Version 2.0)
+// or the GNU Lesser General Public License.
+/////////////////////////////////////////////////////////////////////////////
+
+#include "TestInc.h"
+#include "LuceneTestFixture.h"
+#include "RAMDirectory.h"
+#include "IndexWriter.h"
+#include "IndexReader.h"
+#include "WhitespaceAnalyzer.h"
+#include "Document.h"
+#include "Field.h"
+#include "DocValuesField.h"
+#include "FieldCache.h"
+#include "IndexSearcher.h"
+#include "MatchAllDocsQuery.h"
+#include "Sort.h"
+#include "SortField.h"
+#include "TopFieldDocs.h"
+#include "ScoreDoc.h"
+#include "Term.h"
+
+using namespace Lucene;
+
+typedef LuceneTestFixture DocValuesTest;
+
+static const int32_t NUM_DOCS = 300;
+
+static int64_t price(int32_t id) {
+    return (int64_t)(id * 7919 % 1000) - 500;
+}
+
+static String category(int32_t id) {
+    return id % 10 == 0 ? L"" : L"cat" + StringUtils::toString(id % 7);
+}
+
+/// Index NUM_DOCS documents in three segments; every third document has no price.
+static RAMDirectoryPtr createIndex(bool useCompoundFile) {
+    RAMDirectoryPtr dir = newLucene<RAMDirectory>();
+    IndexWriterPtr writer = newLucene<IndexWriter>(dir, newLucene<WhitespaceAnalyzer>(), true, IndexWriter::MaxFieldLengthLIMITED);
+    writer->setMergeFactor(1000);
+    writer->setUseCompoundFile(useCompoundFile);
+    for (int32_t i = 0; i < NUM_DOCS; ++i) {
+        DocumentPtr doc = newLucene<Document>();
+        doc->add(newLucene<Field>(L"id", StringUtils::toString(i), Field::STORE_YES, Field::INDEX_NOT_ANALYZED));
+        if (i % 3 != 0) {
+            doc->add(newLucene<DocValuesField>(L"price", price(i)));
+        }
+        if (!category(i).empty()) {
+            doc->add(newLucene<DocValuesField>(L"category", category(i)));
+        }
+        writer->addDocument(doc);
+        if (i % 100 == 99) {
+            writer->commit();
+        }
+    }
+    writer->close();
+    return dir;
+}
+
+static void checkValues(const IndexReaderPtr& reader) {
+    Collection<IndexReaderPtr> segments(reader->getSequentialSubReaders());
+    if (!segments) {
+        segments = newCollection<IndexReaderPtr>(reader);
+    }
+    for (Collection<IndexReaderPtr>::iterator segment = segments.begin(); segment != segments.end(); ++segment) {
+        PackedValuesPtr prices((*segment)->getNumericDocValues(L"price"));
+        PackedStringIndexPtr categories((*segment)->getSortedDocValues(L"category"));
+        EXPECT_TRUE(prices);
+        EXPECT_TRUE(categories);
+        EXPECT_TRUE(!(*segment)->getNumericDocValues(L"category"));
+        EXPECT_TRUE(!(*segment)->getSortedDocValues(L"id"));
+        EXPECT_EQ((*segment)->maxDoc(), prices->size());
+        EXPECT_EQ((*segment)->maxDoc(), categories->size());
+
+        Collection<int32_t> ints(FieldCache::DEFAULT()->getInts(*segment, L"price"));
+        StringIndexPtr index(FieldCache::DEFAULT()->getStringIndex(*segment, L"category"));
+        for (int32_t doc = 0; doc < (*segment)->maxDoc(); ++doc) {
+            if ((*segment)->isDeleted(doc)) {
+                continue;
+            }
+            int32_t id = StringUtils::toInt((*segment)->document(doc)->get(L"id"));
+            int64_t expected = id % 3 != 0 ? price(id) : 0;
+            EXPECT_EQ(expected, prices->get(doc));
+            EXPECT_EQ(expected, ints[doc]);
+            EXPECT_EQ(category(id), categories->lookup(categories->getOrd(doc)));
+            EXPECT_EQ(category(id), index->lookup[index->order[doc]]);
+        }
+        // ordinals follow the order of the values
+        for (int32_t ord = 2; ord < categories->numOrds(); ++ord) {
+            EXPECT_TRUE(categories->lookup(ord - 1) < categories->lookup(ord));
+        }
+
+        HashSet<String> numericFields((*segment)->getFieldNames(IndexReader::FIELD_OPTION_NUMERIC_DOC_VALUES));
+        EXPECT_EQ(1, numericFields.size());
+        EXPECT_TRUE(numericFields.contains(L"price"));
+        HashSet<String> sortedFields((*segment)->getFieldNames(IndexReader::FIELD_OPTION_SORTED_DOC_VALUES));
+        EXPECT_EQ(1, sortedFields.size());
+        EXPECT_TRUE(sortedFields.contains(L"category"));
+    }
+}
+
+TEST_F(DocValuesTest, testFlushedSegments) {
+    RAMDirectoryPtr dir = createIndex(false);
+    IndexReaderPtr reader = IndexReader::open(dir, true);
+    EXPECT_EQ(3, reader->getSequentialSubReaders().size());
+    checkValues(reader);
+    reader->close();
+
+    dir = createIndex(true);
+    reader = IndexReader::open(dir, true);
+    checkValues(reader);
+    reader->close();
+}
+
+TEST_F(DocValuesTest, testMerge) {
+    RAMDirectoryPtr dir = createIndex(true);
+    IndexReaderPtr reader = IndexReader::open(dir, false);
+    for (int32_t i = 0; i < NUM_DOCS; i += 4) {
+        reader->deleteDocuments(newLucene<Term>(L"id", StringUtils::toString(i)));
+    }
+    reader->close();
+
+    IndexWriterPtr writer = newLucene<IndexWriter>(dir, newLucene<WhitespaceAnalyzer>(), false, IndexWriter::MaxFieldLengthLIMITED);
+    writer->optimize();
+    writer->close();
+
+    reader = IndexReader::open(dir, true);
+    EXPECT_EQ(1, reader->getSequentialSubReaders().size());
+    EXPECT_EQ(NUM_DOCS - NUM_DOCS / 4, reader->maxDoc());
+    checkValues(reader);
+    reader->close();
+}
+
+TEST_F(DocValuesTest, testSort) {
+    RAMDirectoryPtr dir = createIndex(true);
+    IndexSearcherPtr searcher = newLucene<IndexSearcher>(dir, true);
+    TopFieldDocsPtr docs = searcher->search(newLucene<MatchAllDocsQuery>(), FilterPtr(), NUM_DOCS, newLucene<Sort>(newLucene<SortField>(L"price", SortField::LONG)));
+    EXPECT_EQ(NUM_DOCS, docs->scoreDocs.size());
+    int64_t last = std::numeric_limits<int64_t>::min();
+    for (int32_t i = 0; i < docs->scoreDocs.size(); ++i) {
+        int32_t id = StringUtils::toInt(searcher->doc(docs->scoreDocs[i]->doc)->get(L"id"));
+        int64_t value = id % 3 != 0 ? price(id) : 0;
+        EXPECT_TRUE(value >= last);
+        last = value;
+    }
+    searcher->close();
+}
+
+TEST_F(DocValuesTest, testRAMAccounting) {
+    RAMDirectoryPtr dir = newLucene<RAMDirectory>();
+    IndexWriterPtr writer = newLucene<IndexWriter>(dir, newLucene<WhitespaceAnalyzer>(), true, IndexWriter::MaxFieldLengthLIMITED);
+    writer->setMaxBufferedDocs(100000);
+    String value(100, L'x');
+    for (int32_t i = 0; i < 1000; ++i) {
+        DocumentPtr doc = newLucene<Document>();
+        doc->add(newLucene<DocValuesField>(L"category", value));
+        doc->add(newLucene<DocValuesField>(L"price", (int64_t)i));
+        writer->addDocument(doc);
+    }
+
+    // buffered doc values count towards the RAM buffer until they are flushed
+    EXPECT_TRUE(writer->ramSizeInBytes() >= 1000 * (int64_t)(value.length() * sizeof(wchar_t) + sizeof(int64_t)));
+    writer->commit();
+    EXPECT_EQ(0, writer->ramSizeInBytes());
+    writer->close();
+}
+
+TEST_F(DocValuesTest, testIntRange) {
+    RAMDirectoryPtr dir = newLucene<RAMDirectory>();
+    IndexWriterPtr writer = newLucene<IndexWriter>(dir, newLucene<WhitespaceAnalyzer>(), true, IndexWriter::MaxFieldLengthLIMITED);
+    DocumentPtr doc = newLucene<Document>();
+    doc->add(newLucene<DocValuesField>(L"big", (int64_t)1 << 40));
+    writer->addDocument(doc);
+    doc = newLucene<Document>();
+    doc->add(newLucene<DocValuesField>(L"big", (int64_t)-1));
+    writer->addDocument(doc);
+    writer->close();
+
+    IndexReaderPtr reader = IndexReader::open(dir, true);
+    EXPECT_EQ(1, reader->getSequentialSubReaders().size());
+    IndexReaderPtr segment = reader->getSequentialSubReaders()[0];
+    Collection<int64_t> longs(FieldCache::DEFAULT()->getLongs(segment, L"big"));
+    EXPECT_EQ((int64_t)1 << 40, longs[0]);
+    EXPECT_EQ(-1, longs[1]);
+
+    // ints would have to narrow the values, so they are refused
+    try {
+        FieldCache::DEFAULT()->getInts(segment, L"big");
+        FAIL() << "expected IllegalStateException";
+    } catch (IllegalStateException& e) {
+        EXPECT_TRUE(check_exception(LuceneException::IllegalState)(e));
+    }
+    try {
+        FieldCache::DEFAULT()->getPackedInts(segment, L"big");
+        FAIL() << "expected IllegalStateException";
+    } catch (IllegalStateException& e) {
+        EXPECT_TRUE(check_exception(LuceneException::IllegalState)(e));
+    }
+    reader->close();
+}
+
+TEST_F(DocValuesTest, testTopLevelReader) {
+    RAMDirectoryPtr dir = createIndex(true);
+    IndexReaderPtr reader = IndexReader::open(dir, true);
+    EXPECT_EQ(3, reader->getSequentialSubReaders().size());
+    EXPECT_TRUE(!reader->getNumericDocValues(L"price"));
+
+    // the field has no terms, so the values come from the segments' columns
+    Collection<int64_t> longs(FieldCache::DEFAULT()->getLongs(reader, L"price"));
+    Collection<int32_t> ints(FieldCache::DEFAULT()->getInts(reader, L"price"));
+    PackedValuesPtr packedLongs(FieldCache::DEFAULT()->getPackedLongs(reader, L"price"));
+    Collection<String> strings(FieldCache::DEFAULT()->getStrings(reader, L"category"));
+    StringIndexPtr index(FieldCache::DEFAULT()->getStringIndex(reader, L"category"));
+    PackedStringIndexPtr packedIndex(FieldCache::DEFAULT()->getPackedStringIndex(reader, L"category"));
+    EXPECT_EQ(NUM_DOCS, longs.size());
+    EXPECT_EQ(NUM_DOCS, packedLongs->size());
+    EXPECT_EQ(NUM_DOCS, packedIndex->size());
+    EXPECT_EQ(8, packedIndex->numOrds());
+    for (int32_t doc = 0; doc < NUM_DOCS; ++doc) {
+        int32_t id = StringUtils::toInt(reader->document(doc)->get(L"id"));
+        int64_t expected = id % 3 != 0 ? price(id) : 0;
+        EXPECT_EQ(expected, longs[doc]);
+        EXPECT_EQ(expected, ints[doc]);
+        EXPECT_EQ(expected, packedLongs->get(doc));
+        EXPECT_EQ(category(id), strings[doc]);
+        EXPECT_EQ(category(id), index->lookup[index->order[doc]]);
+        EXPECT_EQ(category(id), packedIndex->lookup(packedIndex->getOrd(doc)));
+    }
+    for (int32_t ord = 2; ord < packedIndex->numOrds(); ++ord) {
+        EXPECT_TRUE(packedIndex->lookup(ord - 1) < packedIndex->lookup(ord));
+    }
+    reader->close();
+}
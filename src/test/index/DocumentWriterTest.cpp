@@ -22,6 +22,7 @@
 #include "FieldInfo.h"
 #include "FieldInfos.h"
 #include "TermPositions.h"
+#include "TermEnum.h"
 #include "Term.h"
 #include "TokenFilter.h"
 #include "TokenStream.h"
@@ -363,3 +364,59 @@ TEST_F(DocumentWriterTest, testMixedTermVectorSettingsSameField2) {
     EXPECT_TRUE(reader->hasNorms(L"f2"));
     EXPECT_TRUE(fi->fieldInfo(L"f2")->omitTermFreqAndPositions);
 }
+
+TEST_F(DocumentWriterTest, testTermsSortedAtFlush) {
+    // Terms sharing long prefixes, terms that are prefixes of others and non-ascii terms
+    Collection<String> words = Collection<String>::newInstance();
+    for (int32_t i = 0; i < 3000; ++i) {
+        words.add(StringUtils::toString((i * 7919) % 3001));
+        words.add(L"prefix" + StringUtils::toString(i % 100));
+    }
+    String text(L"a");
+    for (int32_t i = 0; i < 40; ++i) {
+        text += (wchar_t)(L'a' + i % 3);
+        words.add(text);
+    }
+    words.add(L"\x00e9t\x00e9");
+    words.add(L"\x00e9");
+    words.add(L"\x4e2d\x6587");
+    words.add(L"z");
+
+    StringStream buffer;
+    HashSet<String> unique = HashSet<String>::newInstance();
+    for (Collection<String>::iterator word = words.begin(); word != words.end(); ++word) {
+        buffer << *word << L" ";
+        unique.add(*word);
+    }
+
+    RAMDirectoryPtr dir = newLucene<RAMDirectory>();
+    IndexWriterPtr writer = newLucene<IndexWriter>(dir, newLucene<WhitespaceAnalyzer>(), true, IndexWriter::MaxFieldLengthUNLIMITED);
+    DocumentPtr doc = newLucene<Document>();
+    doc->add(newLucene<Field>(L"f", buffer.str(), Field::STORE_NO, Field::INDEX_ANALYZED, Field::TERM_VECTOR_YES));
+    writer->addDocument(doc);
+    writer->close();
+
+    SegmentReaderPtr reader = SegmentReader::getOnlySegmentReader(dir);
+    TermEnumPtr terms = reader->terms();
+    int32_t count = 0;
+    String last;
+    while (terms->next()) {
+        String term(terms->term()->text());
+        EXPECT_TRUE(unique.contains(term));
+        if (count > 0) {
+            EXPECT_TRUE(last < term);
+        }
+        last = term;
+        ++count;
+    }
+    EXPECT_EQ(unique.size(), count);
+    terms->close();
+
+    TermFreqVectorPtr vector = reader->getTermFreqVector(0, L"f");
+    Collection<String> vectorTerms = vector->getTerms();
+    EXPECT_EQ(unique.size(), vectorTerms.size());
+    for (int32_t i = 1; i < vectorTerms.size(); ++i) {
+        EXPECT_TRUE(vectorTerms[i - 1] < vectorTerms[i]);
+    }
+    reader->close();
+}
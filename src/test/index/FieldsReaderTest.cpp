@@ -22,6 +22,7 @@
 #include "IndexReader.h"
 #include "MiscUtils.h"
 #include "FileUtils.h"
+#include "Term.h"
 
 using namespace Lucene;
 
@@ -435,3 +436,155 @@ TEST_F(FieldsReaderTest, testExceptions) {
     FileUtils::removeDirectory(indexDir);
     finally.throwException();
 }
+
+static DocumentPtr createChunkedDocument(int32_t id) {
+    DocumentPtr doc = newLucene<Document>();
+    doc->add(newLucene<Field>(L"id", StringUtils::toString(id), Field::STORE_YES, Field::INDEX_NOT_ANALYZED));
+    doc->add(newLucene<Field>(L"text", L"stored text of document number " + StringUtils::toString(id), Field::STORE_YES, Field::INDEX_ANALYZED));
+    if (id % 3 == 0) {
+        ByteArray bytes(ByteArray::newInstance(id % 100));
+        for (int32_t i = 0; i < bytes.size(); ++i) {
+            bytes[i] = (uint8_t)(id + i);
+        }
+        doc->add(newLucene<Field>(L"binary", bytes, Field::STORE_YES));
+    }
+    return doc;
+}
+
+static void checkChunkedDocument(const DocumentPtr& doc, int32_t id) {
+    EXPECT_EQ(StringUtils::toString(id), doc->get(L"id"));
+    EXPECT_EQ(L"stored text of document number " + StringUtils::toString(id), doc->get(L"text"));
+    ByteArray bytes(doc->getBinaryValue(L"binary"));
+    if (id % 3 == 0) {
+        EXPECT_EQ(id % 100, bytes.size());
+        for (int32_t i = 0; i < bytes.size(); ++i) {
+            EXPECT_EQ((uint8_t)(id + i), bytes[i]);
+        }
+    } else {
+        EXPECT_TRUE(!bytes);
+    }
+}
+
+static void checkChunkedDocuments(const DirectoryPtr& dir, int32_t numDocs, int32_t deletedEvery) {
+    IndexReaderPtr reader = IndexReader::open(dir, true);
+    int32_t id = 0;
+    for (int32_t doc = 0; doc < reader->maxDoc(); ++doc) {
+        if (reader->isDeleted(doc)) {
+            continue;
+        }
+        while (deletedEvery > 0 && id % deletedEvery == 0) {
+            ++id;
+        }
+        checkChunkedDocument(reader->document(doc), id++);
+    }
+    EXPECT_EQ(numDocs, id);
+    reader->close();
+}
+
+TEST_F(FieldsReaderTest, testChunkedFields) {
+    RAMDirectoryPtr plainDir = newLucene<RAMDirectory>();
+    RAMDirectoryPtr chunkedDir = newLucene<RAMDirectory>();
+    for (int32_t chunked = 0; chunked < 2; ++chunked) {
+        IndexWriterPtr writer = newLucene<IndexWriter>(chunked ? chunkedDir : plainDir, newLucene<WhitespaceAnalyzer>(), true, IndexWriter::MaxFieldLengthLIMITED);
+        writer->setUseCompoundFile(false);
+        writer->setStoredFieldsChunkSize(chunked ? 4096 : 0);
+        for (int32_t id = 0; id < 1000; ++id) {
+            writer->addDocument(createChunkedDocument(id));
+        }
+        writer->close();
+    }
+
+    // Documents with similar fields compress well together
+    EXPECT_TRUE(chunkedDir->fileLength(TEST_SEGMENT_NAME + L".fdt") < plainDir->fileLength(TEST_SEGMENT_NAME + L".fdt") / 2);
+    checkChunkedDocuments(chunkedDir, 1000, 0);
+
+    // Documents are read in any order, from the same chunk or from another one
+    IndexReaderPtr reader = IndexReader::open(chunkedDir, true);
+    for (int32_t i = 0; i < 1000; ++i) {
+        int32_t doc = (i * 7919) % 1000;
+        checkChunkedDocument(reader->document(doc), doc);
+    }
+    reader->close();
+}
+
+TEST_F(FieldsReaderTest, testChunkedFieldSelectors) {
+    RAMDirectoryPtr chunkedDir = newLucene<RAMDirectory>();
+    IndexWriterPtr writer = newLucene<IndexWriter>(chunkedDir, newLucene<WhitespaceAnalyzer>(), true, IndexWriter::MaxFieldLengthLIMITED);
+    writer->setUseCompoundFile(false);
+    writer->setStoredFieldsChunkSize(1024);
+    EXPECT_EQ(1024, writer->getStoredFieldsChunkSize());
+    writer->addDocument(testDoc);
+    writer->addDocument(testDoc);
+    writer->close();
+
+    FieldsReaderPtr reader = newLucene<FieldsReader>(chunkedDir, TEST_SEGMENT_NAME, fieldInfos);
+    EXPECT_TRUE(reader->isChunked());
+    EXPECT_EQ(2, reader->size());
+    HashSet<String> loadFieldNames = HashSet<String>::newInstance();
+    loadFieldNames.add(DocHelper::TEXT_FIELD_1_KEY);
+    HashSet<String> lazyFieldNames = HashSet<String>::newInstance();
+    lazyFieldNames.add(DocHelper::LAZY_FIELD_KEY);
+    lazyFieldNames.add(DocHelper::LAZY_FIELD_BINARY_KEY);
+    SetBasedFieldSelectorPtr fieldSelector = newLucene<SetBasedFieldSelector>(loadFieldNames, lazyFieldNames);
+    DocumentPtr doc = reader->doc(1, fieldSelector);
+
+    // Lazy fields of compressed documents are loaded with the document
+    FieldablePtr field = doc->getFieldable(DocHelper::LAZY_FIELD_KEY);
+    EXPECT_TRUE(field);
+    EXPECT_TRUE(!field->isLazy());
+    EXPECT_EQ(DocHelper::LAZY_FIELD_TEXT, field->stringValue());
+    field = doc->getFieldable(DocHelper::LAZY_FIELD_BINARY_KEY);
+    EXPECT_TRUE(field);
+    EXPECT_TRUE(field->getBinaryValue().equals(DocHelper::LAZY_FIELD_BINARY_BYTES));
+    EXPECT_EQ(DocHelper::FIELD_1_TEXT, doc->get(DocHelper::TEXT_FIELD_1_KEY));
+    EXPECT_TRUE(!doc->getFieldable(DocHelper::TEXT_FIELD_2_KEY));
+
+    doc = reader->doc(0, newLucene<LoadFirstFieldSelector>());
+    EXPECT_EQ(1, doc->getFields().size());
+
+    doc = reader->doc(0, newLucene<TestLoadSize::TestableFieldSelector>());
+    checkSizeEquals(DocHelper::LAZY_FIELD_BINARY_BYTES.size(), doc->getFieldable(DocHelper::LAZY_FIELD_BINARY_KEY)->getBinaryValue().get());
+    EXPECT_EQ(DocHelper::FIELD_3_TEXT, doc->get(DocHelper::TEXT_FIELD_3_KEY));
+
+    FieldsReaderPtr clone = boost::dynamic_pointer_cast<FieldsReader>(reader->clone());
+    EXPECT_EQ(DocHelper::FIELD_1_TEXT, clone->doc(0, FieldSelectorPtr())->get(DocHelper::TEXT_FIELD_1_KEY));
+    clone->close();
+    reader->close();
+}
+
+TEST_F(FieldsReaderTest, testChunkedMerges) {
+    RAMDirectoryPtr chunkedDir = newLucene<RAMDirectory>();
+    IndexWriterPtr writer = newLucene<IndexWriter>(chunkedDir, newLucene<WhitespaceAnalyzer>(), true, IndexWriter::MaxFieldLengthLIMITED);
+    writer->setStoredFieldsChunkSize(512);
+    writer->setMaxBufferedDocs(37);
+    writer->setMergeFactor(3);
+    for (int32_t id = 0; id < 1000; ++id) {
+        writer->addDocument(createChunkedDocument(id));
+    }
+    writer->commit();
+    checkChunkedDocuments(chunkedDir, 1000, 0);
+
+    // Whole chunks are copied and the others decompressed, around deleted documents
+    for (int32_t id = 0; id < 1000; id += 11) {
+        writer->deleteDocuments(newLucene<Term>(L"id", StringUtils::toString(id)));
+    }
+    writer->optimize();
+    writer->close();
+    checkChunkedDocuments(chunkedDir, 1000, 11);
+
+    // Chunked segments merged into a segment without chunks, and back again
+    for (int32_t chunkSize = 0; chunkSize <= 2048; chunkSize += 2048) {
+        writer = newLucene<IndexWriter>(chunkedDir, newLucene<WhitespaceAnalyzer>(), IndexWriter::MaxFieldLengthLIMITED);
+        writer->setStoredFieldsChunkSize(chunkSize);
+        writer->setMaxBufferedDocs(37);
+        writer->addDocument(createChunkedDocument(1000));
+        writer->optimize();
+        writer->close();
+    }
+    IndexReaderPtr reader = IndexReader::open(chunkedDir, true);
+    EXPECT_EQ(911, reader->numDocs());
+    checkChunkedDocument(reader->document(909), 1000);
+    checkChunkedDocument(reader->document(910), 1000);
+    reader->close();
+    EXPECT_TRUE(checkIndex(chunkedDir));
+}
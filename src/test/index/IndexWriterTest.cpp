@@ -4633,3 +4633,203 @@ TEST_F(IndexWriterTest, testNoUnwantedTVFiles) {
 
     dir->close();
 }
+
+namespace TestMaxThreadStates {
+
+class AddDocumentsThread : public LuceneThread {
+public:
+    AddDocumentsThread(const IndexWriterPtr& writer, int32_t threadId, int32_t numDocs) {
+        this->writer = writer;
+        this->threadId = threadId;
+        this->numDocs = numDocs;
+    }
+
+    virtual ~AddDocumentsThread() {
+    }
+
+    LUCENE_CLASS(AddDocumentsThread);
+
+protected:
+    IndexWriterPtr writer;
+    int32_t threadId;
+    int32_t numDocs;
+
+public:
+    virtual void run() {
+        try {
+            for (int32_t i = 0; i < numDocs; ++i) {
+                DocumentPtr doc = newLucene<Document>();
+                doc->add(newLucene<Field>(L"id", StringUtils::toString(threadId) + L"_" + StringUtils::toString(i), Field::STORE_YES, Field::INDEX_NOT_ANALYZED));
+                doc->add(newLucene<Field>(L"content", L"aaa bbb ccc thread" + StringUtils::toString(threadId), Field::STORE_NO, Field::INDEX_ANALYZED));
+                writer->addDocument(doc);
+            }
+        } catch (...) {
+            FAIL() << "Unexpected exception";
+        }
+    }
+};
+
+DECLARE_SHARED_PTR(InversionGate)
+
+/// Holds back the threads inverting a document until a given number of them are inverting at once.
+class InversionGate : public LuceneObject {
+public:
+    InversionGate(int32_t target) {
+        this->target = target;
+        this->arrived = 0;
+    }
+
+    virtual ~InversionGate() {
+    }
+
+    LUCENE_CLASS(InversionGate);
+
+protected:
+    int32_t target;
+    int32_t arrived;
+
+public:
+    /// Returns false if the other threads didn't arrive in time.
+    bool arrive() {
+        SyncLock syncLock(this);
+        ++arrived;
+        notifyAll();
+        uint64_t deadline = MiscUtils::currentTimeMillis() + 10000;
+        while (arrived < target && MiscUtils::currentTimeMillis() < deadline) {
+            wait(100);
+        }
+        return arrived >= target;
+    }
+};
+
+class GateFilter : public TokenFilter {
+public:
+    GateFilter(const TokenStreamPtr& input, const InversionGatePtr& gate) : TokenFilter(input) {
+        this->gate = gate;
+        this->first = true;
+    }
+
+    virtual ~GateFilter() {
+    }
+
+    LUCENE_CLASS(GateFilter);
+
+protected:
+    InversionGatePtr gate;
+    bool first;
+
+public:
+    virtual bool incrementToken() {
+        if (first) {
+            first = false;
+            EXPECT_TRUE(gate->arrive());
+        }
+        return input->incrementToken();
+    }
+};
+
+class GateAnalyzer : public Analyzer {
+public:
+    GateAnalyzer(const InversionGatePtr& gate) {
+        this->gate = gate;
+    }
+
+    virtual ~GateAnalyzer() {
+    }
+
+    LUCENE_CLASS(GateAnalyzer);
+
+protected:
+    InversionGatePtr gate;
+
+public:
+    virtual TokenStreamPtr tokenStream(const String& fieldName, const ReaderPtr& reader) {
+        return newLucene<GateFilter>(newLucene<WhitespaceTokenizer>(reader), gate);
+    }
+};
+
+class ThreadStatesIndexWriter : public IndexWriter {
+public:
+    ThreadStatesIndexWriter(const DirectoryPtr& d, const AnalyzerPtr& a, int32_t mfl) : IndexWriter(d, a, mfl) {
+    }
+
+    virtual ~ThreadStatesIndexWriter() {
+    }
+
+    LUCENE_CLASS(ThreadStatesIndexWriter);
+
+public:
+    int32_t getNumThreadStates() {
+        return docWriter->getNumThreadStates();
+    }
+};
+
+/// Adds one document from each of numThreads threads and returns the number of thread states used.
+static int32_t countThreadStates(int32_t numThreads, int32_t maxThreadStates) {
+    MockRAMDirectoryPtr dir = newLucene<MockRAMDirectory>();
+    InversionGatePtr gate = newLucene<InversionGate>(std::min(numThreads, maxThreadStates));
+    IndexWriterPtr writer = newLucene<ThreadStatesIndexWriter>(dir, newLucene<GateAnalyzer>(gate), IndexWriter::MaxFieldLengthUNLIMITED);
+    writer->setMaxThreadStates(maxThreadStates);
+    Collection<LuceneThreadPtr> threads = Collection<LuceneThreadPtr>::newInstance(numThreads);
+    for (int32_t i = 0; i < numThreads; ++i) {
+        threads[i] = newLucene<AddDocumentsThread>(writer, i, 1);
+        threads[i]->start();
+    }
+    for (int32_t i = 0; i < numThreads; ++i) {
+        threads[i]->join();
+    }
+    int32_t numThreadStates = boost::static_pointer_cast<ThreadStatesIndexWriter>(writer)->getNumThreadStates();
+    writer->close();
+    IndexReaderPtr reader = IndexReader::open(dir, true);
+    EXPECT_EQ(numThreads, reader->numDocs());
+    reader->close();
+    dir->close();
+    return numThreadStates;
+}
+
+}
+
+TEST_F(IndexWriterTest, testMaxThreadStates) {
+    static const int32_t NUM_THREADS = 12;
+    static const int32_t NUM_DOCS = 300;
+    MockRAMDirectoryPtr dir = newLucene<MockRAMDirectory>();
+    IndexWriterPtr writer = newLucene<IndexWriter>(dir, newLucene<WhitespaceAnalyzer>(), IndexWriter::MaxFieldLengthUNLIMITED);
+    EXPECT_EQ(IndexWriter::DEFAULT_MAX_THREAD_STATES, writer->getMaxThreadStates());
+    try {
+        writer->setMaxThreadStates(0);
+    } catch (IllegalArgumentException& e) {
+        EXPECT_TRUE(check_exception(LuceneException::IllegalArgument)(e));
+    }
+
+    // more threads than the default, each with its own thread state, flushing by RAM usage
+    writer->setMaxThreadStates(NUM_THREADS);
+    EXPECT_EQ(NUM_THREADS, writer->getMaxThreadStates());
+    writer->setRAMBufferSizeMB(0.5);
+
+    Collection<LuceneThreadPtr> threads = Collection<LuceneThreadPtr>::newInstance(NUM_THREADS);
+    for (int32_t i = 0; i < NUM_THREADS; ++i) {
+        threads[i] = newLucene<TestMaxThreadStates::AddDocumentsThread>(writer, i, NUM_DOCS);
+        threads[i]->start();
+    }
+    for (int32_t i = 0; i < NUM_THREADS; ++i) {
+        threads[i]->join();
+    }
+    writer->close();
+
+    IndexReaderPtr reader = IndexReader::open(dir, true);
+    EXPECT_EQ(NUM_THREADS * NUM_DOCS, reader->numDocs());
+    for (int32_t i = 0; i < NUM_THREADS; ++i) {
+        EXPECT_EQ(NUM_DOCS, reader->docFreq(newLucene<Term>(L"content", L"thread" + StringUtils::toString(i))));
+        EXPECT_EQ(1, reader->docFreq(newLucene<Term>(L"id", StringUtils::toString(i) + L"_" + StringUtils::toString(NUM_DOCS - 1))));
+    }
+    reader->close();
+
+    checkIndex(dir);
+    dir->close();
+}
+
+TEST_F(IndexWriterTest, testThreadStatesInvertConcurrently) {
+    // each thread inverts with its own thread state, up to the maximum
+    EXPECT_EQ(8, TestMaxThreadStates::countThreadStates(8, 8));
+    EXPECT_EQ(3, TestMaxThreadStates::countThreadStates(8, 3));
+}
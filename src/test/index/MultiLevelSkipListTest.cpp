@@ -22,6 +22,8 @@
 #include "SegmentReader.h"
 #include "SegmentTermPositions.h"
 #include "IndexInput.h"
+#include "WhitespaceAnalyzer.h"
+#include "TermDocs.h"
 
 using namespace Lucene;
 
@@ -168,3 +170,52 @@ TEST_F(MultiLevelSkipListTest, testSimpleSkip) {
         checkSkipTo(tp, 4800, 250);// one skip on level 2
     }
 }
+
+TEST_F(MultiLevelSkipListTest, testBlockMaxFreq) {
+    DirectoryPtr dir = newLucene<RAMDirectory>();
+    IndexWriterPtr writer = newLucene<IndexWriter>(dir, newLucene<WhitespaceAnalyzer>(), true, IndexWriter::MaxFieldLengthLIMITED);
+    Collection<int32_t> freqs(Collection<int32_t>::newInstance(5000));
+    for (int32_t i = 0; i < freqs.size(); ++i) {
+        freqs[i] = i % 1000 == 500 ? 20 : 1 + (i * 7) % 5;
+        StringStream text;
+        for (int32_t j = 0; j < freqs[i]; ++j) {
+            text << L"a ";
+        }
+        DocumentPtr d1 = newLucene<Document>();
+        d1->add(newLucene<Field>(L"test", text.str(), Field::STORE_NO, Field::INDEX_ANALYZED));
+        writer->addDocument(d1);
+    }
+    writer->optimize();
+    writer->close();
+
+    IndexReaderPtr reader = SegmentReader::getOnlySegmentReader(dir);
+    TermDocsPtr td = reader->termDocs(newLucene<Term>(L"test", L"a"));
+    EXPECT_EQ(20, td->maxFreq());
+
+    int32_t skipInterval = 16;
+    for (int32_t target = 0; target < freqs.size(); target += 37) {
+        int32_t levels = td->advanceShallow(target);
+        if (target < freqs.size() - skipInterval) {
+            EXPECT_TRUE(levels > 0);
+        }
+        for (int32_t level = 0; level < levels; ++level) {
+            int32_t end = td->blockEnd(level);
+            EXPECT_TRUE(end >= target);
+            EXPECT_TRUE(end < freqs.size());
+            // every document of the block has at most the highest frequency, and all documents hold the term
+            int32_t start = std::max(0, end + 1 - (int32_t)std::pow((double)skipInterval, level + 1));
+            int32_t expected = *std::max_element(freqs.begin() + start, freqs.begin() + end + 1);
+            EXPECT_EQ(expected, td->blockMaxFreq(level));
+        }
+    }
+
+    // shallow advancing doesn't move the enumeration
+    td->seek(newLucene<Term>(L"test", L"a"));
+    td->advanceShallow(3000);
+    EXPECT_TRUE(td->skipTo(1234));
+    EXPECT_EQ(1234, td->doc());
+    EXPECT_EQ(freqs[1234], td->freq());
+    EXPECT_TRUE(td->next());
+    EXPECT_EQ(1235, td->doc());
+    reader->close();
+}
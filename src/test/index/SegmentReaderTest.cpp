@@ -155,6 +155,23 @@ TEST_F(SegmentReaderTest, testNorms) {
     }
 }
 
+TEST_F(SegmentReaderTest, testMaxNorm) {
+    EXPECT_EQ(reader->norms(DocHelper::TEXT_FIELD_1_KEY)[0], reader->maxNorm(DocHelper::TEXT_FIELD_1_KEY));
+    EXPECT_EQ(0, reader->maxNorm(DocHelper::NO_NORMS_KEY));
+    EXPECT_EQ(0, reader->maxNorm(L"missing"));
+
+    // changing a norm drops the cached maximum
+    DocumentPtr doc = newLucene<Document>();
+    DocHelper::setupDoc(doc);
+    SegmentInfoPtr info = DocHelper::writeDoc(dir, doc);
+    SegmentReaderPtr normsReader = SegmentReader::get(false, info, IndexReader::DEFAULT_TERMS_INDEX_DIVISOR);
+    uint8_t maxNorm = normsReader->maxNorm(DocHelper::TEXT_FIELD_1_KEY);
+    EXPECT_TRUE(maxNorm < 255);
+    normsReader->setNorm(0, DocHelper::TEXT_FIELD_1_KEY, (uint8_t)255);
+    EXPECT_EQ(255, normsReader->maxNorm(DocHelper::TEXT_FIELD_1_KEY));
+    normsReader->close();
+}
+
 TEST_F(SegmentReaderTest, testTermVectors) {
     TermFreqVectorPtr result = reader->getTermFreqVector(0, DocHelper::TEXT_FIELD_2_KEY);
     EXPECT_TRUE(result);
@@ -227,6 +227,58 @@ TEST_F(SegmentTermDocsTest, testSkipTo) {
     checkSkipTo(1);
 }
 
+TEST_F(SegmentTermDocsTest, testBulkRead) {
+    DirectoryPtr dir = newLucene<RAMDirectory>();
+    IndexWriterPtr writer = newLucene<IndexWriter>(dir, newLucene<WhitespaceAnalyzer>(), true, IndexWriter::MaxFieldLengthLIMITED);
+    for (int32_t i = 0; i < 1000; ++i) {
+        String content = L"aaa";
+        for (int32_t j = 0; j < i % 7; ++j) {
+            content += L" aaa";
+        }
+        if (i % 3 == 0) {
+            content += L" bbb";
+        }
+        DocumentPtr doc = newLucene<Document>();
+        doc->add(newLucene<Field>(L"content", content, Field::STORE_NO, Field::INDEX_ANALYZED));
+        FieldPtr noTf = newLucene<Field>(L"notf", content, Field::STORE_NO, Field::INDEX_ANALYZED);
+        noTf->setOmitTermFreqAndPositions(true);
+        doc->add(noTf);
+        writer->addDocument(doc);
+    }
+    writer->close();
+
+    IndexReaderPtr reader = IndexReader::open(dir, false);
+    reader->deleteDocument(5);
+    reader->deleteDocument(500);
+    reader->deleteDocument(999);
+
+    Collection<TermPtr> terms = newCollection<TermPtr>(newLucene<Term>(L"content", L"aaa"), newLucene<Term>(L"content", L"bbb"), newLucene<Term>(L"notf", L"aaa"));
+    for (int32_t t = 0; t < terms.size(); ++t) {
+        TermDocsPtr expected = reader->termDocs(terms[t]);
+        TermDocsPtr actual = reader->termDocs(terms[t]);
+        Collection<int32_t> docs = Collection<int32_t>::newInstance(61);
+        Collection<int32_t> freqs = Collection<int32_t>::newInstance(61);
+        int32_t total = 0;
+        while (true) {
+            int32_t n = actual->read(docs, freqs);
+            if (n == 0) {
+                break;
+            }
+            for (int32_t i = 0; i < n; ++i) {
+                EXPECT_TRUE(expected->next());
+                EXPECT_EQ(expected->doc(), docs[i]);
+                EXPECT_EQ(expected->freq(), freqs[i]);
+            }
+            total += n;
+        }
+        EXPECT_TRUE(!expected->next());
+        EXPECT_EQ(t == 1 ? 333 : 997, total);
+        expected->close();
+        actual->close();
+    }
+    reader->close();
+}
+
 TEST_F(SegmentTermDocsTest, testIndexDivisor) {
     dir = newLucene<MockRAMDirectory>();
     testDoc = newLucene<Document>();
@@ -0,0 +1,281 @@
+/////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2009-2014 Alan Wright. All rights reserved.
+// Distributable under the terms of either the Apache License (Version 2.0)
+// or the GNU Lesser General Public License.
+/////////////////////////////////////////////////////////////////////////////
+
+#include "TestInc.h"
+#include "LuceneTestFixture.h"
+#include "RAMDirectory.h"
+#include "IndexWriter.h"
+#include "IndexReader.h"
+#include "SegmentReader.h"
+#include "SegmentInfo.h"
+#include "SortingMergePolicy.h"
+#include "LogDocMergePolicy.h"
+#include "WhitespaceAnalyzer.h"
+#include "Document.h"
+#include "Field.h"
+#include "DocValuesField.h"
+#include "FieldCache.h"
+#include "PackedInts.h"
+#include "TermDocs.h"
+#include "TermPositions.h"
+#include "TermFreqVector.h"
+#include "IndexSearcher.h"
+#include "MatchAllDocsQuery.h"
+#include "TermQuery.h"
+#include "TopFieldCollector.h"
+#include "TopFieldDocs.h"
+#include "ScoreDoc.h"
+#include "Sort.h"
+#include "SortField.h"
+#include "Term.h"
+
+using namespace Lucene;
+
+typedef LuceneTestFixture SortingMergePolicyTest;
+
+static const int32_t NUM_DOCS = 300;
+
+/// Timestamps are distinct and unrelated to the order the documents are added in.
+static int32_t timestamp(int32_t id) {
+    return id * 7919 % 1009;
+}
+
+static SortPtr timestampSort() {
+    return newLucene<Sort>(newLucene<SortField>(L"timestamp", SortField::INT, true));
+}
+
+static DocumentPtr createDocument(int32_t id) {
+    DocumentPtr doc = newLucene<Document>();
+    doc->add(newLucene<Field>(L"id", StringUtils::toString(id), Field::STORE_YES, Field::INDEX_NOT_ANALYZED));
+    doc->add(newLucene<Field>(L"timestamp", StringUtils::toString(timestamp(id)), Field::STORE_NO, Field::INDEX_NOT_ANALYZED));
+    String text(L"all");
+    for (int32_t i = 0; i <= id % 4; ++i) {
+        text += L" w" + StringUtils::toString(id % 5) + L" x" + StringUtils::toString(i);
+    }
+    FieldPtr field = newLucene<Field>(L"text", text, Field::STORE_YES, Field::INDEX_ANALYZED, Field::TERM_VECTOR_WITH_POSITIONS_OFFSETS);
+    field->setBoost(1.0 + (double)(id % 3));
+    doc->add(field);
+    doc->add(newLucene<DocValuesField>(L"price", (int64_t)id * 3 - 100));
+    return doc;
+}
+
+/// Index NUM_DOCS documents in three segments, deleting every seventh document.
+static RAMDirectoryPtr createIndex(bool sorted, bool optimize) {
+    RAMDirectoryPtr dir = newLucene<RAMDirectory>();
+    IndexWriterPtr writer = newLucene<IndexWriter>(dir, newLucene<WhitespaceAnalyzer>(), true, IndexWriter::MaxFieldLengthLIMITED);
+    LogDocMergePolicyPtr mergePolicy = newLucene<LogDocMergePolicy>(writer);
+    mergePolicy->setMergeFactor(1000);
+    if (sorted) {
+        writer->setMergePolicy(newLucene<SortingMergePolicy>(writer, mergePolicy, timestampSort()));
+    } else {
+        writer->setMergePolicy(mergePolicy);
+    }
+    for (int32_t i = 0; i < NUM_DOCS; ++i) {
+        writer->addDocument(createDocument(i));
+        if (i % 100 == 99) {
+            writer->commit();
+        }
+    }
+    for (int32_t i = 0; i < NUM_DOCS; i += 7) {
+        writer->deleteDocuments(newLucene<Term>(L"id", StringUtils::toString(i)));
+    }
+    if (optimize) {
+        writer->optimize();
+    }
+    writer->close();
+    return dir;
+}
+
+static SegmentInfoPtr segmentInfo(const IndexReaderPtr& reader) {
+    Collection<IndexReaderPtr> segments(reader->getSequentialSubReaders());
+    EXPECT_EQ(1, segments.size());
+    return boost::dynamic_pointer_cast<SegmentReader>(segments[0])->getSegmentInfo();
+}
+
+/// Returns the document of each id.
+static Collection<int32_t> documentsById(const IndexReaderPtr& reader) {
+    Collection<int32_t> docs(Collection<int32_t>::newInstance(NUM_DOCS));
+    for (int32_t i = 0; i < NUM_DOCS; ++i) {
+        docs[i] = -1;
+    }
+    for (int32_t doc = 0; doc < reader->maxDoc(); ++doc) {
+        if (!reader->isDeleted(doc)) {
+            docs[StringUtils::toInt(reader->document(doc)->get(L"id"))] = doc;
+        }
+    }
+    return docs;
+}
+
+static void checkSameDocuments(const IndexReaderPtr& expected, const IndexReaderPtr& actual) {
+    EXPECT_EQ(expected->numDocs(), actual->numDocs());
+    Collection<int32_t> expectedDocs(documentsById(expected));
+    Collection<int32_t> actualDocs(documentsById(actual));
+    ByteArray expectedNorms(expected->norms(L"text"));
+    ByteArray actualNorms(actual->norms(L"text"));
+    PackedValuesPtr expectedPrices(expected->getSequentialSubReaders()[0]->getNumericDocValues(L"price"));
+    PackedValuesPtr actualPrices(actual->getSequentialSubReaders()[0]->getNumericDocValues(L"price"));
+    for (int32_t id = 0; id < NUM_DOCS; ++id) {
+        EXPECT_EQ(expectedDocs[id] == -1, actualDocs[id] == -1);
+        if (expectedDocs[id] == -1) {
+            continue;
+        }
+        int32_t expectedDoc = expectedDocs[id];
+        int32_t actualDoc = actualDocs[id];
+        EXPECT_EQ(expected->document(expectedDoc)->get(L"text"), actual->document(actualDoc)->get(L"text"));
+        EXPECT_EQ(expectedNorms[expectedDoc], actualNorms[actualDoc]);
+        EXPECT_EQ(expectedPrices->get(expectedDoc), actualPrices->get(actualDoc));
+
+        TermFreqVectorPtr expectedVector(expected->getTermFreqVector(expectedDoc, L"text"));
+        TermFreqVectorPtr actualVector(actual->getTermFreqVector(actualDoc, L"text"));
+        EXPECT_TRUE(expectedVector->getTerms().equals(actualVector->getTerms()));
+        EXPECT_TRUE(expectedVector->getTermFrequencies().equals(actualVector->getTermFrequencies()));
+    }
+
+    // every posting maps to the same document, in increasing document order
+    Collection<String> terms(newCollection<String>(L"all", L"w0", L"w3", L"x0", L"x3"));
+    for (Collection<String>::iterator term = terms.begin(); term != terms.end(); ++term) {
+        TermPositionsPtr expectedPositions(expected->termPositions(newLucene<Term>(L"text", *term)));
+        TermPositionsPtr actualPositions(actual->termPositions(newLucene<Term>(L"text", *term)));
+        Collection<int32_t> expectedIds(Collection<int32_t>::newInstance());
+        Collection<int32_t> actualIds(Collection<int32_t>::newInstance());
+        HashMap<int32_t, Collection<int32_t> > positions(HashMap<int32_t, Collection<int32_t> >::newInstance());
+        while (expectedPositions->next()) {
+            int32_t id = StringUtils::toInt(expected->document(expectedPositions->doc())->get(L"id"));
+            Collection<int32_t> docPositions(Collection<int32_t>::newInstance());
+            for (int32_t i = 0; i < expectedPositions->freq(); ++i) {
+                docPositions.add(expectedPositions->nextPosition());
+            }
+            positions.put(id, docPositions);
+            expectedIds.add(id);
+        }
+        int32_t lastDoc = -1;
+        while (actualPositions->next()) {
+            EXPECT_TRUE(actualPositions->doc() > lastDoc);
+            lastDoc = actualPositions->doc();
+            int32_t id = StringUtils::toInt(actual->document(actualPositions->doc())->get(L"id"));
+            Collection<int32_t> docPositions(positions.get(id));
+            EXPECT_EQ(docPositions.size(), actualPositions->freq());
+            for (int32_t i = 0; i < actualPositions->freq(); ++i) {
+                EXPECT_EQ(docPositions[i], actualPositions->nextPosition());
+            }
+            actualIds.add(id);
+        }
+        std::sort(expectedIds.begin(), expectedIds.end());
+        std::sort(actualIds.begin(), actualIds.end());
+        EXPECT_TRUE(expectedIds.equals(actualIds));
+    }
+}
+
+TEST_F(SortingMergePolicyTest, testMergedSegmentIsSorted) {
+    RAMDirectoryPtr dir = createIndex(true, true);
+    IndexReaderPtr reader = IndexReader::open(dir, true);
+    EXPECT_EQ(NUM_DOCS - (NUM_DOCS + 6) / 7, reader->maxDoc());
+    EXPECT_TRUE(!reader->hasDeletions());
+
+    SortPtr indexSort(segmentInfo(reader)->getIndexSort());
+    EXPECT_TRUE(indexSort);
+    EXPECT_TRUE(indexSort->getSort().equals(timestampSort()->getSort(), luceneEquals<SortFieldPtr>()));
+
+    int32_t last = INT_MAX;
+    for (int32_t doc = 0; doc < reader->maxDoc(); ++doc) {
+        int32_t id = StringUtils::toInt(reader->document(doc)->get(L"id"));
+        EXPECT_NE(0, id % 7);
+        EXPECT_TRUE(timestamp(id) < last);
+        last = timestamp(id);
+    }
+
+    IndexReaderPtr unsorted = IndexReader::open(createIndex(false, true), true);
+    EXPECT_TRUE(!segmentInfo(unsorted)->getIndexSort());
+    checkSameDocuments(unsorted, reader);
+    unsorted->close();
+    reader->close();
+}
+
+TEST_F(SortingMergePolicyTest, testSortSurvivesMergeWithDifferentPolicy) {
+    RAMDirectoryPtr dir = createIndex(true, true);
+
+    // a writer that doesn't sort keeps the recorded sort of the segments it leaves alone
+    IndexWriterPtr writer = newLucene<IndexWriter>(dir, newLucene<WhitespaceAnalyzer>(), false, IndexWriter::MaxFieldLengthLIMITED);
+    writer->commit();
+    writer->close();
+    IndexReaderPtr reader = IndexReader::open(dir, true);
+    EXPECT_TRUE(segmentInfo(reader)->getIndexSort());
+    reader->close();
+
+    // but a segment it rewrites is no longer sorted
+    writer = newLucene<IndexWriter>(dir, newLucene<WhitespaceAnalyzer>(), false, IndexWriter::MaxFieldLengthLIMITED);
+    writer->addDocument(createDocument(NUM_DOCS));
+    writer->optimize();
+    writer->close();
+    reader = IndexReader::open(dir, true);
+    EXPECT_TRUE(!segmentInfo(reader)->getIndexSort());
+    reader->close();
+}
+
+TEST_F(SortingMergePolicyTest, testOptimizeSortsSingleSegment) {
+    RAMDirectoryPtr dir = newLucene<RAMDirectory>();
+    IndexWriterPtr writer = newLucene<IndexWriter>(dir, newLucene<WhitespaceAnalyzer>(), true, IndexWriter::MaxFieldLengthLIMITED);
+    for (int32_t i = 0; i < NUM_DOCS; ++i) {
+        writer->addDocument(createDocument(i));
+    }
+    writer->close();
+
+    writer = newLucene<IndexWriter>(dir, newLucene<WhitespaceAnalyzer>(), false, IndexWriter::MaxFieldLengthLIMITED);
+    SortingMergePolicyPtr mergePolicy = newLucene<SortingMergePolicy>(writer, newLucene<LogDocMergePolicy>(writer), timestampSort());
+    writer->setMergePolicy(mergePolicy);
+    writer->optimize();
+    writer->close();
+
+    IndexReaderPtr reader = IndexReader::open(dir, true);
+    EXPECT_EQ(NUM_DOCS, reader->maxDoc());
+    EXPECT_TRUE(mergePolicy->isSorted(segmentInfo(reader)));
+    Collection<int32_t> timestamps(FieldCache::DEFAULT()->getInts(reader->getSequentialSubReaders()[0], L"timestamp"));
+    for (int32_t doc = 1; doc < reader->maxDoc(); ++doc) {
+        EXPECT_TRUE(timestamps[doc - 1] > timestamps[doc]);
+    }
+    reader->close();
+}
+
+TEST_F(SortingMergePolicyTest, testInvalidSort) {
+    RAMDirectoryPtr dir = newLucene<RAMDirectory>();
+    IndexWriterPtr writer = newLucene<IndexWriter>(dir, newLucene<WhitespaceAnalyzer>(), true, IndexWriter::MaxFieldLengthLIMITED);
+    try {
+        newLucene<SortingMergePolicy>(writer, newLucene<LogDocMergePolicy>(writer), Sort::RELEVANCE());
+    } catch (IllegalArgumentException& e) {
+        EXPECT_TRUE(check_exception(LuceneException::IllegalArgument)(e));
+    }
+    try {
+        newLucene<SortingMergePolicy>(writer, newLucene<LogDocMergePolicy>(writer), newLucene<Sort>());
+    } catch (IllegalArgumentException& e) {
+        EXPECT_TRUE(check_exception(LuceneException::IllegalArgument)(e));
+    }
+    writer->close();
+}
+
+TEST_F(SortingMergePolicyTest, testEarlyTermination) {
+    RAMDirectoryPtr dir = createIndex(true, true);
+    IndexSearcherPtr searcher = newLucene<IndexSearcher>(dir, true);
+    SortPtr sort(timestampSort());
+
+    TopFieldDocsPtr full(searcher->search(newLucene<MatchAllDocsQuery>(), FilterPtr(), 10, sort));
+    searcher->setTrackTotalHits(false);
+    TopFieldDocsPtr early(searcher->search(newLucene<MatchAllDocsQuery>(), FilterPtr(), 10, sort));
+
+    EXPECT_EQ(searcher->maxDoc(), full->totalHits);
+    EXPECT_TRUE(early->totalHits < full->totalHits / 10);
+    EXPECT_EQ(full->scoreDocs.size(), early->scoreDocs.size());
+    for (int32_t i = 0; i < full->scoreDocs.size(); ++i) {
+        EXPECT_EQ(full->scoreDocs[i]->doc, early->scoreDocs[i]->doc);
+    }
+
+    // a sort that isn't a prefix of the index sort collects every document
+    SortPtr ascending(newLucene<Sort>(newLucene<SortField>(L"timestamp", SortField::INT)));
+    TopFieldDocsPtr unsorted(searcher->search(newLucene<TermQuery>(newLucene<Term>(L"text", L"w1")), FilterPtr(), 10, ascending));
+    TopFieldCollectorPtr collector(TopFieldCollector::create(ascending, 10, true, false, false, true));
+    searcher->search(newLucene<TermQuery>(newLucene<Term>(L"text", L"w1")), collector);
+    EXPECT_EQ(collector->getTotalHits(), unsorted->totalHits);
+    searcher->close();
+}
@@ -0,0 +1,113 @@
+/////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2009-2014 Alan Wright. All rights reserved.
+// Distributable under the terms of either the Apache License (Version 2.0)
+// or the GNU Lesser General Public License.
+/////////////////////////////////////////////////////////////////////////////
+
+#include "TestInc.h"
+#include "LuceneTestFixture.h"
+#include "TestUtils.h"
+#include "IndexWriter.h"
+#include "MockRAMDirectory.h"
+#include "WhitespaceAnalyzer.h"
+#include "Document.h"
+#include "Field.h"
+#include "IndexReader.h"
+#include "TermEnum.h"
+#include "Term.h"
+#include "Random.h"
+
+using namespace Lucene;
+
+class TermInfosReaderIndexTest : public LuceneTestFixture {
+public:
+    TermInfosReaderIndexTest() {
+        random = newLucene<Random>(1234);
+        dir = newLucene<MockRAMDirectory>();
+        IndexWriterPtr writer = newLucene<IndexWriter>(dir, newLucene<WhitespaceAnalyzer>(), true, IndexWriter::MaxFieldLengthLIMITED);
+        writer->setTermIndexInterval(4);
+        for (int32_t i = 0; i < 300; ++i) {
+            DocumentPtr doc = newLucene<Document>();
+            doc->add(newLucene<Field>(L"body", randomText(), Field::STORE_NO, Field::INDEX_ANALYZED));
+            doc->add(newLucene<Field>(L"aid", L"id" + StringUtils::toString(i % 97), Field::STORE_NO, Field::INDEX_NOT_ANALYZED));
+            doc->add(newLucene<Field>(L"title", randomText(), Field::STORE_NO, Field::INDEX_ANALYZED));
+            writer->addDocument(doc);
+        }
+        writer->optimize();
+        writer->close();
+    }
+
+    virtual ~TermInfosReaderIndexTest() {
+    }
+
+protected:
+    RandomPtr random;
+    DirectoryPtr dir;
+
+public:
+    String randomText() {
+        // include characters that need multi-byte UTF-8 encoding
+        static const wchar_t* alphabet = L"abcdefgh\x00e9\x00fc\x4e2d\x6587";
+        StringStream buffer;
+        int32_t numTerms = 1 + random->nextInt(5);
+        for (int32_t i = 0; i < numTerms; ++i) {
+            int32_t length = 1 + random->nextInt(6);
+            for (int32_t j = 0; j < length; ++j) {
+                buffer << alphabet[random->nextInt(12)];
+            }
+            buffer << L" ";
+        }
+        return buffer.str();
+    }
+
+    void checkAllTerms(const IndexReaderPtr& reader) {
+        Collection<TermPtr> terms = Collection<TermPtr>::newInstance();
+        Collection<int32_t> docFreqs = Collection<int32_t>::newInstance();
+        TermEnumPtr termEnum = reader->terms();
+        while (termEnum->next()) {
+            terms.add(termEnum->term());
+            docFreqs.add(termEnum->docFreq());
+        }
+        termEnum->close();
+        EXPECT_TRUE(terms.size() > 100);
+
+        // random access lookups of every term
+        for (int32_t i = 0; i < terms.size(); ++i) {
+            int32_t index = random->nextInt(terms.size());
+            EXPECT_EQ(docFreqs[index], reader->docFreq(terms[index]));
+        }
+
+        // seek to every term and to a missing term just after it
+        for (int32_t i = 0; i < terms.size(); ++i) {
+            TermEnumPtr seekEnum = reader->terms(terms[i]);
+            EXPECT_TRUE(seekEnum->term()->equals(terms[i]));
+            seekEnum->close();
+
+            TermPtr missing = newLucene<Term>(terms[i]->field(), terms[i]->text() + L"\x0001");
+            EXPECT_EQ(0, reader->docFreq(missing));
+            seekEnum = reader->terms(missing);
+            if (i + 1 < terms.size()) {
+                EXPECT_TRUE(seekEnum->term()->equals(terms[i + 1]));
+            } else {
+                EXPECT_TRUE(!seekEnum->term());
+            }
+            seekEnum->close();
+        }
+
+        // terms before the first and after the last index entries
+        EXPECT_EQ(0, reader->docFreq(newLucene<Term>(L"", L"")));
+        EXPECT_EQ(0, reader->docFreq(newLucene<Term>(L"zzz", L"zzz")));
+    }
+};
+
+TEST_F(TermInfosReaderIndexTest, testLookups) {
+    IndexReaderPtr reader = IndexReader::open(dir, true);
+    checkAllTerms(reader);
+    reader->close();
+}
+
+TEST_F(TermInfosReaderIndexTest, testLookupsWithIndexDivisor) {
+    IndexReaderPtr reader = IndexReader::open(dir, IndexDeletionPolicyPtr(), true, 3);
+    checkAllTerms(reader);
+    reader->close();
+}
@@ -0,0 +1,234 @@
+/////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2009-2014 Alan Wright. All rights reserved.
+// Distributable under the terms of either the Apache License (Version 2.0)
+// or the GNU Lesser General Public License.
+/////////////////////////////////////////////////////////////////////////////
+
+#include "TestInc.h"
+#include "LuceneTestFixture.h"
+#include "TestUtils.h"
+#include "TieredMergePolicy.h"
+#include "IndexWriter.h"
+#include "IndexReader.h"
+#include "TermDocs.h"
+#include "RAMDirectory.h"
+#include "WhitespaceAnalyzer.h"
+#include "SerialMergeScheduler.h"
+#include "Document.h"
+#include "Field.h"
+#include "Term.h"
+
+using namespace Lucene;
+
+typedef LuceneTestFixture TieredMergePolicyTest;
+
+static DocumentPtr createDocument(int32_t id, int32_t numWords) {
+    DocumentPtr doc = newLucene<Document>();
+    doc->add(newLucene<Field>(L"id", StringUtils::toString(id), Field::STORE_YES, Field::INDEX_NOT_ANALYZED));
+    String text(L"all");
+    for (int32_t i = 0; i < numWords; ++i) {
+        text += L" w" + StringUtils::toString(i);
+    }
+    doc->add(newLucene<Field>(L"text", text, Field::STORE_YES, Field::INDEX_ANALYZED));
+    return doc;
+}
+
+static IndexWriterPtr createWriter(const DirectoryPtr& dir, bool create) {
+    IndexWriterPtr writer = newLucene<IndexWriter>(dir, newLucene<WhitespaceAnalyzer>(), create, IndexWriter::MaxFieldLengthUNLIMITED);
+    TieredMergePolicyPtr mergePolicy = newLucene<TieredMergePolicy>(writer);
+    mergePolicy->setFloorSegmentMB(0.0001);
+    writer->setMergePolicy(mergePolicy);
+    writer->setMergeScheduler(newLucene<SerialMergeScheduler>());
+    writer->setMaxBufferedDocs(10);
+    return writer;
+}
+
+/// Each id is in the index exactly once, and its stored fields are its own.
+static void checkDocuments(const DirectoryPtr& dir, int32_t numDocs) {
+    IndexReaderPtr reader = IndexReader::open(dir, true);
+    EXPECT_EQ(numDocs, reader->numDocs());
+    for (int32_t id = 0; id < numDocs; ++id) {
+        // docFreq also counts deleted documents that are not merged away yet
+        TermDocsPtr termDocs = reader->termDocs(newLucene<Term>(L"id", StringUtils::toString(id)));
+        int32_t count = 0;
+        while (termDocs->next()) {
+            ++count;
+        }
+        termDocs->close();
+        EXPECT_EQ(1, count);
+    }
+    for (int32_t doc = 0; doc < reader->maxDoc(); ++doc) {
+        if (!reader->isDeleted(doc)) {
+            int32_t id = StringUtils::toInt(reader->document(doc)->get(L"id"));
+            EXPECT_TRUE(id >= 0 && id < numDocs);
+        }
+    }
+    reader->close();
+    EXPECT_TRUE(checkIndex(dir));
+}
+
+TEST_F(TieredMergePolicyTest, testNonAdjacentMerges) {
+    RAMDirectoryPtr dir = newLucene<RAMDirectory>();
+    IndexWriterPtr writer = createWriter(dir, true);
+    TieredMergePolicyPtr mergePolicy = boost::dynamic_pointer_cast<TieredMergePolicy>(writer->getMergePolicy());
+    mergePolicy->setMaxMergeAtOnce(4);
+    mergePolicy->setSegmentsPerTier(4.0);
+
+    // Every other flushed segment is much larger, so merges of similarly sized segments skip over the others
+    static const int32_t NUM_DOCS = 400;
+    for (int32_t id = 0; id < NUM_DOCS; ++id) {
+        writer->addDocument(createDocument(id, (id / 10) % 2 == 0 ? 1 : 200));
+    }
+    writer->commit();
+    EXPECT_LT(writer->getSegmentCount(), 20);
+    writer->close();
+
+    checkDocuments(dir, NUM_DOCS);
+
+    // The documents are no longer in the order they were added in
+    IndexReaderPtr reader = IndexReader::open(dir, true);
+    bool inOrder = true;
+    for (int32_t doc = 1; doc < reader->maxDoc() && inOrder; ++doc) {
+        inOrder = (StringUtils::toInt(reader->document(doc - 1)->get(L"id")) < StringUtils::toInt(reader->document(doc)->get(L"id")));
+    }
+    EXPECT_TRUE(!inOrder);
+    reader->close();
+}
+
+TEST_F(TieredMergePolicyTest, testUpdatesDuringMerges) {
+    RAMDirectoryPtr dir = newLucene<RAMDirectory>();
+    IndexWriterPtr writer = createWriter(dir, true);
+
+    // Buffered deletes must be renumbered when a merge moves the segments in between the merged ones
+    static const int32_t NUM_DOCS = 100;
+    for (int32_t id = 0; id < NUM_DOCS; ++id) {
+        writer->addDocument(createDocument(id, id % 20 < 10 ? 1 : 100));
+    }
+    for (int32_t i = 0; i < 1000; ++i) {
+        int32_t id = (i * 37) % NUM_DOCS;
+        writer->updateDocument(newLucene<Term>(L"id", StringUtils::toString(id)), createDocument(id, i % 20 < 10 ? 1 : 100));
+    }
+    writer->close();
+
+    checkDocuments(dir, NUM_DOCS);
+}
+
+TEST_F(TieredMergePolicyTest, testSegmentCountBounded) {
+    RAMDirectoryPtr dir = newLucene<RAMDirectory>();
+    IndexWriterPtr writer = createWriter(dir, true);
+    TieredMergePolicyPtr mergePolicy = boost::dynamic_pointer_cast<TieredMergePolicy>(writer->getMergePolicy());
+    mergePolicy->setMaxMergeAtOnce(4);
+    mergePolicy->setSegmentsPerTier(4.0);
+
+    int32_t maxSegmentCount = 0;
+    for (int32_t id = 0; id < 1000; ++id) {
+        writer->addDocument(createDocument(id, 1 + id % 7));
+        maxSegmentCount = std::max(maxSegmentCount, writer->getSegmentCount());
+    }
+    // 4 segments per tier, plus one tier that is about to be merged
+    EXPECT_TRUE(maxSegmentCount < 20);
+    writer->close();
+
+    checkDocuments(dir, 1000);
+}
+
+TEST_F(TieredMergePolicyTest, testExpungeDeletes) {
+    RAMDirectoryPtr dir = newLucene<RAMDirectory>();
+    IndexWriterPtr writer = createWriter(dir, true);
+    TieredMergePolicyPtr mergePolicy = boost::dynamic_pointer_cast<TieredMergePolicy>(writer->getMergePolicy());
+    mergePolicy->setMaxMergeAtOnce(50);
+    for (int32_t id = 0; id < 100; ++id) {
+        writer->addDocument(createDocument(id, 1));
+    }
+    writer->commit();
+    EXPECT_EQ(10, writer->getSegmentCount());
+
+    // Half of the first segment, and a tenth of the second one
+    for (int32_t id = 0; id < 5; ++id) {
+        writer->deleteDocuments(newLucene<Term>(L"id", StringUtils::toString(id)));
+    }
+    writer->deleteDocuments(newLucene<Term>(L"id", L"15"));
+    writer->commit();
+
+    IndexReaderPtr reader = IndexReader::open(dir, true);
+    EXPECT_EQ(6, reader->numDeletedDocs());
+    reader->close();
+
+    // Only the segment with more than 10% deletions is merged
+    writer->expungeDeletes();
+    writer->commit();
+    EXPECT_EQ(10, writer->getSegmentCount());
+    reader = IndexReader::open(dir, true);
+    EXPECT_EQ(1, reader->numDeletedDocs());
+    EXPECT_EQ(94, reader->numDocs());
+    reader->close();
+
+    mergePolicy->setExpungeDeletesPctAllowed(0.0);
+    writer->expungeDeletes();
+    writer->close();
+    reader = IndexReader::open(dir, true);
+    EXPECT_TRUE(!reader->hasDeletions());
+    EXPECT_EQ(94, reader->numDocs());
+    reader->close();
+}
+
+TEST_F(TieredMergePolicyTest, testOptimize) {
+    RAMDirectoryPtr dir = newLucene<RAMDirectory>();
+    IndexWriterPtr writer = createWriter(dir, true);
+    TieredMergePolicyPtr mergePolicy = boost::dynamic_pointer_cast<TieredMergePolicy>(writer->getMergePolicy());
+    mergePolicy->setMaxMergeAtOnce(100);
+    mergePolicy->setMaxMergeAtOnceExplicit(5);
+    for (int32_t id = 0; id < 200; ++id) {
+        writer->addDocument(createDocument(id, 1 + id % 13));
+    }
+    writer->commit();
+    EXPECT_EQ(20, writer->getSegmentCount());
+
+    writer->optimize(3);
+    EXPECT_TRUE(writer->getSegmentCount() <= 3);
+
+    writer->deleteDocuments(newLucene<Term>(L"id", L"7"));
+    writer->optimize();
+    EXPECT_EQ(1, writer->getSegmentCount());
+    writer->close();
+
+    IndexReaderPtr reader = IndexReader::open(dir, true);
+    EXPECT_EQ(199, reader->maxDoc());
+    EXPECT_TRUE(!reader->hasDeletions());
+    reader->close();
+}
+
+TEST_F(TieredMergePolicyTest, testSettings) {
+    RAMDirectoryPtr dir = newLucene<RAMDirectory>();
+    IndexWriterPtr writer = newLucene<IndexWriter>(dir, newLucene<WhitespaceAnalyzer>(), true, IndexWriter::MaxFieldLengthUNLIMITED);
+    TieredMergePolicyPtr mergePolicy = newLucene<TieredMergePolicy>(writer);
+    EXPECT_EQ(10, mergePolicy->getMaxMergeAtOnce());
+    EXPECT_EQ(30, mergePolicy->getMaxMergeAtOnceExplicit());
+    EXPECT_EQ(5.0 * 1024.0, mergePolicy->getMaxMergedSegmentMB());
+    EXPECT_EQ(2.0, mergePolicy->getFloorSegmentMB());
+    EXPECT_EQ(10.0, mergePolicy->getSegmentsPerTier());
+    EXPECT_EQ(10.0, mergePolicy->getExpungeDeletesPctAllowed());
+    EXPECT_EQ(2.0, mergePolicy->getReclaimDeletesWeight());
+
+    try {
+        mergePolicy->setMaxMergeAtOnce(1);
+    } catch (IllegalArgumentException& e) {
+        EXPECT_TRUE(check_exception(LuceneException::IllegalArgument)(e));
+    }
+    try {
+        mergePolicy->setSegmentsPerTier(1.5);
+    } catch (IllegalArgumentException& e) {
+        EXPECT_TRUE(check_exception(LuceneException::IllegalArgument)(e));
+    }
+    try {
+        mergePolicy->setExpungeDeletesPctAllowed(101.0);
+    } catch (IllegalArgumentException& e) {
+        EXPECT_TRUE(check_exception(LuceneException::IllegalArgument)(e));
+    }
+    try {
+        mergePolicy->setFloorSegmentMB(0.0);
+    } catch (IllegalArgumentException& e) {
+        EXPECT_TRUE(check_exception(LuceneException::IllegalArgument)(e));
+    }
+    writer->close();
+}
@@ -19,6 +19,7 @@
 #include "TopDocs.h"
 #include "Similarity.h"
 #include "BooleanScorer.h"
+#include "Collector.h"
 
 using namespace Lucene;
 
@@ -99,3 +100,113 @@ TEST_F(BooleanScorerTest, testEmptyBucketWithMoreDocs) {
     EXPECT_EQ(3000, bs->nextDoc());
     EXPECT_EQ(DocIdSetIterator::NO_MORE_DOCS, bs->nextDoc());
 }
+
+namespace TestBulkScoring {
+
+DECLARE_SHARED_PTR(ScoresCollector)
+
+class ScoresCollector : public Collector {
+public:
+    ScoresCollector(bool outOfOrder) {
+        this->outOfOrder = outOfOrder;
+        this->scores = MapIntDouble::newInstance();
+        this->docBase = 0;
+    }
+
+    virtual ~ScoresCollector() {
+    }
+
+public:
+    bool outOfOrder;
+    MapIntDouble scores;
+    int32_t docBase;
+    ScorerPtr scorer;
+
+public:
+    virtual void setScorer(const ScorerPtr& scorer) {
+        this->scorer = scorer;
+    }
+
+    virtual void collect(int32_t doc) {
+        EXPECT_TRUE(!scores.contains(docBase + doc));
+        scores.put(docBase + doc, scorer->score());
+    }
+
+    virtual void setNextReader(const IndexReaderPtr& reader, int32_t docBase) {
+        this->docBase = docBase;
+    }
+
+    virtual bool acceptsDocsOutOfOrder() {
+        return outOfOrder;
+    }
+};
+
+}
+
+/// Compares out of order scoring, through BooleanScorer, with in order scoring, over enough documents for
+/// several windows of the bucket table.
+static void checkBulkScoring(bool optimize) {
+    RAMDirectoryPtr directory = newLucene<RAMDirectory>();
+    IndexWriterPtr writer = newLucene<IndexWriter>(directory, newLucene<WhitespaceAnalyzer>(), true, IndexWriter::MaxFieldLengthLIMITED);
+    writer->setMaxBufferedDocs(5000);
+    writer->setMergeFactor(1000);
+    for (int32_t i = 0; i < 20000; ++i) {
+        StringStream text;
+        for (int32_t j = 2; j < 8; ++j) {
+            for (int32_t k = 0; k < i % j; ++k) {
+                text << L"t" << j << L" ";
+            }
+        }
+        DocumentPtr doc = newLucene<Document>();
+        doc->add(newLucene<Field>(L"field", text.str(), Field::STORE_NO, Field::INDEX_ANALYZED));
+        writer->addDocument(doc);
+    }
+    if (optimize) {
+        writer->optimize();
+    }
+    writer->close();
+
+    BooleanQueryPtr nested = newLucene<BooleanQuery>();
+    nested->add(newLucene<TermQuery>(newLucene<Term>(L"field", L"t6")), BooleanClause::MUST);
+    nested->add(newLucene<TermQuery>(newLucene<Term>(L"field", L"t7")), BooleanClause::MUST);
+
+    Collection<BooleanQueryPtr> queries = Collection<BooleanQueryPtr>::newInstance();
+    for (int32_t i = 0; i < 3; ++i) {
+        BooleanQueryPtr query = newLucene<BooleanQuery>();
+        query->add(newLucene<TermQuery>(newLucene<Term>(L"field", L"t2")), BooleanClause::SHOULD);
+        query->add(newLucene<TermQuery>(newLucene<Term>(L"field", L"t3")), BooleanClause::SHOULD);
+        query->add(newLucene<TermQuery>(newLucene<Term>(L"field", L"t5")), BooleanClause::SHOULD);
+        query->add(nested, BooleanClause::SHOULD);
+        if (i == 1) {
+            query->add(newLucene<TermQuery>(newLucene<Term>(L"field", L"t4")), BooleanClause::MUST_NOT);
+        } else if (i == 2) {
+            query->setMinimumNumberShouldMatch(2);
+        }
+        queries.add(query);
+    }
+
+    IndexSearcherPtr searcher = newLucene<IndexSearcher>(directory, true);
+    for (Collection<BooleanQueryPtr>::iterator query = queries.begin(); query != queries.end(); ++query) {
+        TestBulkScoring::ScoresCollectorPtr inOrder = newLucene<TestBulkScoring::ScoresCollector>(false);
+        TestBulkScoring::ScoresCollectorPtr outOfOrder = newLucene<TestBulkScoring::ScoresCollector>(true);
+        searcher->search(*query, inOrder);
+        searcher->search(*query, outOfOrder);
+        EXPECT_TRUE(inOrder->scores.size() > 4000);
+        EXPECT_EQ(inOrder->scores.size(), outOfOrder->scores.size());
+        for (MapIntDouble::iterator score = inOrder->scores.begin(); score != inOrder->scores.end(); ++score) {
+            EXPECT_TRUE(outOfOrder->scores.contains(score->first));
+            EXPECT_NEAR(score->second, outOfOrder->scores.get(score->first), 1e-5);
+        }
+    }
+    searcher->close();
+}
+
+TEST_F(BooleanScorerTest, testBulkScoring) {
+    checkBulkScoring(true);
+}
+
+TEST_F(BooleanScorerTest, testBulkScoringSegments) {
+    // each segment's scorer reuses the bucket table of the previous one, so documents of one segment must
+    // not be mistaken for those of another with the same ids
+    checkBulkScoring(false);
+}
@@ -14,6 +14,7 @@
 #include "Field.h"
 #include "IndexReader.h"
 #include "FieldCache.h"
+#include "PackedInts.h"
 
 using namespace Lucene;
 
@@ -90,3 +91,109 @@ TEST_F(FieldCacheTest, testFieldCache) {
         EXPECT_EQ(ints[i], (INT_MAX - i));
     }
 }
+
+TEST_F(FieldCacheTest, testPackedValues) {
+    FieldCachePtr cache = FieldCache::DEFAULT();
+    PackedValuesPtr longs = cache->getPackedLongs(reader, L"theLong");
+    EXPECT_EQ(longs, cache->getPackedLongs(reader, L"theLong"));
+    EXPECT_EQ(longs, cache->getPackedLongs(reader, L"theLong", FieldCache::DEFAULT_LONG_PARSER()));
+    EXPECT_EQ(longs->size(), NUM_DOCS);
+    EXPECT_EQ(longs->getBitsPerValue(), PackedInts::bitsRequired(NUM_DOCS - 1));
+    Collection<int64_t> fullLongs = cache->getLongs(reader, L"theLong");
+    for (int32_t i = 0; i < NUM_DOCS; ++i) {
+        EXPECT_EQ(longs->get(i), fullLongs[i]);
+    }
+    EXPECT_TRUE(longs->ramBytesUsed() < NUM_DOCS * (int64_t)sizeof(int64_t) / 4);
+
+    PackedValuesPtr ints = cache->getPackedInts(reader, L"theInt");
+    EXPECT_EQ(ints, cache->getPackedInts(reader, L"theInt", FieldCache::DEFAULT_INT_PARSER()));
+    for (int32_t i = 0; i < NUM_DOCS; ++i) {
+        EXPECT_EQ(ints->get(i), (INT_MAX - i));
+    }
+}
+
+TEST_F(FieldCacheTest, testPackedValuesMissing) {
+    RAMDirectoryPtr directory = newLucene<RAMDirectory>();
+    IndexWriterPtr writer = newLucene<IndexWriter>(directory, newLucene<WhitespaceAnalyzer>(), true, IndexWriter::MaxFieldLengthLIMITED);
+    for (int32_t i = 0; i < 100; ++i) {
+        DocumentPtr doc = newLucene<Document>();
+        if (i % 2 == 0) {
+            doc->add(newLucene<Field>(L"sparse", StringUtils::toString(-1000 - i), Field::STORE_NO, Field::INDEX_NOT_ANALYZED));
+        }
+        writer->addDocument(doc);
+    }
+    writer->close();
+    IndexReaderPtr sparseReader = IndexReader::open(directory, true);
+    PackedValuesPtr values = FieldCache::DEFAULT()->getPackedInts(sparseReader, L"sparse");
+    for (int32_t i = 0; i < 100; ++i) {
+        EXPECT_EQ(values->get(i), i % 2 == 0 ? -1000 - i : 0);
+    }
+    PackedValuesPtr none = FieldCache::DEFAULT()->getPackedLongs(sparseReader, L"nosuchfield");
+    EXPECT_EQ(none->size(), 100);
+    EXPECT_EQ(none->get(50), 0);
+    sparseReader->close();
+}
+
+TEST_F(FieldCacheTest, testPackedValuesMultiValued) {
+    RAMDirectoryPtr directory = newLucene<RAMDirectory>();
+    IndexWriterPtr writer = newLucene<IndexWriter>(directory, newLucene<WhitespaceAnalyzer>(), true, IndexWriter::MaxFieldLengthLIMITED);
+    DocumentPtr doc = newLucene<Document>();
+    doc->add(newLucene<Field>(L"multi", L"-1000 -1001 -1002", Field::STORE_NO, Field::INDEX_ANALYZED));
+    writer->addDocument(doc);
+    writer->addDocument(newLucene<Document>());
+    doc = newLucene<Document>();
+    doc->add(newLucene<Field>(L"multi", L"-1003", Field::STORE_NO, Field::INDEX_ANALYZED));
+    writer->addDocument(doc);
+    writer->close();
+    IndexReaderPtr multiReader = IndexReader::open(directory, true);
+
+    // the terms have as many documents as the index, but the second document still has no value
+    PackedValuesPtr values = FieldCache::DEFAULT()->getPackedInts(multiReader, L"multi");
+    EXPECT_EQ(values->get(0), -1002); // the last of its terms
+    EXPECT_EQ(values->get(1), 0);
+    EXPECT_EQ(values->get(2), -1003);
+    multiReader->close();
+}
+
+TEST_F(FieldCacheTest, testPackedStringIndex) {
+    FieldCachePtr cache = FieldCache::DEFAULT();
+    StringIndexPtr stringIndex = cache->getStringIndex(reader, L"theInt");
+    PackedStringIndexPtr packedIndex = cache->getPackedStringIndex(reader, L"theInt");
+    EXPECT_EQ(packedIndex, cache->getPackedStringIndex(reader, L"theInt"));
+    EXPECT_EQ(packedIndex->size(), NUM_DOCS);
+    EXPECT_EQ(packedIndex->numOrds(), stringIndex->lookup.size());
+    for (int32_t i = 0; i < NUM_DOCS; ++i) {
+        EXPECT_EQ(packedIndex->getOrd(i), stringIndex->order[i]);
+    }
+    for (int32_t ord = 0; ord < packedIndex->numOrds(); ++ord) {
+        EXPECT_EQ(packedIndex->lookup(ord), stringIndex->lookup[ord]);
+        EXPECT_EQ(packedIndex->binarySearchLookup(stringIndex->lookup[ord]), ord);
+    }
+    EXPECT_EQ(packedIndex->binarySearchLookup(L"0"), stringIndex->binarySearchLookup(L"0"));
+    EXPECT_EQ(packedIndex->binarySearchLookup(L"zzz"), stringIndex->binarySearchLookup(L"zzz"));
+
+    PackedStringIndexPtr none = cache->getPackedStringIndex(reader, L"nosuchfield");
+    EXPECT_EQ(none->numOrds(), 1);
+    EXPECT_EQ(none->getOrd(0), 0);
+    EXPECT_EQ(none->lookup(0), L"");
+}
+
+TEST_F(FieldCacheTest, testPackedStringIndexMoreTermsThanDocs) {
+    RAMDirectoryPtr directory = newLucene<RAMDirectory>();
+    IndexWriterPtr writer = newLucene<IndexWriter>(directory, newLucene<WhitespaceAnalyzer>(), true, IndexWriter::MaxFieldLengthLIMITED);
+    DocumentPtr doc = newLucene<Document>();
+    doc->add(newLucene<Field>(L"tokens", L"a b c", Field::STORE_NO, Field::INDEX_ANALYZED));
+    writer->addDocument(doc);
+    doc = newLucene<Document>();
+    doc->add(newLucene<Field>(L"tokens", L"d e f", Field::STORE_NO, Field::INDEX_ANALYZED));
+    writer->addDocument(doc);
+    writer->close();
+    IndexReaderPtr multiReader = IndexReader::open(directory, true);
+
+    // every term gets an ordinal, and each document keeps the last of its terms
+    PackedStringIndexPtr packedIndex = FieldCache::DEFAULT()->getPackedStringIndex(multiReader, L"tokens");
+    EXPECT_EQ(packedIndex->numOrds(), 7);
+    EXPECT_EQ(packedIndex->lookup(packedIndex->getOrd(0)), L"c");
+    EXPECT_EQ(packedIndex->lookup(packedIndex->getOrd(1)), L"f");
+    multiReader->close();
+}
@@ -0,0 +1,113 @@
+/////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2009-2014 Alan Wright. All rights reserved.
+// Distributable under the terms of either the Apache License (Version 2.0)
+// or the GNU Lesser General Public License.
+/////////////////////////////////////////////////////////////////////////////
+
+#include "TestInc.h"
+#include "LuceneTestFixture.h"
+#include "RAMDirectory.h"
+#include "Document.h"
+#include "Field.h"
+#include "IndexWriter.h"
+#include "WhitespaceAnalyzer.h"
+#include "IndexSearcher.h"
+#include "IndexReader.h"
+#include "ThreadPool.h"
+#include "TermQuery.h"
+#include "Term.h"
+#include "TopDocs.h"
+#include "TopFieldDocs.h"
+#include "ScoreDoc.h"
+#include "Sort.h"
+#include "SortField.h"
+#include "MiscUtils.h"
+
+using namespace Lucene;
+
+typedef LuceneTestFixture IndexSearcherTest;
+
+static RAMDirectoryPtr createIndex(int32_t numSegments, int32_t docsPerSegment) {
+    RAMDirectoryPtr dir = newLucene<RAMDirectory>();
+    IndexWriterPtr writer = newLucene<IndexWriter>(dir, newLucene<WhitespaceAnalyzer>(), true, IndexWriter::MaxFieldLengthLIMITED);
+    writer->setMergeFactor(1000);
+    for (int32_t i = 0; i < numSegments; ++i) {
+        for (int32_t j = 0; j < docsPerSegment; ++j) {
+            int32_t id = i * docsPerSegment + j;
+            DocumentPtr doc = newLucene<Document>();
+            doc->add(newLucene<Field>(L"id", StringUtils::toString(id), Field::STORE_YES, Field::INDEX_NOT_ANALYZED));
+            doc->add(newLucene<Field>(L"sort", StringUtils::toString((id * 7) % 13), Field::STORE_NO, Field::INDEX_NOT_ANALYZED));
+            String contents = L"all";
+            for (int32_t k = 0; k < id % 5; ++k) {
+                contents += L" five";
+            }
+            doc->add(newLucene<Field>(L"contents", contents, Field::STORE_NO, Field::INDEX_ANALYZED));
+            writer->addDocument(doc);
+        }
+        writer->commit();
+    }
+    writer->close();
+    return dir;
+}
+
+static void checkSameHits(const TopDocsPtr& expected, const TopDocsPtr& actual) {
+    EXPECT_EQ(expected->totalHits, actual->totalHits);
+    EXPECT_EQ(expected->scoreDocs.size(), actual->scoreDocs.size());
+    for (int32_t i = 0; i < expected->scoreDocs.size(); ++i) {
+        EXPECT_EQ(expected->scoreDocs[i]->doc, actual->scoreDocs[i]->doc);
+        if (!MiscUtils::isNaN(expected->scoreDocs[i]->score)) {
+            EXPECT_EQ(expected->scoreDocs[i]->score, actual->scoreDocs[i]->score);
+        }
+    }
+}
+
+TEST_F(IndexSearcherTest, testConcurrentSearch) {
+    RAMDirectoryPtr dir = createIndex(4, 25);
+    IndexReaderPtr reader = IndexReader::open(dir, true);
+    EXPECT_EQ(4, reader->getSequentialSubReaders().size());
+
+    ThreadPoolPtr threadPool = newLucene<ThreadPool>(2);
+    IndexSearcherPtr sequential = newLucene<IndexSearcher>(reader);
+    IndexSearcherPtr concurrent = newLucene<IndexSearcher>(reader, threadPool);
+
+    QueryPtr query = newLucene<TermQuery>(newLucene<Term>(L"contents", L"five"));
+    for (int32_t n = 1; n <= 100; n += 33) {
+        TopDocsPtr expected = sequential->search(query, n);
+        TopDocsPtr actual = concurrent->search(query, n);
+        checkSameHits(expected, actual);
+        EXPECT_EQ(expected->maxScore, actual->maxScore);
+    }
+
+    SortPtr sort = newLucene<Sort>(newCollection<SortFieldPtr>(newLucene<SortField>(L"sort", SortField::INT), SortField::FIELD_DOC()));
+    TopFieldDocsPtr expected = sequential->search(query, FilterPtr(), 30, sort);
+    TopFieldDocsPtr actual = concurrent->search(query, FilterPtr(), 30, sort);
+    checkSameHits(expected, actual);
+
+    // settings changed after construction reach the segment searchers
+    sequential->setDefaultFieldSortScoring(true, true);
+    concurrent->setDefaultFieldSortScoring(true, true);
+    expected = sequential->search(query, FilterPtr(), 30, sort);
+    actual = concurrent->search(query, FilterPtr(), 30, sort);
+    EXPECT_TRUE(!MiscUtils::isNaN(expected->scoreDocs[0]->score));
+    checkSameHits(expected, actual);
+    EXPECT_EQ(expected->maxScore, actual->maxScore);
+
+    // pruned searches return the same top hits, counting at most the hits of a full search
+    sequential->setTrackTotalHits(false);
+    concurrent->setTrackTotalHits(false);
+    TopDocsPtr prunedExpected = sequential->search(query, 10);
+    TopDocsPtr pruned = concurrent->search(query, 10);
+    EXPECT_EQ(prunedExpected->scoreDocs.size(), pruned->scoreDocs.size());
+    for (int32_t i = 0; i < pruned->scoreDocs.size(); ++i) {
+        EXPECT_EQ(prunedExpected->scoreDocs[i]->score, pruned->scoreDocs[i]->score);
+    }
+    sequential->setTrackTotalHits(true);
+    concurrent->setTrackTotalHits(true);
+    EXPECT_TRUE(pruned->totalHits <= concurrent->search(query, 10)->totalHits);
+
+    // no matches
+    EXPECT_EQ(0, concurrent->search(newLucene<TermQuery>(newLucene<Term>(L"contents", L"none")), 10)->totalHits);
+
+    threadPool->close();
+    reader->close();
+}
@@ -0,0 +1,192 @@
+/////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2009-2014 Alan Wright. All rights reserved.
+// Distributable under the terms of either the Apache License (Version 2.0)
+// or the GNU Lesser General Public License.
+/////////////////////////////////////////////////////////////////////////////
+
+#include "TestInc.h"
+#include "LuceneTestFixture.h"
+#include "RAMDirectory.h"
+#include "IndexWriter.h"
+#include "WhitespaceAnalyzer.h"
+#include "IndexReader.h"
+#include "IndexSearcher.h"
+#include "Document.h"
+#include "Field.h"
+#include "MockFilter.h"
+#include "LRUFilterCache.h"
+#include "QueryWrapperFilter.h"
+#include "TermQuery.h"
+#include "MatchAllDocsQuery.h"
+#include "Term.h"
+#include "TopDocs.h"
+#include "DocIdSet.h"
+
+using namespace Lucene;
+
+typedef LuceneTestFixture LRUFilterCacheTest;
+
+/// Three segments of 20 documents each.
+static IndexReaderPtr createReader() {
+    RAMDirectoryPtr dir = newLucene<RAMDirectory>();
+    IndexWriterPtr writer = newLucene<IndexWriter>(dir, newLucene<WhitespaceAnalyzer>(), true, IndexWriter::MaxFieldLengthLIMITED);
+    writer->setMergeFactor(1000);
+    for (int32_t i = 0; i < 60; ++i) {
+        DocumentPtr doc = newLucene<Document>();
+        doc->add(newLucene<Field>(L"parity", i % 2 == 0 ? L"even" : L"odd", Field::STORE_NO, Field::INDEX_NOT_ANALYZED));
+        doc->add(newLucene<Field>(L"tens", StringUtils::toString(i / 10), Field::STORE_NO, Field::INDEX_NOT_ANALYZED));
+        writer->addDocument(doc);
+        if (i % 20 == 19) {
+            writer->commit();
+        }
+    }
+    writer->close();
+    return IndexReader::open(dir, true);
+}
+
+static FilterPtr termFilter(const String& field, const String& text) {
+    return newLucene<QueryWrapperFilter>(newLucene<TermQuery>(newLucene<Term>(field, text)));
+}
+
+static void getDocIdSets(const FilterPtr& filter, const IndexReaderPtr& reader) {
+    Collection<IndexReaderPtr> segments(reader->getSequentialSubReaders());
+    for (Collection<IndexReaderPtr>::iterator segment = segments.begin(); segment != segments.end(); ++segment) {
+        filter->getDocIdSet(*segment);
+    }
+}
+
+TEST_F(LRUFilterCacheTest, testCachingWorks) {
+    IndexReaderPtr reader = createReader();
+    Collection<IndexReaderPtr> segments(reader->getSequentialSubReaders());
+    EXPECT_EQ(3, segments.size());
+
+    LRUFilterCachePtr cache = newLucene<LRUFilterCache>();
+    cache->setMinSegmentSize(0);
+    MockFilterPtr filter = newLucene<MockFilter>();
+    FilterPtr cached = cache->doCache(filter);
+
+    // first time, nested filter is called
+    getDocIdSets(cached, reader);
+    EXPECT_TRUE(filter->wasCalled());
+    EXPECT_EQ(0, cache->getHitCount());
+    EXPECT_EQ(3, cache->getMissCount());
+    EXPECT_EQ(3, cache->getCacheSize());
+    EXPECT_EQ(3, cache->getCacheCount());
+    EXPECT_TRUE(cache->getRamBytesUsed() > 0);
+
+    // second time, nested filter should not be called
+    filter->clear();
+    getDocIdSets(cached, reader);
+    EXPECT_TRUE(!filter->wasCalled());
+    EXPECT_EQ(3, cache->getHitCount());
+    EXPECT_EQ(3, cache->getMissCount());
+
+    cache->clear();
+    EXPECT_EQ(0, cache->getCacheSize());
+    EXPECT_EQ(0, cache->getRamBytesUsed());
+    getDocIdSets(cached, reader);
+    EXPECT_TRUE(filter->wasCalled());
+    EXPECT_EQ(6, cache->getMissCount());
+    reader->close();
+}
+
+TEST_F(LRUFilterCacheTest, testEqualFiltersShareEntries) {
+    IndexReaderPtr reader = createReader();
+    LRUFilterCachePtr cache = newLucene<LRUFilterCache>();
+    cache->setMinSegmentSize(0);
+
+    IndexSearcherPtr searcher = newLucene<IndexSearcher>(reader);
+    TopDocsPtr docs = searcher->search(newLucene<MatchAllDocsQuery>(), cache->doCache(termFilter(L"parity", L"odd")), 100);
+    EXPECT_EQ(30, docs->totalHits);
+    EXPECT_EQ(3, cache->getMissCount());
+
+    // a new instance of an equal filter finds the cached results
+    docs = searcher->search(newLucene<MatchAllDocsQuery>(), cache->doCache(termFilter(L"parity", L"odd")), 100);
+    EXPECT_EQ(30, docs->totalHits);
+    EXPECT_EQ(3, cache->getHitCount());
+    EXPECT_EQ(3, cache->getMissCount());
+
+    docs = searcher->search(newLucene<MatchAllDocsQuery>(), cache->doCache(termFilter(L"parity", L"even")), 100);
+    EXPECT_EQ(30, docs->totalHits);
+    EXPECT_EQ(6, cache->getMissCount());
+    EXPECT_EQ(6, cache->getCacheSize());
+    searcher->close();
+    reader->close();
+}
+
+TEST_F(LRUFilterCacheTest, testMinSegmentSize) {
+    IndexReaderPtr reader = createReader();
+    LRUFilterCachePtr cache = newLucene<LRUFilterCache>();
+    EXPECT_EQ(LRUFilterCache::DEFAULT_MIN_SEGMENT_SIZE, cache->getMinSegmentSize());
+    MockFilterPtr filter = newLucene<MockFilter>();
+    FilterPtr cached = cache->doCache(filter);
+
+    // segments are too small to be cached
+    getDocIdSets(cached, reader);
+    filter->clear();
+    getDocIdSets(cached, reader);
+    EXPECT_TRUE(filter->wasCalled());
+    EXPECT_EQ(0, cache->getCacheSize());
+    EXPECT_EQ(0, cache->getHitCount());
+    EXPECT_EQ(6, cache->getMissCount());
+    reader->close();
+}
+
+TEST_F(LRUFilterCacheTest, testEvictLeastRecentlyUsed) {
+    IndexReaderPtr reader = createReader();
+    IndexReaderPtr segment = reader->getSequentialSubReaders()[0];
+    LRUFilterCachePtr cache = newLucene<LRUFilterCache>(2);
+    cache->setMinSegmentSize(0);
+
+    FilterPtr filter1 = cache->doCache(termFilter(L"tens", L"0"));
+    FilterPtr filter2 = cache->doCache(termFilter(L"tens", L"1"));
+    FilterPtr filter3 = cache->doCache(termFilter(L"tens", L"2"));
+
+    filter1->getDocIdSet(segment);
+    filter2->getDocIdSet(segment);
+    filter1->getDocIdSet(segment);
+    EXPECT_EQ(1, cache->getHitCount());
+
+    // filter2 is the least recently used
+    filter3->getDocIdSet(segment);
+    EXPECT_EQ(2, cache->getCacheSize());
+    EXPECT_EQ(1, cache->getEvictionCount());
+    filter1->getDocIdSet(segment);
+    filter3->getDocIdSet(segment);
+    EXPECT_EQ(3, cache->getHitCount());
+    filter2->getDocIdSet(segment);
+    EXPECT_EQ(3, cache->getHitCount());
+    EXPECT_EQ(2, cache->getEvictionCount());
+    reader->close();
+}
+
+TEST_F(LRUFilterCacheTest, testRamBudget) {
+    IndexReaderPtr reader = createReader();
+    LRUFilterCachePtr cache = newLucene<LRUFilterCache>();
+    cache->setMinSegmentSize(0);
+
+    for (int32_t i = 0; i < 6; ++i) {
+        getDocIdSets(cache->doCache(termFilter(L"tens", StringUtils::toString(i))), reader);
+    }
+    EXPECT_EQ(18, cache->getCacheSize());
+    int64_t bytesUsed = cache->getRamBytesUsed();
+    EXPECT_TRUE(bytesUsed > 0);
+
+    // shrinking the budget evicts entries until the cache fits
+    cache->setMaxRamBytesUsed(bytesUsed / 2);
+    EXPECT_TRUE(cache->getRamBytesUsed() <= bytesUsed / 2);
+    EXPECT_TRUE(cache->getCacheSize() < 18);
+    EXPECT_EQ(18 - cache->getCacheSize(), cache->getEvictionCount());
+
+    for (int32_t i = 0; i < 6; ++i) {
+        getDocIdSets(cache->doCache(termFilter(L"parity", StringUtils::toString(i))), reader);
+        EXPECT_TRUE(cache->getRamBytesUsed() <= bytesUsed / 2);
+    }
+
+    // results larger than the whole budget are never cached
+    cache->setMaxRamBytesUsed(0);
+    EXPECT_EQ(0, cache->getCacheSize());
+    getDocIdSets(cache->doCache(termFilter(L"parity", L"odd")), reader);
+    EXPECT_EQ(0, cache->getCacheSize());
+    reader->close();
+}
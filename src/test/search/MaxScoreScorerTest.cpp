@@ -0,0 +1,207 @@
+/////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2009-2014 Alan Wright. All rights reserved.
+// Distributable under the terms of either the Apache License (Version 2.0)
+// or the GNU Lesser General Public License.
+/////////////////////////////////////////////////////////////////////////////
+
+#include "TestInc.h"
+#include "LuceneTestFixture.h"
+#include "RAMDirectory.h"
+#include "IndexWriter.h"
+#include "WhitespaceAnalyzer.h"
+#include "IndexReader.h"
+#include "IndexSearcher.h"
+#include "Document.h"
+#include "Field.h"
+#include "BooleanQuery.h"
+#include "TermQuery.h"
+#include "Term.h"
+#include "TermDocs.h"
+#include "TopScoreDocCollector.h"
+#include "TopDocs.h"
+#include "ScoreDoc.h"
+#include "Weight.h"
+#include "MaxScoreScorer.h"
+#include "Random.h"
+#include "MiscUtils.h"
+
+using namespace Lucene;
+
+typedef LuceneTestFixture MaxScoreScorerTest;
+
+static const int32_t NUM_DOCS = 2000;
+
+static const wchar_t* WORDS[] = {L"aaa", L"bbb", L"ccc", L"ddd", L"eee", L"fff"};
+
+/// Words are frequent, with random frequencies and field lengths; "rare" occurs in one document in 50.
+static RAMDirectoryPtr createIndex() {
+    RAMDirectoryPtr dir = newLucene<RAMDirectory>();
+    IndexWriterPtr writer = newLucene<IndexWriter>(dir, newLucene<WhitespaceAnalyzer>(), true, IndexWriter::MaxFieldLengthLIMITED);
+    writer->setMaxBufferedDocs(500);
+    RandomPtr random = newLucene<Random>(17);
+    for (int32_t i = 0; i < NUM_DOCS; ++i) {
+        StringStream body;
+        int32_t length = 1 + random->nextInt(20);
+        for (int32_t j = 0; j < length; ++j) {
+            body << WORDS[random->nextInt(6 - random->nextInt(5))] << L" ";
+        }
+        body << L"common";
+        if (i % 50 == 7) {
+            body << L" rare rare rare";
+        }
+        DocumentPtr doc = newLucene<Document>();
+        doc->add(newLucene<Field>(L"body", body.str(), Field::STORE_NO, Field::INDEX_ANALYZED));
+        writer->addDocument(doc);
+    }
+    writer->close();
+    return dir;
+}
+
+static BooleanQueryPtr disjunction(const wchar_t* first, const wchar_t* second, const wchar_t* third = NULL) {
+    BooleanQueryPtr query = newLucene<BooleanQuery>();
+    query->add(newLucene<TermQuery>(newLucene<Term>(L"body", first)), BooleanClause::SHOULD);
+    query->add(newLucene<TermQuery>(newLucene<Term>(L"body", second)), BooleanClause::SHOULD);
+    if (third) {
+        query->add(newLucene<TermQuery>(newLucene<Term>(L"body", third)), BooleanClause::SHOULD);
+    }
+    return query;
+}
+
+/// Checks that pruning returns the same top hits as collecting every document.
+static int32_t checkSameTopHits(const IndexSearcherPtr& searcher, const QueryPtr& query, int32_t n) {
+    TopScoreDocCollectorPtr all = TopScoreDocCollector::create(n, true);
+    searcher->search(query, all);
+    TopDocsPtr expected = all->topDocs();
+
+    TopScoreDocCollectorPtr pruned = TopScoreDocCollector::create(n, true, false);
+    searcher->search(query, pruned);
+    TopDocsPtr actual = pruned->topDocs();
+
+    EXPECT_EQ(expected->scoreDocs.size(), actual->scoreDocs.size());
+    for (int32_t i = 0; i < expected->scoreDocs.size() && i < actual->scoreDocs.size(); ++i) {
+        EXPECT_EQ(expected->scoreDocs[i]->doc, actual->scoreDocs[i]->doc);
+        EXPECT_EQ(expected->scoreDocs[i]->score, actual->scoreDocs[i]->score);
+    }
+    EXPECT_TRUE(actual->totalHits <= expected->totalHits);
+
+    // scoring out of order gives the same hits, up to rounding of the scores
+    TopDocsPtr outOfOrder = searcher->search(query, n);
+    EXPECT_EQ(expected->totalHits, outOfOrder->totalHits);
+    for (int32_t i = 0; i < expected->scoreDocs.size(); ++i) {
+        EXPECT_NEAR(expected->scoreDocs[i]->score, outOfOrder->scoreDocs[i]->score, 1e-6);
+    }
+    return actual->totalHits;
+}
+
+TEST_F(MaxScoreScorerTest, testMaxFreq) {
+    RAMDirectoryPtr dir = createIndex();
+    IndexReaderPtr reader = IndexReader::open(dir, true);
+    EXPECT_TRUE(reader->getSequentialSubReaders().size() > 1);
+    Collection<IndexReaderPtr> segments(reader->getSequentialSubReaders());
+    for (int32_t i = 0; i < segments.size(); ++i) {
+        for (int32_t w = 0; w < 6; ++w) {
+            TermDocsPtr termDocs = segments[i]->termDocs(newLucene<Term>(L"body", WORDS[w]));
+            int32_t maxFreq = 0;
+            while (termDocs->next()) {
+                maxFreq = std::max(maxFreq, termDocs->freq());
+            }
+            termDocs->seek(newLucene<Term>(L"body", WORDS[w]));
+            EXPECT_EQ(maxFreq, termDocs->maxFreq());
+        }
+        TermDocsPtr termDocs = segments[i]->termDocs(newLucene<Term>(L"body", L"rare"));
+        EXPECT_EQ(3, termDocs->maxFreq());
+        termDocs = segments[i]->termDocs(newLucene<Term>(L"body", L"missing"));
+        EXPECT_EQ(0, termDocs->maxFreq());
+    }
+    reader->close();
+
+    // merged segments record the highest frequency too
+    IndexWriterPtr writer = newLucene<IndexWriter>(dir, newLucene<WhitespaceAnalyzer>(), false, IndexWriter::MaxFieldLengthLIMITED);
+    writer->optimize();
+    writer->close();
+    reader = IndexReader::open(dir, true);
+    EXPECT_EQ(1, reader->getSequentialSubReaders().size());
+    EXPECT_EQ(3, reader->getSequentialSubReaders()[0]->termDocs(newLucene<Term>(L"body", L"rare"))->maxFreq());
+    reader->close();
+}
+
+TEST_F(MaxScoreScorerTest, testScorer) {
+    RAMDirectoryPtr dir = createIndex();
+    IndexReaderPtr reader = IndexReader::open(dir, true);
+    IndexSearcherPtr searcher = newLucene<IndexSearcher>(reader);
+    WeightPtr weight = disjunction(L"aaa", L"fff")->weight(searcher);
+    IndexReaderPtr segment = reader->getSequentialSubReaders()[0];
+
+    EXPECT_TRUE(MiscUtils::typeOf<MaxScoreScorer>(weight->scorer(segment, true, true)));
+    EXPECT_TRUE(!MiscUtils::typeOf<MaxScoreScorer>(weight->scorer(segment, false, true)));
+    EXPECT_TRUE(!MiscUtils::typeOf<MaxScoreScorer>(weight->scorer(segment, true, false)));
+
+    // large disjunctions are left to BooleanScorer2
+    BooleanQueryPtr largest = newLucene<BooleanQuery>();
+    BooleanQueryPtr tooLarge = newLucene<BooleanQuery>();
+    for (int32_t i = 0; i <= MaxScoreScorer::MAX_CLAUSES; ++i) {
+        if (i < MaxScoreScorer::MAX_CLAUSES) {
+            largest->add(newLucene<TermQuery>(newLucene<Term>(L"body", WORDS[i % 6])), BooleanClause::SHOULD);
+        }
+        tooLarge->add(newLucene<TermQuery>(newLucene<Term>(L"body", WORDS[i % 6])), BooleanClause::SHOULD);
+    }
+    EXPECT_TRUE(MiscUtils::typeOf<MaxScoreScorer>(largest->weight(searcher)->scorer(segment, true, true)));
+    EXPECT_TRUE(!MiscUtils::typeOf<MaxScoreScorer>(tooLarge->weight(searcher)->scorer(segment, true, true)));
+
+    // without a minimum competitive score every matching document is returned
+    ScorerPtr scorer = weight->scorer(segment, true, true);
+    TermDocsPtr aaa = segment->termDocs(newLucene<Term>(L"body", L"aaa"));
+    TermDocsPtr fff = segment->termDocs(newLucene<Term>(L"body", L"fff"));
+    bool moreAaa = aaa->next();
+    bool moreFff = fff->next();
+    while (moreAaa || moreFff) {
+        int32_t expected = std::min(moreAaa ? aaa->doc() : INT_MAX, moreFff ? fff->doc() : INT_MAX);
+        EXPECT_EQ(expected, scorer->nextDoc());
+        if (moreAaa && aaa->doc() == expected) {
+            moreAaa = aaa->next();
+        }
+        if (moreFff && fff->doc() == expected) {
+            moreFff = fff->next();
+        }
+    }
+    EXPECT_EQ(DocIdSetIterator::NO_MORE_DOCS, scorer->nextDoc());
+
+    // once the minimum is higher than any score, nothing is left
+    scorer = weight->scorer(segment, true, true);
+    scorer->setMinCompetitiveScore(1000.0);
+    EXPECT_EQ(DocIdSetIterator::NO_MORE_DOCS, scorer->nextDoc());
+    searcher->close();
+    reader->close();
+}
+
+TEST_F(MaxScoreScorerTest, testSameTopHits) {
+    RAMDirectoryPtr dir = createIndex();
+    IndexSearcherPtr searcher = newLucene<IndexSearcher>(dir, true);
+    for (int32_t n = 1; n <= 100; n *= 10) {
+        checkSameTopHits(searcher, disjunction(L"aaa", L"bbb"), n);
+        checkSameTopHits(searcher, disjunction(L"aaa", L"fff"), n);
+        checkSameTopHits(searcher, disjunction(L"bbb", L"eee", L"fff"), n);
+        checkSameTopHits(searcher, disjunction(L"ccc", L"common", L"rare"), n);
+        checkSameTopHits(searcher, disjunction(L"ddd", L"missing"), n);
+    }
+    searcher->close();
+}
+
+TEST_F(MaxScoreScorerTest, testSkipsNonCompetitiveDocuments) {
+    RAMDirectoryPtr dir = createIndex();
+    IndexSearcherPtr searcher = newLucene<IndexSearcher>(dir, true);
+
+    // documents with "common" only can't beat the ones with "rare" too
+    int32_t collected = checkSameTopHits(searcher, disjunction(L"common", L"rare"), 10);
+    EXPECT_TRUE(collected < NUM_DOCS / 4);
+
+    TopDocsPtr topDocs = searcher->search(disjunction(L"common", L"rare"), 10);
+    EXPECT_EQ(NUM_DOCS, topDocs->totalHits);
+    searcher->setTrackTotalHits(false);
+    TopDocsPtr pruned = searcher->search(disjunction(L"common", L"rare"), 10);
+    EXPECT_EQ(collected, pruned->totalHits);
+    for (int32_t i = 0; i < 10; ++i) {
+        EXPECT_EQ(7, pruned->scoreDocs[i]->doc % 50);
+    }
+    searcher->close();
+}
@@ -25,6 +25,7 @@
 #include "Sort.h"
 #include "DefaultSimilarity.h"
 #include "TopFieldDocs.h"
+#include "ThreadPool.h"
 
 using namespace Lucene;
 
@@ -357,3 +358,19 @@ TEST_F(ParallelMultiSearcherTest, testDocFreq) {
     MultiSearcherPtr multiSearcher = getMultiSearcherInstance(newCollection<SearchablePtr>(searcher1, searcher2));
     EXPECT_EQ(15, multiSearcher->docFreq(newLucene<Term>(L"contents", L"x")));
 }
+
+TEST_F(ParallelMultiSearcherTest, testSharedThreadPool) {
+    RAMDirectoryPtr dir1 = newLucene<RAMDirectory>();
+    RAMDirectoryPtr dir2 = newLucene<RAMDirectory>();
+
+    initIndex(dir1, 10, true, L"x");
+    initIndex(dir2, 5, true, L"x");
+    IndexSearcherPtr searcher1 = newLucene<IndexSearcher>(dir1, true);
+    IndexSearcherPtr searcher2 = newLucene<IndexSearcher>(dir2, true);
+
+    ThreadPoolPtr threadPool = newLucene<ThreadPool>(1);
+    MultiSearcherPtr multiSearcher = newLucene<ParallelMultiSearcher>(newCollection<SearchablePtr>(searcher1, searcher2), threadPool);
+    EXPECT_EQ(15, multiSearcher->docFreq(newLucene<Term>(L"contents", L"x")));
+    EXPECT_EQ(15, multiSearcher->search(newLucene<TermQuery>(newLucene<Term>(L"contents", L"x")), FilterPtr(), 20)->totalHits);
+    threadPool->close();
+}
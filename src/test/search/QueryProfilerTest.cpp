@@ -0,0 +1,227 @@
+/////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2009-2014 Alan Wright. All rights reserved.
+// Distributable under the terms of either the Apache License (Version 2.0)
+// or the GNU Lesser General Public License.
+/////////////////////////////////////////////////////////////////////////////
+
+#include "TestInc.h"
+#include "LuceneTestFixture.h"
+#include "RAMDirectory.h"
+#include "Document.h"
+#include "Field.h"
+#include "IndexWriter.h"
+#include "WhitespaceAnalyzer.h"
+#include "IndexSearcher.h"
+#include "QueryProfiler.h"
+#include "BooleanQuery.h"
+#include "TermQuery.h"
+#include "Term.h"
+#include "TopDocs.h"
+#include "ScoreDoc.h"
+#include "LuceneThread.h"
+#include "Collector.h"
+
+using namespace Lucene;
+
+typedef LuceneTestFixture QueryProfilerTest;
+
+static RAMDirectoryPtr createIndex() {
+    RAMDirectoryPtr dir = newLucene<RAMDirectory>();
+    IndexWriterPtr writer = newLucene<IndexWriter>(dir, newLucene<WhitespaceAnalyzer>(), true, IndexWriter::MaxFieldLengthLIMITED);
+    writer->setMergeFactor(1000);
+    for (int32_t i = 0; i < 100; ++i) {
+        DocumentPtr doc = newLucene<Document>();
+        doc->add(newLucene<Field>(L"contents", (i % 2 == 0 ? L"even" : L"odd") + String(i % 3 == 0 ? L" three" : L""), Field::STORE_NO, Field::INDEX_ANALYZED));
+        writer->addDocument(doc);
+        if (i % 50 == 49) {
+            writer->commit();
+        }
+    }
+    writer->close();
+    return dir;
+}
+
+DECLARE_SHARED_PTR(ProfiledSearchThread)
+
+class ProfiledSearchThread : public LuceneThread {
+public:
+    ProfiledSearchThread(const IndexSearcherPtr& searcher, const QueryPtr& query) {
+        this->searcher = searcher;
+        this->query = query;
+    }
+
+    virtual ~ProfiledSearchThread() {
+    }
+
+    LUCENE_CLASS(ProfiledSearchThread);
+
+protected:
+    IndexSearcherPtr searcher;
+    QueryPtr query;
+
+public:
+    virtual void run() {
+        try {
+            for (int32_t i = 0; i < 50; ++i) {
+                searcher->search(query, 10);
+            }
+        } catch (LuceneException& e) {
+            FAIL() << "Unexpected exception: " << e.getError();
+        }
+    }
+};
+
+DECLARE_SHARED_PTR(FailingCollector)
+
+/// Throws a non-Lucene exception once it has collected limit documents.
+class FailingCollector : public Collector {
+public:
+    FailingCollector(int32_t limit) {
+        this->limit = limit;
+        this->count = 0;
+    }
+
+    virtual ~FailingCollector() {
+    }
+
+    LUCENE_CLASS(FailingCollector);
+
+protected:
+    int32_t limit;
+    int32_t count;
+
+public:
+    virtual void setScorer(const ScorerPtr& scorer) {
+    }
+
+    virtual void collect(int32_t doc) {
+        if (count == limit) {
+            throw std::runtime_error("collection failed");
+        }
+        ++count;
+    }
+
+    virtual void setNextReader(const IndexReaderPtr& reader, int32_t docBase) {
+    }
+
+    virtual bool acceptsDocsOutOfOrder() {
+        return true;
+    }
+};
+
+TEST_F(QueryProfilerTest, testBooleanQueryProfile) {
+    RAMDirectoryPtr dir = createIndex();
+    IndexSearcherPtr searcher = newLucene<IndexSearcher>(dir, true);
+
+    BooleanQueryPtr query = newLucene<BooleanQuery>();
+    query->add(newLucene<TermQuery>(newLucene<Term>(L"contents", L"even")), BooleanClause::MUST);
+    query->add(newLucene<TermQuery>(newLucene<Term>(L"contents", L"three")), BooleanClause::SHOULD);
+
+    TopDocsPtr expected = searcher->search(query, 10);
+
+    QueryProfilerPtr profiler = newLucene<QueryProfiler>();
+    searcher->setProfiler(profiler);
+    TopDocsPtr actual = searcher->search(query, 10);
+    searcher->setProfiler(QueryProfilerPtr());
+
+    // profiling must not change the results
+    EXPECT_EQ(expected->totalHits, actual->totalHits);
+    EXPECT_EQ(expected->scoreDocs.size(), actual->scoreDocs.size());
+    for (int32_t i = 0; i < expected->scoreDocs.size(); ++i) {
+        EXPECT_EQ(expected->scoreDocs[i]->doc, actual->scoreDocs[i]->doc);
+        EXPECT_EQ(expected->scoreDocs[i]->score, actual->scoreDocs[i]->score);
+    }
+
+    EXPECT_EQ(1, profiler->getProfiles().size());
+    QueryProfileNodePtr root = profiler->getProfile();
+    EXPECT_EQ(L"BooleanQuery", root->type);
+    EXPECT_EQ(2, root->children.size());
+    EXPECT_EQ(L"TermQuery", root->children[0]->type);
+    EXPECT_EQ(L"contents:even", root->children[0]->description);
+    EXPECT_EQ(L"TermQuery", root->children[1]->type);
+    EXPECT_EQ(L"contents:three", root->children[1]->description);
+
+    // one scorer per segment, for every node
+    EXPECT_EQ(2, root->segments.size());
+    EXPECT_EQ(2, root->children[0]->segments.size());
+    EXPECT_EQ(2, root->children[1]->segments.size());
+
+    // the boolean scorer drives collection, pulling from its clauses
+    int64_t termIterations = 0;
+    for (int32_t i = 0; i < 2; ++i) {
+        for (Collection<QueryProfileSegmentPtr>::iterator segment = root->children[i]->segments.begin(); segment != root->children[i]->segments.end(); ++segment) {
+            termIterations += (*segment)->nextDocCount + (*segment)->advanceCount;
+        }
+    }
+    EXPECT_TRUE(termIterations > 0);
+    EXPECT_EQ(expected->totalHits, profiler->getCollectCount());
+
+    String profile = profiler->toString();
+    EXPECT_NE(String::npos, profile.find(L"contents:three"));
+
+    // profiles accumulate until reset
+    searcher->setProfiler(profiler);
+    searcher->search(query, 10);
+    EXPECT_EQ(2, profiler->getProfiles().size());
+    profiler->reset();
+    EXPECT_EQ(0, profiler->getProfiles().size());
+    EXPECT_TRUE(!profiler->getProfile());
+    EXPECT_EQ(0, profiler->getCollectCount());
+
+    searcher->close();
+}
+
+TEST_F(QueryProfilerTest, testSharedBetweenThreads) {
+    RAMDirectoryPtr dir = createIndex();
+
+    BooleanQueryPtr query = newLucene<BooleanQuery>();
+    query->add(newLucene<TermQuery>(newLucene<Term>(L"contents", L"even")), BooleanClause::MUST);
+    query->add(newLucene<TermQuery>(newLucene<Term>(L"contents", L"three")), BooleanClause::SHOULD);
+
+    QueryProfilerPtr profiler = newLucene<QueryProfiler>();
+    Collection<IndexSearcherPtr> searchers = Collection<IndexSearcherPtr>::newInstance(4);
+    Collection<ProfiledSearchThreadPtr> threads = Collection<ProfiledSearchThreadPtr>::newInstance(searchers.size());
+    for (int32_t i = 0; i < searchers.size(); ++i) {
+        searchers[i] = newLucene<IndexSearcher>(dir, true);
+        searchers[i]->setProfiler(profiler);
+        threads[i] = newLucene<ProfiledSearchThread>(searchers[i], query);
+    }
+    for (int32_t i = 0; i < threads.size(); ++i) {
+        threads[i]->start();
+    }
+    for (int32_t i = 0; i < threads.size(); ++i) {
+        threads[i]->join();
+    }
+
+    // every thread builds its own trees, so no node picks up another search's clauses
+    Collection<QueryProfileNodePtr> profiles = profiler->getProfiles();
+    EXPECT_EQ(threads.size() * 50, profiles.size());
+    for (Collection<QueryProfileNodePtr>::iterator profile = profiles.begin(); profile != profiles.end(); ++profile) {
+        EXPECT_EQ(L"BooleanQuery", (*profile)->type);
+        EXPECT_EQ(2, (*profile)->children.size());
+    }
+    searchers[0]->setProfiler(QueryProfilerPtr());
+    int32_t totalHits = searchers[0]->search(query, 10)->totalHits;
+    EXPECT_EQ(threads.size() * 50 * totalHits, profiler->getCollectCount());
+
+    for (int32_t i = 0; i < searchers.size(); ++i) {
+        searchers[i]->close();
+    }
+}
+
+TEST_F(QueryProfilerTest, testCollectorException) {
+    RAMDirectoryPtr dir = createIndex();
+    IndexSearcherPtr searcher = newLucene<IndexSearcher>(dir, true);
+    QueryProfilerPtr profiler = newLucene<QueryProfiler>();
+    searcher->setProfiler(profiler);
+    try {
+        searcher->search(newLucene<TermQuery>(newLucene<Term>(L"contents", L"even")), newLucene<FailingCollector>(5));
+        FAIL() << "expected std::runtime_error";
+    } catch (std::runtime_error&) {
+    }
+
+    // the documents collected before the failure are still recorded
+    EXPECT_EQ(1, profiler->getProfiles().size());
+    EXPECT_EQ(5, profiler->getCollectCount());
+    searcher->close();
+}
@@ -0,0 +1,198 @@
+/////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2009-2014 Alan Wright. All rights reserved.
+// Distributable under the terms of either the Apache License (Version 2.0)
+// or the GNU Lesser General Public License.
+/////////////////////////////////////////////////////////////////////////////
+
+#include "TestInc.h"
+#include "LuceneTestFixture.h"
+#include "QueryResultCache.h"
+#include "RAMDirectory.h"
+#include "IndexWriter.h"
+#include "IndexReader.h"
+#include "IndexSearcher.h"
+#include "WhitespaceAnalyzer.h"
+#include "Document.h"
+#include "Field.h"
+#include "TermQuery.h"
+#include "QueryWrapperFilter.h"
+#include "Sort.h"
+#include "SortField.h"
+#include "TopFieldDocs.h"
+#include "ScoreDoc.h"
+#include "Term.h"
+#include "DefaultSimilarity.h"
+#include "MiscUtils.h"
+
+using namespace Lucene;
+
+typedef LuceneTestFixture QueryResultCacheTest;
+
+static void addDocuments(const IndexWriterPtr& writer, int32_t start, int32_t end) {
+    for (int32_t i = start; i < end; ++i) {
+        DocumentPtr doc = newLucene<Document>();
+        doc->add(newLucene<Field>(L"id", StringUtils::toString(i), Field::STORE_YES, Field::INDEX_NOT_ANALYZED));
+        doc->add(newLucene<Field>(L"rank", StringUtils::toString(i * 37 % 101), Field::STORE_NO, Field::INDEX_NOT_ANALYZED));
+        doc->add(newLucene<Field>(L"body", i % 2 == 0 ? L"even common" : L"odd common common", Field::STORE_NO, Field::INDEX_ANALYZED));
+        writer->addDocument(doc);
+    }
+    writer->commit();
+}
+
+static void checkSameHits(const TopDocsPtr& expected, const TopDocsPtr& actual) {
+    EXPECT_EQ(expected->totalHits, actual->totalHits);
+    EXPECT_EQ(expected->scoreDocs.size(), actual->scoreDocs.size());
+    for (int32_t i = 0; i < expected->scoreDocs.size(); ++i) {
+        EXPECT_EQ(expected->scoreDocs[i]->doc, actual->scoreDocs[i]->doc);
+        if (!MiscUtils::isNaN(expected->scoreDocs[i]->score)) {
+            EXPECT_EQ(expected->scoreDocs[i]->score, actual->scoreDocs[i]->score);
+        }
+    }
+}
+
+static SortPtr rankSort() {
+    return newLucene<Sort>(newCollection<SortFieldPtr>(newLucene<SortField>(L"rank", SortField::INT, true), SortField::FIELD_DOC()));
+}
+
+TEST_F(QueryResultCacheTest, testRelevanceSearch) {
+    RAMDirectoryPtr dir = newLucene<RAMDirectory>();
+    IndexWriterPtr writer = newLucene<IndexWriter>(dir, newLucene<WhitespaceAnalyzer>(), true, IndexWriter::MaxFieldLengthLIMITED);
+    addDocuments(writer, 0, 50);
+    addDocuments(writer, 50, 100);
+
+    IndexReaderPtr reader = IndexReader::open(dir, true);
+    IndexSearcherPtr searcher = newLucene<IndexSearcher>(reader);
+    QueryResultCachePtr cache = newLucene<QueryResultCache>();
+
+    TopDocsPtr first = cache->search(searcher, newLucene<TermQuery>(newLucene<Term>(L"body", L"common")), FilterPtr(), 10);
+    checkSameHits(searcher->search(newLucene<TermQuery>(newLucene<Term>(L"body", L"common")), 10), first);
+    EXPECT_EQ(0, cache->getHitCount());
+    EXPECT_EQ(1, cache->getMissCount());
+
+    // an equal query hits the cache, a different filter or n doesn't
+    EXPECT_EQ(first, cache->search(searcher, newLucene<TermQuery>(newLucene<Term>(L"body", L"common")), FilterPtr(), 10));
+    EXPECT_EQ(1, cache->getHitCount());
+    FilterPtr filter = newLucene<QueryWrapperFilter>(newLucene<TermQuery>(newLucene<Term>(L"body", L"odd")));
+    cache->search(searcher, newLucene<TermQuery>(newLucene<Term>(L"body", L"common")), filter, 10);
+    cache->search(searcher, newLucene<TermQuery>(newLucene<Term>(L"body", L"common")), FilterPtr(), 5);
+    EXPECT_EQ(1, cache->getHitCount());
+    EXPECT_EQ(3, cache->getCacheSize());
+
+    // scores depend on the whole index, so new documents invalidate the search
+    addDocuments(writer, 100, 150);
+    IndexReaderPtr newReader = reader->reopen();
+    reader->close();
+    IndexSearcherPtr newSearcher = newLucene<IndexSearcher>(newReader);
+    TopDocsPtr second = cache->search(newSearcher, newLucene<TermQuery>(newLucene<Term>(L"body", L"common")), FilterPtr(), 10);
+    EXPECT_EQ(1, cache->getHitCount());
+    EXPECT_EQ(150, second->totalHits);
+    checkSameHits(newSearcher->search(newLucene<TermQuery>(newLucene<Term>(L"body", L"common")), 10), second);
+
+    // the segments the readers share are still open, so the old entries stay until they are evicted
+    EXPECT_EQ(4, cache->getCacheSize());
+
+    writer->close();
+    newReader->close();
+}
+
+namespace TestQueryResultCache {
+
+class FlatSimilarity : public DefaultSimilarity {
+public:
+    virtual ~FlatSimilarity() {
+    }
+
+    LUCENE_CLASS(FlatSimilarity);
+
+public:
+    virtual double tf(double freq) {
+        return 1.0;
+    }
+};
+
+}
+
+TEST_F(QueryResultCacheTest, testSimilarity) {
+    RAMDirectoryPtr dir = newLucene<RAMDirectory>();
+    IndexWriterPtr writer = newLucene<IndexWriter>(dir, newLucene<WhitespaceAnalyzer>(), true, IndexWriter::MaxFieldLengthLIMITED);
+    addDocuments(writer, 0, 50);
+    writer->close();
+
+    IndexReaderPtr reader = IndexReader::open(dir, true);
+    IndexSearcherPtr searcher = newLucene<IndexSearcher>(reader);
+    IndexSearcherPtr flatSearcher = newLucene<IndexSearcher>(reader);
+    flatSearcher->setSimilarity(newLucene<TestQueryResultCache::FlatSimilarity>());
+    QueryResultCachePtr cache = newLucene<QueryResultCache>();
+    QueryPtr query = newLucene<TermQuery>(newLucene<Term>(L"body", L"common"));
+
+    // the same search scored by another similarity isn't answered from the cache
+    TopDocsPtr topDocs = cache->search(searcher, query, FilterPtr(), 10);
+    TopDocsPtr flatTopDocs = cache->search(flatSearcher, query, FilterPtr(), 10);
+    EXPECT_NE(topDocs, flatTopDocs);
+    EXPECT_EQ(0, cache->getHitCount());
+    checkSameHits(flatSearcher->search(query, 10), flatTopDocs);
+    EXPECT_NE(topDocs->scoreDocs[0]->score, flatTopDocs->scoreDocs[0]->score);
+    EXPECT_EQ(flatTopDocs, cache->search(flatSearcher, query, FilterPtr(), 10));
+    EXPECT_EQ(1, cache->getHitCount());
+    reader->close();
+}
+
+TEST_F(QueryResultCacheTest, testSortedSearchReusesSegments) {
+    RAMDirectoryPtr dir = newLucene<RAMDirectory>();
+    IndexWriterPtr writer = newLucene<IndexWriter>(dir, newLucene<WhitespaceAnalyzer>(), true, IndexWriter::MaxFieldLengthLIMITED);
+    writer->setMergeFactor(1000);
+    addDocuments(writer, 0, 50);
+    addDocuments(writer, 50, 100);
+    addDocuments(writer, 100, 150);
+
+    IndexReaderPtr reader = IndexReader::open(dir, true);
+    IndexSearcherPtr searcher = newLucene<IndexSearcher>(reader);
+    QueryResultCachePtr cache = newLucene<QueryResultCache>();
+    QueryPtr query = newLucene<TermQuery>(newLucene<Term>(L"body", L"common"));
+
+    checkSameHits(searcher->search(query, FilterPtr(), 10, rankSort()), cache->search(searcher, query, FilterPtr(), 10, rankSort()));
+    EXPECT_EQ(3, cache->getMissCount());
+    checkSameHits(searcher->search(query, FilterPtr(), 10, rankSort()), cache->search(searcher, query, FilterPtr(), 10, rankSort()));
+    EXPECT_EQ(3, cache->getHitCount());
+
+    // a new segment and deletions in another are searched again, the unchanged segment is reused
+    addDocuments(writer, 150, 200);
+    writer->deleteDocuments(newLucene<Term>(L"id", L"60"));
+    writer->commit();
+    IndexReaderPtr newReader = reader->reopen();
+    reader->close();
+    searcher = newLucene<IndexSearcher>(newReader);
+    TopFieldDocsPtr topDocs = cache->search(searcher, query, FilterPtr(), 10, rankSort());
+    checkSameHits(searcher->search(query, FilterPtr(), 10, rankSort()), topDocs);
+    EXPECT_EQ(199, topDocs->totalHits);
+    EXPECT_EQ(5, cache->getHitCount());
+    EXPECT_EQ(5, cache->getMissCount());
+
+    writer->close();
+    newReader->close();
+}
+
+TEST_F(QueryResultCacheTest, testEviction) {
+    RAMDirectoryPtr dir = newLucene<RAMDirectory>();
+    IndexWriterPtr writer = newLucene<IndexWriter>(dir, newLucene<WhitespaceAnalyzer>(), true, IndexWriter::MaxFieldLengthLIMITED);
+    addDocuments(writer, 0, 20);
+    writer->close();
+
+    IndexSearcherPtr searcher = newLucene<IndexSearcher>(dir, true);
+    QueryResultCachePtr cache = newLucene<QueryResultCache>(2);
+    for (int32_t i = 0; i < 5; ++i) {
+        cache->search(searcher, newLucene<TermQuery>(newLucene<Term>(L"id", StringUtils::toString(i))), FilterPtr(), 10);
+    }
+    EXPECT_EQ(2, cache->getCacheSize());
+    EXPECT_EQ(3, cache->getEvictionCount());
+
+    // the most recently used searches are kept
+    cache->search(searcher, newLucene<TermQuery>(newLucene<Term>(L"id", L"4")), FilterPtr(), 10);
+    EXPECT_EQ(1, cache->getHitCount());
+    cache->search(searcher, newLucene<TermQuery>(newLucene<Term>(L"id", L"0")), FilterPtr(), 10);
+    EXPECT_EQ(1, cache->getHitCount());
+
+    cache->clear();
+    EXPECT_EQ(0, cache->getCacheSize());
+    searcher->close();
+}
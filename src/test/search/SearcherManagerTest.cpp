@@ -0,0 +1,230 @@
+/////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2009-2014 Alan Wright. All rights reserved.
+// Distributable under the terms of either the Apache License (Version 2.0)
+// or the GNU Lesser General Public License.
+/////////////////////////////////////////////////////////////////////////////
+
+#include "TestInc.h"
+#include "LuceneTestFixture.h"
+#include "SearcherManager.h"
+#include "RAMDirectory.h"
+#include "MockRAMDirectory.h"
+#include "IndexWriter.h"
+#include "IndexReader.h"
+#include "IndexSearcher.h"
+#include "WhitespaceAnalyzer.h"
+#include "Document.h"
+#include "Field.h"
+#include "FieldCache.h"
+#include "TermQuery.h"
+#include "TopDocs.h"
+#include "Term.h"
+#include "LuceneThread.h"
+
+using namespace Lucene;
+
+typedef LuceneTestFixture SearcherManagerTest;
+
+namespace TestSearcherManager {
+
+DECLARE_SHARED_PTR(CountingWarmer)
+
+/// Loads the FieldCache of each segment it is given and remembers the segments.
+class CountingWarmer : public IndexReaderWarmer {
+public:
+    CountingWarmer() {
+        cores = HashSet<LuceneObjectPtr>::newInstance();
+        warmCount = 0;
+    }
+
+    virtual ~CountingWarmer() {
+    }
+
+public:
+    HashSet<LuceneObjectPtr> cores;
+    int32_t warmCount;
+
+public:
+    virtual void warm(const IndexReaderPtr& reader) {
+        SyncLock syncLock(this);
+        FieldCache::DEFAULT()->getInts(reader, L"id");
+        cores.add(reader->getFieldCacheKey());
+        ++warmCount;
+    }
+};
+
+DECLARE_SHARED_PTR(FailingWarmer)
+
+/// Throws a non-Lucene exception while fail is set.
+class FailingWarmer : public IndexReaderWarmer {
+public:
+    FailingWarmer() {
+        fail = false;
+    }
+
+    virtual ~FailingWarmer() {
+    }
+
+public:
+    bool fail;
+
+public:
+    virtual void warm(const IndexReaderPtr& reader) {
+        if (fail) {
+            throw std::runtime_error("warming failed");
+        }
+    }
+};
+
+}
+
+static void addDocuments(const IndexWriterPtr& writer, int32_t start, int32_t end) {
+    for (int32_t i = start; i < end; ++i) {
+        DocumentPtr doc = newLucene<Document>();
+        doc->add(newLucene<Field>(L"id", StringUtils::toString(i), Field::STORE_YES, Field::INDEX_NOT_ANALYZED));
+        doc->add(newLucene<Field>(L"body", L"text", Field::STORE_NO, Field::INDEX_ANALYZED));
+        writer->addDocument(doc);
+    }
+}
+
+static int32_t countDocuments(const SearcherManagerPtr& manager) {
+    IndexSearcherPtr searcher = manager->acquire();
+    int32_t count = searcher->search(newLucene<TermQuery>(newLucene<Term>(L"body", L"text")), 1000)->totalHits;
+    manager->release(searcher);
+    return count;
+}
+
+TEST_F(SearcherManagerTest, testNearRealTime) {
+    RAMDirectoryPtr dir = newLucene<RAMDirectory>();
+    IndexWriterPtr writer = newLucene<IndexWriter>(dir, newLucene<WhitespaceAnalyzer>(), true, IndexWriter::MaxFieldLengthLIMITED);
+    writer->setMergeFactor(1000);
+    addDocuments(writer, 0, 10);
+
+    TestSearcherManager::CountingWarmerPtr warmer = newLucene<TestSearcherManager::CountingWarmer>();
+    SearcherManagerPtr manager = newLucene<SearcherManager>(writer, warmer);
+    EXPECT_EQ(10, countDocuments(manager));
+    EXPECT_EQ(1, warmer->warmCount);
+    EXPECT_TRUE(!manager->maybeRefresh());
+
+    // a searcher acquired before the refresh keeps its reader open until released
+    IndexSearcherPtr old = manager->acquire();
+    addDocuments(writer, 10, 25);
+    EXPECT_TRUE(manager->maybeRefresh());
+    EXPECT_EQ(25, countDocuments(manager));
+    EXPECT_EQ(10, old->search(newLucene<TermQuery>(newLucene<Term>(L"body", L"text")), 1000)->totalHits);
+    EXPECT_EQ(1, old->getIndexReader()->getRefCount());
+    manager->release(old);
+    EXPECT_EQ(0, old->getIndexReader()->getRefCount());
+
+    // only the new segment was warmed
+    EXPECT_EQ(2, warmer->warmCount);
+    IndexSearcherPtr searcher = manager->acquire();
+    Collection<IndexReaderPtr> segments = searcher->getSubReaders();
+    EXPECT_EQ(2, segments.size());
+    for (Collection<IndexReaderPtr>::iterator segment = segments.begin(); segment != segments.end(); ++segment) {
+        EXPECT_TRUE(warmer->cores.contains((*segment)->getFieldCacheKey()));
+    }
+    manager->release(searcher);
+
+    // deletions alone don't need warming
+    writer->deleteDocuments(newLucene<Term>(L"id", L"3"));
+    EXPECT_TRUE(manager->maybeRefresh());
+    EXPECT_EQ(24, countDocuments(manager));
+    EXPECT_EQ(2, warmer->warmCount);
+
+    searcher = manager->acquire();
+    manager->close();
+    EXPECT_EQ(1, searcher->getIndexReader()->getRefCount());
+    manager->release(searcher);
+    EXPECT_EQ(0, searcher->getIndexReader()->getRefCount());
+    try {
+        manager->acquire();
+    } catch (AlreadyClosedException& e) {
+        EXPECT_TRUE(check_exception(LuceneException::AlreadyClosed)(e));
+    }
+    writer->close();
+}
+
+TEST_F(SearcherManagerTest, testDirectory) {
+    RAMDirectoryPtr dir = newLucene<RAMDirectory>();
+    IndexWriterPtr writer = newLucene<IndexWriter>(dir, newLucene<WhitespaceAnalyzer>(), true, IndexWriter::MaxFieldLengthLIMITED);
+    addDocuments(writer, 0, 10);
+    writer->commit();
+
+    SearcherManagerPtr manager = newLucene<SearcherManager>(dir);
+    EXPECT_EQ(10, countDocuments(manager));
+
+    // only commits are seen
+    addDocuments(writer, 10, 20);
+    EXPECT_TRUE(!manager->maybeRefresh());
+    writer->commit();
+    EXPECT_TRUE(manager->maybeRefresh());
+    EXPECT_EQ(20, countDocuments(manager));
+
+    manager->close();
+    writer->close();
+}
+
+TEST_F(SearcherManagerTest, testWarmerFailure) {
+    RAMDirectoryPtr dir = newLucene<RAMDirectory>();
+    IndexWriterPtr writer = newLucene<IndexWriter>(dir, newLucene<WhitespaceAnalyzer>(), true, IndexWriter::MaxFieldLengthLIMITED);
+    addDocuments(writer, 0, 10);
+
+    TestSearcherManager::FailingWarmerPtr warmer = newLucene<TestSearcherManager::FailingWarmer>();
+
+    SearcherManagerPtr manager = newLucene<SearcherManager>(writer, warmer);
+    addDocuments(writer, 10, 20);
+    warmer->fail = true;
+    try {
+        manager->maybeRefresh();
+        FAIL() << "expected std::runtime_error";
+    } catch (std::runtime_error&) {
+    }
+    EXPECT_EQ(10, countDocuments(manager));
+
+    // the failed refresh doesn't block the next one
+    warmer->fail = false;
+    EXPECT_TRUE(manager->maybeRefresh());
+    EXPECT_EQ(20, countDocuments(manager));
+
+    manager->close();
+    writer->close();
+}
+
+TEST_F(SearcherManagerTest, testWarmerFailureOnOpen) {
+    MockRAMDirectoryPtr dir = newLucene<MockRAMDirectory>();
+    IndexWriterPtr writer = newLucene<IndexWriter>(dir, newLucene<WhitespaceAnalyzer>(), true, IndexWriter::MaxFieldLengthLIMITED);
+    addDocuments(writer, 0, 10);
+    writer->close();
+
+    TestSearcherManager::FailingWarmerPtr warmer = newLucene<TestSearcherManager::FailingWarmer>();
+    warmer->fail = true;
+    try {
+        newLucene<SearcherManager>(dir, warmer);
+        FAIL() << "expected std::runtime_error";
+    } catch (std::runtime_error&) {
+    }
+
+    // the reader was closed, so no file is left open
+    dir->close();
+}
+
+TEST_F(SearcherManagerTest, testBackgroundRefresh) {
+    RAMDirectoryPtr dir = newLucene<RAMDirectory>();
+    IndexWriterPtr writer = newLucene<IndexWriter>(dir, newLucene<WhitespaceAnalyzer>(), true, IndexWriter::MaxFieldLengthLIMITED);
+    addDocuments(writer, 0, 10);
+
+    SearcherManagerPtr manager = newLucene<SearcherManager>(writer, newLucene<TestSearcherManager::CountingWarmer>());
+    manager->startRefreshing(10);
+    addDocuments(writer, 10, 20);
+
+    int32_t count = 0;
+    for (int32_t i = 0; i < 500 && count != 20; ++i) {
+        count = countDocuments(manager);
+        LuceneThread::threadSleep(10);
+    }
+    EXPECT_EQ(20, count);
+
+    manager->close();
+    writer->close();
+}
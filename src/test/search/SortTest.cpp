@@ -34,6 +34,7 @@
 #include "TopFieldCollector.h"
 #include "BooleanQuery.h"
 #include "MiscUtils.h"
+#include "PackedComparatorSource.h"
 
 using namespace Lucene;
 
@@ -364,6 +365,40 @@ TEST_F(SortTest, testTypedSort) {
     checkMatches(full, queryY, sort, L"DJHFB");
 }
 
+/// test sorts using the packed field cache give the same order as the typed sorts
+TEST_F(SortTest, testPackedSort) {
+    sort->setSort(newCollection<SortFieldPtr>(newLucene<SortField>(L"int", newLucene<PackedComparatorSource>(SortField::INT)), SortField::FIELD_DOC()));
+    checkMatches(full, queryX, sort, L"IGAEC");
+    checkMatches(full, queryY, sort, L"DHFJB");
+
+    sort->setSort(newCollection<SortFieldPtr>(newLucene<SortField>(L"long", newLucene<PackedComparatorSource>(SortField::LONG)), SortField::FIELD_DOC()));
+    checkMatches(full, queryX, sort, L"EACGI");
+    checkMatches(full, queryY, sort, L"FBJHD");
+
+    sort->setSort(newCollection<SortFieldPtr>(newLucene<SortField>(L"string", newLucene<PackedComparatorSource>(SortField::STRING)), SortField::FIELD_DOC()));
+    checkMatches(full, queryX, sort, L"AIGEC");
+    checkMatches(full, queryY, sort, L"DJHFB");
+
+    sort->setSort(newCollection<SortFieldPtr>(newLucene<SortField>(L"string", newLucene<PackedComparatorSource>(SortField::STRING), true)));
+    checkMatches(full, queryX, sort, L"CEGIA");
+    checkMatches(full, queryY, sort, L"BFHJD");
+
+    // documents without a value sort as 0 and as the empty string
+    sort->setSort(newCollection<SortFieldPtr>(newLucene<SortField>(L"int", newLucene<PackedComparatorSource>(SortField::INT))));
+    checkMatches(full, queryF, sort, L"IZJ");
+
+    sort->setSort(newCollection<SortFieldPtr>(newLucene<SortField>(L"string", newLucene<PackedComparatorSource>(SortField::STRING))));
+    checkMatches(full, queryF, sort, L"ZJI");
+
+    // the parser has to produce the values of the sort type
+    try {
+        newLucene<PackedComparatorSource>(SortField::INT, FieldCache::DEFAULT_LONG_PARSER())->newComparator(L"int", 10, 0, false);
+        FAIL() << "expected IllegalArgumentException";
+    } catch (IllegalArgumentException& e) {
+        EXPECT_TRUE(check_exception(LuceneException::IllegalArgument)(e));
+    }
+}
+
 /// Test String sorting: small queue to many matches, multi field sort, reverse sort
 TEST_F(SortTest, testStringSort) {
     IndexSearcherPtr searcher = getFullStrings();
@@ -19,6 +19,9 @@
 #include "IndexReader.h"
 #include "Collector.h"
 #include "DocIdSetIterator.h"
+#include "TopScoreDocCollector.h"
+#include "TopDocs.h"
+#include "ScoreDoc.h"
 
 using namespace Lucene;
 
@@ -157,3 +160,67 @@ TEST_F(TermScorerTest, testSkipTo) {
     EXPECT_NE(ts->advance(3), DocIdSetIterator::NO_MORE_DOCS);
     EXPECT_EQ(ts->docID(), 5);
 }
+
+TEST_F(TermScorerTest, testSkipsNonCompetitiveBlocks) {
+    // documents have the same length, so only the frequency of "dogs" sets their score
+    RAMDirectoryPtr dir = newLucene<RAMDirectory>();
+    IndexWriterPtr writer = newLucene<IndexWriter>(dir, newLucene<WhitespaceAnalyzer>(), true, IndexWriter::MaxFieldLengthLIMITED);
+    for (int32_t i = 0; i < 3000; ++i) {
+        DocumentPtr doc = newLucene<Document>();
+        String text = i % 300 == 150 ? L"dogs dogs dogs dogs" : L"dogs like playing fetch";
+        doc->add(newLucene<Field>(FIELD, text, Field::STORE_NO, Field::INDEX_ANALYZED));
+        writer->addDocument(doc);
+    }
+    writer->optimize();
+    writer->close();
+
+    IndexSearcherPtr searcher = newLucene<IndexSearcher>(dir, true);
+    TermQueryPtr query = newLucene<TermQuery>(newLucene<Term>(FIELD, L"dogs"));
+
+    TopScoreDocCollectorPtr all = TopScoreDocCollector::create(5, true);
+    searcher->search(query, all);
+    TopDocsPtr expected = all->topDocs();
+    EXPECT_EQ(3000, expected->totalHits);
+
+    TopScoreDocCollectorPtr pruned = TopScoreDocCollector::create(5, true, false);
+    searcher->search(query, pruned);
+    TopDocsPtr actual = pruned->topDocs();
+
+    // the blocks without a document of frequency 4 are skipped once the queue is full
+    EXPECT_TRUE(actual->totalHits < 500);
+    EXPECT_EQ(5, actual->scoreDocs.size());
+    for (int32_t i = 0; i < 5; ++i) {
+        EXPECT_EQ(expected->scoreDocs[i]->doc, actual->scoreDocs[i]->doc);
+        EXPECT_EQ(expected->scoreDocs[i]->score, actual->scoreDocs[i]->score);
+        EXPECT_EQ(150, actual->scoreDocs[i]->doc % 300);
+    }
+    searcher->close();
+}
+
+TEST_F(TermScorerTest, testBlockBoundsFollowNormChanges) {
+    RAMDirectoryPtr dir = newLucene<RAMDirectory>();
+    IndexWriterPtr writer = newLucene<IndexWriter>(dir, newLucene<WhitespaceAnalyzer>(), true, IndexWriter::MaxFieldLengthLIMITED);
+    for (int32_t i = 0; i < 3000; ++i) {
+        DocumentPtr doc = newLucene<Document>();
+        String text = i % 300 == 150 ? L"dogs dogs dogs dogs" : L"dogs like playing fetch";
+        doc->add(newLucene<Field>(FIELD, text, Field::STORE_NO, Field::INDEX_ANALYZED));
+        writer->addDocument(doc);
+    }
+    writer->optimize();
+    writer->close();
+
+    IndexReaderPtr reader = IndexReader::open(dir, false);
+    IndexSearcherPtr searcher = newLucene<IndexSearcher>(reader);
+    TermQueryPtr query = newLucene<TermQuery>(newLucene<Term>(FIELD, L"dogs"));
+    TopScoreDocCollectorPtr pruned = TopScoreDocCollector::create(5, true, false);
+    searcher->search(query, pruned);
+    EXPECT_EQ(150, pruned->topDocs()->scoreDocs[0]->doc);
+
+    // a higher norm makes a document of frequency 1 the best one, so its block must no longer be skipped
+    reader->setNorm(2007, FIELD, (uint8_t)255);
+    pruned = TopScoreDocCollector::create(5, true, false);
+    searcher->search(query, pruned);
+    EXPECT_EQ(2007, pruned->topDocs()->scoreDocs[0]->doc);
+    searcher->close();
+    reader->close();
+}
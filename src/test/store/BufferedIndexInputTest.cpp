@@ -77,6 +77,36 @@ TEST_F(BufferedIndexInputTest, testReadVInt) {
     EXPECT_EQ(indexInput.readVInt(), 201696456);
 }
 
+TEST_F(BufferedIndexInputTest, testReadVInts) {
+    // runs of single byte values mixed with wider values, so the buffer boundary falls inside values
+    Collection<int32_t> values(Collection<int32_t>::newInstance(1000));
+    for (int32_t i = 0; i < values.size(); ++i) {
+        values[i] = (i % 50) < 30 ? (i % 128) : (i * 7919) << (i % 12);
+        if (values[i] < 0) {
+            values[i] = INT_MAX;
+        }
+    }
+    ByteArray inputBytes(ByteArray::newInstance(values.size() * 5));
+    int32_t length = 0;
+    for (int32_t i = 0; i < values.size(); ++i) {
+        int32_t value = values[i];
+        while ((value & ~0x7f) != 0) {
+            inputBytes[length++] = (uint8_t)((value & 0x7f) | 0x80);
+            value = MiscUtils::unsignedShift(value, 7);
+        }
+        inputBytes[length++] = (uint8_t)value;
+    }
+    TestableBufferedIndexInputRead indexInput(inputBytes.get(), length);
+    indexInput.setBufferSize(37);
+    IntArray decoded(IntArray::newInstance(values.size()));
+    indexInput.readVInts(decoded.get(), 3);
+    indexInput.readVInts(decoded.get() + 3, values.size() - 3);
+    for (int32_t i = 0; i < values.size(); ++i) {
+        EXPECT_EQ(values[i], decoded[i]);
+    }
+    EXPECT_EQ(length, indexInput.getFilePointer());
+}
+
 TEST_F(BufferedIndexInputTest, testReadLong) {
     ByteArray inputBytes(ByteArray::newInstance(10));
     uint8_t input[8] = { 32, 43, 32, 96, 12, 54, 22, 96 };
@@ -12,6 +12,7 @@
 #include "FSDirectory.h"
 #include "SimpleFSDirectory.h"
 #include "MMapDirectory.h"
+#include "NIOFSDirectory.h"
 #include "RAMDirectory.h"
 #include "IndexInput.h"
 #include "IndexOutput.h"
@@ -105,6 +106,16 @@ public:
     }
 };
 
+class TestableNIOFSDirectory : public NIOFSDirectory {
+public:
+    TestableNIOFSDirectory(const String& path) : NIOFSDirectory(path) {}
+    virtual ~TestableNIOFSDirectory() {}
+    using NIOFSDirectory::ensureOpen;
+    bool isMMapDirectory() {
+        return false;
+    }
+};
+
 class TestableMMapDirectory : public MMapDirectory {
 public:
     TestableMMapDirectory(const String& path) : MMapDirectory(path) {}
@@ -126,8 +137,17 @@ TEST_F(DirectoryTest, testDirectInstantiation) {
     TestDirectInstantiation::TestableMMapDirectory mmapDir(getTempDir());
     mmapDir.ensureOpen();
 
+    TestDirectInstantiation::TestableNIOFSDirectory nioDir(getTempDir());
+    nioDir.ensureOpen();
+
     TestInstantiationPair(fsDir, mmapDir, L"foo.0", L"foo0.lck");
     TestInstantiationPair(mmapDir, fsDir, L"foo.1", L"foo1.lck");
+
+    TestInstantiationPair(fsDir, nioDir, L"foo.2", L"foo2.lck");
+    TestInstantiationPair(nioDir, fsDir, L"foo.3", L"foo3.lck");
+
+    TestInstantiationPair(nioDir, mmapDir, L"foo.4", L"foo4.lck");
+    TestInstantiationPair(mmapDir, nioDir, L"foo.5", L"foo5.lck");
 }
 
 TEST_F(DirectoryTest, testDontCreate) {
@@ -16,6 +16,11 @@
 #include "Field.h"
 #include "Random.h"
 #include "FileUtils.h"
+#include "IndexInput.h"
+#include "IndexOutput.h"
+#include "TermQuery.h"
+#include "Term.h"
+#include "TopDocs.h"
 
 using namespace Lucene;
 
@@ -65,3 +70,120 @@ TEST_F(MMapDirectoryTest, testMmapIndex) {
 
     FileUtils::removeDirectory(storePathname);
 }
+
+TEST_F(MMapDirectoryTest, testChunkedReads) {
+    String storePathname(FileUtils::joinPath(getTempDir(), L"testLuceneMmapChunks"));
+
+    MMapDirectoryPtr storeDirectory(newLucene<MMapDirectory>(storePathname));
+    storeDirectory->setMaxChunkSize(1);
+    int32_t chunkSize = storeDirectory->getMaxChunkSize();
+    EXPECT_TRUE(chunkSize > 1);
+    EXPECT_EQ(chunkSize & (chunkSize - 1), 0);
+
+    int32_t numBytes = chunkSize * 3 + chunkSize / 2;
+    IndexOutputPtr output = storeDirectory->createOutput(L"chunked.bin");
+    for (int32_t i = 0; i < numBytes; ++i) {
+        output->writeByte((uint8_t)(i % 251));
+    }
+    output->close();
+
+    IndexInputPtr input = storeDirectory->openInput(L"chunked.bin");
+    EXPECT_EQ(input->length(), numBytes);
+    for (int32_t i = 0; i < numBytes; ++i) {
+        EXPECT_EQ(input->readByte(), (uint8_t)(i % 251));
+    }
+    EXPECT_EQ(input->getFilePointer(), numBytes);
+
+    // read across chunk boundaries
+    ByteArray bytes(ByteArray::newInstance(chunkSize * 2));
+    input->seek(chunkSize - 10);
+    input->readBytes(bytes.get(), 0, bytes.size());
+    for (int32_t i = 0; i < bytes.size(); ++i) {
+        EXPECT_EQ(bytes[i], (uint8_t)((chunkSize - 10 + i) % 251));
+    }
+    EXPECT_EQ(input->getFilePointer(), chunkSize * 3 - 10);
+
+    // clones share the mapping but keep their own position
+    IndexInputPtr clone = boost::dynamic_pointer_cast<IndexInput>(input->clone());
+    EXPECT_EQ(clone->getFilePointer(), chunkSize * 3 - 10);
+    clone->seek(chunkSize * 2);
+    EXPECT_EQ(clone->readByte(), (uint8_t)((chunkSize * 2) % 251));
+    EXPECT_EQ(input->readByte(), (uint8_t)((chunkSize * 3 - 10) % 251));
+
+    input->seek(numBytes);
+    try {
+        input->readByte();
+    } catch (LuceneException& e) {
+        EXPECT_TRUE(check_exception(LuceneException::IO)(e));
+    }
+
+    input->close();
+    try {
+        input->clone();
+        FAIL() << "expected AlreadyClosedException";
+    } catch (AlreadyClosedException& e) {
+        EXPECT_TRUE(check_exception(LuceneException::AlreadyClosed)(e));
+    }
+    storeDirectory->close();
+
+    FileUtils::removeDirectory(storePathname);
+}
+
+TEST_F(MMapDirectoryTest, testChunkBoundaryAtEOF) {
+    String storePathname(FileUtils::joinPath(getTempDir(), L"testLuceneMmapBoundary"));
+
+    MMapDirectoryPtr storeDirectory(newLucene<MMapDirectory>(storePathname));
+    storeDirectory->setMaxChunkSize(1);
+    int32_t chunkSize = storeDirectory->getMaxChunkSize();
+
+    IndexOutputPtr output = storeDirectory->createOutput(L"exact.bin");
+    for (int32_t i = 0; i < chunkSize * 2; ++i) {
+        output->writeByte((uint8_t)i);
+    }
+    output->close();
+
+    IndexInputPtr input = storeDirectory->openInput(L"exact.bin");
+    input->seek(chunkSize * 2);
+    EXPECT_EQ(input->getFilePointer(), chunkSize * 2);
+    try {
+        input->readByte();
+    } catch (LuceneException& e) {
+        EXPECT_TRUE(check_exception(LuceneException::IO)(e));
+    }
+    input->seek(chunkSize * 2 - 1);
+    EXPECT_EQ(input->readByte(), (uint8_t)(chunkSize * 2 - 1));
+
+    input->close();
+    storeDirectory->close();
+
+    FileUtils::removeDirectory(storePathname);
+}
+
+TEST_F(MMapDirectoryTest, testAdvice) {
+    String storePathname(FileUtils::joinPath(getTempDir(), L"testLuceneMmapAdvice"));
+
+    MMapDirectoryPtr storeDirectory(newLucene<MMapDirectory>(storePathname));
+    EXPECT_EQ(storeDirectory->getAdvice(L"frq"), MMapDirectory::ADVICE_NORMAL);
+    storeDirectory->setAdvice(L"frq", MMapDirectory::ADVICE_RANDOM);
+    storeDirectory->setAdvice(L"fdt", MMapDirectory::ADVICE_WILLNEED);
+    EXPECT_EQ(storeDirectory->getAdvice(L"frq"), MMapDirectory::ADVICE_RANDOM);
+    EXPECT_EQ(storeDirectory->getAdvice(L"fdt"), MMapDirectory::ADVICE_WILLNEED);
+
+    storeDirectory->setMaxChunkSize(1);
+
+    IndexWriterPtr writer = newLucene<IndexWriter>(storeDirectory, newLucene<StandardAnalyzer>(LuceneVersion::LUCENE_CURRENT), true, IndexWriter::MaxFieldLengthLIMITED);
+    writer->setUseCompoundFile(false);
+    for (int32_t dx = 0; dx < 1000; ++dx) {
+        DocumentPtr doc = newLucene<Document>();
+        doc->add(newLucene<Field>(L"data", randomField() + L" common", Field::STORE_YES, Field::INDEX_ANALYZED));
+        writer->addDocument(doc);
+    }
+    writer->close();
+
+    IndexSearcherPtr searcher = newLucene<IndexSearcher>(storeDirectory, true);
+    EXPECT_EQ(searcher->search(newLucene<TermQuery>(newLucene<Term>(L"data", L"common")), 1000)->totalHits, 1000);
+    searcher->close();
+    storeDirectory->close();
+
+    FileUtils::removeDirectory(storePathname);
+}
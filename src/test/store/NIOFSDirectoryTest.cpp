@@ -0,0 +1,132 @@
+/////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2009-2014 Alan Wright. All rights reserved.
+// Distributable under the terms of either the Apache License (Version 2.0)
+// or the GNU Lesser General Public License.
+/////////////////////////////////////////////////////////////////////////////
+
+#include "TestInc.h"
+#include "LuceneTestFixture.h"
+#include "TestUtils.h"
+#include "NIOFSDirectory.h"
+#include "IndexInput.h"
+#include "IndexOutput.h"
+#include "LuceneThread.h"
+#include "WhitespaceAnalyzer.h"
+#include "IndexWriter.h"
+#include "IndexSearcher.h"
+#include "Document.h"
+#include "Field.h"
+#include "TermQuery.h"
+#include "Term.h"
+#include "TopDocs.h"
+#include "Random.h"
+#include "FileUtils.h"
+
+using namespace Lucene;
+
+typedef LuceneTestFixture NIOFSDirectoryTest;
+
+namespace TestConcurrentReads {
+
+class ReadThread : public LuceneThread {
+public:
+    ReadThread(const IndexInputPtr& input, int32_t seed) {
+        this->input = input;
+        this->rand = newLucene<Random>(seed);
+    }
+
+    virtual ~ReadThread() {
+    }
+
+    LUCENE_CLASS(ReadThread);
+
+protected:
+    IndexInputPtr input;
+    RandomPtr rand;
+
+public:
+    virtual void run() {
+        try {
+            IndexInputPtr clone = boost::dynamic_pointer_cast<IndexInput>(input->clone());
+            ByteArray bytes(ByteArray::newInstance(100));
+            for (int32_t i = 0; i < 1000; ++i) {
+                int32_t pos = rand->nextInt((int32_t)clone->length() - bytes.size());
+                clone->seek(pos);
+                clone->readBytes(bytes.get(), 0, bytes.size());
+                for (int32_t j = 0; j < bytes.size(); ++j) {
+                    if (bytes[j] != (uint8_t)((pos + j) % 251)) {
+                        FAIL() << "Invalid byte read at position " << (pos + j);
+                    }
+                }
+            }
+            clone->close();
+        } catch (LuceneException& e) {
+            FAIL() << "Unexpected exception: " << e.getError();
+        }
+    }
+};
+
+}
+
+TEST_F(NIOFSDirectoryTest, testConcurrentReads) {
+    String storePathname(FileUtils::joinPath(getTempDir(), L"testLuceneNIOFS"));
+    NIOFSDirectoryPtr dir(newLucene<NIOFSDirectory>(storePathname));
+
+    int32_t numBytes = 100000;
+    IndexOutputPtr output = dir->createOutput(L"test.bin");
+    for (int32_t i = 0; i < numBytes; ++i) {
+        output->writeByte((uint8_t)(i % 251));
+    }
+    output->close();
+
+    IndexInputPtr input = dir->openInput(L"test.bin");
+    EXPECT_EQ(input->length(), numBytes);
+
+    Collection<LuceneThreadPtr> threads = Collection<LuceneThreadPtr>::newInstance(10);
+    for (int32_t i = 0; i < threads.size(); ++i) {
+        threads[i] = newLucene<TestConcurrentReads::ReadThread>(input, i);
+        threads[i]->start();
+    }
+    for (int32_t i = 0; i < threads.size(); ++i) {
+        threads[i]->join();
+    }
+
+    // the original input is unaffected by its clones
+    EXPECT_EQ(input->getFilePointer(), 0);
+    EXPECT_EQ(input->readByte(), 0);
+
+    input->seek(numBytes);
+    try {
+        input->readByte();
+    } catch (LuceneException& e) {
+        EXPECT_TRUE(check_exception(LuceneException::IO)(e));
+    }
+
+    input->close();
+    dir->close();
+
+    FileUtils::removeDirectory(storePathname);
+}
+
+TEST_F(NIOFSDirectoryTest, testIndexAndSearch) {
+    String storePathname(FileUtils::joinPath(getTempDir(), L"testLuceneNIOFSIndex"));
+    NIOFSDirectoryPtr dir(newLucene<NIOFSDirectory>(storePathname));
+
+    IndexWriterPtr writer = newLucene<IndexWriter>(dir, newLucene<WhitespaceAnalyzer>(), true, IndexWriter::MaxFieldLengthLIMITED);
+    for (int32_t i = 0; i < 500; ++i) {
+        DocumentPtr doc = newLucene<Document>();
+        doc->add(newLucene<Field>(L"id", StringUtils::toString(i), Field::STORE_YES, Field::INDEX_NOT_ANALYZED));
+        doc->add(newLucene<Field>(L"content", i % 2 == 0 ? L"even common" : L"odd common", Field::STORE_NO, Field::INDEX_ANALYZED));
+        writer->addDocument(doc);
+    }
+    writer->close();
+
+    IndexSearcherPtr searcher = newLucene<IndexSearcher>(dir, true);
+    EXPECT_EQ(searcher->search(newLucene<TermQuery>(newLucene<Term>(L"content", L"common")), 10)->totalHits, 500);
+    EXPECT_EQ(searcher->search(newLucene<TermQuery>(newLucene<Term>(L"content", L"even")), 10)->totalHits, 250);
+    EXPECT_EQ(searcher->doc(42)->get(L"id"), L"42");
+    searcher->close();
+    dir->close();
+
+    FileUtils::removeDirectory(storePathname);
+}
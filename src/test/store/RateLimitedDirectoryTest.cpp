@@ -0,0 +1,70 @@
+/////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2009-2014 Alan Wright. All rights reserved.
+// Distributable under the terms of either the Apache License (Version 2.0)
+// or the GNU Lesser General Public License.
+/////////////////////////////////////////////////////////////////////////////
+
+#include "TestInc.h"
+#include "LuceneTestFixture.h"
+#include "RateLimitedDirectory.h"
+#include "RateLimitedIndexOutput.h"
+#include "RateLimiter.h"
+#include "MockRAMDirectory.h"
+#include "IndexOutput.h"
+#include "IndexInput.h"
+#include "MiscUtils.h"
+
+using namespace Lucene;
+
+typedef LuceneTestFixture RateLimitedDirectoryTest;
+
+TEST_F(RateLimitedDirectoryTest, testWriteRate) {
+    static const int32_t NUM_BYTES = 1024 * 1024;
+    MockRAMDirectoryPtr dir = newLucene<MockRAMDirectory>();
+    RateLimiterPtr rateLimiter = newLucene<RateLimiter>(8.0);
+    DirectoryPtr limitedDir = newLucene<RateLimitedDirectory>(dir, rateLimiter);
+
+    ByteArray bytes(ByteArray::newInstance(1000));
+    for (int32_t i = 0; i < bytes.size(); ++i) {
+        bytes[i] = (uint8_t)i;
+    }
+
+    int64_t start = MiscUtils::nanoTime();
+    IndexOutputPtr output = limitedDir->createOutput(L"test");
+    EXPECT_TRUE(boost::dynamic_pointer_cast<RateLimitedIndexOutput>(output));
+    int32_t written = 0;
+    while (written < NUM_BYTES) {
+        output->writeByte((uint8_t)written);
+        output->writeBytes(bytes.get(), 0, bytes.size());
+        written += 1 + bytes.size();
+    }
+    output->close();
+    int64_t elapsedMillis = (MiscUtils::nanoTime() - start) / 1000000;
+
+    // 1MB at 8MB/sec takes at least 125 msec
+    EXPECT_TRUE(elapsedMillis >= 100);
+    EXPECT_EQ(written, dir->fileLength(L"test"));
+
+    // the bytes are passed through unchanged, and reading isn't limited
+    IndexInputPtr input = limitedDir->openInput(L"test");
+    ByteArray readBytes(ByteArray::newInstance(bytes.size()));
+    for (int32_t i = 0; i < written; i += 1 + bytes.size()) {
+        EXPECT_EQ((uint8_t)i, input->readByte());
+        input->readBytes(readBytes.get(), 0, readBytes.size());
+        EXPECT_TRUE(readBytes.equals(bytes));
+    }
+    input->close();
+    limitedDir->close();
+}
+
+TEST_F(RateLimitedDirectoryTest, testMbPerSec) {
+    RateLimiterPtr rateLimiter = newLucene<RateLimiter>(10.0);
+    EXPECT_EQ(10.0, rateLimiter->getMbPerSec());
+    rateLimiter->setMbPerSec(2.5);
+    EXPECT_EQ(2.5, rateLimiter->getMbPerSec());
+    try {
+        rateLimiter->setMbPerSec(0.0);
+    } catch (IllegalArgumentException& e) {
+        EXPECT_TRUE(check_exception(LuceneException::IllegalArgument)(e));
+    }
+}
@@ -44,3 +44,85 @@ TEST_F(CloseableThreadLocalTest, testDefaultValueWithoutSetting) {
     EXPECT_TRUE(!ctl.get());
     EXPECT_TRUE(!ctl.get());
 }
+
+namespace TestPerThreadValues {
+
+class CountingThreadLocal : public CloseableThreadLocal<int32_t> {
+public:
+    CountingThreadLocal() {
+        count = 0;
+    }
+
+    virtual ~CountingThreadLocal() {
+    }
+
+protected:
+    int32_t count;
+
+protected:
+    virtual boost::shared_ptr<int32_t> initialValue() {
+        SyncLock syncLock(this);
+        return newInstance<int32_t>(count++);
+    }
+};
+
+class ValueThread : public LuceneThread {
+public:
+    ValueThread(CountingThreadLocal* tl) {
+        this->tl = tl;
+        this->value = -1;
+        this->same = false;
+    }
+
+    virtual ~ValueThread() {
+    }
+
+    LUCENE_CLASS(ValueThread);
+
+public:
+    CountingThreadLocal* tl;
+    int32_t value;
+    bool same;
+
+public:
+    virtual void run() {
+        boost::shared_ptr<int32_t> first(tl->get());
+        for (int32_t i = 0; i < 1000; ++i) {
+            LuceneThread::threadYield();
+        }
+        same = (first == tl->get());
+        value = *first;
+    }
+};
+
+}
+
+/// Each thread sees its own value, created once.
+TEST_F(CloseableThreadLocalTest, testPerThreadValues) {
+    TestPerThreadValues::CountingThreadLocal tl;
+    Collection<LuceneThreadPtr> threads(Collection<LuceneThreadPtr>::newInstance(8));
+    for (int32_t i = 0; i < threads.size(); ++i) {
+        threads[i] = newLucene<TestPerThreadValues::ValueThread>(&tl);
+        threads[i]->start();
+    }
+    Collection<int32_t> values(Collection<int32_t>::newInstance());
+    for (int32_t i = 0; i < threads.size(); ++i) {
+        threads[i]->join();
+        boost::shared_ptr<TestPerThreadValues::ValueThread> thread(boost::dynamic_pointer_cast<TestPerThreadValues::ValueThread>(threads[i]));
+        EXPECT_TRUE(thread->same);
+        EXPECT_TRUE(!values.contains(thread->value));
+        values.add(thread->value);
+    }
+    EXPECT_EQ(threads.size(), *tl.get());
+}
+
+/// Closing releases the value held for the current thread.
+TEST_F(CloseableThreadLocalTest, testCloseReleasesValue) {
+    CloseableThreadLocal<String> ctl;
+    ctl.set(newInstance<String>(TEST_VALUE));
+    boost::weak_ptr<String> value(ctl.get());
+    EXPECT_EQ(TEST_VALUE, *value.lock());
+    ctl.close();
+    EXPECT_TRUE(value.expired());
+    EXPECT_TRUE(!ctl.get());
+}
@@ -0,0 +1,115 @@
+/////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2009-2014 Alan Wright. All rights reserved.
+// Distributable under the terms of either the Apache License (Version 2.0)
+// or the GNU Lesser General Public License.
+/////////////////////////////////////////////////////////////////////////////
+
+#include "TestInc.h"
+#include "LuceneTestFixture.h"
+#include "LZ4.h"
+#include "Random.h"
+#include "MiscUtils.h"
+
+using namespace Lucene;
+
+typedef LuceneTestFixture LZ4Test;
+
+static int32_t checkRoundTrip(const ByteArray& data, int32_t length) {
+    ByteArray compressed(ByteArray::newInstance(LZ4::maxCompressedLength(length)));
+    int32_t compressedLength = LZ4::compress(data.get(), length, compressed.get());
+    EXPECT_TRUE(compressedLength <= LZ4::maxCompressedLength(length));
+
+    ByteArray decompressed(ByteArray::newInstance(length + 1));
+    EXPECT_EQ(length, LZ4::decompress(compressed.get(), compressedLength, decompressed.get(), length));
+    for (int32_t i = 0; i < length; ++i) {
+        EXPECT_EQ(data[i], decompressed[i]);
+    }
+    return compressedLength;
+}
+
+TEST_F(LZ4Test, testEmptyAndShort) {
+    ByteArray data(ByteArray::newInstance(20));
+    for (int32_t i = 0; i < data.size(); ++i) {
+        data[i] = (uint8_t)i;
+    }
+    for (int32_t length = 0; length <= data.size(); ++length) {
+        checkRoundTrip(data, length);
+    }
+}
+
+TEST_F(LZ4Test, testRepetitive) {
+    String text;
+    for (int32_t i = 0; i < 1000; ++i) {
+        text += L"the quick brown fox jumps over the lazy dog ";
+    }
+    ByteArray data(ByteArray::newInstance(text.length()));
+    for (int32_t i = 0; i < data.size(); ++i) {
+        data[i] = (uint8_t)text[i];
+    }
+    int32_t compressedLength = checkRoundTrip(data, data.size());
+    EXPECT_TRUE(compressedLength < data.size() / 20);
+}
+
+TEST_F(LZ4Test, testOverlappingMatches) {
+    // Runs of the same byte are back references to the previous byte, overlapping the bytes they produce
+    ByteArray data(ByteArray::newInstance(5000));
+    for (int32_t i = 0; i < data.size(); ++i) {
+        data[i] = (uint8_t)(i < 2500 ? 'a' : (i % 3));
+    }
+    int32_t compressedLength = checkRoundTrip(data, data.size());
+    EXPECT_TRUE(compressedLength < 100);
+}
+
+TEST_F(LZ4Test, testRandom) {
+    RandomPtr random = newLucene<Random>(42);
+    ByteArray data(ByteArray::newInstance(100000));
+    for (int32_t iter = 0; iter < 20; ++iter) {
+        // From incompressible to mostly repeated bytes, and back references further than 64 KB
+        int32_t alphabet = 1 + random->nextInt(256);
+        int32_t length = random->nextInt(data.size());
+        for (int32_t i = 0; i < length; ++i) {
+            if (i > 70000 && random->nextInt(4) != 0) {
+                data[i] = data[i - 70000];
+            } else {
+                data[i] = (uint8_t)random->nextInt(alphabet);
+            }
+        }
+        checkRoundTrip(data, length);
+    }
+}
+
+TEST_F(LZ4Test, testCorrupt) {
+    ByteArray data(ByteArray::newInstance(1000));
+    for (int32_t i = 0; i < data.size(); ++i) {
+        data[i] = (uint8_t)(i % 10);
+    }
+    ByteArray compressed(ByteArray::newInstance(LZ4::maxCompressedLength(data.size())));
+    int32_t compressedLength = LZ4::compress(data.get(), data.size(), compressed.get());
+    ByteArray decompressed(ByteArray::newInstance(data.size()));
+
+    // Too small a destination
+    try {
+        LZ4::decompress(compressed.get(), compressedLength, decompressed.get(), data.size() - 1);
+    } catch (CompressionException& e) {
+        EXPECT_TRUE(check_exception(LuceneException::Compression)(e));
+    }
+
+    // Truncated input
+    try {
+        LZ4::decompress(compressed.get(), compressedLength - 1, decompressed.get(), data.size());
+    } catch (CompressionException& e) {
+        EXPECT_TRUE(check_exception(LuceneException::Compression)(e));
+    }
+
+    // Any corrupt byte is detected or decompresses to garbage, but never reads or writes out of bounds
+    for (int32_t i = 0; i < compressedLength; ++i) {
+        ByteArray corrupt(ByteArray::newInstance(compressedLength));
+        MiscUtils::arrayCopy(compressed.get(), 0, corrupt.get(), 0, compressedLength);
+        corrupt[i] = (uint8_t)0xff;
+        try {
+            LZ4::decompress(corrupt.get(), compressedLength, decompressed.get(), data.size());
+        } catch (CompressionException& e) {
+            EXPECT_TRUE(check_exception(LuceneException::Compression)(e));
+        }
+    }
+}
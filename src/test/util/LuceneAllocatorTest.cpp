@@ -0,0 +1,153 @@
+/////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2009-2014 Alan Wright. All rights reserved.
+// Distributable under the terms of either the Apache License (Version 2.0)
+// or the GNU Lesser General Public License.
+/////////////////////////////////////////////////////////////////////////////
+
+#include "TestInc.h"
+#include "LuceneTestFixture.h"
+#include <boost/atomic.hpp>
+#include "LuceneAllocator.h"
+#include "LuceneThread.h"
+#include "Term.h"
+
+using namespace Lucene;
+
+typedef LuceneTestFixture LuceneAllocatorTest;
+
+TEST_F(LuceneAllocatorTest, testReallocPreservesContents) {
+    uint8_t* memory = (uint8_t*)AllocMemory(10);
+    for (int32_t i = 0; i < 10; ++i) {
+        memory[i] = (uint8_t)i;
+    }
+    memory = (uint8_t*)ReallocMemory(memory, 100000);
+    for (int32_t i = 0; i < 10; ++i) {
+        EXPECT_EQ(i, memory[i]);
+    }
+    FreeMemory(memory);
+    EXPECT_TRUE(ReallocMemory(AllocMemory(10), 0) == NULL);
+}
+
+TEST_F(LuceneAllocatorTest, testPoolReusesBlocks) {
+    // blocks remember their allocator, so the pool has to outlive every block allocated from it
+    static PoolMemoryAllocator* pool = new PoolMemoryAllocator();
+    MemoryAllocator* previous = GetMemoryAllocator();
+    void* second = NULL;
+    void* large = NULL;
+    {
+        ScopedMemoryAllocator scoped(pool);
+        EXPECT_EQ(pool, GetMemoryAllocator());
+        void* first = AllocMemory(40);
+        FreeMemory(first);
+        second = AllocMemory(33); // same size class
+        large = AllocMemory(PoolMemoryAllocator::MAX_POOLED_SIZE * 2);
+        EXPECT_EQ(first, second);
+    }
+    EXPECT_EQ(previous, GetMemoryAllocator());
+
+    // blocks go back to the allocator they came from, even after it is uninstalled
+    FreeMemory(second);
+    FreeMemory(large);
+    pool->reset();
+}
+
+namespace TestLuceneAllocator {
+
+/// Installs its pool in a scope, frees a block into the pool, then waits to be released before leaving
+/// the scope.
+class PoolThread : public LuceneThread {
+public:
+    PoolThread(MemoryAllocator* pool) : pool(pool), ready(false), done(false), seen(NULL), seenInScope(NULL) {
+    }
+
+    virtual ~PoolThread() {
+    }
+
+    LUCENE_CLASS(PoolThread);
+
+public:
+    MemoryAllocator* pool;
+    boost::atomic<bool> ready;
+    boost::atomic<bool> done;
+    MemoryAllocator* seen;
+    MemoryAllocator* seenInScope;
+
+public:
+    virtual void run() {
+        seen = GetMemoryAllocator();
+        {
+            ScopedMemoryAllocator scoped(pool);
+            FreeMemory(AllocMemory(40));
+            ready = true;
+            while (!done) {
+                LuceneThread::threadSleep(1);
+            }
+            seenInScope = GetMemoryAllocator();
+        }
+    }
+};
+
+DECLARE_SHARED_PTR(PoolThread)
+
+}
+
+TEST_F(LuceneAllocatorTest, testScopedAllocatorIsPerThread) {
+    static PoolMemoryAllocator* mainPool = new PoolMemoryAllocator();
+    static PoolMemoryAllocator* threadPool = new PoolMemoryAllocator();
+    MemoryAllocator* previous = GetMemoryAllocator();
+    TestLuceneAllocator::PoolThreadPtr thread = newLucene<TestLuceneAllocator::PoolThread>(threadPool);
+    {
+        ScopedMemoryAllocator scoped(mainPool);
+        thread->start();
+        while (!thread->ready) {
+            LuceneThread::threadSleep(1);
+        }
+        EXPECT_EQ(mainPool, GetMemoryAllocator());
+    }
+    // the scopes overlap but don't end in reverse order, and neither disturbs the other thread
+    EXPECT_EQ(previous, GetMemoryAllocator());
+    thread->done = true;
+    thread->join();
+    EXPECT_EQ(previous, thread->seen);
+    EXPECT_EQ(threadPool, thread->seenInScope);
+    EXPECT_EQ(previous, GetMemoryAllocator());
+}
+
+TEST_F(LuceneAllocatorTest, testPoolDestroyedBeforeThreadExits) {
+    PoolMemoryAllocator* pool = new PoolMemoryAllocator();
+    TestLuceneAllocator::PoolThreadPtr thread = newLucene<TestLuceneAllocator::PoolThread>(pool);
+    thread->start();
+    while (!thread->ready) {
+        LuceneThread::threadSleep(1);
+    }
+    // the block cached by the other thread is freed with the pool, and the thread can still exit cleanly
+    delete pool;
+    thread->done = true;
+    thread->join();
+}
+
+TEST_F(LuceneAllocatorTest, testArenaObjectsOutliveArena) {
+    TermPtr term;
+    ByteArray bytes;
+    {
+        MemoryArena arena;
+        EXPECT_EQ(&arena, MemoryArena::current());
+        for (int32_t i = 0; i < 10000; ++i) {
+            newLucene<Term>(L"field", L"text");
+        }
+        term = newLucene<Term>(L"field", L"kept");
+        arena.reset(); // the kept term's chunk is released once the term is
+        EXPECT_EQ(L"kept", term->text());
+        newLucene<Term>(L"field", L"text");
+        bytes = ByteArray::newInstance(MemoryArena::CHUNK_SIZE); // too large for the arena
+        {
+            MemoryArena nested;
+            EXPECT_EQ(&nested, MemoryArena::current());
+        }
+        EXPECT_EQ(&arena, MemoryArena::current());
+    }
+    EXPECT_TRUE(MemoryArena::current() == NULL);
+    EXPECT_EQ(L"kept", term->text());
+    bytes[MemoryArena::CHUNK_SIZE - 1] = 1;
+    EXPECT_EQ(1, bytes[MemoryArena::CHUNK_SIZE - 1]);
+}
@@ -0,0 +1,61 @@
+/////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2009-2014 Alan Wright. All rights reserved.
+// Distributable under the terms of either the Apache License (Version 2.0)
+// or the GNU Lesser General Public License.
+/////////////////////////////////////////////////////////////////////////////
+
+#include "TestInc.h"
+#include "LuceneTestFixture.h"
+#include "PackedInts.h"
+#include "Random.h"
+
+using namespace Lucene;
+
+typedef LuceneTestFixture PackedIntsTest;
+
+TEST_F(PackedIntsTest, testBitsRequired) {
+    EXPECT_EQ(PackedInts::bitsRequired(0), 1);
+    EXPECT_EQ(PackedInts::bitsRequired(1), 1);
+    EXPECT_EQ(PackedInts::bitsRequired(2), 2);
+    EXPECT_EQ(PackedInts::bitsRequired(255), 8);
+    EXPECT_EQ(PackedInts::bitsRequired(256), 9);
+    EXPECT_EQ(PackedInts::bitsRequired(INT_MAX), 31);
+    EXPECT_EQ(PackedInts::bitsRequired(LLONG_MAX), 63);
+    EXPECT_EQ(PackedInts::bitsRequired(-1), 64);
+}
+
+TEST_F(PackedIntsTest, testRandomValues) {
+    RandomPtr random = newLucene<Random>(42);
+    for (int32_t bitsPerValue = 1; bitsPerValue <= 64; ++bitsPerValue) {
+        int32_t valueCount = 1 + random->nextInt(500);
+        PackedIntsPtr packed = newLucene<PackedInts>(valueCount, bitsPerValue);
+        EXPECT_EQ(packed->size(), valueCount);
+        EXPECT_EQ(packed->getBitsPerValue(), bitsPerValue);
+
+        Collection<int64_t> values = Collection<int64_t>::newInstance(valueCount);
+        uint64_t mask = bitsPerValue == 64 ? (uint64_t)-1 : (((uint64_t)1 << bitsPerValue) - 1);
+        for (int32_t i = 0; i < valueCount; ++i) {
+            EXPECT_EQ(packed->get(i), 0);
+            uint64_t value = ((uint64_t)random->nextInt() << 32) ^ (uint64_t)(uint32_t)random->nextInt();
+            values[i] = (int64_t)(value & mask);
+            packed->set(i, values[i]);
+        }
+        for (int32_t i = 0; i < valueCount; ++i) {
+            EXPECT_EQ(packed->get(i), values[i]);
+        }
+
+        // overwrite every other value and make sure neighbours are unaffected
+        for (int32_t i = 0; i < valueCount; i += 2) {
+            values[i] = (int64_t)(mask - (uint64_t)values[i]);
+            packed->set(i, values[i]);
+        }
+        for (int32_t i = 0; i < valueCount; ++i) {
+            EXPECT_EQ(packed->get(i), values[i]);
+        }
+    }
+}
+
+TEST_F(PackedIntsTest, testRamBytesUsed) {
+    PackedIntsPtr packed = newLucene<PackedInts>(1000, 3);
+    EXPECT_TRUE(packed->ramBytesUsed() < 1000);
+}
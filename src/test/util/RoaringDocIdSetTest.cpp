@@ -0,0 +1,105 @@
+/////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2009-2014 Alan Wright. All rights reserved.
+// Distributable under the terms of either the Apache License (Version 2.0)
+// or the GNU Lesser General Public License.
+/////////////////////////////////////////////////////////////////////////////
+
+#include "TestInc.h"
+#include "LuceneTestFixture.h"
+#include "RoaringDocIdSet.h"
+#include "OpenBitSet.h"
+#include "OpenBitSetIterator.h"
+#include "DocIdSetIterator.h"
+#include "Random.h"
+
+using namespace Lucene;
+
+typedef LuceneTestFixture RoaringDocIdSetTest;
+
+static const int32_t MAX_DOC = 300000;
+
+/// Sparse documents in the first block, a dense block, a block of long runs and a single document.
+static OpenBitSetPtr createBits(const RandomPtr& random) {
+    OpenBitSetPtr bits = newLucene<OpenBitSet>(MAX_DOC);
+    for (int32_t i = 0; i < 1000; ++i) {
+        bits->set(random->nextInt(65536));
+    }
+    for (int32_t i = 0; i < 40000; ++i) {
+        bits->set(65536 + random->nextInt(65536));
+    }
+    for (int32_t start = 131072; start < 196608; start += 2000) {
+        bits->set(start, start + 1000);
+    }
+    bits->set(MAX_DOC - 1);
+    return bits;
+}
+
+static void checkEquals(const OpenBitSetPtr& bits, const RoaringDocIdSetPtr& set, const RandomPtr& random) {
+    EXPECT_EQ(bits->cardinality(), set->size());
+
+    DocIdSetIteratorPtr expected = newLucene<OpenBitSetIterator>(bits);
+    DocIdSetIteratorPtr actual = set->iterator();
+    for (int32_t doc = expected->nextDoc(); doc != DocIdSetIterator::NO_MORE_DOCS; doc = expected->nextDoc()) {
+        EXPECT_EQ(doc, actual->nextDoc());
+    }
+    EXPECT_EQ(DocIdSetIterator::NO_MORE_DOCS, actual->nextDoc());
+    EXPECT_EQ(DocIdSetIterator::NO_MORE_DOCS, actual->nextDoc());
+
+    expected = newLucene<OpenBitSetIterator>(bits);
+    actual = set->iterator();
+    int32_t doc = -1;
+    while (doc != DocIdSetIterator::NO_MORE_DOCS) {
+        int32_t target = doc + 1 + random->nextInt(5000);
+        doc = expected->advance(target);
+        EXPECT_EQ(doc, actual->advance(target));
+        EXPECT_EQ(doc, actual->docID());
+    }
+
+    for (int32_t i = 0; i < 1000; ++i) {
+        int32_t doc = random->nextInt(MAX_DOC);
+        EXPECT_EQ(bits->get(doc), set->contains(doc));
+    }
+}
+
+TEST_F(RoaringDocIdSetTest, testEmpty) {
+    RoaringDocIdSetPtr set = newLucene<RoaringDocIdSet>(newLucene<OpenBitSetIterator>(newLucene<OpenBitSet>(MAX_DOC)));
+    EXPECT_EQ(0, set->size());
+    EXPECT_TRUE(set->isCacheable());
+    EXPECT_EQ(DocIdSetIterator::NO_MORE_DOCS, set->iterator()->nextDoc());
+    EXPECT_EQ(DocIdSetIterator::NO_MORE_DOCS, set->iterator()->advance(10));
+    EXPECT_TRUE(!set->contains(0));
+}
+
+TEST_F(RoaringDocIdSetTest, testIterate) {
+    RandomPtr random = newLucene<Random>(123);
+    OpenBitSetPtr bits = createBits(random);
+    RoaringDocIdSetPtr set = newLucene<RoaringDocIdSet>(newLucene<OpenBitSetIterator>(bits));
+    checkEquals(bits, set, random);
+}
+
+TEST_F(RoaringDocIdSetTest, testIntersect) {
+    RandomPtr random = newLucene<Random>(456);
+    OpenBitSetPtr bits1 = createBits(random);
+    OpenBitSetPtr bits2 = createBits(random);
+    RoaringDocIdSetPtr set1 = newLucene<RoaringDocIdSet>(newLucene<OpenBitSetIterator>(bits1));
+    RoaringDocIdSetPtr set2 = newLucene<RoaringDocIdSet>(newLucene<OpenBitSetIterator>(bits2));
+    RoaringDocIdSetPtr intersection = set1->intersect(set2);
+    bits1->intersect(bits2);
+    checkEquals(bits1, intersection, random);
+    checkEquals(bits1, set2->intersect(set1), random);
+}
+
+TEST_F(RoaringDocIdSetTest, testRamBytesUsed) {
+    RandomPtr random = newLucene<Random>(789);
+    OpenBitSetPtr bits = createBits(random);
+    RoaringDocIdSetPtr set = newLucene<RoaringDocIdSet>(newLucene<OpenBitSetIterator>(bits));
+    // array of 1000 values, 8KB bitmap, 33 runs and one value, well under the 37KB of the bitset
+    EXPECT_TRUE(set->ramBytesUsed() < 12000);
+
+    OpenBitSetPtr all = newLucene<OpenBitSet>(MAX_DOC);
+    all->set(0, MAX_DOC);
+    RoaringDocIdSetPtr allSet = newLucene<RoaringDocIdSet>(newLucene<OpenBitSetIterator>(all));
+    EXPECT_EQ(MAX_DOC, allSet->size());
+    EXPECT_TRUE(allSet->ramBytesUsed() < 200);
+    checkEquals(all, allSet, random);
+}
@@ -0,0 +1,127 @@
+/////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2009-2014 Alan Wright. All rights reserved.
+// Distributable under the terms of either the Apache License (Version 2.0)
+// or the GNU Lesser General Public License.
+/////////////////////////////////////////////////////////////////////////////
+
+#include "TestInc.h"
+#include "LuceneTestFixture.h"
+#include "ThreadPool.h"
+
+using namespace Lucene;
+
+typedef LuceneTestFixture ThreadPoolTest;
+
+namespace TestThreadPool {
+
+static int32_t square(int32_t value) {
+    return value * value;
+}
+
+static int32_t fail(int32_t value) {
+    boost::throw_exception(IllegalStateException(L"task failed"));
+    return value;
+}
+
+static int32_t throwUnknown(int32_t value) {
+    throw value;
+}
+
+static int32_t waitAndHold(const ThreadPoolPtr& pool, boost::mutex* mutex) {
+    // the bound pool is the last reference once the caller has released its own
+    boost::mutex::scoped_lock lock(*mutex);
+    return 1;
+}
+
+static int32_t sumSquares(const ThreadPoolPtr& pool, int32_t count) {
+    // schedules sub-tasks from within a pool thread and waits on them
+    Collection<FuturePtr> futures = Collection<FuturePtr>::newInstance(count);
+    for (int32_t i = 0; i < count; ++i) {
+        futures[i] = pool->scheduleTask(boost::protect(boost::bind<int32_t>(&square, i)));
+    }
+    int32_t sum = 0;
+    for (int32_t i = 0; i < count; ++i) {
+        sum += futures[i]->get<int32_t>();
+    }
+    return sum;
+}
+
+}
+
+TEST_F(ThreadPoolTest, testDefaultSize) {
+    EXPECT_TRUE(ThreadPool::availableProcessors() >= 1);
+    EXPECT_EQ(newLucene<ThreadPool>()->getNumThreads(), ThreadPool::availableProcessors());
+    EXPECT_EQ(newLucene<ThreadPool>(3)->getNumThreads(), 3);
+}
+
+TEST_F(ThreadPoolTest, testScheduleTasks) {
+    ThreadPoolPtr pool = newLucene<ThreadPool>(4);
+    Collection<FuturePtr> futures = Collection<FuturePtr>::newInstance(1000);
+    for (int32_t i = 0; i < futures.size(); ++i) {
+        futures[i] = pool->scheduleTask(boost::protect(boost::bind<int32_t>(&TestThreadPool::square, i)));
+    }
+    for (int32_t i = 0; i < futures.size(); ++i) {
+        EXPECT_EQ(futures[i]->get<int32_t>(), i * i);
+        EXPECT_TRUE(futures[i]->isDone());
+    }
+    pool->close();
+}
+
+TEST_F(ThreadPoolTest, testException) {
+    ThreadPoolPtr pool = newLucene<ThreadPool>(2);
+    FuturePtr future = pool->scheduleTask(boost::protect(boost::bind<int32_t>(&TestThreadPool::fail, 1)));
+    try {
+        future->get<int32_t>();
+        FAIL() << "expected exception";
+    } catch (LuceneException& e) {
+        EXPECT_TRUE(check_exception(LuceneException::IllegalState)(e));
+    }
+
+    // the pool keeps working after a task failed
+    EXPECT_EQ(pool->scheduleTask(boost::protect(boost::bind<int32_t>(&TestThreadPool::square, 3)))->get<int32_t>(), 9);
+}
+
+TEST_F(ThreadPoolTest, testUnknownException) {
+    ThreadPoolPtr pool = newLucene<ThreadPool>(2);
+    FuturePtr future = pool->scheduleTask(boost::protect(boost::bind<int32_t>(&TestThreadPool::throwUnknown, 1)));
+    try {
+        future->get<int32_t>();
+        FAIL() << "expected exception";
+    } catch (LuceneException& e) {
+        EXPECT_TRUE(check_exception(LuceneException::Runtime)(e));
+    }
+    pool->close();
+}
+
+TEST_F(ThreadPoolTest, testDestroyFromWorker) {
+    boost::mutex mutex;
+    FuturePtr future;
+    {
+        boost::mutex::scoped_lock lock(mutex);
+        ThreadPoolPtr pool = newLucene<ThreadPool>(2);
+        future = pool->scheduleTask(boost::protect(boost::bind<int32_t>(&TestThreadPool::waitAndHold, pool, &mutex)));
+    }
+    // the worker releases the last reference, so the pool is destroyed on its own thread
+    EXPECT_EQ(future->get<int32_t>(), 1);
+}
+
+TEST_F(ThreadPoolTest, testNestedTasks) {
+    // a single worker waiting on its own sub-tasks must not deadlock
+    ThreadPoolPtr pool = newLucene<ThreadPool>(1);
+    FuturePtr future = pool->scheduleTask(boost::protect(boost::bind<int32_t>(&TestThreadPool::sumSquares, pool, 10)));
+    EXPECT_EQ(future->get<int32_t>(), 285);
+    pool->close();
+}
+
+TEST_F(ThreadPoolTest, testClose) {
+    ThreadPoolPtr pool = newLucene<ThreadPool>(2);
+    FuturePtr future = pool->scheduleTask(boost::protect(boost::bind<int32_t>(&TestThreadPool::square, 5)));
+    pool->close();
+    EXPECT_EQ(future->get<int32_t>(), 25);
+    try {
+        pool->scheduleTask(boost::protect(boost::bind<int32_t>(&TestThreadPool::square, 5)));
+        FAIL() << "expected exception";
+    } catch (LuceneException& e) {
+        EXPECT_TRUE(check_exception(LuceneException::IllegalState)(e));
+    }
+}